@@ -0,0 +1,96 @@
+#ifndef TACORE_ALIAS_TABLE_H
+#define TACORE_ALIAS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace TACore
+{
+
+	/**
+	* @brief	Alias table of a discrete distribution, Vose's method
+	*			See http://www.keithschwarz.com/darts-dice-coins/
+	*			Built in O(n) from non negative weights, an index is drawn in O(1) from two random numbers
+	*/
+	class AliasTable
+	{
+	public:
+		AliasTable() : m_lfTotalWeight(0.0) {}
+
+		/**
+		* @brief	Builds the table from the weights
+		* @param	weights Non negative weights of the indices
+		* @param	noWeights Number of weights
+		*/
+		void build(const double* weights, const int& noWeights)
+		{
+			m_vProbabilities = std::vector<double>(noWeights, 1.0);
+			m_vAliases = std::vector<int>(noWeights);
+			m_lfTotalWeight = 0.0;
+			for (int i = 0; i < noWeights; i++)
+			{
+				m_lfTotalWeight += weights[i];
+				m_vAliases[i] = i;
+			}
+			if (!(m_lfTotalWeight > 0.0))
+			{
+				return;
+			}
+
+			//Scaled weights are 1 on average, small ones borrow from the large ones
+			std::vector<double> scaled(noWeights);
+			std::vector<int> small, large;
+			for (int i = 0; i < noWeights; i++)
+			{
+				scaled[i] = weights[i] * noWeights / m_lfTotalWeight;
+				if (scaled[i] < 1.0) small.push_back(i);
+				else large.push_back(i);
+			}
+			while (!small.empty() && !large.empty())
+			{
+				const int s = small.back(); small.pop_back();
+				const int l = large.back(); large.pop_back();
+				m_vProbabilities[s] = scaled[s];
+				m_vAliases[s] = l;
+				scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+				if (scaled[l] < 1.0) small.push_back(l);
+				else large.push_back(l);
+			}
+			//Remaining ones are 1 up to the rounding errors
+			for (size_t i = 0; i < small.size(); i++) m_vProbabilities[small[i]] = 1.0;
+			for (size_t i = 0; i < large.size(); i++) m_vProbabilities[large[i]] = 1.0;
+		}
+
+		/**
+		* @brief	Draws an index
+		* @param	randomColumn 32 bit random number selecting the column
+		* @param	randomCoin 32 bit random number selecting the column itself or its alias
+		* @return	Index drawn with the probability proportional to its weight
+		*/
+		int sample(const uint32_t& randomColumn, const uint32_t& randomCoin) const
+		{
+			const int column = (int)(((uint64_t)randomColumn * m_vAliases.size()) >> 32);
+			const double coin = randomCoin * (1.0 / 4294967296.0);
+			return coin < m_vProbabilities[column] ? column : m_vAliases[column];
+		}
+
+		/**
+		* @brief	Gets the number of indices
+		*/
+		int size() const { return (int)m_vAliases.size(); }
+
+		/**
+		* @brief	Gets the sum of the weights
+		*/
+		double getTotalWeight() const { return m_lfTotalWeight; }
+
+	private:
+		std::vector<double> m_vProbabilities;	///< Probability of selecting the column itself instead of its alias
+		std::vector<int> m_vAliases;			///< Alias of each column
+		double m_lfTotalWeight;					///< Sum of the weights
+	};
+
+} // namespace TACore
+
+#endif // AliasTable
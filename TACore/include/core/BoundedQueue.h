@@ -0,0 +1,111 @@
+#ifndef TACORE_BOUNDED_QUEUE_H
+#define TACORE_BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace TACore
+{
+
+	/**
+	* @brief	First in first out queue between producer and consumer threads with a limited number of items and total weight.
+	*			Weight of an item is given by the producer, e.g. its estimated size in bytes, so the queue bounds the memory held by its items
+	*			push blocks while the queue is full and pop blocks while it is empty, close wakes both up
+	*			An item heavier than the weight limit is accepted when the queue is empty, so it does not block forever
+	*/
+	template <class T>
+	class BoundedQueue
+	{
+	public:
+		/**
+		* @brief	Creates an empty queue
+		* @param	maxItems Maximum number of items, at least 1
+		* @param	maxWeight Maximum total weight of the items, 0 for no limit
+		*/
+		BoundedQueue(const size_t& maxItems, const unsigned long long& maxWeight)
+		{
+			this->m_nMaxItems = (maxItems > 0) ? maxItems : 1;
+			this->m_nMaxWeight = maxWeight;
+			this->m_nWeight = 0;
+			this->m_bIsClosed = false;
+		}
+
+		/**
+		* @brief	Appends an item, waits while the queue is full
+		* @param	item Item to be appended
+		* @param	weight Weight of the item
+		* @return	true if appended, false if the queue is closed
+		*/
+		bool push(const T& item, const unsigned long long& weight)
+		{
+			std::unique_lock<std::mutex> lock(this->m_Mutex);
+			while (!this->m_bIsClosed && !this->m_Items.empty()
+				&& (this->m_Items.size() >= this->m_nMaxItems || (this->m_nMaxWeight != 0 && this->m_nWeight + weight > this->m_nMaxWeight)))
+			{
+				this->m_NotFull.wait(lock);
+			}
+			if (this->m_bIsClosed)
+			{
+				return false;
+			}
+
+			this->m_Items.push_back(std::make_pair(item, weight));
+			this->m_nWeight += weight;
+			this->m_NotEmpty.notify_one();
+			return true;
+		}
+
+		/**
+		* @brief	Removes the first item, waits while the queue is empty
+		* @param	[out] outItem Removed item
+		* @return	true if an item is removed, false if the queue is closed and empty
+		*/
+		bool pop(T& outItem)
+		{
+			std::unique_lock<std::mutex> lock(this->m_Mutex);
+			while (!this->m_bIsClosed && this->m_Items.empty())
+			{
+				this->m_NotEmpty.wait(lock);
+			}
+			if (this->m_Items.empty())
+			{
+				return false;
+			}
+
+			outItem = this->m_Items.front().first;
+			this->m_nWeight -= this->m_Items.front().second;
+			this->m_Items.pop_front();
+			this->m_NotFull.notify_all();
+			return true;
+		}
+
+		/**
+		* @brief	Closes the queue, later pushes fail and pops fail once the remaining items are removed
+		* @return	void
+		*/
+		void close()
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_bIsClosed = true;
+			this->m_NotEmpty.notify_all();
+			this->m_NotFull.notify_all();
+		}
+
+	private:
+		BoundedQueue(const BoundedQueue& other);
+		BoundedQueue& operator=(const BoundedQueue& other);
+
+		std::deque<std::pair<T, unsigned long long> > m_Items;	///< Items and their weights in the order they are pushed
+		size_t m_nMaxItems;										///< Maximum number of items
+		unsigned long long m_nMaxWeight;						///< Maximum total weight, 0 for no limit
+		unsigned long long m_nWeight;							///< Total weight of the items
+		bool m_bIsClosed;										///< Whether the queue is closed or not
+		std::mutex m_Mutex;										///< Guards the items and the state
+		std::condition_variable m_NotEmpty;						///< Signalled when an item is pushed or the queue is closed
+		std::condition_variable m_NotFull;						///< Signalled when an item is popped or the queue is closed
+	};
+
+} //namespace TACore
+
+#endif
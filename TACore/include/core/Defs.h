@@ -73,6 +73,11 @@ namespace TACore
 #	endif
 #elif __cplusplus > 199711L
 #	define TACORE_IS_CPP11
+#endif
+
+	// SSE2 is there on every x64 target and on x86 targets built with /arch:SSE2 or -msse2
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	define TACORE_HAS_SSE2
 #endif
 
 } // namespace TACore
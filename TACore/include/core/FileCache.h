@@ -0,0 +1,141 @@
+#ifndef TACORE_FILE_CACHE_H
+#define TACORE_FILE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include "core/Defs.h"
+
+namespace TACore
+{
+
+	/**
+	* @brief	Content addressed cache of files in a folder.
+	*			An entry is named by a key created from the hash of the content it is produced from, e.g. a mesh,
+	*			the name and the version of its producer and the parameters of the producer, so a changed input never finds a stale entry
+	*			A producer increases its version when the content or the format of its entries changes, then the old entries are never found and are evicted in time
+	*			Entries are written to a temporary file first and renamed into place, so a partially written entry is never found
+	*			Last access time of an entry is its modification time, which is renewed by find,
+	*			least recently used entries are removed when the total size exceeds the limit
+	*			The folder is scanned on open and then only when the size inserted since the last scan may exceed the limit
+	*			No index file is kept, so several processes can share the same cache folder
+	*			find, insert, insertCopy, copyEntry and evict can be called from several threads of a process, open and close cannot
+	*/
+	class FileCache
+	{
+	public:
+		FileCache();
+		~FileCache();
+
+		/**
+		* @brief	Opens a cache folder, the folder is created if it does not exist
+		* @param	cacheFolder Path of the folder
+		* @param	maxSizeInBytes Maximum total size of the entries, 0 for no limit
+		* @return	TACORE_OK if the folder can be used
+		* @return	TACORE_FILE_ERROR if the folder cannot be created
+		*/
+		Result open(const std::string& cacheFolder, const unsigned long long& maxSizeInBytes);
+
+		/**
+		* @brief	Closes the cache, entries are kept in the folder
+		*/
+		void close();
+
+		/**
+		* @brief	Query if a cache folder is opened.
+		* @return	true if opened, false otherwise.
+		*/
+		bool isOpen() const;
+
+		/**
+		* @brief	Creates the key of an entry
+		* @param	contentHash Hash of the content the entry is produced from, e.g. TriangularMesh::calcContentHash
+		* @param	producer Name of the producer of the entry, used as the prefix of the file name
+		* @param	producerVersion Version of the content and the format of the entries of the producer
+		* @param	parameters Names and values of the parameters of the producer
+		* @param	extension Extension of the file of the entry
+		* @return	Key in the form producer-vVersion-hash.extension where hash is 16 hex digits
+		*/
+		static std::string createKey(const unsigned long long& contentHash, const std::string& producer, const unsigned int& producerVersion,
+			const std::vector<std::pair<std::string, std::string> >& parameters, const std::string& extension);
+
+		/**
+		* @brief	Finds an entry and marks it as the most recently used
+		* @param	key Key of the entry
+		* @param	[out] outPath Path of the file of the entry
+		* @return	true if the entry exists, false otherwise
+		*/
+		bool find(const std::string& key, std::string& outPath);
+
+		/**
+		* @brief	Gets a path to write a new entry, unique for each call
+		* @param	key Key of the entry
+		* @return	Path of the temporary file to be given to insert
+		*/
+		std::string getTemporaryPath(const std::string& key) const;
+
+		/**
+		* @brief	Inserts a file written to a temporary path as an entry and evicts the least recently used entries if needed
+		*			An existing entry with the same key is replaced
+		* @param	key Key of the entry
+		* @param	temporaryPath Path returned by getTemporaryPath, the file is moved
+		* @return	TACORE_OK if the entry is inserted
+		* @return	TACORE_INVALID_OPERATION if the cache is not opened
+		* @return	TACORE_FILE_ERROR if the file cannot be moved, the temporary file is removed
+		*/
+		Result insert(const std::string& key, const std::string& temporaryPath);
+
+		/**
+		* @brief	Inserts a copy of a file as an entry
+		* @param	key Key of the entry
+		* @param	sourcePath Path of the file to be copied
+		* @return	TACORE_OK if the entry is inserted
+		* @return	TACORE_INVALID_OPERATION if the cache is not opened
+		* @return	TACORE_FILE_ERROR if the file cannot be copied
+		*/
+		Result insertCopy(const std::string& key, const std::string& sourcePath);
+
+		/**
+		* @brief	Copies the file of an entry and marks it as the most recently used
+		* @param	key Key of the entry
+		* @param	destinationPath Path of the copy
+		* @return	TACORE_OK if the entry is copied
+		* @return	TACORE_FILE_ERROR if the entry does not exist or cannot be copied
+		*/
+		Result copyEntry(const std::string& key, const std::string& destinationPath);
+
+		/**
+		* @brief	Removes the least recently used entries until the total size is within the limit
+		*			Entries which cannot be removed, e.g. mapped ones on Windows, are skipped
+		* @param	keptKey Key of an entry which is never removed, e.g. the one just inserted, may be empty
+		* @return	void
+		*/
+		void evict(const std::string& keptKey);
+
+		//Getters
+		const std::string& getCacheFolder() const;
+		unsigned long long getMaxSize() const;
+
+	private:
+		FileCache(const FileCache& other);
+		FileCache& operator=(const FileCache& other);
+
+		/**
+		* @brief	Copies a file
+		* @param	sourcePath Path of the file to be copied
+		* @param	destinationPath Path of the copy
+		* @return	TACORE_OK if the file is copied
+		* @return	TACORE_FILE_ERROR if the files cannot be opened or written
+		*/
+		static Result copyFile(const std::string& sourcePath, const std::string& destinationPath);
+
+		std::string m_sCacheFolder;			///< Cache folder ending with a separator
+		unsigned long long m_nMaxSize;		///< Maximum total size of the entries in bytes, 0 for no limit
+		unsigned long long m_nKnownSize;	///< Total size found by the last eviction plus the size inserted by this object since then
+		bool m_bIsOpen;						///< Whether a cache folder is opened or not
+		std::mutex m_SizeMutex;				///< Guards the known size and the eviction
+	};
+
+} //namespace TACore
+
+#endif
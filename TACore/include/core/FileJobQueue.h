@@ -0,0 +1,199 @@
+#ifndef TACORE_FILE_JOB_QUEUE_H
+#define TACORE_FILE_JOB_QUEUE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/Defs.h"
+
+namespace TACore
+{
+
+	/**
+	* @brief	Queue of jobs kept as files in a folder, so worker processes on one or several machines can share it through a shared file system.
+	*			A job is a small text file named after the job, it is moved among the pending, running, done and failed subfolders of the queue folder
+	*			A worker claims a job by renaming it from pending to running, only one of the workers renaming the same file succeeds
+	*			Jobs are written to a temporary file first and renamed into pending, so a partially written job is never claimed
+	*			A running job whose file is not renewed for a while is assumed to belong to a dead worker and is moved back to pending
+	*			Jobs claimed through a queue object can be renewed by its heartbeat thread until they are finished, e.g. while they wait to be processed
+	*			Ages of the jobs are measured by the clock of the file system: the current time is read from a probe file touched by the caller,
+	*			so the clocks of the machines may differ as long as the file server sets the times of the touched files, as e.g. NFS does
+	*			A job may rarely be run twice, e.g. by a worker which is too slow to renew it, so running a job must be idempotent
+	*			All methods except open and close can be called from several threads of a process
+	*/
+	class FileJobQueue
+	{
+	public:
+		//States of a job, each has its own subfolder
+		enum JobState
+		{
+			JOB_PENDING = 0,
+			JOB_RUNNING,
+			JOB_DONE,
+			JOB_FAILED
+		};
+
+		FileJobQueue();
+		~FileJobQueue();
+
+		/**
+		* @brief	Opens a queue folder, the folder and its subfolders are created if they do not exist
+		* @param	queueFolder Path of the folder
+		* @return	TACORE_OK if the folder can be used
+		* @return	TACORE_FILE_ERROR if the folders cannot be created
+		*/
+		Result open(const std::string& queueFolder);
+
+		/**
+		* @brief	Closes the queue, jobs are kept in the folder
+		*/
+		void close();
+
+		/**
+		* @brief	Query if a queue folder is opened.
+		* @return	true if opened, false otherwise.
+		*/
+		bool isOpen() const;
+
+		/**
+		* @brief	Adds a pending job, a done or failed job with the same name is run again
+		* @param	name Name of the job, used as a file name
+		* @param	content Content of the job, e.g. what the worker is going to process
+		* @return	TACORE_OK if the job is added
+		* @return	TACORE_INVALID_OPERATION if the queue is not opened or the job is already pending or running
+		* @return	TACORE_FILE_ERROR if the job cannot be written
+		*/
+		Result addJob(const std::string& name, const std::string& content);
+
+		/**
+		* @brief	Claims the first pending job in the order of names
+		* @param	namePrefix Only the jobs whose names start with the prefix are claimed, may be empty
+		* @param	[out] outName Name of the claimed job
+		* @param	[out] outContent Content of the claimed job
+		* @return	true if a job is claimed, false if no pending job is left
+		*/
+		bool claimJob(const std::string& namePrefix, std::string& outName, std::string& outContent);
+
+		/**
+		* @brief	Claims a pending job, waits while there is no pending job but some are running
+		*			Running jobs of dead workers are moved back to pending while waiting, so they are eventually claimed
+		* @param	namePrefix Only the jobs whose names start with the prefix are considered, may be empty
+		* @param	maxAgeInSeconds Time after which a running job which is not renewed is assumed to be abandoned
+		* @param	pollIntervalInSeconds Time to sleep between checks
+		* @param	[out] outName Name of the claimed job
+		* @param	[out] outContent Content of the claimed job
+		* @return	true if a job is claimed, false if no job is pending or running
+		*/
+		bool waitForJob(const std::string& namePrefix, const unsigned int& maxAgeInSeconds, const unsigned int& pollIntervalInSeconds,
+			std::string& outName, std::string& outContent);
+
+		/**
+		* @brief	Marks a running job as alive, should be called more often than the age limit of the workers
+		* @param	name Name of the job
+		* @return	void
+		*/
+		void renewJob(const std::string& name);
+
+		/**
+		* @brief	Starts a thread renewing the jobs claimed through this object until they are finished, so a worker does not need to renew them itself
+		* @param	intervalInSeconds Time between the renewals, should be well below the age limit of the workers
+		* @return	TACORE_OK if the thread is started
+		* @return	TACORE_INVALID_OPERATION if the queue is not opened or the heartbeat is already started
+		*/
+		Result startHeartbeat(const unsigned int& intervalInSeconds);
+
+		/**
+		* @brief	Stops the heartbeat thread, claimed jobs which are not finished are not renewed anymore
+		* @return	void
+		*/
+		void stopHeartbeat();
+
+		/**
+		* @brief	Moves a running job to done or failed
+		* @param	name Name of the job
+		* @param	isSucceeded Whether the job is done or failed
+		* @return	TACORE_OK if the job is moved
+		* @return	TACORE_INVALID_OPERATION if the queue is not opened
+		* @return	TACORE_FILE_ERROR if the job is not running anymore, e.g. it is moved back to pending by another worker
+		*/
+		Result finishJob(const std::string& name, bool isSucceeded);
+
+		/**
+		* @brief	Moves the running jobs which are not renewed for a while back to pending
+		*			A stale job is first moved aside under a name only the caller uses and checked again, so a job which other workers requeue
+		*			and claim meanwhile is given back to its new worker instead of being requeued a second time
+		*			Nothing is requeued if the current time of the file system cannot be read
+		* @param	namePrefix Only the jobs whose names start with the prefix are considered, may be empty
+		* @param	maxAgeInSeconds Time after which a running job which is not renewed is assumed to be abandoned
+		* @return	Number of jobs moved back to pending
+		*/
+		size_t requeueStaleJobs(const std::string& namePrefix, const unsigned int& maxAgeInSeconds);
+
+		/**
+		* @brief	Gets the names of the jobs in a state
+		* @param	state State of the jobs
+		* @param	namePrefix Only the jobs whose names start with the prefix are listed, may be empty
+		* @param	[out] outNames Names of the jobs in ascending order
+		* @return	void
+		*/
+		void getJobNames(JobState state, const std::string& namePrefix, std::vector<std::string>& outNames) const;
+
+		/**
+		* @brief	Creates an identifier of the calling process which is unique among the machines, e.g. to name the files written by a worker
+		* @return	Host name and process id in the form host-pid, characters which are not safe in file names are replaced
+		*/
+		static std::string createWorkerId();
+
+		//Getters
+		const std::string& getQueueFolder() const;
+
+	private:
+		FileJobQueue(const FileJobQueue& other);
+		FileJobQueue& operator=(const FileJobQueue& other);
+
+		/**
+		* @brief	Gets the path of the file of a job
+		* @param	state State of the job
+		* @param	name Name of the job
+		* @return	Path of the file in the subfolder of the state
+		*/
+		std::string getJobPath(JobState state, const std::string& name) const;
+
+		/**
+		* @brief	Gets a path in the queue folder which no other thread or worker uses, such files are not listed as jobs
+		* @param	name Name of the job the file belongs to
+		* @return	Path of the temporary file
+		*/
+		std::string createTemporaryPath(const std::string& name) const;
+
+		/**
+		* @brief	Reads the current time of the file system by touching the probe file of the queue, which is created if it is missing
+		* @param	[out] outTime Modification time of the probe file
+		* @return	true if the time is read, false if the probe file cannot be created
+		*/
+		bool getFileSystemTime(long long& outTime) const;
+
+		/**
+		* @brief	Renews the claimed jobs periodically until the heartbeat is stopped, run by the heartbeat thread
+		* @return	void
+		*/
+		void runHeartbeat();
+
+		std::string m_sQueueFolder;						///< Queue folder ending with a separator
+		std::string m_sProbePath;						///< File touched to read the time of the file system, removed when the queue is closed
+		bool m_bIsOpen;									///< Whether a queue folder is opened or not
+
+		std::mutex m_Mutex;								///< Guards the claimed jobs and the state of the heartbeat
+		std::set<std::string> m_ClaimedJobs;			///< Jobs claimed through this object which are not finished yet
+		std::thread m_HeartbeatThread;					///< Thread renewing the claimed jobs
+		std::condition_variable m_HeartbeatCondition;	///< Wakes the heartbeat thread up when it is stopped
+		unsigned int m_nHeartbeatInterval;				///< Time between the renewals in seconds
+		bool m_bIsHeartbeatRunning;						///< Whether the heartbeat thread is running or not
+	};
+
+} //namespace TACore
+
+#endif
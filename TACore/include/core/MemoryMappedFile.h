@@ -0,0 +1,70 @@
+#ifndef TACORE_MEMORY_MAPPED_FILE_H
+#define TACORE_MEMORY_MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include "core/Defs.h"
+
+namespace TACore
+{
+
+	/**
+	* @brief	Read only view of a whole file mapped into the memory.
+	*			Pages are loaded by the operating system when they are accessed, so reading a small part of a big file is cheap
+	*			The object is not copyable, share it through a pointer if needed
+	*/
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile();
+		~MemoryMappedFile();
+
+		/**
+		* @brief	Maps the file into the memory. An already opened file is closed first
+		* @param	pathToFile Path of the file
+		* @return	TACORE_OK if the file is mapped
+		* @return	TACORE_FILE_ERROR if the file cannot be opened or mapped
+		*/
+		Result open(const std::string& pathToFile);
+
+		/**
+		* @brief	Unmaps the file
+		*/
+		void close();
+
+		/**
+		* @brief	Query if a file is mapped.
+		* @return	true if a file is mapped, false otherwise.
+		*/
+		bool isOpen() const;
+
+		/**
+		* @brief	Gets the first byte of the mapped file.
+		* @return	Pointer to the mapped bytes, NULL if no file is mapped or the file is empty.
+		*/
+		const unsigned char* getData() const;
+
+		/**
+		* @brief	Gets the size of the mapped file.
+		* @return	Size of the file in bytes.
+		*/
+		size_t getSize() const;
+
+	private:
+		MemoryMappedFile(const MemoryMappedFile& other);
+		MemoryMappedFile& operator=(const MemoryMappedFile& other);
+
+		const unsigned char* m_pData;	///< First byte of the mapping
+		size_t m_nSize;					///< Size of the mapping in bytes
+		bool m_bIsOpen;					///< Whether a file is mapped or not
+#ifdef TACORE_IS_WINDOWS
+		void* m_hFile;					///< Handle of the file
+		void* m_hMapping;				///< Handle of the file mapping object
+#else
+		int m_nFileDescriptor;			///< Descriptor of the file
+#endif
+	};
+
+} // namespace TACore
+
+#endif // MemoryMappedFile
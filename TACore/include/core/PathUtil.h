@@ -192,11 +192,34 @@ namespace TACore
 		static const std::wstring getCurrentDirectoryW();
 
 		/**
-		* Takes a folder path that ends with a separator
+		* Takes a folder path, the separator at the end is optional
 		* fills the vector entries with the files/foldes under the path
 		* by filtering with the parameters ext, getFolders and getHiddens
 		*/
-		static const void getDirectoryEntries(const std::string& path, std::vector<std::string>& entries, const std::string& ext = "", bool getFolders = false, bool getHiddens = false);
+		static const void getDirectoryEntries(const std::string& folderPath, std::vector<std::string>& entries, const std::string& ext = "", bool getFolders = false, bool getHiddens = false);
+
+		/**
+		* Size and modification time of a file
+		* \return false if the file does not exist or it is a folder
+		*/
+		static bool getFileStatus(const std::string& path, unsigned long long& size, long long& modificationTime);
+
+		/**
+		* Sets the modification time of a file to now
+		*/
+		static void touchFile(const std::string& path);
+
+		/**
+		* Moves a file replacing the destination, atomic if both are in the same folder
+		* \return false if the file cannot be moved
+		*/
+		static bool moveFile(const std::string& sourcePath, const std::string& destinationPath);
+
+		/**
+		* Creates a folder and its missing parents
+		* \return false if the folder does not exist afterwards
+		*/
+		static bool createFolder(const std::string& path);
 	};
 
 } //namespace TACore
@@ -0,0 +1,260 @@
+#ifndef TACORE_PHILOX_RANDOM_H
+#define TACORE_PHILOX_RANDOM_H
+
+#include <core/Defs.h>
+#include <cstdint>
+#ifdef TACORE_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace TACore
+{
+
+	/**
+	* @brief	Counter based random number generator, Philox4x32-10
+	*			See http://www.thesalmons.org/john/random123/papers/random123sc11.pdf
+	*			Each (key, stream) pair is an independent stream of random numbers, so a stream can be created for any piece of work
+	*			without sharing a state between threads, and the numbers do not depend on which thread draws them
+	*			Numbers of a stream are produced by encrypting the counter (block, 0, stream low, stream high) with the key
+	*/
+	class PhiloxRandom
+	{
+	public:
+		/**
+		* @brief	Creates the stream of the key
+		* @param	key Key of the generator, i.e. the seed given by the user
+		* @param	streamLow Low word of the stream id
+		* @param	streamHigh High word of the stream id
+		*/
+		PhiloxRandom(const uint64_t& key, const uint32_t& streamLow, const uint32_t& streamHigh)
+		{
+			m_vKey[0] = (uint32_t)key;
+			m_vKey[1] = (uint32_t)(key >> 32);
+			m_vCounter[0] = 0;
+			m_vCounter[1] = 0;
+			m_vCounter[2] = streamLow;
+			m_vCounter[3] = streamHigh;
+			m_nNumberOfUnused = 0;
+		}
+
+		/**
+		* @brief	Draws the next 32 bit random number
+		* @return	Uniform random number in [0, 2^32)
+		*/
+		uint32_t next()
+		{
+			if (m_nNumberOfUnused == 0)
+			{
+				generateBlock();
+			}
+			return m_vOutput[4 - m_nNumberOfUnused--];
+		}
+
+		/**
+		* @brief	Draws the next count 32 bit random numbers at once, same numbers as count calls of next
+		*			Whole blocks are encrypted in a tight loop, four at a time so that their multiplications overlap,
+		*			which is much faster than drawing the numbers one by one
+		* @param	[out] out Random numbers
+		* @param	count Number of random numbers
+		*/
+		void fill(uint32_t* out, const int& count)
+		{
+			int i = 0;
+			while (i < count && m_nNumberOfUnused > 0)
+			{
+				out[i++] = next();
+			}
+			for (; i + 16 <= count && m_vCounter[0] <= 0xFFFFFFFCu; i += 16)
+			{
+				encryptFourBlocks(m_vCounter, m_vKey, out + i);
+				for (int b = 0; b < 4; b++)
+				{
+					incrementCounter();
+				}
+			}
+			for (; i + 4 <= count; i += 4)
+			{
+				encryptBlock(m_vCounter, m_vKey, out + i);
+				incrementCounter();
+			}
+			while (i < count)
+			{
+				out[i++] = next();
+			}
+		}
+
+		/**
+		* @brief	Maps a 32 bit random number into [0, range) by multiplying and shifting
+		*			Bias of a value is smaller than range / 2^32, use nextInt if no bias is allowed
+		* @param	random 32 bit random number
+		* @param	range Number of possible values
+		* @return	Random integer in [0, range)
+		*/
+		static uint32_t toRange(const uint32_t& random, const uint32_t& range)
+		{
+			return (uint32_t)(((uint64_t)random * range) >> 32);
+		}
+
+		/**
+		* @brief	Draws a random integer without bias
+		*			Multiplies a 32 bit number by the range and rejects the numbers falling into the uneven part
+		*			See https://arxiv.org/abs/1805.10941
+		* @param	range Number of possible values, must be positive
+		* @return	Uniform random integer in [0, range)
+		*/
+		uint32_t nextInt(const uint32_t& range)
+		{
+			uint64_t product = (uint64_t)next() * range;
+			uint32_t low = (uint32_t)product;
+			if (low < range)
+			{
+				const uint32_t threshold = (uint32_t)(0u - range) % range;
+				while (low < threshold)
+				{
+					product = (uint64_t)next() * range;
+					low = (uint32_t)product;
+				}
+			}
+			return (uint32_t)(product >> 32);
+		}
+
+		/**
+		* @brief	Draws a random double with 53 random bits
+		* @return	Uniform random number in [0, 1)
+		*/
+		double nextDouble()
+		{
+			const uint64_t high = next() >> 5;
+			const uint64_t low = next() >> 6;
+			return (high * 67108864.0 + low) * (1.0 / 9007199254740992.0);
+		}
+
+	private:
+		uint32_t m_vKey[2];				///< Key of the generator
+		uint32_t m_vCounter[4];			///< Counter of the next block, first word is the block index inside the stream
+		uint32_t m_vOutput[4];			///< Last generated block
+		int m_nNumberOfUnused;			///< Number of numbers of the last block which are not drawn yet
+
+		static void mulhilo(const uint32_t& a, const uint32_t& b, uint32_t& hi, uint32_t& lo)
+		{
+			const uint64_t product = (uint64_t)a * b;
+			hi = (uint32_t)(product >> 32);
+			lo = (uint32_t)product;
+		}
+
+#ifdef TACORE_HAS_SSE2
+		//Products of the four lanes, SSE2 multiplies only the even lanes into 64 bits, so the odd lanes are shifted down for a second multiplication
+		static void mulhilo(const __m128i& a, const __m128i& b, __m128i& hi, __m128i& lo)
+		{
+			const __m128i evenProducts = _mm_mul_epu32(a, b);
+			const __m128i oddProducts = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			const __m128i evenWords = _mm_shuffle_epi32(evenProducts, _MM_SHUFFLE(3, 1, 2, 0));
+			const __m128i oddWords = _mm_shuffle_epi32(oddProducts, _MM_SHUFFLE(3, 1, 2, 0));
+			lo = _mm_unpacklo_epi32(evenWords, oddWords);
+			hi = _mm_unpackhi_epi32(evenWords, oddWords);
+		}
+#endif
+
+		static void encryptBlock(const uint32_t* counter, const uint32_t* key, uint32_t* out)
+		{
+			uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+			uint32_t k0 = key[0], k1 = key[1];
+			for (int round = 0; round < 10; round++)
+			{
+				uint32_t hi0, lo0, hi1, lo1;
+				mulhilo(0xD2511F53u, c0, hi0, lo0);
+				mulhilo(0xCD9E8D57u, c2, hi1, lo1);
+				c0 = hi1 ^ c1 ^ k0;
+				c1 = lo1;
+				c2 = hi0 ^ c3 ^ k1;
+				c3 = lo0;
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+		}
+
+		//Same as four calls of encryptBlock for the counter and the three following ones, the low word of the counter must not wrap around among them
+		//A single block is a chain of dependent multiplications, so the blocks are encrypted together, in the lanes of SSE2 registers where it is there
+		static void encryptFourBlocks(const uint32_t* counter, const uint32_t* key, uint32_t* out)
+		{
+#ifdef TACORE_HAS_SSE2
+			//Words of the four blocks, e.g. c0 holds the first words of them
+			__m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)counter[0]), _mm_set_epi32(3, 2, 1, 0));
+			__m128i c1 = _mm_set1_epi32((int)counter[1]);
+			__m128i c2 = _mm_set1_epi32((int)counter[2]);
+			__m128i c3 = _mm_set1_epi32((int)counter[3]);
+			__m128i k0 = _mm_set1_epi32((int)key[0]);
+			__m128i k1 = _mm_set1_epi32((int)key[1]);
+			for (int round = 0; round < 10; round++)
+			{
+				__m128i hi0, lo0, hi1, lo1;
+				mulhilo(_mm_set1_epi32((int)0xD2511F53u), c0, hi0, lo0);
+				mulhilo(_mm_set1_epi32((int)0xCD9E8D57u), c2, hi1, lo1);
+				c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), k0);
+				c1 = lo1;
+				c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), k1);
+				c3 = lo0;
+				k0 = _mm_add_epi32(k0, _mm_set1_epi32((int)0x9E3779B9u));
+				k1 = _mm_add_epi32(k1, _mm_set1_epi32((int)0xBB67AE85u));
+			}
+
+			//Transposed back to one block after the other
+			const __m128i low01 = _mm_unpacklo_epi32(c0, c1), low23 = _mm_unpacklo_epi32(c2, c3);
+			const __m128i high01 = _mm_unpackhi_epi32(c0, c1), high23 = _mm_unpackhi_epi32(c2, c3);
+			_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi64(low01, low23));
+			_mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi64(low01, low23));
+			_mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi64(high01, high23));
+			_mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi64(high01, high23));
+#else
+			uint32_t c0[4], c1[4], c2[4], c3[4];
+			for (int b = 0; b < 4; b++)
+			{
+				c0[b] = counter[0] + b;
+				c1[b] = counter[1];
+				c2[b] = counter[2];
+				c3[b] = counter[3];
+			}
+			uint32_t k0 = key[0], k1 = key[1];
+			for (int round = 0; round < 10; round++)
+			{
+				for (int b = 0; b < 4; b++)
+				{
+					uint32_t hi0, lo0, hi1, lo1;
+					mulhilo(0xD2511F53u, c0[b], hi0, lo0);
+					mulhilo(0xCD9E8D57u, c2[b], hi1, lo1);
+					c0[b] = hi1 ^ c1[b] ^ k0;
+					c1[b] = lo1;
+					c2[b] = hi0 ^ c3[b] ^ k1;
+					c3[b] = lo0;
+				}
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			for (int b = 0; b < 4; b++)
+			{
+				out[4 * b] = c0[b]; out[4 * b + 1] = c1[b]; out[4 * b + 2] = c2[b]; out[4 * b + 3] = c3[b];
+			}
+#endif
+		}
+
+		//Block index is 64 bits wide
+		void incrementCounter()
+		{
+			if (++m_vCounter[0] == 0)
+			{
+				++m_vCounter[1];
+			}
+		}
+
+		void generateBlock()
+		{
+			encryptBlock(m_vCounter, m_vKey, m_vOutput);
+			incrementCounter();
+			m_nNumberOfUnused = 4;
+		}
+	};
+
+} // namespace TACore
+
+#endif // PhiloxRandom
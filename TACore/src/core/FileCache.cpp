@@ -0,0 +1,301 @@
+#include "core/FileCache.h"
+#include "core/PathUtil.h"
+#include "core/StringUtil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#ifdef TACORE_IS_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	//Mixes the bytes of a value into a 64 bit FNV-1a hash
+	void fnv1aHashBytes(unsigned long long& hash, const void* val, const size_t& size)
+	{
+		const unsigned char* bytes = (const unsigned char*)val;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+	}
+
+	//Mixes a string and its length into a 64 bit FNV-1a hash, the length keeps "ab"+"c" and "a"+"bc" apart
+	void fnv1aHashString(unsigned long long& hash, const std::string& str)
+	{
+		const unsigned int length = (unsigned int)str.size();
+		fnv1aHashBytes(hash, &length, sizeof(length));
+		fnv1aHashBytes(hash, str.data(), str.size());
+	}
+
+	//Entry of the cache folder considered by the eviction
+	struct CacheEntry
+	{
+		std::string m_sPath;
+		unsigned long long m_nSize;
+		long long m_nModificationTime;
+
+		bool operator<(const CacheEntry& other) const
+		{
+			if (this->m_nModificationTime != other.m_nModificationTime)
+			{
+				return this->m_nModificationTime < other.m_nModificationTime;
+			}
+			return this->m_sPath < other.m_sPath;
+		}
+	};
+}
+
+namespace TACore
+{
+	FileCache::FileCache()
+	{
+		this->m_nMaxSize = 0;
+		this->m_nKnownSize = 0;
+		this->m_bIsOpen = false;
+	}
+
+	FileCache::~FileCache()
+	{
+		close();
+	}
+
+	Result FileCache::open(const std::string& cacheFolder, const unsigned long long& maxSizeInBytes)
+	{
+		close();
+
+		std::string folder = cacheFolder;
+		while (folder.size() > 1 && (folder[folder.size() - 1] == '/' || folder[folder.size() - 1] == '\\'))
+		{
+			folder.erase(folder.size() - 1);
+		}
+		if (folder.empty() || !PathUtil::createFolder(folder))
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		//Directory listing expects the folder to end with a separator
+		this->m_sCacheFolder = PathUtil::joinPath(folder, "x");
+		this->m_sCacheFolder.erase(this->m_sCacheFolder.size() - 1);
+		this->m_nMaxSize = maxSizeInBytes;
+		this->m_nKnownSize = 0;
+		this->m_bIsOpen = true;
+		evict("");
+
+		return TACORE_OK;
+	}
+
+	void FileCache::close()
+	{
+		this->m_sCacheFolder = "";
+		this->m_nMaxSize = 0;
+		this->m_nKnownSize = 0;
+		this->m_bIsOpen = false;
+	}
+
+	bool FileCache::isOpen() const
+	{
+		return this->m_bIsOpen;
+	}
+
+	std::string FileCache::createKey(const unsigned long long& contentHash, const std::string& producer, const unsigned int& producerVersion,
+		const std::vector<std::pair<std::string, std::string> >& parameters, const std::string& extension)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		fnv1aHashBytes(hash, &contentHash, sizeof(contentHash));
+		fnv1aHashString(hash, producer);
+		fnv1aHashBytes(hash, &producerVersion, sizeof(producerVersion));
+		for (size_t i = 0; i < parameters.size(); i++)
+		{
+			fnv1aHashString(hash, parameters[i].first);
+			fnv1aHashString(hash, parameters[i].second);
+		}
+
+		const char* hexDigits = "0123456789abcdef";
+		std::string hexHash(16, '0');
+		for (int i = 15; i >= 0; i--)
+		{
+			hexHash[i] = hexDigits[hash & 0xF];
+			hash >>= 4;
+		}
+
+		return PathUtil::addExtension(producer + "-v" + StringUtil::str(producerVersion) + "-" + hexHash, extension);
+	}
+
+	bool FileCache::find(const std::string& key, std::string& outPath)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return false;
+		}
+
+		const std::string path = this->m_sCacheFolder + key;
+		unsigned long long size = 0;
+		long long modificationTime = 0;
+		if (!PathUtil::getFileStatus(path, size, modificationTime))
+		{
+			return false;
+		}
+		PathUtil::touchFile(path);
+		outPath = path;
+
+		return true;
+	}
+
+	std::string FileCache::getTemporaryPath(const std::string& key) const
+	{
+#ifdef TACORE_IS_WINDOWS
+		const int processId = (int)_getpid();
+#else
+		const int processId = (int)getpid();
+#endif
+		//Threads of the same process may write the same key at the same time
+		static std::atomic<unsigned int> temporaryFileCounter(0);
+		const unsigned int counter = temporaryFileCounter++;
+		return this->m_sCacheFolder + key + "." + StringUtil::str(processId) + "_" + StringUtil::str(counter) + ".tmp";
+	}
+
+	Result FileCache::insert(const std::string& key, const std::string& temporaryPath)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+
+		const std::string path = this->m_sCacheFolder + key;
+		if (!PathUtil::moveFile(temporaryPath, path))
+		{
+			remove(temporaryPath.c_str());
+			return TACORE_FILE_ERROR;
+		}
+
+		//Folder is scanned only when the entries known to this process may exceed the limit
+		unsigned long long size = 0;
+		long long modificationTime = 0;
+		bool isOverLimit = false;
+		if (PathUtil::getFileStatus(path, size, modificationTime))
+		{
+			std::lock_guard<std::mutex> lock(this->m_SizeMutex);
+			this->m_nKnownSize += size;
+			isOverLimit = (this->m_nMaxSize != 0 && this->m_nKnownSize > this->m_nMaxSize);
+		}
+		if (isOverLimit)
+		{
+			evict(key);
+		}
+
+		return TACORE_OK;
+	}
+
+	Result FileCache::insertCopy(const std::string& key, const std::string& sourcePath)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+
+		const std::string temporaryPath = getTemporaryPath(key);
+		if (copyFile(sourcePath, temporaryPath) != TACORE_OK)
+		{
+			remove(temporaryPath.c_str());
+			return TACORE_FILE_ERROR;
+		}
+
+		return insert(key, temporaryPath);
+	}
+
+	Result FileCache::copyEntry(const std::string& key, const std::string& destinationPath)
+	{
+		std::string path;
+		if (!find(key, path))
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		return copyFile(path, destinationPath);
+	}
+
+	void FileCache::evict(const std::string& keptKey)
+	{
+		if (!this->m_bIsOpen || this->m_nMaxSize == 0)
+		{
+			return;
+		}
+
+		//Entries inserted by other threads while scanning would be counted twice
+		std::lock_guard<std::mutex> lock(this->m_SizeMutex);
+		std::vector<std::string> paths;
+		PathUtil::getDirectoryEntries(this->m_sCacheFolder, paths);
+
+		//Temporary files are being written by some process, they are not entries yet
+		const std::string keptPath = this->m_sCacheFolder + keptKey;
+		std::vector<CacheEntry> entries;
+		unsigned long long totalSize = 0;
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			CacheEntry entry;
+			entry.m_sPath = paths[i];
+			if (PathUtil::getExtension(paths[i]) == "tmp" || !PathUtil::getFileStatus(paths[i], entry.m_nSize, entry.m_nModificationTime))
+			{
+				continue;
+			}
+			totalSize += entry.m_nSize;
+			if (paths[i] != keptPath)
+			{
+				entries.push_back(entry);
+			}
+		}
+
+		std::sort(entries.begin(), entries.end());
+		for (size_t i = 0; i < entries.size() && totalSize > this->m_nMaxSize; i++)
+		{
+			if (remove(entries[i].m_sPath.c_str()) == 0)
+			{
+				totalSize -= entries[i].m_nSize;
+			}
+		}
+		this->m_nKnownSize = totalSize;
+	}
+
+	const std::string& FileCache::getCacheFolder() const
+	{
+		return this->m_sCacheFolder;
+	}
+
+	unsigned long long FileCache::getMaxSize() const
+	{
+		return this->m_nMaxSize;
+	}
+
+	Result FileCache::copyFile(const std::string& sourcePath, const std::string& destinationPath)
+	{
+		std::ifstream inp(sourcePath.c_str(), std::ios::binary);
+		if (!inp.is_open())
+		{
+			return TACORE_FILE_ERROR;
+		}
+		std::ofstream out(destinationPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		//Streaming an empty buffer sets the fail bit, so an empty file is only created
+		if (inp.peek() != std::ifstream::traits_type::eof())
+		{
+			out << inp.rdbuf();
+		}
+		out.close();
+		if (out.fail())
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		return TACORE_OK;
+	}
+}
@@ -0,0 +1,429 @@
+#include "core/FileJobQueue.h"
+#include "core/PathUtil.h"
+#include "core/StringUtil.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef TACORE_IS_WINDOWS
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	//Subfolders of the queue folder in the order of FileJobQueue::JobState
+	const char* JOB_STATE_FOLDERS[] = { "pending", "running", "done", "failed" };
+
+	//Extension of the job files, temporary files are ignored while listing
+	const char* JOB_EXTENSION = "job";
+
+	//Whether a string starts with a prefix
+	bool startsWith(const std::string& str, const std::string& prefix)
+	{
+		return str.compare(0, prefix.size(), prefix) == 0;
+	}
+
+	//Process id of the caller
+	int getProcessId()
+	{
+#ifdef TACORE_IS_WINDOWS
+		return (int)_getpid();
+#else
+		return (int)getpid();
+#endif
+	}
+}
+
+namespace TACore
+{
+	FileJobQueue::FileJobQueue()
+	{
+		this->m_bIsOpen = false;
+		this->m_nHeartbeatInterval = 0;
+		this->m_bIsHeartbeatRunning = false;
+	}
+
+	FileJobQueue::~FileJobQueue()
+	{
+		close();
+	}
+
+	Result FileJobQueue::open(const std::string& queueFolder)
+	{
+		close();
+
+		std::string folder = queueFolder;
+		while (folder.size() > 1 && (folder[folder.size() - 1] == '/' || folder[folder.size() - 1] == '\\'))
+		{
+			folder.erase(folder.size() - 1);
+		}
+		if (folder.empty())
+		{
+			return TACORE_FILE_ERROR;
+		}
+		for (int i = JOB_PENDING; i <= JOB_FAILED; i++)
+		{
+			if (!PathUtil::createFolder(PathUtil::joinPath(folder, JOB_STATE_FOLDERS[i])))
+			{
+				return TACORE_FILE_ERROR;
+			}
+		}
+
+		//Paths of the jobs are appended to the folder, so it must end with a separator
+		this->m_sQueueFolder = PathUtil::joinPath(folder, "x");
+		this->m_sQueueFolder.erase(this->m_sQueueFolder.size() - 1);
+		this->m_sProbePath = createTemporaryPath("clock");
+		this->m_bIsOpen = true;
+
+		return TACORE_OK;
+	}
+
+	void FileJobQueue::close()
+	{
+		stopHeartbeat();
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_ClaimedJobs.clear();
+		}
+		if (!this->m_sProbePath.empty())
+		{
+			remove(this->m_sProbePath.c_str());
+		}
+		this->m_sProbePath = "";
+		this->m_sQueueFolder = "";
+		this->m_bIsOpen = false;
+	}
+
+	bool FileJobQueue::isOpen() const
+	{
+		return this->m_bIsOpen;
+	}
+
+	Result FileJobQueue::addJob(const std::string& name, const std::string& content)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+
+		unsigned long long size = 0;
+		long long modificationTime = 0;
+		if (PathUtil::getFileStatus(getJobPath(JOB_PENDING, name), size, modificationTime)
+			|| PathUtil::getFileStatus(getJobPath(JOB_RUNNING, name), size, modificationTime))
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+		remove(getJobPath(JOB_DONE, name).c_str());
+		remove(getJobPath(JOB_FAILED, name).c_str());
+
+		const std::string temporaryPath = createTemporaryPath(name);
+		std::ofstream out(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+		{
+			return TACORE_FILE_ERROR;
+		}
+		out << content;
+		out.close();
+		if (out.fail() || !PathUtil::moveFile(temporaryPath, getJobPath(JOB_PENDING, name)))
+		{
+			remove(temporaryPath.c_str());
+			return TACORE_FILE_ERROR;
+		}
+
+		return TACORE_OK;
+	}
+
+	bool FileJobQueue::claimJob(const std::string& namePrefix, std::string& outName, std::string& outContent)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return false;
+		}
+
+		std::vector<std::string> names;
+		getJobNames(JOB_PENDING, namePrefix, names);
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			//Another worker may have claimed the job since the listing, then the rename fails
+			const std::string runningPath = getJobPath(JOB_RUNNING, names[i]);
+			if (!PathUtil::moveFile(getJobPath(JOB_PENDING, names[i]), runningPath))
+			{
+				continue;
+			}
+			//Rename keeps the modification time, which would make the job look abandoned
+			PathUtil::touchFile(runningPath);
+
+			std::ifstream inp(runningPath.c_str(), std::ios::binary);
+			std::stringstream content;
+			if (inp.is_open() && inp.peek() != std::ifstream::traits_type::eof())
+			{
+				content << inp.rdbuf();
+			}
+			if (!inp.is_open() || inp.bad())
+			{
+				inp.close();
+				PathUtil::moveFile(runningPath, getJobPath(JOB_FAILED, names[i]));
+				continue;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(this->m_Mutex);
+				this->m_ClaimedJobs.insert(names[i]);
+			}
+			outName = names[i];
+			outContent = content.str();
+			return true;
+		}
+
+		return false;
+	}
+
+	bool FileJobQueue::waitForJob(const std::string& namePrefix, const unsigned int& maxAgeInSeconds, const unsigned int& pollIntervalInSeconds,
+		std::string& outName, std::string& outContent)
+	{
+		while (this->m_bIsOpen)
+		{
+			if (claimJob(namePrefix, outName, outContent))
+			{
+				return true;
+			}
+			if (requeueStaleJobs(namePrefix, maxAgeInSeconds) > 0)
+			{
+				continue;
+			}
+
+			std::vector<std::string> names;
+			getJobNames(JOB_PENDING, namePrefix, names);
+			if (names.empty())
+			{
+				getJobNames(JOB_RUNNING, namePrefix, names);
+				if (names.empty())
+				{
+					return false;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::seconds(pollIntervalInSeconds));
+		}
+
+		return false;
+	}
+
+	void FileJobQueue::renewJob(const std::string& name)
+	{
+		if (this->m_bIsOpen)
+		{
+			PathUtil::touchFile(getJobPath(JOB_RUNNING, name));
+		}
+	}
+
+	Result FileJobQueue::startHeartbeat(const unsigned int& intervalInSeconds)
+	{
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		if (!this->m_bIsOpen || this->m_bIsHeartbeatRunning)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+
+		this->m_nHeartbeatInterval = (intervalInSeconds > 0) ? intervalInSeconds : 1;
+		this->m_bIsHeartbeatRunning = true;
+		this->m_HeartbeatThread = std::thread(&FileJobQueue::runHeartbeat, this);
+
+		return TACORE_OK;
+	}
+
+	void FileJobQueue::stopHeartbeat()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_bIsHeartbeatRunning = false;
+		}
+		this->m_HeartbeatCondition.notify_all();
+		if (this->m_HeartbeatThread.joinable())
+		{
+			this->m_HeartbeatThread.join();
+		}
+	}
+
+	Result FileJobQueue::finishJob(const std::string& name, bool isSucceeded)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_ClaimedJobs.erase(name);
+		}
+		if (!PathUtil::moveFile(getJobPath(JOB_RUNNING, name), getJobPath(isSucceeded ? JOB_DONE : JOB_FAILED, name)))
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		return TACORE_OK;
+	}
+
+	size_t FileJobQueue::requeueStaleJobs(const std::string& namePrefix, const unsigned int& maxAgeInSeconds)
+	{
+		if (!this->m_bIsOpen)
+		{
+			return 0;
+		}
+
+		std::vector<std::string> names;
+		getJobNames(JOB_RUNNING, namePrefix, names);
+		long long now = 0;
+		if (names.empty() || !getFileSystemTime(now))
+		{
+			return 0;
+		}
+
+		size_t numberOfRequeued = 0;
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			const std::string runningPath = getJobPath(JOB_RUNNING, names[i]);
+			unsigned long long size = 0;
+			long long modificationTime = 0;
+			if (!PathUtil::getFileStatus(runningPath, size, modificationTime) || now - modificationTime <= (long long)maxAgeInSeconds)
+			{
+				continue;
+			}
+
+			//Only one of the workers noticing the same job succeeds in moving it aside
+			//Other workers may requeue, claim and renew it between the check and the move, the time of such a renewal moves along with the file
+			const std::string asidePath = createTemporaryPath(names[i]);
+			if (!PathUtil::moveFile(runningPath, asidePath))
+			{
+				continue;
+			}
+			if (PathUtil::getFileStatus(asidePath, size, modificationTime) && now - modificationTime <= (long long)maxAgeInSeconds)
+			{
+				//Given back to its new worker, whose renewal fails only if it happens while the job is aside
+				PathUtil::moveFile(asidePath, runningPath);
+				continue;
+			}
+			if (PathUtil::moveFile(asidePath, getJobPath(JOB_PENDING, names[i])))
+			{
+				numberOfRequeued++;
+			}
+			else
+			{
+				remove(asidePath.c_str());
+			}
+		}
+
+		return numberOfRequeued;
+	}
+
+	void FileJobQueue::getJobNames(JobState state, const std::string& namePrefix, std::vector<std::string>& outNames) const
+	{
+		outNames.clear();
+		if (!this->m_bIsOpen)
+		{
+			return;
+		}
+
+		std::vector<std::string> paths;
+		PathUtil::getDirectoryEntries(this->m_sQueueFolder + JOB_STATE_FOLDERS[state], paths, JOB_EXTENSION);
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			const std::string name = PathUtil::stripExtension(PathUtil::getFileNameFromPath(paths[i]));
+			if (startsWith(name, namePrefix))
+			{
+				outNames.push_back(name);
+			}
+		}
+	}
+
+	std::string FileJobQueue::createWorkerId()
+	{
+		char hostName[256] = { 0 };
+#ifdef TACORE_IS_WINDOWS
+		DWORD length = sizeof(hostName);
+		if (!GetComputerNameA(hostName, &length))
+		{
+			hostName[0] = 0;
+		}
+#else
+		if (gethostname(hostName, sizeof(hostName) - 1) != 0)
+		{
+			hostName[0] = 0;
+		}
+#endif
+		std::string workerId = (hostName[0] != 0) ? std::string(hostName) : std::string("host");
+		for (size_t i = 0; i < workerId.size(); i++)
+		{
+			const char c = workerId[i];
+			if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.'))
+			{
+				workerId[i] = '_';
+			}
+		}
+
+		return workerId + "-" + StringUtil::str(getProcessId());
+	}
+
+	const std::string& FileJobQueue::getQueueFolder() const
+	{
+		return this->m_sQueueFolder;
+	}
+
+	void FileJobQueue::runHeartbeat()
+	{
+		std::unique_lock<std::mutex> lock(this->m_Mutex);
+		while (this->m_bIsHeartbeatRunning)
+		{
+			this->m_HeartbeatCondition.wait_for(lock, std::chrono::seconds(this->m_nHeartbeatInterval));
+			if (!this->m_bIsHeartbeatRunning)
+			{
+				break;
+			}
+
+			//Jobs are renewed without the lock, so claiming and finishing do not wait for the file system
+			//A job finished meanwhile is not in running anymore, so renewing it does nothing
+			const std::vector<std::string> names(this->m_ClaimedJobs.begin(), this->m_ClaimedJobs.end());
+			lock.unlock();
+			for (size_t i = 0; i < names.size(); i++)
+			{
+				renewJob(names[i]);
+			}
+			lock.lock();
+		}
+	}
+
+	std::string FileJobQueue::getJobPath(JobState state, const std::string& name) const
+	{
+		return PathUtil::joinPath(this->m_sQueueFolder + JOB_STATE_FOLDERS[state], PathUtil::addExtension(name, JOB_EXTENSION));
+	}
+
+	std::string FileJobQueue::createTemporaryPath(const std::string& name) const
+	{
+		//Threads of the same process may create temporary files at the same time
+		static std::atomic<unsigned int> temporaryFileCounter(0);
+		const unsigned int counter = temporaryFileCounter++;
+		return this->m_sQueueFolder + name + "." + createWorkerId() + "_" + StringUtil::str(counter) + ".tmp";
+	}
+
+	bool FileJobQueue::getFileSystemTime(long long& outTime) const
+	{
+		unsigned long long size = 0;
+		if (!PathUtil::getFileStatus(this->m_sProbePath, size, outTime))
+		{
+			std::ofstream probe(this->m_sProbePath.c_str(), std::ios::binary | std::ios::trunc);
+			if (!probe.is_open())
+			{
+				return false;
+			}
+		}
+		//Touched the same way as a renewed job, so both times come from the same clock
+		PathUtil::touchFile(this->m_sProbePath);
+		return PathUtil::getFileStatus(this->m_sProbePath, size, outTime);
+	}
+}
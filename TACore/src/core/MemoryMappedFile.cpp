@@ -0,0 +1,149 @@
+#include "core/MemoryMappedFile.h"
+
+#ifdef TACORE_IS_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace TACore
+{
+
+	MemoryMappedFile::MemoryMappedFile()
+	{
+		m_pData = NULL;
+		m_nSize = 0;
+		m_bIsOpen = false;
+#ifdef TACORE_IS_WINDOWS
+		m_hFile = INVALID_HANDLE_VALUE;
+		m_hMapping = NULL;
+#else
+		m_nFileDescriptor = -1;
+#endif
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		close();
+	}
+
+	Result MemoryMappedFile::open(const std::string& pathToFile)
+	{
+		close();
+
+#ifdef TACORE_IS_WINDOWS
+		m_hFile = CreateFileA(pathToFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (m_hFile == INVALID_HANDLE_VALUE)
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(m_hFile, &fileSize))
+		{
+			close();
+			return TACORE_FILE_ERROR;
+		}
+		m_nSize = (size_t)fileSize.QuadPart;
+
+		//Empty files cannot be mapped, they are opened without any data
+		if (m_nSize > 0)
+		{
+			m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (m_hMapping == NULL)
+			{
+				close();
+				return TACORE_FILE_ERROR;
+			}
+
+			m_pData = (const unsigned char*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+			if (m_pData == NULL)
+			{
+				close();
+				return TACORE_FILE_ERROR;
+			}
+		}
+#else
+		m_nFileDescriptor = ::open(pathToFile.c_str(), O_RDONLY);
+		if (m_nFileDescriptor < 0)
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		struct stat fileStat;
+		if (fstat(m_nFileDescriptor, &fileStat) != 0)
+		{
+			close();
+			return TACORE_FILE_ERROR;
+		}
+		m_nSize = (size_t)fileStat.st_size;
+
+		//Empty files cannot be mapped, they are opened without any data
+		if (m_nSize > 0)
+		{
+			void* mapping = mmap(NULL, m_nSize, PROT_READ, MAP_SHARED, m_nFileDescriptor, 0);
+			if (mapping == MAP_FAILED)
+			{
+				close();
+				return TACORE_FILE_ERROR;
+			}
+			m_pData = (const unsigned char*)mapping;
+		}
+#endif
+
+		m_bIsOpen = true;
+		return TACORE_OK;
+	}
+
+	void MemoryMappedFile::close()
+	{
+#ifdef TACORE_IS_WINDOWS
+		if (m_pData != NULL)
+		{
+			UnmapViewOfFile(m_pData);
+		}
+		if (m_hMapping != NULL)
+		{
+			CloseHandle(m_hMapping);
+			m_hMapping = NULL;
+		}
+		if (m_hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_hFile);
+			m_hFile = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (m_pData != NULL)
+		{
+			munmap((void*)m_pData, m_nSize);
+		}
+		if (m_nFileDescriptor >= 0)
+		{
+			::close(m_nFileDescriptor);
+			m_nFileDescriptor = -1;
+		}
+#endif
+		m_pData = NULL;
+		m_nSize = 0;
+		m_bIsOpen = false;
+	}
+
+	bool MemoryMappedFile::isOpen() const
+	{
+		return m_bIsOpen;
+	}
+
+	const unsigned char* MemoryMappedFile::getData() const
+	{
+		return m_pData;
+	}
+
+	size_t MemoryMappedFile::getSize() const
+	{
+		return m_nSize;
+	}
+
+} // namespace TACore
@@ -4,6 +4,9 @@
 
 #if defined _WIN32 || defined _WIN64
 #include <direct.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/utime.h>
 #include <windows.h>
 #define PATH_SEPERATOR_CHAR '\\'
 #define ALT_PATH_SEPERATOR_CHAR '/'
@@ -21,6 +24,7 @@
 #include <dirent.h>
 #include <unistd.h>
 #include <sys/stat.h> 
+#include <utime.h>
 #define PATH_SEPERATOR_CHAR '/'
 #define ALT_PATH_SEPERATOR_CHAR '\\'
 #define PATH_SEPERATOR  "/"
@@ -518,10 +522,15 @@ namespace TACore
 #endif
 	}
 
-	const void PathUtil::getDirectoryEntries(const std::string& path, std::vector<std::string>& entries, const std::string& ext, bool getFolders, bool getHiddens) {
+	const void PathUtil::getDirectoryEntries(const std::string& folderPath, std::vector<std::string>& entries, const std::string& ext, bool getFolders, bool getHiddens) {
 		if (ext != "") {
 			getFolders = false;
 		}
+		//Entries are joined to the folder, so it must end with a separator
+		std::string path = folderPath;
+		if (!path.empty() && path.find_last_of(ALL_PATH_SEPERATORS) != path.size() - 1) {
+			path += PATH_SEPERATOR;
+		}
 #if defined _WIN32 || defined _WIN64
 		WIN32_FIND_DATAA search_data;
 
@@ -599,8 +608,71 @@ namespace TACore
 				}
 			}
 		}
+		closedir(dir);
 #endif
 		std::sort(entries.begin(), entries.end());
 	}
 
+	bool PathUtil::getFileStatus(const std::string& path, unsigned long long& size, long long& modificationTime)
+	{
+#if defined _WIN32 || defined _WIN64
+		struct _stat64 st;
+		if (_stat64(path.c_str(), &st) != 0 || (st.st_mode & _S_IFDIR))
+		{
+			return false;
+		}
+#else
+		struct stat st;
+		if (stat(path.c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+		{
+			return false;
+		}
+#endif
+		size = (unsigned long long)st.st_size;
+		modificationTime = (long long)st.st_mtime;
+		return true;
+	}
+
+	void PathUtil::touchFile(const std::string& path)
+	{
+#if defined _WIN32 || defined _WIN64
+		_utime(path.c_str(), NULL);
+#else
+		utime(path.c_str(), NULL);
+#endif
+	}
+
+	bool PathUtil::moveFile(const std::string& sourcePath, const std::string& destinationPath)
+	{
+#if defined _WIN32 || defined _WIN64
+		return MoveFileExA(sourcePath.c_str(), destinationPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return rename(sourcePath.c_str(), destinationPath.c_str()) == 0;
+#endif
+	}
+
+	bool PathUtil::createFolder(const std::string& path)
+	{
+		for (size_t pos = path.find_first_of("\\/", 1); ; pos = path.find_first_of("\\/", pos + 1))
+		{
+			const std::string subPath = path.substr(0, pos);
+#if defined _WIN32 || defined _WIN64
+			_mkdir(subPath.c_str());
+#else
+			mkdir(subPath.c_str(), 0755);
+#endif
+			if (pos == std::string::npos)
+			{
+				break;
+			}
+		}
+
+#if defined _WIN32 || defined _WIN64
+		struct _stat64 st;
+		return _stat64(path.c_str(), &st) == 0 && (st.st_mode & _S_IFDIR);
+#else
+		struct stat st;
+		return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+	}
 	} // namespace TACore 
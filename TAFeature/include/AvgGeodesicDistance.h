@@ -18,7 +18,8 @@ namespace TAFea
 		AvgGeodesicDistance(const AvgGeodesicDistance& other);
 
 	public:
-		float m_distance;	//< Average Geodesic Distance value for a single vertex in a mesh
+		float m_distance;				//< Average Geodesic Distance value for a single vertex in a mesh
+		float m_confidenceHalfWidth;	//< Half width of the confidence interval around m_distance if it is estimated from sampled sources, 0 if it is exact
 	
 	};
 }
@@ -0,0 +1,125 @@
+#ifndef FEATURE_MATRIX_H
+#define FEATURE_MATRIX_H
+
+#include "TAFeature.h"
+#include <core/Defs.h>
+#include <vector>
+
+namespace TAFea
+{
+	//Descriptors of all vertices of a mesh in a single contiguous rows x cols block, row i is the descriptor of vertex i
+	//A descriptor is a sequence of equal sized blocks, e.g. a histogram for each patch of PatchBasedShapeDistributionHistogram,
+	//so the layout is kept as the number of blocks and the block size together with the type of the descriptor
+	//Rows are dense and follow each other, so distances between descriptors run over plain arrays
+	//Explicitly instantiated for float and double
+	template <class T>
+	class FeatureMatrix
+	{
+	public:
+
+		//Type of the per vertex descriptor held in the rows
+		enum DescriptorType
+		{
+			UNKNOWN_DESCRIPTOR = 0,
+			AVG_GEODESIC_DISTANCE,						//< See AvgGeodesicDistance, a single block of size 1
+			HEAT_KERNEL_SIGNATURE,						//< See HeatKernelSignatureDesc, a single block of time samples
+			WAVE_KERNEL_SIGNATURE,						//< See WaveKernelSignatureDesc, a single block of energy samples
+			PATCH_BASED_SUM_OF_CENTER_DISTANCES,		//< See PatchBasedSumOfCenterDistances, a block of size 1 for each patch
+			PATCH_BASED_SHAPE_DISTRIBUTION_HISTOGRAM	//< See PatchBasedShapeDistributionHistogram, a block of bins for each patch
+		};
+
+		virtual ~FeatureMatrix();
+		FeatureMatrix();
+		FeatureMatrix(const FeatureMatrix& other);
+		FeatureMatrix& operator=(const FeatureMatrix& other);
+
+		/**
+		* @brief	Allocates the matrix with all values set to zero
+		*
+		* @param	noRows Number of rows, i.e. number of vertices
+		* @param	noBlocks Number of blocks in a descriptor
+		* @param	blockSize Number of values in a block
+		* @param	descriptorType Type of the descriptor
+		* @return	void
+		*/
+		void init(const int& noRows, const int& noBlocks, const int& blockSize, const DescriptorType& descriptorType);
+
+		/**
+		* @brief	Clears the matrix
+		* @return	void
+		*/
+		void clear();
+
+		/**
+		* @brief	Copies the values and the layout of a matrix of another value type
+		*
+		* @param	other Matrix to be copied
+		* @return	void
+		*/
+		template <class U>
+		void assign(const FeatureMatrix<U>& other)
+		{
+			init(other.rows(), other.getNumberOfBlocks(), other.getBlockSize(), (DescriptorType)other.getDescriptorType());
+			const U* src = other.getData();
+			for (size_t i = 0; i < this->m_vData.size(); i++)
+			{
+				this->m_vData[i] = (T)src[i];
+			}
+		}
+
+		/**
+		* @brief	Gets the descriptor of a vertex
+		* @param	row Id of the vertex
+		* @return	Pointer to the first value of the descriptor, cols() values follow it
+		*/
+		T* getRow(const int& row);
+		const T* getRow(const int& row) const;
+
+		/**
+		* @brief	Gets a block of the descriptor of a vertex
+		* @param	row Id of the vertex
+		* @param	block Id of the block
+		* @return	Pointer to the first value of the block, getBlockSize() values follow it
+		*/
+		T* getBlock(const int& row, const int& block);
+		const T* getBlock(const int& row, const int& block) const;
+
+		/**
+		* @brief	Calculates the L2 distance between the descriptors of two rows
+		* @param	row1 First row
+		* @param	row2 Second row
+		* @return	L2 distance
+		*/
+		T L2Distance(const int& row1, const int& row2) const;
+
+		//Getters
+		int rows() const;
+		int cols() const;
+		int getNumberOfBlocks() const;
+		int getBlockSize() const;
+		DescriptorType getDescriptorType() const;
+		T* getData();
+		const T* getData() const;
+
+	private:
+		std::vector<T>	m_vData;			//< Values of all rows one after the other
+		int				m_nRows;			//< Number of rows
+		int				m_nBlocks;			//< Number of blocks in a row
+		int				m_nBlockSize;		//< Number of values in a block
+		DescriptorType	m_DescriptorType;	//< Type of the descriptor of the rows
+	};
+
+	/**
+	* @brief	Copies the descriptors of per vertex feature objects into a feature matrix
+	*			Features must be of the same type and have the same layout, feature i is written to row i
+	*
+	* @param	feas Per vertex features
+	* @param	[out] outMatrix Feature matrix
+	* @return	TACORE_OK if everything goes fine
+	* @return	TACORE_BAD_ARGS if a feature is NULL, of an unknown type or its layout differs from the first one
+	*/
+	template <class T>
+	TACore::Result createFeatureMatrix(const std::vector<LocalFeaturePtr>& feas, FeatureMatrix<T>& outMatrix);
+}
+
+#endif
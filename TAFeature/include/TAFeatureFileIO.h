@@ -2,18 +2,171 @@
 #define TA_FEATURE_FILE_IO_H
 
 #include <TAFeature.h>
+#include <FeatureMatrix.h>
 #include <core/Defs.h>
+#include <core/MemoryMappedFile.h>
 #include <vector>
+#include <string>
 #include <fstream>
 
 namespace TAFea
 {
+	//Information kept in the header of a feature container file besides the layout of the descriptors
+	struct FeatureFileInfo
+	{
+		unsigned long long m_nMeshHash;										//< See TriangularMesh::calcContentHash, 0 if not known
+		std::vector<std::pair<std::string, std::string> > m_vParameters;	//< Names and values of the extraction parameters
+
+		FeatureFileInfo() : m_nMeshHash(0) {};
+	};
+
+	//Read only view of a feature container file written by TAFeatureFileIO::writeFeatureMatrix
+	//The file is mapped into the memory and only the header is parsed on open,
+	//the descriptor of a vertex is reached by its offset in the payload without reading the other vertices
+	//The object is not copyable since it owns the mapping
+	class MappedFeatureFile
+	{
+	public:
+
+		//Type of the values in the payload
+		enum DataType
+		{
+			FLOAT32 = 1,
+			FLOAT64
+		};
+
+		MappedFeatureFile();
+		virtual ~MappedFeatureFile();
+
+		/**
+		* @brief	Maps a feature container file and parses its header. An already opened file is closed first
+		* @param	filePath Path of the file
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_FILE_ERROR if the file cannot be mapped
+		* @return	TACORE_INVALID_OPERATION if the file is not a feature container, has an unknown version or is truncated
+		*/
+		TACore::Result open(const std::string& filePath);
+
+		/**
+		* @brief	Unmaps the file
+		* @return	void
+		*/
+		void close();
+
+		/**
+		* @brief	Query if a file is mapped.
+		* @return	true if a file is mapped, false otherwise.
+		*/
+		bool isOpen() const;
+
+		/**
+		* @brief	Gets the mapped values of the descriptor of a vertex without copying
+		*			Values are of getDataType(), cols() values follow the returned pointer
+		* @param	row Id of the vertex
+		* @return	Pointer to the first value of the descriptor
+		*/
+		const void* getRowData(const int& row) const;
+
+		/**
+		* @brief	Copies the descriptor of a vertex converting its values to T
+		* @param	row Id of the vertex
+		* @param	[out] outRow Buffer of cols() values
+		* @return	void
+		*/
+		template <class T>
+		void readRow(const int& row, T* outRow) const;
+
+		/**
+		* @brief	Calculates the L2 distances of the descriptors of all vertices to a set of reference descriptors
+		*			Distances are calculated over the mapped values in a single pass through the payload, no row is copied
+		*			and each row is compared with all references while it is in the cache
+		* @param	refDescriptors Reference descriptors of cols() values one after the other, e.g. read by readRow
+		* @param	noRefs Number of reference descriptors
+		* @param	[out] outDistances Distances to the references, distance of vertex v to reference r is at r * rows() + v
+		* @return	void
+		*/
+		void calcL2Distances(const double* refDescriptors, const int& noRefs, std::vector<double>& outDistances) const;
+
+		//Getters
+		int rows() const;
+		int cols() const;
+		int getNumberOfBlocks() const;
+		int getBlockSize() const;
+		FeatureMatrix<double>::DescriptorType getDescriptorType() const;
+		DataType getDataType() const;
+		const FeatureFileInfo& getInfo() const;
+
+	private:
+		MappedFeatureFile(const MappedFeatureFile& other);
+		MappedFeatureFile& operator=(const MappedFeatureFile& other);
+
+		TACore::MemoryMappedFile				m_File;				//< Mapping of the whole file
+		const unsigned char*					m_pPayload;			//< First value of the first row
+		int										m_nRows;			//< Number of rows
+		int										m_nBlocks;			//< Number of blocks in a row
+		int										m_nBlockSize;		//< Number of values in a block
+		FeatureMatrix<double>::DescriptorType	m_DescriptorType;	//< Type of the descriptor of the rows
+		DataType								m_DataType;			//< Type of the values
+		FeatureFileInfo							m_Info;				//< Mesh hash and parameters read from the header
+	};
+
 	class TAFeatureFileIO
 	{
 	public:
 		static TACore::Result writePBSDInBinary(const std::vector<LocalFeaturePtr>& feas, const std::string& filePath);
 		static TACore::Result readPBSDInBinary(const std::string& filePath, std::vector<LocalFeaturePtr>& feas);
 
+		/**
+		* @brief	Writes a feature matrix into a versioned feature container file
+		*			The file has a fixed size header with the descriptor type, the layout, the value type, the mesh hash and the size of the parameters,
+		*			the parameters as "name=value" lines and the rows one after the other starting from a 64 byte aligned offset
+		*			The payload is written with a single write, so the descriptor of vertex i starts at payload offset + i * cols * sizeof(T)
+		*			The file is written under a temporary name next to filePath and then moved there, so a reader never sees a partial file
+		*
+		* @param	matrix Descriptors of the vertices, float matrices are written as 32 bit and double matrices as 64 bit values
+		* @param	info Mesh hash and parameters kept in the header
+		* @param	filePath Path of the file
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if a parameter name contains '=' or a parameter contains a new line
+		* @return	TACORE_FILE_ERROR if the file cannot be opened or written, an existing file is then kept as it is
+		*/
+		template <class T>
+		static TACore::Result writeFeatureMatrix(const FeatureMatrix<T>& matrix, const FeatureFileInfo& info, const std::string& filePath);
+
+		/**
+		* @brief	Reads a feature matrix from a feature container file, values are converted if the file has the other value type
+		*
+		* @param	filePath Path of the file
+		* @param	[out] outMatrix Descriptors of the vertices
+		* @param	[out] outInfo Mesh hash and parameters kept in the header, ignored if NULL
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_FILE_ERROR if the file cannot be mapped
+		* @return	TACORE_INVALID_OPERATION if the file is not a valid feature container
+		*/
+		template <class T>
+		static TACore::Result readFeatureMatrix(const std::string& filePath, FeatureMatrix<T>& outMatrix, FeatureFileInfo* outInfo = NULL);
+
+		/**
+		* @brief	Writes per vertex features of any type known by createFeatureMatrix into a feature container file as 64 bit values
+		*
+		* @param	feas Per vertex features
+		* @param	info Mesh hash and parameters kept in the header
+		* @param	filePath Path of the file
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if the features cannot be put into a feature matrix or the parameters are not valid
+		* @return	TACORE_FILE_ERROR if the file cannot be opened or written
+		*/
+		static TACore::Result writeFeatures(const std::vector<LocalFeaturePtr>& feas, const FeatureFileInfo& info, const std::string& filePath);
+
+		/**
+		* @brief	Checks the magic at the beginning of a file, e.g. to tell a feature container from a file written by writePBSDInBinary
+		*			Only the magic is read, so the rest of the header may still be invalid
+		*
+		* @param	filePath Path of the file
+		* @return	true if the file starts with the magic of a feature container, false otherwise or if the file cannot be read
+		*/
+		static bool isFeatureContainer(const std::string& filePath);
+
 	private:	
 		template <class T>
 		static TACore::Result writeBinary(const std::vector<T>& vec, std::ofstream& out);
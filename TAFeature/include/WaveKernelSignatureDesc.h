@@ -0,0 +1,24 @@
+#ifndef WAVE_KERNEL_SIGNATURE_DESC_H
+#define WAVE_KERNEL_SIGNATURE_DESC_H
+
+#include "TAFeature.h"
+#include <vector>
+
+namespace TAFea
+{
+	//Wave Kernel Signature for a single vertex in a mesh
+	//Technical Details of the feature is described in http://imagine.enpc.fr/~aubrym/projects/wks/texts/2011-wave-kernel-signature.pdf
+	//Wave Kernel Signature is a PerVertexFeature
+	class WaveKernelSignatureDesc : public PerVertexFeature
+	{
+	public:
+		virtual ~WaveKernelSignatureDesc();
+		WaveKernelSignatureDesc();
+		WaveKernelSignatureDesc(const int& vertexid);
+
+	public:
+		std::vector<double> m_vDescriptor;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -6,24 +6,28 @@ namespace TAFea
 	{
 		this->m_ID = -1;
 		this->m_distance = 0.0f;
+		this->m_confidenceHalfWidth = 0.0f;
 	}
 
 	AvgGeodesicDistance::AvgGeodesicDistance(const int& vertexid)
 	{
 		this->m_ID = vertexid;
 		this->m_distance = 0.0f;
+		this->m_confidenceHalfWidth = 0.0f;
 	}
 
 	AvgGeodesicDistance::AvgGeodesicDistance(const int& vertexid, const float& distance)
 	{
 		this->m_ID = vertexid;
 		this->m_distance = distance;
+		this->m_confidenceHalfWidth = 0.0f;
 	}
 
 	AvgGeodesicDistance::AvgGeodesicDistance(const AvgGeodesicDistance& other)
 	{
 		this->m_ID = other.m_ID;
 		this->m_distance = other.m_distance;
+		this->m_confidenceHalfWidth = other.m_confidenceHalfWidth;
 	}
 
 	AvgGeodesicDistance::~AvgGeodesicDistance()
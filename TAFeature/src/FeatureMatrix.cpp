@@ -0,0 +1,278 @@
+#include "FeatureMatrix.h"
+#include "AvgGeodesicDistance.h"
+#include "HeatKernelSignatureDesc.h"
+#include "WaveKernelSignatureDesc.h"
+#include "PatchBasedSumOfCenterDistances.h"
+#include "PatchBasedShapeDistributionHistogram.h"
+#include <cmath>
+
+namespace
+{
+	//Gets the type and the layout of a feature object, false if the type is not known
+	bool getFeatureLayout(const TAFea::LocalFeature* fea, int& noBlocks, int& blockSize, int& descriptorType)
+	{
+		typedef TAFea::FeatureMatrix<double> Matrix;
+		if (const TAFea::PatchBasedShapeDistributionHistogram* pbsd = dynamic_cast<const TAFea::PatchBasedShapeDistributionHistogram*>(fea))
+		{
+			noBlocks = (int)pbsd->m_vDescriptor.size();
+			blockSize = pbsd->m_vDescriptor.empty() ? 0 : (int)pbsd->m_vDescriptor[0].size();
+			descriptorType = Matrix::PATCH_BASED_SHAPE_DISTRIBUTION_HISTOGRAM;
+			for (int block = 1; block < noBlocks; block++)
+			{
+				if ((int)pbsd->m_vDescriptor[block].size() != blockSize)
+				{
+					return false;
+				}
+			}
+		}
+		else if (const TAFea::PatchBasedSumOfCenterDistances* scd = dynamic_cast<const TAFea::PatchBasedSumOfCenterDistances*>(fea))
+		{
+			noBlocks = (int)scd->m_vDescriptor.size();
+			blockSize = 1;
+			descriptorType = Matrix::PATCH_BASED_SUM_OF_CENTER_DISTANCES;
+		}
+		else if (const TAFea::HeatKernelSignatureDesc* hks = dynamic_cast<const TAFea::HeatKernelSignatureDesc*>(fea))
+		{
+			noBlocks = 1;
+			blockSize = (int)hks->m_vDescriptor.size();
+			descriptorType = Matrix::HEAT_KERNEL_SIGNATURE;
+		}
+		else if (const TAFea::WaveKernelSignatureDesc* wks = dynamic_cast<const TAFea::WaveKernelSignatureDesc*>(fea))
+		{
+			noBlocks = 1;
+			blockSize = (int)wks->m_vDescriptor.size();
+			descriptorType = Matrix::WAVE_KERNEL_SIGNATURE;
+		}
+		else if (dynamic_cast<const TAFea::AvgGeodesicDistance*>(fea) != NULL)
+		{
+			noBlocks = 1;
+			blockSize = 1;
+			descriptorType = Matrix::AVG_GEODESIC_DISTANCE;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	//Copies the values of a feature object whose layout is already checked
+	template <class T>
+	void copyFeatureValues(const TAFea::LocalFeature* fea, const int& descriptorType, T* row)
+	{
+		typedef TAFea::FeatureMatrix<double> Matrix;
+		switch (descriptorType)
+		{
+			case Matrix::PATCH_BASED_SHAPE_DISTRIBUTION_HISTOGRAM:
+			{
+				const std::vector<std::vector<double> >& desc = static_cast<const TAFea::PatchBasedShapeDistributionHistogram*>(fea)->m_vDescriptor;
+				for (size_t block = 0; block < desc.size(); block++)
+				{
+					for (size_t i = 0; i < desc[block].size(); i++)
+					{
+						*row++ = (T)desc[block][i];
+					}
+				}
+				break;
+			}
+			case Matrix::PATCH_BASED_SUM_OF_CENTER_DISTANCES:
+			{
+				const std::vector<double>& desc = static_cast<const TAFea::PatchBasedSumOfCenterDistances*>(fea)->m_vDescriptor;
+				for (size_t i = 0; i < desc.size(); i++) row[i] = (T)desc[i];
+				break;
+			}
+			case Matrix::HEAT_KERNEL_SIGNATURE:
+			{
+				const std::vector<double>& desc = static_cast<const TAFea::HeatKernelSignatureDesc*>(fea)->m_vDescriptor;
+				for (size_t i = 0; i < desc.size(); i++) row[i] = (T)desc[i];
+				break;
+			}
+			case Matrix::WAVE_KERNEL_SIGNATURE:
+			{
+				const std::vector<double>& desc = static_cast<const TAFea::WaveKernelSignatureDesc*>(fea)->m_vDescriptor;
+				for (size_t i = 0; i < desc.size(); i++) row[i] = (T)desc[i];
+				break;
+			}
+			case Matrix::AVG_GEODESIC_DISTANCE:
+			{
+				row[0] = (T)static_cast<const TAFea::AvgGeodesicDistance*>(fea)->m_distance;
+				break;
+			}
+		}
+	}
+}
+
+namespace TAFea
+{
+	template <class T>
+	FeatureMatrix<T>::~FeatureMatrix()
+	{
+
+	}
+
+	template <class T>
+	FeatureMatrix<T>::FeatureMatrix()
+	{
+		this->m_nRows = 0;
+		this->m_nBlocks = 0;
+		this->m_nBlockSize = 0;
+		this->m_DescriptorType = UNKNOWN_DESCRIPTOR;
+	}
+
+	template <class T>
+	FeatureMatrix<T>::FeatureMatrix(const FeatureMatrix& other)
+	{
+		this->m_vData = other.m_vData;
+		this->m_nRows = other.m_nRows;
+		this->m_nBlocks = other.m_nBlocks;
+		this->m_nBlockSize = other.m_nBlockSize;
+		this->m_DescriptorType = other.m_DescriptorType;
+	}
+
+	template <class T>
+	FeatureMatrix<T>& FeatureMatrix<T>::operator=(const FeatureMatrix& other)
+	{
+		this->m_vData = other.m_vData;
+		this->m_nRows = other.m_nRows;
+		this->m_nBlocks = other.m_nBlocks;
+		this->m_nBlockSize = other.m_nBlockSize;
+		this->m_DescriptorType = other.m_DescriptorType;
+		return *this;
+	}
+
+	template <class T>
+	void FeatureMatrix<T>::init(const int& noRows, const int& noBlocks, const int& blockSize, const DescriptorType& descriptorType)
+	{
+		this->m_vData.assign((size_t)noRows * noBlocks * blockSize, (T)0);
+		this->m_nRows = noRows;
+		this->m_nBlocks = noBlocks;
+		this->m_nBlockSize = blockSize;
+		this->m_DescriptorType = descriptorType;
+	}
+
+	template <class T>
+	void FeatureMatrix<T>::clear()
+	{
+		std::vector<T>().swap(this->m_vData);
+		this->m_nRows = 0;
+		this->m_nBlocks = 0;
+		this->m_nBlockSize = 0;
+		this->m_DescriptorType = UNKNOWN_DESCRIPTOR;
+	}
+
+	template <class T>
+	T* FeatureMatrix<T>::getRow(const int& row)
+	{
+		return this->m_vData.data() + (size_t)row * cols();
+	}
+
+	template <class T>
+	const T* FeatureMatrix<T>::getRow(const int& row) const
+	{
+		return this->m_vData.data() + (size_t)row * cols();
+	}
+
+	template <class T>
+	T* FeatureMatrix<T>::getBlock(const int& row, const int& block)
+	{
+		return getRow(row) + block * this->m_nBlockSize;
+	}
+
+	template <class T>
+	const T* FeatureMatrix<T>::getBlock(const int& row, const int& block) const
+	{
+		return getRow(row) + block * this->m_nBlockSize;
+	}
+
+	template <class T>
+	T FeatureMatrix<T>::L2Distance(const int& row1, const int& row2) const
+	{
+		const T* desc1 = getRow(row1);
+		const T* desc2 = getRow(row2);
+		const int noCols = cols();
+		T sqDistance = 0;
+		for (int i = 0; i < noCols; i++)
+		{
+			const T diff = desc1[i] - desc2[i];
+			sqDistance += diff * diff;
+		}
+		return std::sqrt(sqDistance);
+	}
+
+	template <class T>
+	int FeatureMatrix<T>::rows() const
+	{
+		return this->m_nRows;
+	}
+
+	template <class T>
+	int FeatureMatrix<T>::cols() const
+	{
+		return this->m_nBlocks * this->m_nBlockSize;
+	}
+
+	template <class T>
+	int FeatureMatrix<T>::getNumberOfBlocks() const
+	{
+		return this->m_nBlocks;
+	}
+
+	template <class T>
+	int FeatureMatrix<T>::getBlockSize() const
+	{
+		return this->m_nBlockSize;
+	}
+
+	template <class T>
+	typename FeatureMatrix<T>::DescriptorType FeatureMatrix<T>::getDescriptorType() const
+	{
+		return this->m_DescriptorType;
+	}
+
+	template <class T>
+	T* FeatureMatrix<T>::getData()
+	{
+		return this->m_vData.empty() ? NULL : &this->m_vData[0];
+	}
+
+	template <class T>
+	const T* FeatureMatrix<T>::getData() const
+	{
+		return this->m_vData.empty() ? NULL : &this->m_vData[0];
+	}
+
+	template <class T>
+	TACore::Result createFeatureMatrix(const std::vector<LocalFeaturePtr>& feas, FeatureMatrix<T>& outMatrix)
+	{
+		outMatrix.clear();
+		if (feas.empty())
+		{
+			return TACore::TACORE_OK;
+		}
+
+		int noBlocks = 0, blockSize = 0, descriptorType = 0;
+		TACORE_CHECK_ARGS(feas[0] && getFeatureLayout(feas[0].get(), noBlocks, blockSize, descriptorType));
+
+		const int noRows = (int)feas.size();
+		outMatrix.init(noRows, noBlocks, blockSize, (typename FeatureMatrix<T>::DescriptorType)descriptorType);
+		for (int v = 0; v < noRows; v++)
+		{
+			int feaNoBlocks = 0, feaBlockSize = 0, feaDescriptorType = 0;
+			if (!feas[v] || !getFeatureLayout(feas[v].get(), feaNoBlocks, feaBlockSize, feaDescriptorType)
+				|| feaNoBlocks != noBlocks || feaBlockSize != blockSize || feaDescriptorType != descriptorType)
+			{
+				outMatrix.clear();
+				return TACore::TACORE_BAD_ARGS;
+			}
+			copyFeatureValues(feas[v].get(), descriptorType, outMatrix.getRow(v));
+		}
+
+		return TACore::TACORE_OK;
+	}
+
+	template class FeatureMatrix<float>;
+	template class FeatureMatrix<double>;
+
+	template TACore::Result createFeatureMatrix<float>(const std::vector<LocalFeaturePtr>& feas, FeatureMatrix<float>& outMatrix);
+	template TACore::Result createFeatureMatrix<double>(const std::vector<LocalFeaturePtr>& feas, FeatureMatrix<double>& outMatrix);
+}
@@ -1,12 +1,400 @@
 #include "TAFeatureFileIO.h"
 #include "PatchBasedShapeDistributionHistogram.h"
+#include <core/FileJobQueue.h>
+#include <core/PathUtil.h>
+#include <core/StringUtil.h>
+#include <atomic>
+#include <cstdio>
 #include <iostream>
+#include <cstring>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+	const char FEATURE_FILE_MAGIC[4] = { 'T', 'A', 'F', 'M' };
+	const unsigned int FEATURE_FILE_VERSION = 1;
+	const unsigned long long FEATURE_FILE_PAYLOAD_ALIGNMENT = 64;
+
+	//Fixed size part at the beginning of a feature container file, the members are ordered so that there is no padding
+	//Parameters follow the header as "name=value" lines, rows start at m_nPayloadOffset
+	struct FeatureFileHeader
+	{
+		char				m_vMagic[4];			//< Always FEATURE_FILE_MAGIC
+		unsigned int		m_nVersion;				//< Version of the layout, FEATURE_FILE_VERSION when written
+		unsigned int		m_nDescriptorType;		//< FeatureMatrix::DescriptorType of the rows
+		unsigned int		m_nDataType;			//< MappedFeatureFile::DataType of the values
+		unsigned long long	m_nRows;				//< Number of rows
+		unsigned int		m_nBlocks;				//< Number of blocks in a row
+		unsigned int		m_nBlockSize;			//< Number of values in a block
+		unsigned long long	m_nMeshHash;			//< Content hash of the mesh, 0 if not known
+		unsigned long long	m_nParametersSize;		//< Size of the parameter text in bytes
+		unsigned long long	m_nPayloadOffset;		//< Offset of the first row from the beginning of the file
+	};
+
+	//Files are written next to their final path and moved there when complete, so that readers never see a partially written file
+	//and two workers writing the same file, e.g. while running the same job twice, do not mix their contents
+	std::string createTemporaryFilePath(const std::string& filePath)
+	{
+		//Threads of the same process may write files at the same time
+		static std::atomic<unsigned int> temporaryFileCounter(0);
+		const unsigned int counter = temporaryFileCounter++;
+		return filePath + "." + TACore::FileJobQueue::createWorkerId() + "_" + TACore::StringUtil::str(counter) + ".tmp";
+	}
+
+	//Moves a closed temporary file to its final path, or removes it if it is not written completely
+	TACore::Result replaceWithTemporaryFile(const std::string& temporaryPath, const std::string& filePath, const bool& isWritten)
+	{
+		if (!isWritten || !TACore::PathUtil::moveFile(temporaryPath, filePath))
+		{
+			remove(temporaryPath.c_str());
+			return TACore::TACORE_FILE_ERROR;
+		}
+		return TACore::TACORE_OK;
+	}
+
+	template <class T>
+	unsigned int getDataTypeOf();
+
+	template <>
+	unsigned int getDataTypeOf<float>()
+	{
+		return TAFea::MappedFeatureFile::FLOAT32;
+	}
+
+	template <>
+	unsigned int getDataTypeOf<double>()
+	{
+		return TAFea::MappedFeatureFile::FLOAT64;
+	}
+
+	//Converts the values of a mapped row of type S
+	template <class S, class T>
+	void convertValues(const unsigned char* src, const size_t& noValues, T* dst)
+	{
+		const S* values = (const S*)src;
+		for (size_t i = 0; i < noValues; i++)
+		{
+			dst[i] = (T)values[i];
+		}
+	}
+
+	//Calculates the L2 distances of mapped rows of type S to reference descriptors
+	//Four partial sums break the dependency between the iterations so that the compiler can vectorize the inner loop
+	template <class S>
+	void calcL2DistancesOfRows(const unsigned char* payload, const int& noRows, const int& noCols, const double* refDescriptors, const int& noRefs, double* outDistances)
+	{
+		const S* values = (const S*)payload;
+		const int noUnrolledCols = noCols - noCols % 4;
+		for (int row = 0; row < noRows; row++)
+		{
+			const S* rowValues = values + (size_t)row * noCols;
+			for (int ref = 0; ref < noRefs; ref++)
+			{
+				const double* refValues = refDescriptors + (size_t)ref * noCols;
+				double sqDistances[4] = { 0.0, 0.0, 0.0, 0.0 };
+				int i = 0;
+				for (; i < noUnrolledCols; i += 4)
+				{
+					const double diff0 = (double)rowValues[i] - refValues[i];
+					const double diff1 = (double)rowValues[i + 1] - refValues[i + 1];
+					const double diff2 = (double)rowValues[i + 2] - refValues[i + 2];
+					const double diff3 = (double)rowValues[i + 3] - refValues[i + 3];
+					sqDistances[0] += diff0 * diff0;
+					sqDistances[1] += diff1 * diff1;
+					sqDistances[2] += diff2 * diff2;
+					sqDistances[3] += diff3 * diff3;
+				}
+				for (; i < noCols; i++)
+				{
+					const double diff = (double)rowValues[i] - refValues[i];
+					sqDistances[0] += diff * diff;
+				}
+				outDistances[(size_t)ref * noRows + row] = sqrt((sqDistances[0] + sqDistances[1]) + (sqDistances[2] + sqDistances[3]));
+			}
+		}
+	}
+}
 
 namespace TAFea
 {
+	MappedFeatureFile::MappedFeatureFile()
+	{
+		this->m_pPayload = NULL;
+		this->m_nRows = 0;
+		this->m_nBlocks = 0;
+		this->m_nBlockSize = 0;
+		this->m_DescriptorType = FeatureMatrix<double>::UNKNOWN_DESCRIPTOR;
+		this->m_DataType = FLOAT64;
+	}
+
+	MappedFeatureFile::~MappedFeatureFile()
+	{
+		close();
+	}
+
+	TACore::Result MappedFeatureFile::open(const std::string& filePath)
+	{
+		close();
+		TACORE_CHECK_RESULT(this->m_File.open(filePath));
+
+		const unsigned char* data = this->m_File.getData();
+		const size_t fileSize = this->m_File.getSize();
+
+		FeatureFileHeader header;
+		bool isValid = (data != NULL && fileSize >= sizeof(header));
+		if (isValid)
+		{
+			memcpy(&header, data, sizeof(header));
+			isValid = memcmp(header.m_vMagic, FEATURE_FILE_MAGIC, sizeof(FEATURE_FILE_MAGIC)) == 0
+				&& header.m_nVersion == FEATURE_FILE_VERSION
+				&& (header.m_nDataType == FLOAT32 || header.m_nDataType == FLOAT64)
+				&& header.m_nRows <= (unsigned long long)INT_MAX
+				&& (unsigned long long)header.m_nBlocks * header.m_nBlockSize <= (unsigned long long)INT_MAX
+				&& header.m_nPayloadOffset % FEATURE_FILE_PAYLOAD_ALIGNMENT == 0
+				&& header.m_nParametersSize <= fileSize - sizeof(header)
+				&& header.m_nPayloadOffset >= sizeof(header) + header.m_nParametersSize
+				&& header.m_nPayloadOffset <= fileSize;
+		}
+		if (isValid)
+		{
+			const unsigned long long valueSize = (header.m_nDataType == FLOAT32) ? sizeof(float) : sizeof(double);
+			const unsigned long long rowSize = (unsigned long long)header.m_nBlocks * header.m_nBlockSize * valueSize;
+			isValid = (rowSize == 0 || header.m_nRows <= (fileSize - header.m_nPayloadOffset) / rowSize);
+		}
+		if (!isValid)
+		{
+			std::cerr << "Error: " << filePath << " is not a valid feature container file!" << std::endl;
+			close();
+			return TACore::TACORE_INVALID_OPERATION;
+		}
+
+		this->m_pPayload = data + header.m_nPayloadOffset;
+		this->m_nRows = (int)header.m_nRows;
+		this->m_nBlocks = (int)header.m_nBlocks;
+		this->m_nBlockSize = (int)header.m_nBlockSize;
+		this->m_DescriptorType = (FeatureMatrix<double>::DescriptorType)header.m_nDescriptorType;
+		this->m_DataType = (DataType)header.m_nDataType;
+		this->m_Info.m_nMeshHash = header.m_nMeshHash;
+
+		//Parameters are "name=value" lines
+		const std::string parameters((const char*)data + sizeof(header), (size_t)header.m_nParametersSize);
+		size_t lineStart = 0;
+		while (lineStart < parameters.size())
+		{
+			size_t lineEnd = parameters.find('\n', lineStart);
+			if (lineEnd == std::string::npos)
+			{
+				lineEnd = parameters.size();
+			}
+			const std::string line = parameters.substr(lineStart, lineEnd - lineStart);
+			const size_t separator = line.find('=');
+			if (separator != std::string::npos)
+			{
+				this->m_Info.m_vParameters.push_back(std::make_pair(line.substr(0, separator), line.substr(separator + 1)));
+			}
+			lineStart = lineEnd + 1;
+		}
+
+		return TACore::TACORE_OK;
+	}
+
+	void MappedFeatureFile::close()
+	{
+		this->m_File.close();
+		this->m_pPayload = NULL;
+		this->m_nRows = 0;
+		this->m_nBlocks = 0;
+		this->m_nBlockSize = 0;
+		this->m_DescriptorType = FeatureMatrix<double>::UNKNOWN_DESCRIPTOR;
+		this->m_DataType = FLOAT64;
+		this->m_Info = FeatureFileInfo();
+	}
+
+	bool MappedFeatureFile::isOpen() const
+	{
+		return this->m_File.isOpen();
+	}
+
+	const void* MappedFeatureFile::getRowData(const int& row) const
+	{
+		const size_t valueSize = (this->m_DataType == FLOAT32) ? sizeof(float) : sizeof(double);
+		return this->m_pPayload + (size_t)row * cols() * valueSize;
+	}
+
+	template <class T>
+	void MappedFeatureFile::readRow(const int& row, T* outRow) const
+	{
+		const unsigned char* rowData = (const unsigned char*)getRowData(row);
+		if (this->m_DataType == FLOAT32)
+		{
+			convertValues<float>(rowData, (size_t)cols(), outRow);
+		}
+		else
+		{
+			convertValues<double>(rowData, (size_t)cols(), outRow);
+		}
+	}
+
+	void MappedFeatureFile::calcL2Distances(const double* refDescriptors, const int& noRefs, std::vector<double>& outDistances) const
+	{
+		outDistances.assign((size_t)this->m_nRows * noRefs, 0.0);
+		if (outDistances.empty())
+		{
+			return;
+		}
+		if (this->m_DataType == FLOAT32)
+		{
+			calcL2DistancesOfRows<float>(this->m_pPayload, this->m_nRows, cols(), refDescriptors, noRefs, &outDistances[0]);
+		}
+		else
+		{
+			calcL2DistancesOfRows<double>(this->m_pPayload, this->m_nRows, cols(), refDescriptors, noRefs, &outDistances[0]);
+		}
+	}
+
+	int MappedFeatureFile::rows() const
+	{
+		return this->m_nRows;
+	}
+
+	int MappedFeatureFile::cols() const
+	{
+		return this->m_nBlocks * this->m_nBlockSize;
+	}
+
+	int MappedFeatureFile::getNumberOfBlocks() const
+	{
+		return this->m_nBlocks;
+	}
+
+	int MappedFeatureFile::getBlockSize() const
+	{
+		return this->m_nBlockSize;
+	}
+
+	FeatureMatrix<double>::DescriptorType MappedFeatureFile::getDescriptorType() const
+	{
+		return this->m_DescriptorType;
+	}
+
+	MappedFeatureFile::DataType MappedFeatureFile::getDataType() const
+	{
+		return this->m_DataType;
+	}
+
+	const FeatureFileInfo& MappedFeatureFile::getInfo() const
+	{
+		return this->m_Info;
+	}
+
+	template void MappedFeatureFile::readRow<float>(const int& row, float* outRow) const;
+	template void MappedFeatureFile::readRow<double>(const int& row, double* outRow) const;
+
+	template <class T>
+	TACore::Result TAFeatureFileIO::writeFeatureMatrix(const FeatureMatrix<T>& matrix, const FeatureFileInfo& info, const std::string& filePath)
+	{
+		std::string parameters;
+		for (size_t i = 0; i < info.m_vParameters.size(); i++)
+		{
+			const std::string& name = info.m_vParameters[i].first;
+			const std::string& value = info.m_vParameters[i].second;
+			if (name.find_first_of("=\n") != std::string::npos || value.find('\n') != std::string::npos)
+			{
+				return TACore::TACORE_BAD_ARGS;
+			}
+			parameters += name + "=" + value + "\n";
+		}
+
+		FeatureFileHeader header;
+		memcpy(header.m_vMagic, FEATURE_FILE_MAGIC, sizeof(FEATURE_FILE_MAGIC));
+		header.m_nVersion = FEATURE_FILE_VERSION;
+		header.m_nDescriptorType = (unsigned int)matrix.getDescriptorType();
+		header.m_nDataType = getDataTypeOf<T>();
+		header.m_nRows = (unsigned long long)matrix.rows();
+		header.m_nBlocks = (unsigned int)matrix.getNumberOfBlocks();
+		header.m_nBlockSize = (unsigned int)matrix.getBlockSize();
+		header.m_nMeshHash = info.m_nMeshHash;
+		header.m_nParametersSize = parameters.size();
+		header.m_nPayloadOffset = ((sizeof(header) + parameters.size() + FEATURE_FILE_PAYLOAD_ALIGNMENT - 1) / FEATURE_FILE_PAYLOAD_ALIGNMENT) * FEATURE_FILE_PAYLOAD_ALIGNMENT;
+
+		const std::string temporaryPath = createTemporaryFilePath(filePath);
+		std::ofstream out(temporaryPath, std::ios::out | std::ios::binary);
+		if (!out.is_open())
+		{
+			std::cerr << "Error: Specified File name: " << temporaryPath << " cannot be opened!" << std::endl;
+			return TACore::TACORE_FILE_ERROR;
+		}
+
+		const std::vector<char> padding((size_t)header.m_nPayloadOffset - sizeof(header) - parameters.size(), 0);
+		out.write((const char*)&header, sizeof(header));
+		out.write(parameters.data(), parameters.size());
+		out.write(padding.data(), padding.size());
+		if (matrix.getData() != NULL)
+		{
+			out.write((const char*)matrix.getData(), (std::streamsize)matrix.rows() * matrix.cols() * sizeof(T));
+		}
+		out.close();
+
+		return replaceWithTemporaryFile(temporaryPath, filePath, !out.fail());
+	}
+
+	template <class T>
+	TACore::Result TAFeatureFileIO::readFeatureMatrix(const std::string& filePath, FeatureMatrix<T>& outMatrix, FeatureFileInfo* outInfo)
+	{
+		MappedFeatureFile file;
+		TACORE_CHECK_RESULT(file.open(filePath));
+
+		outMatrix.init(file.rows(), file.getNumberOfBlocks(), file.getBlockSize(), (typename FeatureMatrix<T>::DescriptorType)file.getDescriptorType());
+		if (outMatrix.getData() != NULL)
+		{
+			if (file.getDataType() == getDataTypeOf<T>())
+			{
+				memcpy(outMatrix.getData(), file.getRowData(0), (size_t)file.rows() * file.cols() * sizeof(T));
+			}
+			else
+			{
+				for (int row = 0; row < file.rows(); row++)
+				{
+					file.readRow(row, outMatrix.getRow(row));
+				}
+			}
+		}
+		if (outInfo != NULL)
+		{
+			*outInfo = file.getInfo();
+		}
+
+		return TACore::TACORE_OK;
+	}
+
+	TACore::Result TAFeatureFileIO::writeFeatures(const std::vector<LocalFeaturePtr>& feas, const FeatureFileInfo& info, const std::string& filePath)
+	{
+		FeatureMatrix<double> matrix;
+		TACORE_CHECK_RESULT(createFeatureMatrix(feas, matrix));
+		return writeFeatureMatrix(matrix, info, filePath);
+	}
+
+	bool TAFeatureFileIO::isFeatureContainer(const std::string& filePath)
+	{
+		std::ifstream inp(filePath, std::ios::in | std::ios::binary);
+		char magic[sizeof(FEATURE_FILE_MAGIC)];
+		if (!inp.is_open() || !inp.read(magic, sizeof(magic)))
+		{
+			return false;
+		}
+		return memcmp(magic, FEATURE_FILE_MAGIC, sizeof(FEATURE_FILE_MAGIC)) == 0;
+	}
+
+	template TACore::Result TAFeatureFileIO::writeFeatureMatrix<float>(const FeatureMatrix<float>& matrix, const FeatureFileInfo& info, const std::string& filePath);
+	template TACore::Result TAFeatureFileIO::writeFeatureMatrix<double>(const FeatureMatrix<double>& matrix, const FeatureFileInfo& info, const std::string& filePath);
+	template TACore::Result TAFeatureFileIO::readFeatureMatrix<float>(const std::string& filePath, FeatureMatrix<float>& outMatrix, FeatureFileInfo* outInfo);
+	template TACore::Result TAFeatureFileIO::readFeatureMatrix<double>(const std::string& filePath, FeatureMatrix<double>& outMatrix, FeatureFileInfo* outInfo);
+
 	TACore::Result TAFeatureFileIO::writePBSDInBinary(const std::vector<LocalFeaturePtr>& feas, const std::string& filePath)
 	{
-		std::ofstream out(filePath, std::ios::out | std::ios::binary);
+		const std::string temporaryPath = createTemporaryFilePath(filePath);
+		std::ofstream out(temporaryPath, std::ios::out | std::ios::binary);
 		TACore::Result res = TACore::TACORE_OK;
 		if (out.is_open())
 		{
@@ -24,10 +412,18 @@ namespace TAFea
 				}
 			}
 			out.close();
+			if (res == TACore::TACORE_OK)
+			{
+				res = replaceWithTemporaryFile(temporaryPath, filePath, !out.fail());
+			}
+			else
+			{
+				remove(temporaryPath.c_str());
+			}
 		}
 		else
 		{
-			std::cerr << "Error: Specified File name: " << filePath << " cannot be opened!" << std::endl;
+			std::cerr << "Error: Specified File name: " << temporaryPath << " cannot be opened!" << std::endl;
 			res = TACore::TACORE_FILE_ERROR;
 		}
 		return res;
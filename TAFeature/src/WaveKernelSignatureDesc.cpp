@@ -0,0 +1,20 @@
+#include "WaveKernelSignatureDesc.h"
+
+namespace TAFea
+{
+
+	WaveKernelSignatureDesc::WaveKernelSignatureDesc()
+	{
+		this->m_ID = -1;
+	}
+
+	WaveKernelSignatureDesc::WaveKernelSignatureDesc(const int& vertexid)
+	{
+		this->m_ID = vertexid;
+	}
+
+	WaveKernelSignatureDesc::~WaveKernelSignatureDesc()
+	{
+
+	}
+}
\ No newline at end of file
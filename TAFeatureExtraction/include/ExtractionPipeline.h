@@ -0,0 +1,171 @@
+#ifndef EXTRACTION_PIPELINE_H
+#define EXTRACTION_PIPELINE_H
+
+#include "TAFeatureExtraction.h"
+#include <core/TriMeshAuxInfo.h>
+#include <atomic>
+#include <future>
+#include <mutex>
+
+namespace TAShape
+{
+	class TriangularMesh;
+}
+
+namespace TAFea
+{
+	class GeodesicDistanceMatrix;
+}
+
+namespace TAFeaExt
+{
+	//Runs the per vertex extractors declared for a mesh so that the intermediate results they share are calculated only once
+	//Shared intermediates are:
+	//	Geodesic distance matrix, needed by the patch based extractors calculating their patches, also used by OnEdgeAvgGeoDistExtraction when it exists
+	//	Patches, shared by the patch based extractors with the same geodesic distances and number of patches
+	//	Ring areas and the laplacian created from them, shared by the extractors calculating an eigen basis and the HKS extractors with the Chebyshev backend with the same laplacian
+	//	Eigen basis, shared by the spectral extractors with the same laplacian and coarse mesh
+	//	Maximum possible sample values from the auxilary info of the mesh, needed by PatchBasedShapeDistributionDescExtraction if they are not set
+	//Vertex adjacency is built by the mesh when it is loaded, so it is not an intermediate of the run
+	//Patches and eigen bases are calculated by the first extractor of their group, the source, and handed to the others before they start
+	//Each intermediate and each descriptor is a node of a dependency graph, the laplacian is a node only if more than one extractor needs it
+	//Nodes are run by a fixed number of worker threads taking them in dependency order, so a node runs as soon as the nodes it depends on are completed
+	//and a worker is free, at most getNumberOfWorkers nodes run at the same time
+	//An intermediate is released as soon as all of its consumers are completed, e.g. the geodesic matrix after the patches are created
+	//Extractors are not owned, they are configured by the caller before run and must not be used by others during the run
+	class ExtractionPipeline
+	{
+	public:
+		ExtractionPipeline();
+		virtual ~ExtractionPipeline();
+
+		/**
+		* @brief	Declares a descriptor to be extracted in the run
+		* @param	extractor Configured extractor of the descriptor, not owned
+		* @return	Id of the descriptor used to get its features after the run
+		*/
+		int addDescriptor(PerVertexFeatureExtraction* extractor);
+
+		/**
+		* @brief	Runs all declared descriptors on the mesh
+		*			Eigen bases, patches and geodesic matrices handed to the extractors are taken back from them when they are released
+		* @param	triMesh Mesh whose vertex features are extracted
+		* @return	TACORE_OK if all descriptors are extracted
+		* @return	TACORE_BAD_ARGS if triMesh is NULL
+		* @return	Result of the first failed node in dependency order otherwise, see getResult for each descriptor
+		*/
+		Result run(TriangularMesh* triMesh);
+
+		/**
+		* @brief	Clears the descriptors and their features
+		* @return	void
+		*/
+		void clear();
+
+		/**
+		* @brief	Gets the features extracted for a descriptor in the last run
+		* @param	descriptorId Id returned by addDescriptor
+		* @return	Features of all vertices, empty if the extraction failed
+		*/
+		const std::vector<LocalFeaturePtr>& getFeatures(const int& descriptorId) const;
+
+		/**
+		* @brief	Gets the result of the extraction of a descriptor in the last run
+		* @param	descriptorId Id returned by addDescriptor
+		* @return	Result of the extractor, or of the intermediate it depends on if that failed
+		*/
+		Result getResult(const int& descriptorId) const;
+
+		//Setters
+		void setGeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix* gdMatrix);
+		void setAuxInfo(const TriMeshAuxInfo& auxInfo);
+		void setNumberOfWorkers(const unsigned int& noWorkers);
+
+		//Getters
+		int getNumberOfDescriptors() const;
+		unsigned int getNumberOfWorkers() const;
+
+	private:
+		ExtractionPipeline(const ExtractionPipeline& other);
+		ExtractionPipeline& operator=(const ExtractionPipeline& other);
+
+		enum NodeType
+		{
+			GEODESIC_DISTANCE_MATRIX_NODE = 1,	//< Calculates the geodesic distance matrix
+			LAPLACIAN_NODE,						//< Calculates the ring areas and the laplacian of a laplacian type
+			MAX_POSSIBLE_SAMPLES_NODE,			//< Sets the maximum possible sample values from the auxilary info
+			DESCRIPTOR_NODE						//< Extracts a descriptor, a source node also creates the patches or the eigen basis of its group
+		};
+
+		struct Node
+		{
+			NodeType			m_Type;
+			int					m_nDescriptorId;			//< Descriptor extracted by a DESCRIPTOR_NODE, -1 for the others
+			int					m_nSourceDescriptorId;		//< Descriptor whose patches or eigen basis are taken before the extraction, -1 if none
+			std::vector<int>	m_vDependencies;			//< Nodes which must be completed before this node
+			std::vector<int>	m_vHolderDescriptorIds;		//< Descriptors holding the intermediate of this node, it is taken back from them on release
+			int					m_nRemainingConsumers;		//< Number of nodes depending on this node which are not completed yet
+		};
+
+		/**
+		* @brief	Creates the nodes of the dependency graph of the declared descriptors
+		*			Nodes are ordered so that a node comes after the nodes it depends on
+		* @param	triMesh Mesh whose vertex features are extracted
+		* @return	void
+		*/
+		void createNodes(TriangularMesh* triMesh);
+
+		/**
+		* @brief	Takes the nodes in their order and runs them until no node is left, run by each worker thread
+		*			A node comes after its dependencies, so they are taken by other workers before it and it never waits for a node which is not started
+		* @return	void
+		*/
+		void runWorker();
+
+		/**
+		* @brief	Waits for the dependencies of a node, runs it and releases the intermediates whose consumers are all completed
+		* @param	nodeId Id of the node
+		* @return	Result of the node, or of the first failed dependency
+		*/
+		Result runNode(const int& nodeId);
+
+		/**
+		* @brief	Runs the work of a node whose dependencies are completed
+		* @param	nodeId Id of the node
+		* @return	Result of the work
+		*/
+		Result executeNode(const int& nodeId);
+
+		/**
+		* @brief	Marks a consumer of a node completed and releases the intermediate of the node if it was the last one
+		* @param	nodeId Id of the node
+		* @return	void
+		*/
+		void completeConsumer(const int& nodeId);
+
+		/**
+		* @brief	Releases the intermediate of a node and takes it back from its holders
+		* @param	nodeId Id of the node
+		* @return	void
+		*/
+		void releaseNode(const int& nodeId);
+
+		std::vector<PerVertexFeatureExtraction*>	m_vExtractors;				//< Declared extractors, not owned
+		std::vector<std::vector<LocalFeaturePtr> >	m_vFeatures;				//< Features of each descriptor from the last run
+		std::vector<Result>							m_vResults;					//< Result of each descriptor from the last run
+		TAFea::GeodesicDistanceMatrix*				m_pGeodesicDistanceMatrix;	//< Geodesic distance matrix set by the caller, not owned, NULL if calculated in the run
+		TriMeshAuxInfo								m_AuxInfo;					//< Auxilary info set by the caller
+		bool										m_bHasAuxInfo;				//< Whether the auxilary info is set by the caller or not
+		unsigned int								m_nNumberOfWorkers;			//< Maximum number of nodes running at the same time
+
+		TriangularMesh*								m_pMesh;					//< Mesh of the current run
+		std::vector<Node>							m_vNodes;					//< Nodes of the current run
+		std::vector<std::promise<Result> >			m_vNodePromises;			//< Set by the workers when the nodes of the current run are completed
+		std::vector<std::shared_future<Result> >	m_vNodeFutures;				//< Results of the nodes of the current run
+		std::atomic<int>							m_nNextNodeId;				//< Next node to be taken by a worker
+		GlobalFeaturePtr							m_pCalculatedGeodesicMatrix;//< Geodesic distance matrix calculated in the current run
+		std::mutex									m_ConsumerMutex;			//< Guards the consumer counts of the nodes
+	};
+}
+
+#endif
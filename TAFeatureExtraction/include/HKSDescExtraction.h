@@ -1,13 +1,7 @@
 #ifndef HEAT_KERNEL_SIGNATURE_DESC_EXTRACTION_H
 #define HEAT_KERNEL_SIGNATURE_DESC_EXTRACTION_H
 
-#include "TAFeatureExtraction.h"
-#include <armadillo>
-
-namespace TAShape
-{
-	class TriangularMesh;
-}
+#include "SpectralDescExtraction.h"
 
 namespace TAFeaExt
 {
@@ -15,15 +9,18 @@ namespace TAFeaExt
 	//Technical Details of the feature is described in http://www.lix.polytechnique.fr/~maks/papers/hks.pdf
 	//[Currently] Time interval is decided automatically on default from the eigen values as proposed in the paper.
 	//Set time interval values in case you do not want the default calculated ones
-	//HKSDescExtraction is a PerVertexFeatureExtraction
-	class HKSDescExtraction : public PerVertexFeatureExtraction
+	//Laplacian and its eigen basis are handled by SpectralDescExtraction, the time samples are the spectral filters
+	//Alternatively, the diagonal of exp(-tL) can be approximated by Chebyshev polynomials of the laplacian applied to random probe vectors,
+	//which needs no eigen decomposition, see HKS_BACKEND_CHEBYSHEV
+	//HKSDescExtraction is a SpectralDescExtraction
+	class HKSDescExtraction : public SpectralDescExtraction
 	{
 	public:
 
-		enum TypeOfLaplacian
+		enum HeatKernelBackend
 		{
-			STAR_LAPLACIAN = 1,			//< http://www.cs.princeton.edu/courses/archive/fall10/cos526/papers/sorkine05.pdf
-			DISCRETE_LAPLACIAN = 2		//< http://web.cse.ohio-state.edu/~yusu/papers/finalscg_laplace.pdf, practical impl --> https://etd.ohiolink.edu/rws_etd/document/get/osu1236615194/inline 
+			HKS_BACKEND_EIGEN_DECOMPOSITION = 1,	//< Heat kernel from the eigen values and vectors of the laplacian
+			HKS_BACKEND_CHEBYSHEV = 2				//< Heat kernel diagonal estimated from Chebyshev expansions of exp(-tL) on Rademacher probe vectors, time boundaries must be set by the user
 		};
 
 		virtual ~HKSDescExtraction();
@@ -34,86 +31,79 @@ namespace TAFeaExt
 		virtual Result extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr);
 
 		/**
-		* @brief	Create the laplacian matrix from the polygon mesh according to TypeOfLaplacian and saves it into the object
-		*			[Currently] Only STAR Laplacian is supported
-		* @param	mesh Polygonial mesh from which the laplacian matrix will be created
-		* @param	typeLap Type of the laplacian matrix to be extracted
-		* @param	vertexRingAreas Area sums around a vertex
-		* @return	TACORE_OK if everything goes fine.
+		* @brief	Clears the object by setting default parameters and deleting heap space
+		* @return	void
 		*/
-		Result createLaplacianMatrix(PolygonMesh *mesh, const TypeOfLaplacian& typeLap, const std::vector<double>& vertexRingAreas);
+		virtual void clear();
 
 		/**
-		* @brief	Calculates the eigen values and vectors of the laplacian saved in the object.
-		* @param	noEigenVals Number of eigen values and vectors to be calculated
-		* @param [out] pEigVals Eigenvalues calculated
-		* @param [out] pEigVecs Eigenvectors calculated
-		* @return	TACORE_OK if everything goes fine
-		* @return	TACORE_BAD_ARGS if noEigenVals is smaller than 2
-		* @return	TACORE_INVALID_OPERATION if laplacian matrix is not constructed
-		* @return	TACORE_ERROR if decomposition fails to converge
+		* @brief	Heat kernel terms decrease with the eigen value, so the adaptive eigen count mode can stop early
+		* @return	true
 		*/
-		Result calcEigenDecomposition(const unsigned int& noEigenVals, arma::cx_vec *pEigVals, arma::cx_mat *pEigVecs);
+		virtual bool supportsAdaptiveEigenCount() const;
 
 		/**
-		* @brief	Clears the object by setting default parameters and deleting heap space
-		* @return	void
+		* @brief	Counts the eigen values whose heat kernel term at the minimum time exp(-t_min * lambda) is not below the adaptive eigen tolerance
+		*			Minimum time calculated from the eigen values would depend on the count itself,
+		*			so the minimum time of the user is used in the adaptive eigen count mode even if the time boundaries are calculated from the eigen values
+		* @param	eigVals Eigen values of the laplacian
+		* @param	sumRingAreas Sum of the ring areas of the vertices, i.e. the scale of the eigen values
+		* @return	Number of significant eigen values
 		*/
-		void clear();
+		virtual unsigned int countSignificantEigenVals(const arma::vec& eigVals, const double& sumRingAreas) const;
 
 		//Setters
-		void setTypeOfLaplacian(const TypeOfLaplacian& typeLap);
-		void setNumberOfEigenVals(const unsigned int& noEigenVals);
 		void setMinTimeVal(const double& minTime);
 		void setMaxTimeVal(const double& maxTime);
 		void setNumberOfTimeSamples(const unsigned int& noTimeSamples);
 		void setUseEigenValuesForTimeBoundaries(const bool& calcTimeFromEigenVals);
+		void setHeatKernelBackend(const HeatKernelBackend& backend);
+		void setChebyshevMaxDegree(const unsigned int& maxDegree);
+		void setChebyshevTolerance(const double& tolerance);
+		void setNumberOfProbeVectors(const unsigned int& noProbeVectors);
+		void setProbeBlockSize(const unsigned int& probeBlockSize);
+		void setProbeSeed(const unsigned int& probeSeed);
 
 		//Getters
-		TypeOfLaplacian getTypeOfLaplacian() const;
-		unsigned int getNumberOfEigenVals() const;
 		double getMinTimeVal() const;
 		double getMaxTimeVal() const;
 		unsigned int getNumberOfTimeSamples() const;
 		bool getUseEigenValuesForTimeBoundaries() const;
+		HeatKernelBackend getHeatKernelBackend() const;
+		unsigned int getChebyshevMaxDegree() const;
+		double getChebyshevTolerance() const;
+		unsigned int getNumberOfProbeVectors() const;
+		unsigned int getProbeBlockSize() const;
+		unsigned int getProbeSeed() const;
 
 	private:
 
-		TypeOfLaplacian m_LaplacianUsed;		//< Type of the laplacian used in the extraction
-		unsigned int m_nNoEigenVal;				//< Number of eigen vals and vects extracted from the laplacian matrix
 		double m_fTMin;							//< Minimum value of the time interval
 		double m_fTMax;							//< Maximum value of the time interval
 		unsigned int m_nNumberOfTimeSamples;	//< Number of time values in the interval
 		bool m_bCalcTimeValsFromEigenVals;		//< Check whether to use time boundaries from eigen values or user input
 
-		arma::SpMat<double> *m_mLaplacian;		//< Laplacian matrix, it is a class member because multiple executions for different time intervals should be enabled without re-construction.
+		HeatKernelBackend m_Backend;			//< How the heat kernel is evaluated
+		unsigned int m_nChebyshevMaxDegree;		//< Maximum degree of the Chebyshev expansions
+		double m_fChebyshevTolerance;			//< Expansions are truncated after the coefficients fall below this value for all time samples
+		unsigned int m_nNumberOfProbeVectors;	//< Number of Rademacher probe vectors used to estimate the heat kernel diagonal
+		unsigned int m_nProbeBlockSize;			//< Number of probe vectors propagated together, memory is bounded by 3 * block size * vertex count
+		unsigned int m_nProbeSeed;				//< Seed of the probe vectors, same seed gives the same descriptors
 
 		/**
-		* @brief	Create the STAR laplacian matrix from the polygon mesh saves it into the object
-		*			[Currently] Only Triangular mesh is supported
-		* @param	mesh Polygonial mesh from which the laplacian matrix will be created
-		* @param	vertexRingAreas Area sums around a vertex
+		* @brief	Extracts HKS of all of the vertices without eigen decomposition
+		*			diag(exp(-tA)) of the area scaled laplacian A is estimated by mean(z .* p_t(A) z) over Rademacher probes z,
+		*			where p_t is the Chebyshev expansion of exp(-tx) on [0, Gershgorin bound of A]
+		*			A is negated for the discrete laplacian, so that its spectrum is nonnegative like the absolute eigen values of the eigen decomposition backend
+		*			Chebyshev polynomials T_k(A) z are calculated once for all of the time samples
+		*			Descriptors are normalized by the estimated heat trace instead of the truncated eigen value sum
+		* @param	mesh Polygonial mesh from which the features are extracted
+		* @param [out] outFeatures HKS of the vertices
 		* @return	TACORE_OK if everything goes fine.
+		* @return	TACORE_INVALID_OPERATION if time boundaries are not set by the user or are invalid, if probe settings are invalid
+		*			or if the expansion of the maximum time does not converge within the maximum degree
 		*/
-		Result createStarLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas);
-
-		/**
-		* @brief	Create the Discrete laplacian matrix from the polygon mesh saves it into the object
-		*			[Currently] Only Triangular mesh is supported
-		* @param	mesh Polygonial mesh from which the laplacian matrix will be created
-		* @param	vertexRingAreas Area sums around a vertex
-		* @return	TACORE_OK if everything goes fine.
-		*/
-		Result createDiscreteLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas);
-
-		/**
-		* @brief	Computes the cotangent weigh for w_ij for STAR Laplacian Matrixss
-		* @param	iv The index of the source vertex
-		* @param	jv The index of the neighbor vertex
-		* @return	Cotangent weight between the vertices iv and jn
-		*/
-		double cotangentWeight(TriangularMesh* mesh, int iv, int jv);
-
+		Result extractWithChebyshev(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures);
 	};
 }
 
@@ -0,0 +1,55 @@
+#ifndef BATCH_FEATURE_EXTRACTION_MAIN
+#define BATCH_FEATURE_EXTRACTION_MAIN
+
+//Encapsulates a run method which is used as a script for extracting per vertex features of all meshes of a dataset
+//Meshes are taken from a folder or a manifest file and processed in three overlapping stages:
+//	A loader thread parses the next meshes while the current one is extracted, at most a number of meshes and bytes are kept waiting
+//	The calling thread extracts the descriptors of a mesh with ExtractionPipeline, so intermediates are shared among them
+//	A writer thread writes the feature files of the previous meshes
+//Time spent in each stage is reported for each mesh
+//If the meshes ship with low resolution versions, e.g. dragon_finalLowReso.off next to dragon_final.off, eigen decompositions of hks and wks are seeded from them
+//With a queue folder the meshes are shared by worker processes, possibly on several machines through a shared file system:
+//	A process with the enqueue role adds the meshes as jobs
+//	Processes with the worker role process the jobs until none is left, each reports to its own file
+//	A process with the merge role merges the reports of the workers in the order of the meshes once all jobs are finished
+//Only static use is allowed
+//No object creation of this class is allowed
+class BatchFeatureExtractionMain
+{
+private:
+
+	//Private constructors and destructors
+	BatchFeatureExtractionMain();
+	BatchFeatureExtractionMain(const BatchFeatureExtractionMain&);
+	~BatchFeatureExtractionMain();
+
+public:
+
+	//Run Result
+	enum Result
+	{
+		BFER_OK = 0,
+		BFER_COMMAND_LINE_PARSE_ERROR,
+		BFER_INPUT_ERROR,
+		BFER_FILE_ERROR,
+		BFER_UNFINISHED_ERROR
+	};
+
+	/**
+	* @brief	Implements a main function which is used to create per vertex features of many meshes
+	*			Assumed to be called directly from a main function
+	*			A mesh which cannot be loaded or extracted is reported and skipped
+	*
+	* @param	argc Number of command line arguments
+	* @param	argv List of command line arguments
+	* @return	BFER_OK if everything goes fine
+	* @return	BFER_COMMAND_LINE_PARSE_ERROR if command line cannot be parsed correctly
+	* @return	BFER_INPUT_ERROR if no mesh is found in the folder or the manifest, or a descriptor type is not known
+	*			Workers of a queue take the meshes from the jobs, so they need neither a folder nor a manifest
+	* @return	BFER_FILE_ERROR if the report file or the queue folder cannot be created, or a job cannot be written
+	* @return	BFER_UNFINISHED_ERROR if some jobs are pending or running while merging the reports
+	*/
+	static Result run(int argc, char* argv[]);
+};
+
+#endif
@@ -12,7 +12,7 @@ namespace TAShape
 //Encapsulates a run method which is used as a script for comparing a source feature type with multiple parameters and a reference feature type
 //Features of source types are read from several files created by MultiParameterFeatureExtractionMain
 //Features of reference type is calculated inside
-//Comparison takes a vertex as the reference
+//Comparison takes one or more vertices as the references and scores all permutations against each of them in a single pass
 //Only static use is allowed
 //No object creation of this class is allowed
 class MultiParameterFeatureComparisonMain
@@ -50,22 +50,74 @@ public:
 	*/
 	static Result run(int argc, char* argv[]);
 
+	/**
+	* @brief	Scores the per vertex features of a permutation against the reference magnitudes of all reference vertices
+	*			Magnitudes of the features are normalized (0 to 1) in place, and the score is the L2 distance between them and the reference magnitudes
+	*
+	* @param	[in, out] magnitudes Distances of all vertices to each reference vertex, distance of vertex v to reference r is at r * number of vertices + v
+	* @param	refMagnitudes Normalized reference magnitudes of all vertices for each reference vertex
+	* @return	Score for each reference vertex, lower is better
+	*/
+	static std::vector<double> calcScores(std::vector<double>& magnitudes, const std::vector<std::vector<double> >& refMagnitudes);
+
+	/**
+	* @brief	Calculates the score of a permutation which is used to rank it, the mean of its scores over the reference vertices
+	*
+	* @param	scores Score for each reference vertex
+	* @return	Mean score, lower is better
+	*/
+	static double calcMeanScore(const std::vector<double>& scores);
+
+	/**
+	* @brief	Extracts average geodesic distances and creates magnitude vectors according to reference vertices
+	*			Average geodesic distances are extracted once for all reference vertices
+	*			Magnitudes are normalized (0 to 1) so that they can be compared with others
+	*			Magnitudes represent the distances of all vertices to a reference vertex
+	*
+	* @param	triMesh TriangularMesh from which the magnitudes are calculated
+	* @param	refVertices Reference vertices which are used to assign magnitudes to other vertices
+	* @param	noSourceSamples Number of random source vertices the average geodesic distances are estimated from, 0 uses all vertices
+	* @return	The vector of magnitudes for each reference vertex, empty if the average geodesic distances cannot be extracted
+	*/
+	static std::vector<std::vector<double> > createAGDMagnitudes(TAShape::TriangularMesh* triMesh, const std::vector<int>& refVertices, const int& noSourceSamples);
+
+	/**
+	* @brief	Writes the permutations ranked by their mean score over the reference vertices, the best permutation is the first one
+	*
+	* @param	permutationIdToScoresMap Scores of each permutation for each reference vertex
+	* @param	permutationIdToParametersMap Parameter names and values of each permutation
+	* @param	outFileName Path to the report file
+	* @return	MPFCR_OK if everything goes fine
+	* @return	MPFCR_FILE_ERROR if the output file cannot be opened
+	*/
+	static Result generateComparisonResult(const std::map<int, std::vector<double> >& permutationIdToScoresMap,
+											const std::map<int, std::vector< std::pair< std::string, double > > >& permutationIdToParametersMap, 
+											const std::string& outFileName);
+
 private:
 
 	/**
-	* @brief	Read feature files and creates magnitude vectors for all permutation according to a reference vertex
+	* @brief	Reads feature files and scores all permutations against the reference magnitudes of all reference vertices
 	*			Permutation id must be in the first location of the split of the file name
 	*			Split is done according to "_" character
 	*			Example file name is given below:
 	*				0000000064_MinGD_20_MaxGD_50_NOP_10_NOB_24_SC_128_SM_1_SDF_1.fea
-	*			Magnitudes for each file are normalized (0 to 1) so that they can be compared with others
-	*			Magnitudes represent the distances of all vertices to the reference vertex in a permutation file
+	*			For each reference vertex, magnitudes of a file are the distances of all vertices to the reference vertex normalized (0 to 1),
+	*			and the score is the L2 distance between them and the reference magnitudes
+	*			Files are read and scored in parallel, each file is mapped once for all reference vertices
+	*			Files written by TAFeatureFileIO::writePBSDInBinary before the feature container are read as per vertex objects
+	*			Files which cannot be read, are extracted from another mesh or do not match the mesh are skipped with a warning
 	*
 	* @param	featureFilePaths List of feature file paths
-	* @param	refVertex Reference vertex which is used to assign magnitudes to other vertices
-	* @return	Permutation id to magnitude vector mapping (For each permutation file, the vector of each vertices' magnitudes)
+	* @param	refVertices Reference vertices which are used to assign magnitudes to other vertices
+	* @param	refMagnitudes Normalized reference magnitudes of all vertices for each reference vertex
+	* @param	meshHash Content hash of the mesh, see TriangularMesh::calcContentHash
+	* @return	Permutation id to score vector mapping (For each permutation file, the score of each reference vertex)
 	*/
-	static std::map<int, std::vector<double> > createPermutationIdToMagnitudesMapForPBSD(const std::vector<std::string>& featureFilePaths, const int& refVertex);
+	static std::map<int, std::vector<double> > createPermutationIdToScoresMapForPBSD(const std::vector<std::string>& featureFilePaths,
+																						const std::vector<int>& refVertices,
+																						const std::vector<std::vector<double> >& refMagnitudes,
+																						const unsigned long long& meshHash);
 
 	/**
 	* @brief	Read feature file names and create permutation id to parameter names and values map
@@ -84,21 +136,20 @@ private:
 	static std::map<int, std::vector< std::pair< std::string, double > > > createPermutationIdToParameterValuesMap(const std::vector<std::string>& featureFilePaths);
 
 	/**
-	* @brief	Extracts average geodesic distances and creates magnitude vector according to a reference vertex
-	*			Magnitudes are normalized (0 to 1) so that they can be compared with others
-	*			Magnitudes represent the distances of all vertices to the reference vertex
+	* @brief	Writes the permutations x reference vertices scores as a csv file
+	*			A row has the permutation id, the parameter values and the score for each reference vertex
 	*
-	* @param	triMesh TriangularMesh from which the magnitudes are calculated
-	* @param	refVertex Reference vertex which is used to assign magnitudes to other vertices
-	* @return	The vector of magnitudes
+	* @param	refVertices Reference vertices in the order of the scores
+	* @param	permutationIdToScoresMap Scores of each permutation for each reference vertex
+	* @param	permutationIdToParametersMap Parameter names and values of each permutation
+	* @param	outFileName Path to the csv file
+	* @return	MPFCR_OK if everything goes fine
+	* @return	MPFCR_FILE_ERROR if the output file cannot be opened
 	*/
-	static std::vector<double> createAGDMagnitudes(TAShape::TriangularMesh* triMesh, const int& refVertex);
-
-	//TO DO: Comment when completed
-	static Result generateComparisonResult(const std::vector<double>& referenceMagnitudes,
-											const std::map<int, std::vector<double> >& permutationIdToSourceMagnitudesMap, 
-											const std::map<int, std::vector< std::pair< std::string, double > > >& permutationIdToParametersMap, 
-											const std::string& outFileName);
+	static Result generateScoreMatrix(const std::vector<int>& refVertices,
+										const std::map<int, std::vector<double> >& permutationIdToScoresMap,
+										const std::map<int, std::vector< std::pair< std::string, double > > >& permutationIdToParametersMap,
+										const std::string& outFileName);
 };
 
 #endif
\ No newline at end of file
@@ -20,18 +20,29 @@ public:
 	{
 		MPFER_OK = 0,
 		MPFER_COMMAND_LINE_PARSE_ERROR,
-		MPFER_MESH_LOAD_ERROR
+		MPFER_MESH_LOAD_ERROR,
+		MPFER_FILE_ERROR,
+		MPFER_EXTRACTION_ERROR
 	};
 
 	/**
 	* @brief	Implements a main function which is used to create per vertex features from a mesh with several parameters
 	*			Assumed to be called directly from a main function
+	*			Completed permutations are appended to a journal, a rerun skips the journaled ones whose outputs are valid and extracts the rest
+	*			Permutations sharing the same patches are extracted together, several such groups are extracted at the same time by the workers
+	*			With a queue folder the groups are shared by worker processes, possibly on several machines through a shared file system:
+	*				A process with the enqueue role adds the unfinished groups as jobs
+	*				Processes with the worker role extract the jobs until none is left, each journals to its own file
+	*				A process with the merge role checks the outputs and merges the journals of the workers into the journal once all jobs are finished
 	*
 	* @param	argc Number of command line arguments
 	* @param	argv List of command line arguments
 	* @return	MPFER_OK if everything goes fine
-	* @return	MPFER_COMMAND_LINE_PARSE_ERROR if command line cannot be parsed correctly
+	* @return	MPFER_COMMAND_LINE_PARSE_ERROR if command line cannot be parsed correctly or the role is not known
 	* @return	MPFER_MESH_LOAD_ERROR if mesh cannot be loaded correctly
+	* @return	MPFER_FILE_ERROR if the journal or the queue folder cannot be opened, or a job or the merged journal cannot be written
+	* @return	MPFER_EXTRACTION_ERROR if some permutations cannot be extracted or written, they are not journaled so a rerun retries them
+	*			For the merge role, if some jobs are not finished yet or some permutations are not completed
 	*/
 	static Result run(int argc, char* argv[]);
 };
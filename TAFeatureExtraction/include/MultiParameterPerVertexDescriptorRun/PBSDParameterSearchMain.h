@@ -0,0 +1,47 @@
+#ifndef PBSD_PARAMETER_SEARCH_MAIN
+#define PBSD_PARAMETER_SEARCH_MAIN
+
+//Encapsulates a run method which is used as a script for searching the parameters of patch based shape distribution descriptors
+//which agree with average geodesic distances the most, instead of extracting and comparing all permutations
+//Search is a successive halving over the permutations of PBSDParameterSet::createDefaultPermutations:
+//	All permutations are extracted with a small fraction of their sample counts and scored as MultiParameterFeatureComparisonMain does
+//	The best 1 / eta of them are kept and extracted again with eta times more samples
+//	The last rung extracts the remaining permutations with their own sample counts
+//Only static use is allowed
+//No object creation of this class is allowed
+class PBSDParameterSearchMain
+{
+private:
+
+	//Private constructors and destructors
+	PBSDParameterSearchMain();
+	PBSDParameterSearchMain(const PBSDParameterSearchMain&);
+	~PBSDParameterSearchMain();
+
+public:
+
+	//Run Result
+	enum Result
+	{
+		PPSR_OK = 0,
+		PPSR_COMMAND_LINE_PARSE_ERROR,
+		PPSR_MESH_LOAD_ERROR,
+		PPSR_FILE_ERROR
+	};
+
+	/**
+	* @brief	Implements a main function which is used to find the best parameters of patch based shape distribution descriptors of a mesh
+	*			Assumed to be called directly from a main function
+	*			The report has the same format as the one of MultiParameterFeatureComparisonMain and ranks the permutations of the last rung
+	*
+	* @param	argc Number of command line arguments
+	* @param	argv List of command line arguments
+	* @return	PPSR_OK if everything goes fine
+	* @return	PPSR_COMMAND_LINE_PARSE_ERROR if command line cannot be parsed correctly
+	* @return	PPSR_MESH_LOAD_ERROR if mesh, its geodesic distance matrix, its auxilary info or its average geodesic distances cannot be loaded correctly
+	* @return	PPSR_FILE_ERROR if an output file cannot be created
+	*/
+	static Result run(int argc, char* argv[]);
+};
+
+#endif
@@ -34,7 +34,27 @@ public:
 
 	std::string getName(const std::string& meshName, const size_t& parameterSetId) const;
 
+	//Names and values of the parameters, names are the same as the ones in getName
+	std::vector<std::pair<std::string, std::string> > getParameterValues() const;
+
 	static std::vector<PBSDParameterSet> createPermutations(const PBSDParameterSet& minValues, const PBSDParameterSet& maxValues, const PBSDParameterSet& incrementValues);
+
+	//Permutations of the parameter space which is swept by MultiParameterFeatureExtractionMain and searched by PBSDParameterSearchMain
+	static std::vector<PBSDParameterSet> createDefaultPermutations();
+
+	//Patches depend only on the geodesic distances and the number of patches
+	bool hasSamePatches(const PBSDParameterSet& other) const;
+
+	//Samples depend on the patches, the sample count, the sampling method and the shape distribution function but not on the number of bins
+	bool hasSameSamples(const PBSDParameterSet& other) const;
+
+	//Samples of the patches enumerated exactly do not depend on the sample count, see PatchBasedShapeDistributionDescExtraction::isSampleCountIndependent
+	bool hasSameExactSamples(const PBSDParameterSet& other) const;
+
+	//Groups the permutations by their expensive inputs so that patches and samples are created once for each group
+	//Result[p][s] holds the ids of the permutations with the p-th patches and the s-th samples of them, they differ only in the number of bins
+	//Groups and ids keep the order in which they are first seen in the permutations
+	static std::vector<std::vector<std::vector<size_t> > > groupPermutations(const std::vector<PBSDParameterSet>& permutations);
 };
 
 #endif
\ No newline at end of file
@@ -3,12 +3,23 @@
 
 #include "TAFeatureExtraction.h"
 
+namespace TAFea
+{
+	class GeodesicDistanceMatrix;
+}
+
 using namespace TACore;
 using namespace TAShape;
 using namespace TAFea;
 
 namespace TAFeaExt
 {
+	//Extracts average on edge geodesic distances of vertices
+	//Distances from a source vertex are accumulated into the sums of all vertices as soon as its shortest paths are found,
+	//so the geodesic distance matrix is never created and memory is linear in the number of vertices
+	//Geodesic distances are symmetric, so the distances from a source vertex are also the distances of all vertices to it
+	//This allows estimating all averages from a random subset of source vertices on large meshes, see setNumberOfSourceSamples
+	//If a geodesic distance matrix is already calculated for the mesh, it can be set and the averages are taken from its rows instead
 	class OnEdgeAvgGeoDistExtraction : public PerVertexFeatureExtraction
 	{
 	public:
@@ -16,9 +27,39 @@ namespace TAFeaExt
 		OnEdgeAvgGeoDistExtraction();
 		OnEdgeAvgGeoDistExtraction(const OnEdgeAvgGeoDistExtraction& other);
 
+		/**
+		* @brief	Extracts the average geodesic distances of all vertices
+		*			If a geodesic distance matrix is set, averages are exact and taken from its rows
+		*			If the number of source samples is 0 or not less than the number of vertices, shortest paths are found from all vertices and averages are exact
+		*			Otherwise they are found from randomly selected distinct source vertices, an average is the mean of the distances to them
+		*			and its confidence interval half width is set from their variance
+		*
+		* @param	mesh PolygonMesh
+		* @param	[out] outFeatures AvgGeodesicDistance of each vertex
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if mesh is not a triangular mesh
+		* @return	TACORE_INVALID_OPERATION if the confidence level is not between 0 and 1
+		*/
 		virtual Result extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures);
 		virtual Result extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr);
+
+		//Setters
+		void setNumberOfSourceSamples(const int& noSourceSamples);
+		void setConfidenceLevel(const double& confidenceLevel);
+		void setRandomSeed(const unsigned int& randomSeed);
+		void setGeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix* gdMatrix);
+
+		//Getters
+		int getNumberOfSourceSamples() const;
+		double getConfidenceLevel() const;
+		unsigned int getRandomSeed() const;
+
+	private:
+		int				m_nNumberOfSourceSamples;	//< Number of source vertices the averages are estimated from, 0 uses all vertices
+		double			m_fConfidenceLevel;			//< Confidence level of the intervals of the estimated averages, e.g. 0.95
+		unsigned int	m_nRandomSeed;				//< Seed of the selection of source vertices, same seed selects the same vertices
+		TAFea::GeodesicDistanceMatrix* m_pGeodesicDistanceMatrix;	//< Geodesic distance matrix of the mesh if already calculated, not owned (No Getter)
 	};
 }
 
-#endif //ON_EDGE_AVG_GEO_DIST_EXTRACTION_H
\ No newline at end of file
+#endif //ON_EDGE_AVG_GEO_DIST_EXTRACTION_H
@@ -2,6 +2,7 @@
 #define PATCH_BASED_PER_VERTEX_FEATURE_EXTRACTION_H
 
 #include "TAFeatureExtraction.h"
+#include <memory>
 
 namespace TAShape
 {
@@ -12,6 +13,8 @@ namespace TACore
 {
 	template<class T>
 	class TAMatrix;
+
+	class MemoryMappedFile;
 }
 
 namespace TAFea
@@ -24,8 +27,22 @@ namespace TAFeaExt
 	class PatchBasedPerVertexFeatureExtraction : public PerVertexFeatureExtraction
 	{
 	public:
-		typedef std::vector < int > SinglePatch;
-		typedef std::vector< SinglePatch > PatchList;
+		//Patches of a single vertex
+		//A patch of a bigger radius always contains the smaller ones, so all patches of a vertex are kept in a single list
+		//Vertex ids are sorted by their geodesic distance to the center vertex, the center vertex is the first one
+		//Patch of the scale s is the prefix [0, m_vScaleEnds[s]) of the list
+		struct VertexPatches
+		{
+			std::vector<int> m_vVertexIds;		//< Ids of the vertices inside the biggest patch, sorted by geodesic distance to the center vertex
+			std::vector<int> m_vScaleEnds;		//< End offset of the patch of each scale inside m_vVertexIds, non-decreasing
+
+			int getNumberOfScales() const { return (int)m_vScaleEnds.size(); }
+			int getPatchSize(const int& scale) const { return m_vScaleEnds[scale]; }
+		};
+
+		//Patches of all vertices, shared between the extractors using the same patches so that they are neither recalculated nor copied
+		//Shared patches are never modified, new patches are created in a new list
+		typedef std::shared_ptr<const std::vector<VertexPatches> > VertexPatchesListPtr;
 
 		enum TypeOfGlobalDescriptor
 		{
@@ -40,6 +57,18 @@ namespace TAFeaExt
 		virtual Result extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures);
 		virtual Result extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr);
 
+		/**
+		* @brief	Extracts the features of all vertices into a single contiguous matrix from the patches
+		*			Patches are prepared like extract, then calcFeatureMatrix fills the matrix
+		*
+		* @param	mesh Mesh whose vertex features are extracted
+		* @param	[out] outMatrix Features of all vertices
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if mesh is not a triangular mesh
+		*/
+		virtual Result extractToMatrix(PolygonMesh *mesh, FeatureMatrix<double>& outMatrix);
+		using PerVertexFeatureExtraction::extractToMatrix;
+
 		/**
 		* @brief	Gets the type of the global descriptor extracted from each patch
 		*			Each derived class must implement the specify the type of the global descriptor
@@ -52,26 +81,128 @@ namespace TAFeaExt
 		virtual void setMaxGeodesicDistance(const float& maxGeoDistance);
 		virtual void setNumberOfPatches(const int& noOfPatches);
 		virtual void setGeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix* gdMatrix);
-		virtual void setPatchesForAllVertices(const std::vector<PatchList>& patchesForAll);
+		virtual void setPatchesForAllVertices(const VertexPatchesListPtr& patchesForAll);
 
 		//Getters
 		virtual float getMinGeodesicDistance() const;
 		virtual float getMaxGeodesicDistance() const;
 		virtual int getNumberOfPatches() const;
-		virtual std::vector<PatchList> getPatchesForAllVertices() const;
+		virtual VertexPatchesListPtr getPatchesForAllVertices() const;
+
+		/**
+		* @brief	Saves the patches in the compact binary format
+		*			File starts with a header and an offset index of the vertex records, so the patches of a single vertex can be read without reading the others
+		*			A vertex record keeps the nested form: scale ends and vertex ids in distance order are stored as zigzag encoded deltas in varints
+		*
+		* @param	patchesForAll Patches of all vertices, all vertices must have the same number of scales
+		* @param	pathToFile Path of the file to be saved
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if the number of scales differs between vertices
+		* @return	TACORE_FILE_ERROR if the file cannot be opened
+		*/
+		Result savePatchesInCompactBinary(const std::vector<VertexPatches>& patchesForAll, const std::string& pathToFile);
+
+		/**
+		* @brief	Loads all patches saved by savePatchesInCompactBinary
+		*
+		* @param	pathToFile Path of the file
+		* @param	[out] patchesForAll Patches of all vertices
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_FILE_ERROR if the file cannot be opened or it is not a valid patch file
+		*/
+		Result loadPatchesInCompactBinary(const std::string& pathToFile, std::vector<VertexPatches>& patchesForAll);
+
+		/**
+		* @brief	Memory maps a patch file saved by savePatchesInCompactBinary to be used by the extraction instead of calculating the patches
+		*			extract for a single vertex reads only the record of that vertex
+		*			Number of vertices and number of scales in the file are checked against the mesh and the number of patches during extraction
+		*
+		* @param	pathToFile Path of the file
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_FILE_ERROR if the file cannot be mapped or it is not a valid patch file
+		*/
+		Result openPatchFile(const std::string& pathToFile);
+
+		/**
+		* @brief	Unmaps the patch file opened by openPatchFile, patches are calculated again in the following extractions
+		* @return	void
+		*/
+		void closePatchFile();
+
+		/**
+		* @brief	Query if a patch file is opened by openPatchFile
+		* @return	true if the patches are read from a patch file, false if they are calculated
+		*/
+		bool isPatchFileOpen() const;
 
 	private:
 		float m_fMinGeodesicRadius;									//< Minimum value for geodesic distance from which the smallest patch is created
 		float m_fMaxGeodesicRadius;									//< Maximum value for geodesic distance from which the biggest patch is created
 		int m_nNumberOfPatches;										//< Number of patches which will be the size of the output descriptor
 		TAFea::GeodesicDistanceMatrix* m_pGeodeticDistanceMatrix;	//< Geodesic Distance Matrix used in the extraction. De-allocation is the responsibilty of the users of this class (No Getter)	
-		std::vector<PatchList> m_PatchesForAllVertices;				//< List of patch list for all vertices of the corresponding mesh.
+		VertexPatchesListPtr m_pPatchesForAllVertices;				//< Nested patches of all vertices of the corresponding mesh, NULL until they are prepared or set
+		std::shared_ptr<TACore::MemoryMappedFile> m_pPatchFile;		//< Mapped compact patch file from which the patches are read, NULL if patches are calculated
+
+		/**
+		* @brief	Reads the patches of a vertex from a mapped compact patch file
+		*
+		* @param	patchFile Mapped patch file
+		* @param	vertexId Id of the vertex whose patches are read
+		* @param	[out] patches Nested patches of the vertex
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if vertexId is not inside the file
+		* @return	TACORE_FILE_ERROR if the file is not a valid patch file
+		*/
+		Result readVertexPatchesFromPatchFile(const TACore::MemoryMappedFile& patchFile, const int& vertexId, VertexPatches& patches) const;
+
+		/**
+		* @brief	Checks whether the mapped patch file can be used for the mesh and the number of patches of the object
+		*
+		* @param	patchFile Mapped patch file
+		* @param	noVertices Number of vertices of the mesh
+		* @return	TACORE_OK if the file can be used
+		* @return	TACORE_INVALID_OPERATION if the number of vertices or scales does not match
+		* @return	TACORE_FILE_ERROR if the file is not a valid patch file
+		*/
+		Result checkPatchFile(const TACore::MemoryMappedFile& patchFile, const int& noVertices) const;
+
+		/**
+		* @brief	Creates the nested patches of a vertex from its distance row
+		*			Vertices inside the biggest radius are sorted once by distance, then the end of each scale is found by a single pass over the sorted list
+		*
+		* @param	vertexId The id of the vertex around which the patches will be created
+		* @param	distanceRow Distances of all vertices to the vertex
+		* @param	noVertices Number of vertices, i.e. size of the distance row
+		* @param	minRadius Minimum radius bounding the smallest patch
+		* @param	maxRadius Maximum radius bounding the biggest patch
+		* @param	noOfPatches Number of patches created around a single vertex
+		* @param	[out] patches Nested patches of the vertex
+		* @return	void
+		*/
+		void createVertexPatchesFromDistances(const int& vertexId, const float* distanceRow, const int& noVertices, const float& minRadius, const float& maxRadius, const int& noOfPatches, VertexPatches& patches) const;
 
 	protected:
 
+		/**
+		* @brief	Prepares the patches of all vertices if they are not ready
+		*			Patches are read from the patch file if one is open, otherwise they are created from the geodesic distance matrix
+		*			Prepared patches are kept in the object, so the following extractions with the same object reuse them
+		*
+		* @param	triMesh TriangularMesh
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if triMesh is NULL
+		*/
+		Result preparePatches(TriangularMesh* triMesh);
+
+		/**
+		* @brief	Gets the patches of all vertices prepared by preparePatches, must be called only after preparePatches succeeds
+		* @return	Nested patches of all vertices
+		*/
+		const std::vector<VertexPatches>& getPreparedPatches() const;
+
 		/**
 		* @brief	Creates patches around a vertex for the radii between minimum radius and maximum radius from a triangular mesh
-		*			Patches are considered as the list of vertex ids 
+		*			Patches are considered as the list of vertex ids, see VertexPatches
 		*			A vertex is inside a patch when it is inside the region specified by the current radius
 		*
 		* @param	triMesh TriangularMesh
@@ -80,16 +211,16 @@ namespace TAFeaExt
 		* @param	minRadius Minimum radius bounding the smallest patch
 		* @param	maxRadius Maximum radius bounding the biggest patch
 		* @param	noOfPatches Number of patches created around a single vertex
-		* @param	[out] patchesVertexIds List of patches which contain the list of vertex ids
+		* @param	[out] patches Nested patches of the vertex
 		*			
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_BAD_ARGS if triMesh is NULL
 		*/
-		virtual Result createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, PatchList& patchesVertexIds);
+		virtual Result createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, VertexPatches& patches);
 
 		/**
 		* @brief	Creates patches around a vertex for the radii between minimum radius and maximum radius from a triangular mesh
-		*			Patches are considered as the list of vertex ids
+		*			Patches are considered as the list of vertex ids, see VertexPatches
 		*			A vertex is inside a patch when it is inside the region specified by the current radius
 		*
 		* @param	triMesh TriangularMesh
@@ -98,12 +229,12 @@ namespace TAFeaExt
 		* @param	minRadius Minimum radius bounding the smallest patch
 		* @param	maxRadius Maximum radius bounding the biggest patch
 		* @param	noOfPatches Number of patches created around a single vertex
-		* @param	[out] patchesVertexIds List of patches which contain the list of vertex ids
+		* @param	[out] patches Nested patches of the vertex
 		*
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_BAD_ARGS if triMesh is NULL
 		*/
-		virtual Result createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const std::vector<float>& distanceVector, const float& minRadius, const float& maxRadius, const int& noOfPatches, PatchList& patchesVertexIds);
+		virtual Result createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const std::vector<float>& distanceVector, const float& minRadius, const float& maxRadius, const int& noOfPatches, VertexPatches& patches);
 
 		/**
 		* @brief	Creates patches around all vertices for the radii between minimum radius and maximum radius from a triangular mesh
@@ -115,43 +246,45 @@ namespace TAFeaExt
 		* @param	minRadius Minimum radius bounding the smallest patch
 		* @param	maxRadius Maximum radius bounding the biggest patch
 		* @param	noOfPatches Number of patches created around a single vertex
-		* @param	[out] listOfPatchLists List of patch lists FOR ALL VERTICES
+		* @param	[out] listOfPatches Nested patches FOR ALL VERTICES
 		*
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_BAD_ARGS if triMesh is NULL
 		*/
-		virtual Result createPatches(TriangularMesh* triMesh, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, std::vector<PatchList>& listOfPatchLists);
+		virtual Result createPatches(TriangularMesh* triMesh, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, std::vector<VertexPatches>& listOfPatches);
 
 		/**
 		* @brief	Saves the patches given in binary format
+		*			Each patch is written separately as it was a list of vertex ids sorted by id
 		*
 		* @param	patchesForAll Patches of all vertices
 		* @param	pathToFile patches of all vertices to be saved
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_FILE_ERROR if the file cannot be opened
 		*/
-		Result savePatchesInBinary(const std::vector<PatchList>& patchesForAll, const std::string& pathToFile);
+		Result savePatchesInBinary(const std::vector<VertexPatches>& patchesForAll, const std::string& pathToFile);
 
 		/**
 		* @brief	Loads the patches given in binary format
+		*			Patches are converted into the nested form, the vertices added by each scale are kept in the order of the file
 		*
 		* @param	pathToFile patches of all vertices
 		* @param	[out] patchesForAll Patches of all vertices to be loaded
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_FILE_ERROR if the file cannot be opened
 		*/
-		Result loadPatchesInBinary(const std::string& pathToFile, std::vector<PatchList>& patchesForAll);
+		Result loadPatchesInBinary(const std::string& pathToFile, std::vector<VertexPatches>& patchesForAll);
 
 		/**
 		* @brief	Calculates features from extracted patches for ALL VERTICES
 		*			All derived classes must implement this method
 		*
 		* @param	triMesh TriangularMesh
-		* @param	listOfPatchLists patches of all vertices
+		* @param	listOfPatches patches of all vertices
 		* @param	[out] outFeatures Output vector of features
 		* @return	TACORE_OK if everything goes fine
 		*/
-		virtual Result calcFeature(TriangularMesh* triMesh, const std::vector<PatchList>& listOfPatchLists, std::vector<LocalFeaturePtr>& outFeatures) = 0;
+		virtual Result calcFeature(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, std::vector<LocalFeaturePtr>& outFeatures) = 0;
 
 		/**
 		* @brief	Calculates features from extracted patches for a vertex
@@ -159,11 +292,22 @@ namespace TAFeaExt
 		*
 		* @param	triMesh TriangularMesh
 		* @param	id Id of the vertex whose feature is being extracted
-		* @param	patchesVertexIds patches of a vertex
+		* @param	patches patches of a vertex
 		* @param	[out] outFeaturePtr Output feature pointer
 		* @return	TACORE_OK if everything goes fine
 		*/
-		virtual Result calcFeature(TriangularMesh* triMesh, const int& id, const PatchList& patchesVertexIds, LocalFeaturePtr& outFeaturePtr) = 0;
+		virtual Result calcFeature(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, LocalFeaturePtr& outFeaturePtr) = 0;
+
+		/**
+		* @brief	Calculates features from extracted patches for ALL VERTICES into a feature matrix
+		*			Default implementation converts the output of calcFeature, derived classes override it to fill the rows directly
+		*
+		* @param	triMesh TriangularMesh
+		* @param	listOfPatches patches of all vertices
+		* @param	[out] outMatrix Features of all vertices
+		* @return	TACORE_OK if everything goes fine
+		*/
+		virtual Result calcFeatureMatrix(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, FeatureMatrix<double>& outMatrix);
 	};
 }
 
@@ -2,6 +2,7 @@
 #define PATCH_BASED_SHAPE_DISTRIBUTION_DESC_EXTRACTION_H
 
 #include "PatchBasedPerVertexFeatureExtraction.h"
+#include <core/AliasTable.h>
 
 namespace TACore
 {
@@ -9,6 +10,8 @@ namespace TACore
 	class NDimVector;
 
 	typedef NDimVector<double, 3> Vector3D;
+
+	class PhiloxRandom;
 }
 
 namespace TAFeaExt
@@ -49,6 +52,8 @@ namespace TAFeaExt
 		void setSampleCount(const int& sampleCount);
 		void setNumberOfBins(const int& numberOfBins);
 		void setMaxPossibleSampleValue(const double& maxPossibleVal);
+		void setRandomSeed(const unsigned int& randomSeed);
+		void setExactSampleThreshold(const int& exactSampleThreshold);
 
 		//Getters
 		ShapeDistributionFunction getShapeDistributionFunction() const;
@@ -56,6 +61,8 @@ namespace TAFeaExt
 		int getSampleCount() const;
 		int getNumberOfBins() const;
 		double getMaxPossibleSampleValue() const;
+		unsigned int getRandomSeed() const;
+		int getExactSampleThreshold() const;
 
 
 		/**
@@ -64,6 +71,30 @@ namespace TAFeaExt
 		*/
 		virtual TypeOfGlobalDescriptor getGlobalDescriptorType() const;
 
+		/**
+		* @brief	Extracts the descriptors of all vertices for several numbers of bins from the same patches and samples
+		*			Patches and samples do not depend on the number of bins, so they are created once and each number of bins fills its own histograms
+		*			Features of a number of bins are the same as the ones extracted by extract after setNumberOfBins with that number
+		*
+		* @param	mesh Triangular mesh
+		* @param	numbersOfBins Numbers of bins of the histograms, the number of bins of the object is not used
+		* @param	[out] outFeatures Features of all vertices for each number of bins, in the order of numbersOfBins
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if mesh is not a triangular mesh, numbersOfBins is empty or has a non positive number
+		*/
+		Result extractForNumbersOfBins(PolygonMesh *mesh, const std::vector<int>& numbersOfBins, std::vector<std::vector<LocalFeaturePtr> >& outFeatures);
+
+		/**
+		* @brief	Query if the descriptors of the mesh do not depend on the sample count, i.e. the vertex sampling enumerates every patch exactly
+		*			Patches are prepared like extractForNumbersOfBins, so the following extractions reuse them
+		*
+		* @param	mesh Triangular mesh
+		* @param	[out] outIsIndependent true if every patch of every vertex has the points of a sample and at most the exact sample threshold samples
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if mesh is not a triangular mesh
+		*/
+		Result isSampleCountIndependent(PolygonMesh *mesh, bool& outIsIndependent);
+
 	protected:
 
 		/**
@@ -71,13 +102,13 @@ namespace TAFeaExt
 		*			from extracted patches for ALL VERTICES
 		*
 		* @param	triMesh TriangularMesh
-		* @param	listOfPatchLists patches of all vertices
+		* @param	listOfPatches patches of all vertices
 		* @param	[out] outFeatures Output vector of features
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_BAD_ARGS if triMesh is NULL
-		* @return	TACORE_BAD_ARGS if listOfPatchLists is empty
+		* @return	TACORE_BAD_ARGS if listOfPatches is empty
 		*/
-		virtual Result calcFeature(TriangularMesh* triMesh, const std::vector<PatchList>& listOfPatchLists, std::vector<LocalFeaturePtr>& outFeatures);
+		virtual Result calcFeature(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, std::vector<LocalFeaturePtr>& outFeatures);
 
 		/**
 		* @brief	Calculates patch based shape distribution histogram descriptor for a specified distribution function 
@@ -85,29 +116,123 @@ namespace TAFeaExt
 		*
 		* @param	triMesh TriangularMesh
 		* @param	id Id of the vertex whose feature is being extracted
-		* @param	patchesVertexIds patches of a vertex
+		* @param	patches patches of a vertex
 		* @param	[out] outFeaturePtr Output feature pointer
 		* @return	TACORE_OK if everything goes fine
 		*/
-		virtual Result calcFeature(TriangularMesh* triMesh, const int& id, const PatchList& patchesVertexIds, LocalFeaturePtr& outFeaturePtr);
+		virtual Result calcFeature(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, LocalFeaturePtr& outFeaturePtr);
+
+		/**
+		* @brief	Calculates patch based shape distribution histogram descriptors of ALL VERTICES for several numbers of bins
+		*
+		* @param	triMesh TriangularMesh
+		* @param	listOfPatches patches of all vertices
+		* @param	numbersOfBins Numbers of bins of the histograms
+		* @param	[out] outFeatures Features of all vertices for each number of bins
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if triMesh is NULL
+		* @return	TACORE_BAD_ARGS if listOfPatches is empty
+		*/
+		Result calcFeaturesForNumbersOfBins(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, const std::vector<int>& numbersOfBins, std::vector<std::vector<LocalFeaturePtr> >& outFeatures);
+
+		/**
+		* @brief	Calculates patch based shape distribution histogram descriptors of ALL VERTICES directly into a feature matrix
+		*			Row of a vertex has a block of m_nNumberOfBins values for each patch
+		*
+		* @param	triMesh TriangularMesh
+		* @param	listOfPatches patches of all vertices
+		* @param	[out] outMatrix Features of all vertices
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if triMesh is NULL, listOfPatches is empty or the vertices have different numbers of patches
+		*/
+		virtual Result calcFeatureMatrix(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, FeatureMatrix<double>& outMatrix);
+
+		/**
+		* @brief	Calculates the possible maximum value of a sample from the mesh if it is not set before
+		*			Angle is always bounded by pi
+		*
+		* @param	triMesh TriangularMesh
+		* @return	void
+		*/
+		void prepareMaxPossibleSample(TriangularMesh* triMesh);
+
+		//Triangles of the biggest patch of a vertex for the unbiased surface sampling
+		//A triangle is inside a patch when its three vertices are inside the patch
+		//Triangles are sorted by the scale they enter the patches, triangles entering at the same scale are a layer
+		//Patch of a scale is the union of its first layers, so the alias tables of the layers are shared by all scales
+		struct PatchTriangles
+		{
+			std::vector<int> m_vTriangleVertexIds;				//< Vertex ids of the triangles, 3 per triangle
+			std::vector<int> m_vLayerStarts;					//< Start of each layer inside the triangles, size is number of layers + 1
+			std::vector<TACore::AliasTable> m_vLayerTables;		//< Alias table over the triangle areas of each layer
+			std::vector<double> m_vLayerAreas;					//< Area of each layer
+			std::vector<int> m_vScaleLayerEnds;					//< Number of layers inside the patch of each scale
+
+			double getArea(const int& scale) const
+			{
+				double area = 0.0;
+				for (int layer = 0; layer < m_vScaleLayerEnds[scale]; layer++)
+				{
+					area += m_vLayerAreas[layer];
+				}
+				return area;
+			}
+		};
+
+		/**
+		* @brief	Finds the triangles of the patches of a vertex and builds the alias tables of their layers
+		*
+		* @param	triMesh TriangularMesh
+		* @param	patches patches extracted around a vertex
+		* @param	meshCoords Coordinates of all vertices of the mesh, x, y and z of each vertex one after the other
+		* @param	[out] patchTriangles Triangles of the patches
+		* @return	void
+		*/
+		void createPatchTriangles(TriangularMesh* triMesh, const VertexPatches& patches, const std::vector<double>& meshCoords, PatchTriangles& patchTriangles) const;
 
 		/**
 		* @brief	Creates samples from the patch for the distribution function encapsulated in the object
 		*			There are two different sampling method from them one is encapculated in the object
+		*			Samples are created in batches by kernels specialized for each distribution function
+		*			Unbiased surface sampling falls back to the vertices if the patch has no triangle
+		*			Vertex sampling enumerates all vertex combinations instead if their number is not more than the exact sample threshold
 		*
-		* @param	triMesh TriangularMesh
-		* @param	patch patch extracted around a vertex
+		* @param	patches patches extracted around a vertex
+		* @param	patchTriangles Triangles of the patches, only used by the unbiased surface sampling
+		* @param	scale Scale of the patch from which the samples are extracted
+		* @param	meshCoords Coordinates of all vertices of the mesh, x, y and z of each vertex one after the other
 		* @param	sampleCount Number of samples to be extracted
+		* @param	rng Random number stream of the patch
 		* @param	[out] samples Samples extracted
 		* @return	void
 		*/
-		void createSamplesFromPatch(TriangularMesh* triMesh, const SinglePatch& patch, const int& sampleCount, std::vector<double>& samples) const;
+		void createSamplesFromPatch(const VertexPatches& patches, const PatchTriangles& patchTriangles, const int& scale, const std::vector<double>& meshCoords, const int& sampleCount, TACore::PhiloxRandom& rng, std::vector<double>& samples) const;
 
-		double createSample(TriangularMesh* triMesh, const SinglePatch& patch) const;
-		double createBiasedVertexSample(TriangularMesh* triMesh, const SinglePatch& patch) const;
-		double createUnbiasedSurfaceSample(TriangularMesh* triMesh, const SinglePatch& patch) const;
+		void createBiasedVertexSamples(const VertexPatches& patches, const int& scale, const std::vector<double>& meshCoords, const int& sampleCount, TACore::PhiloxRandom& rng, double* samples) const;
+		void createUnbiasedSurfaceSamples(const VertexPatches& patches, const PatchTriangles& patchTriangles, const int& scale, const std::vector<double>& meshCoords, const int& sampleCount, TACore::PhiloxRandom& rng, double* samples) const;
 		int getNumberOfRandomPointsForASample() const; 
 
+		/**
+		* @brief	Gets the number of samples of the exact histogram of a patch, i.e. the number of combinations of different vertices
+		*			Angle has a sample for each vertex of a combination as the apex
+		*
+		* @param	patchSize Number of vertices in the patch
+		* @return	Number of samples, 0 if the patch has less vertices than the points of a sample, LLONG_MAX if it is too big to count
+		*/
+		long long getNumberOfExactSamples(const int& patchSize) const;
+
+		/**
+		* @brief	Creates the samples of all combinations of different vertices of the patch instead of random ones
+		*			Used by the biased vertex sampling when the number of combinations is not more than the exact sample threshold
+		*
+		* @param	patches patches extracted around a vertex
+		* @param	scale Scale of the patch from which the samples are extracted
+		* @param	meshCoords Coordinates of all vertices of the mesh, x, y and z of each vertex one after the other
+		* @param	[out] samples Samples extracted, must have the space for getNumberOfExactSamples samples
+		* @return	void
+		*/
+		void createExactVertexSamples(const VertexPatches& patches, const int& scale, const std::vector<double>& meshCoords, double* samples) const;
+
 		/**
 		* @brief	Calculates the angle between two vector constructed from 3 points in radians between [0, pi]
 		*			Angle between pt1 ----> pt2 and pt1 ----> pt3
@@ -158,6 +283,34 @@ namespace TAFeaExt
 		*/
 		void writeHistogram(const std::vector<double>& histogram, const std::string& filePath);
 
+		/**
+		* @brief	Calculates the histograms of all patches of a vertex for several numbers of bins
+		*			Samples of a patch are created once and counted into the histograms of each number of bins
+		*
+		* @param	triMesh TriangularMesh
+		* @param	id Id of the vertex whose feature is being extracted
+		* @param	patches patches of the vertex
+		* @param	meshCoords Coordinates of all vertices of the mesh, x, y and z of each vertex one after the other
+		* @param	numbersOfBins Numbers of bins of the histograms
+		* @param	[out] outFeaturePtrs Output feature pointers, one for each number of bins
+		* @return	void
+		*/
+		void calcPatchHistograms(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, const std::vector<double>& meshCoords, const std::vector<int>& numbersOfBins, std::vector<LocalFeaturePtr>& outFeaturePtrs) const;
+
+		/**
+		* @brief	Calculates the normalized histograms of all patches of a vertex for several numbers of bins into contiguous blocks
+		*			Histogram of the patch p for the b-th number of bins starts at outHistograms[b] + p * numbersOfBins[b]
+		*
+		* @param	triMesh TriangularMesh
+		* @param	id Id of the vertex whose feature is being extracted
+		* @param	patches patches of the vertex
+		* @param	meshCoords Coordinates of all vertices of the mesh, x, y and z of each vertex one after the other
+		* @param	numbersOfBins Numbers of bins of the histograms
+		* @param	[out] outHistograms Zero initialized blocks of the histograms, one for each number of bins
+		* @return	void
+		*/
+		void fillPatchHistograms(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, const std::vector<double>& meshCoords, const std::vector<int>& numbersOfBins, double* const* outHistograms) const;
+
 	private:
 		ShapeDistributionFunction	m_DistributionFunction;				//< Shape distribution function from which the samples of the histogram will be extracted, see the comments in the enumaration
 		SamplingMethod				m_SamplingMethod;					//< Sampling method, see the comments in the enumaration
@@ -165,6 +318,8 @@ namespace TAFeaExt
 		double						m_lfMinPossibleSample;				//< Possible minimum value of the sample among the mesh
 		int							m_nNumberOfBins;					//< Number of bins in a patch histogram
 		int							m_nSampleCount;						//< Number of samples for a patch histogram
+		unsigned int				m_nRandomSeed;						//< Seed of the random streams, each (vertex, patch) pair has its own stream so same seed gives the same descriptors
+		int							m_nExactSampleThreshold;			//< Patches of the vertex sampling with at most this many vertex combinations are enumerated exactly, 0 disables it
 	};
 }
 
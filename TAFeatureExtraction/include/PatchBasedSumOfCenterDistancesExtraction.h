@@ -10,6 +10,8 @@ namespace TAFeaExt
 	//This extraction tool extracts PatchBasedSumOfCenterDistances descriptor for a vertex or all vertices
 	//See PatchBasedSumOfCenterDistances.h to get the information about the descriptor
 	//No extract methods. The objects of this class use the extract function of PatchBasedPerVertexFeatureExtraction
+	//Patches are nested and sorted by distance, so the centers of all scales come from running sums over the biggest patch
+	//Only the RMS spread is found in that single pass, the default mean spread still visits the vertices of each scale, see SpreadMeasure
 	class PatchBasedSumOfCenterDistancesExtraction : public PatchBasedPerVertexFeatureExtraction
 	{
 	public:
@@ -18,6 +20,25 @@ namespace TAFeaExt
 		PatchBasedSumOfCenterDistancesExtraction();
 		PatchBasedSumOfCenterDistancesExtraction(const PatchBasedSumOfCenterDistancesExtraction& other);
 
+		//Measure of the spread of the patch vertices around the center of the patch
+		//Measures give different descriptors, features of one cannot be compared with the features of the other
+		enum SpreadMeasure
+		{
+			MEAN_DISTANCE_TO_CENTER = 1,		//< Mean of the euc distances to the center, the original descriptor. Each scale visits its own vertices since the center moves, i.e. the sum of the patch sizes
+			RMS_DISTANCE_TO_CENTER				//< Root mean square of the euc distances to the center, all scales are found from running sums in a single pass over the biggest patch, never smaller than the mean
+		};
+
+		/**
+		* @brief	Sets the measure of the spread, MEAN_DISTANCE_TO_CENTER by default
+		*			RMS_DISTANCE_TO_CENTER is faster with many patches, but its descriptors differ from the mean ones, see SpreadMeasure
+		* @param	spreadMeasure Measure of the spread
+		* @return	void
+		*/
+		void setSpreadMeasure(const SpreadMeasure& spreadMeasure);
+
+		//Getters
+		SpreadMeasure getSpreadMeasure() const;
+
 		/**
 		* @brief	Gets the type of the global descriptor extracted from each patch
 		* @return	SUM_EUC_DISTANCES_TO_CENTER
@@ -30,24 +51,48 @@ namespace TAFeaExt
 		* @brief	Calculates patch based sum of center distances from extracted patches for ALL VERTICES
 		*
 		* @param	triMesh TriangularMesh
-		* @param	listOfPatchLists patches of all vertices
+		* @param	listOfPatches patches of all vertices
 		* @param	[out] outFeatures Output vector of features
 		* @return	TACORE_OK if everything goes fine
 		* @return	TACORE_BAD_ARGS if triMesh is NULL
-		* @return	TACORE_BAD_ARGS if listOfPatchLists is empty
+		* @return	TACORE_BAD_ARGS if listOfPatches is empty
 		*/
-		virtual Result calcFeature(TriangularMesh* triMesh, const std::vector<PatchList>& listOfPatchLists, std::vector<LocalFeaturePtr>& outFeatures);
+		virtual Result calcFeature(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, std::vector<LocalFeaturePtr>& outFeatures);
 
 		/**
 		* @brief	Calculates patch based sum of center distances from extracted patches for a vertex
 		*
 		* @param	triMesh TriangularMesh
 		* @param	id Id of the vertex whose feature is being extracted
-		* @param	patchesVertexIds patches of a vertex
+		* @param	patches patches of a vertex
 		* @param	[out] outFeaturePtr Output feature pointer
 		* @return	TACORE_OK if everything goes fine
 		*/
-		virtual Result calcFeature(TriangularMesh* triMesh, const int& id, const PatchList& patchesVertexIds, LocalFeaturePtr& outFeaturePtr);
+		virtual Result calcFeature(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, LocalFeaturePtr& outFeaturePtr);
+
+		/**
+		* @brief	Calculates patch based sum of center distances of ALL VERTICES directly into a feature matrix
+		*
+		* @param	triMesh TriangularMesh
+		* @param	listOfPatches patches of all vertices
+		* @param	[out] outMatrix Features of all vertices, a block of size 1 for each patch
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if triMesh is NULL, listOfPatches is empty or the vertices have different numbers of patches
+		*/
+		virtual Result calcFeatureMatrix(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, FeatureMatrix<double>& outMatrix);
+
+		/**
+		* @brief	Calculates the spread around the center of each patch of a vertex without normalization
+		*
+		* @param	triMesh TriangularMesh
+		* @param	patches patches of a vertex
+		* @param	[out] outDescriptor Spread of each patch, must have space for the number of patches
+		* @return	void
+		*/
+		void calcCenterDistances(TriangularMesh* triMesh, const VertexPatches& patches, double* outDescriptor) const;
+
+	private:
+		SpreadMeasure m_SpreadMeasure;		//< Measure of the spread around the center of the patch, see the comments in the enumaration
 	};
 }
 
@@ -0,0 +1,284 @@
+#ifndef SPECTRAL_DESC_EXTRACTION_H
+#define SPECTRAL_DESC_EXTRACTION_H
+
+#include "TAFeatureExtraction.h"
+#include <armadillo>
+#include <memory>
+
+namespace TAShape
+{
+	class TriangularMesh;
+}
+
+namespace TAFeaExt
+{
+	//Eigen decomposition of the laplacian of a mesh
+	//Eigen values and vectors are kept as their real parts, in the order they are returned by the eigen solver
+	//It is shared between the spectral extractors running on the same mesh so that the laplacian is decomposed only once
+	struct SpectralEigenBasis
+	{
+		const PolygonMesh* m_pMesh;				//< Mesh from which the basis is calculated
+		unsigned long long m_nMeshHash;			//< Content hash of the mesh, so a mesh edited in place or a new mesh at the address of a freed one is not matched
+		int m_nLaplacianType;					//< SpectralDescExtraction::TypeOfLaplacian of the decomposed laplacian
+		arma::vec m_vEigenValues;				//< Eigen values of the laplacian
+		arma::mat m_mEigenVectors;				//< Eigen vectors of the laplacian, one column for each eigen value
+		double m_fSumRingAreas;					//< Sum of the ring areas of the vertices, i.e. the scale used by the normalized laplacian
+	};
+	typedef std::shared_ptr<SpectralEigenBasis> SpectralEigenBasisPtr;
+
+	//Laplacian of a mesh together with the ring areas it is created from
+	//It is shared between the spectral extractors running on the same mesh so that the ring areas and the laplacian are calculated only once,
+	//e.g. by the extractor calculating the eigen basis and an HKS extractor with the Chebyshev backend
+	struct SpectralLaplacian
+	{
+		const PolygonMesh* m_pMesh;						//< Mesh from which the laplacian is created
+		unsigned long long m_nMeshHash;					//< Content hash of the mesh, see SpectralEigenBasis
+		int m_nLaplacianType;							//< SpectralDescExtraction::TypeOfLaplacian of the laplacian
+		std::vector<double> m_vRingAreas;				//< Area sums around the vertices of the mesh
+		std::shared_ptr<arma::SpMat<double> > m_pMatrix;	//< Laplacian matrix
+	};
+	typedef std::shared_ptr<SpectralLaplacian> SpectralLaplacianPtr;
+
+	//Base of the per vertex descriptors calculated from the eigen decomposition of the laplacian of a mesh
+	//The laplacian is constructed and decomposed once, the basis can be handed to the other spectral extractors by setEigenBasis
+	//A descriptor is a set of spectral filters F (eigen count x dimension), all of the vertices are evaluated by the single product (Phi^2)F
+	//If a coarse version of the mesh is set, the eigen problem is solved on it and the result is refined on the mesh instead of a cold decomposition
+	//In adaptive eigen count mode, eigen pairs are calculated in growing blocks until the derived descriptor reports that the rest are insignificant,
+	//then the number of eigen values is only the upper limit. Each block extends the previous eigen vectors and refines them instead of a cold decomposition
+	//SpectralDescExtraction is a PerVertexFeatureExtraction
+	class SpectralDescExtraction : public PerVertexFeatureExtraction
+	{
+	public:
+
+		enum TypeOfLaplacian
+		{
+			STAR_LAPLACIAN = 1,			//< http://www.cs.princeton.edu/courses/archive/fall10/cos526/papers/sorkine05.pdf
+			DISCRETE_LAPLACIAN = 2		//< http://web.cse.ohio-state.edu/~yusu/papers/finalscg_laplace.pdf, practical impl --> https://etd.ohiolink.edu/rws_etd/document/get/osu1236615194/inline
+		};
+
+		virtual ~SpectralDescExtraction();
+		SpectralDescExtraction();
+		SpectralDescExtraction(const SpectralDescExtraction& other);
+
+		/**
+		* @brief	Create the laplacian matrix from the polygon mesh according to TypeOfLaplacian and saves it into the object
+		* @param	mesh Polygonial mesh from which the laplacian matrix will be created
+		* @param	typeLap Type of the laplacian matrix to be extracted
+		* @param	vertexRingAreas Area sums around a vertex
+		* @return	TACORE_OK if everything goes fine.
+		*/
+		Result createLaplacianMatrix(PolygonMesh *mesh, const TypeOfLaplacian& typeLap, const std::vector<double>& vertexRingAreas);
+
+		/**
+		* @brief	Calculates the eigen values and vectors of the laplacian saved in the object.
+		* @param	noEigenVals Number of eigen values and vectors to be calculated
+		* @param [out] pEigVals Eigenvalues calculated
+		* @param [out] pEigVecs Eigenvectors calculated
+		* @return	TACORE_OK if everything goes fine
+		* @return	TACORE_BAD_ARGS if noEigenVals is smaller than 2
+		* @return	TACORE_INVALID_OPERATION if laplacian matrix is not constructed
+		* @return	TACORE_ERROR if decomposition fails to converge
+		*/
+		Result calcEigenDecomposition(const unsigned int& noEigenVals, arma::cx_vec *pEigVals, arma::cx_mat *pEigVecs);
+
+		/**
+		* @brief	Makes sure that the object holds the laplacian of the mesh and the ring areas behind it
+		*			The laplacian set before is reused if it belongs to the same mesh with the same content and laplacian type, otherwise the ring areas are calculated and the laplacian is created
+		* @param	mesh Polygonial mesh whose laplacian is needed
+		* @return	TACORE_OK if everything goes fine.
+		* @return	TACORE_BAD_ARGS if mesh is not a triangular mesh
+		* @return	Error of the laplacian construction otherwise
+		*/
+		Result prepareLaplacian(PolygonMesh *mesh);
+
+		/**
+		* @brief	Makes sure that the object holds the eigen basis of the mesh
+		*			The basis set before is reused if it belongs to the same mesh with the same content and laplacian type and has enough eigen values,
+		*			otherwise the laplacian is created and decomposed
+		* @param	mesh Polygonial mesh whose eigen basis is needed
+		* @return	TACORE_OK if everything goes fine.
+		* @return	TACORE_BAD_ARGS if mesh is not a triangular mesh
+		* @return	Error of the laplacian construction or decomposition otherwise
+		*/
+		Result prepareEigenBasis(PolygonMesh *mesh);
+
+		/**
+		* @brief	Calculates the eigen basis of the laplacian of the mesh starting from the eigen basis of the coarse mesh
+		*			Laplacian of the coarse mesh is decomposed first, then the laplacian of the mesh is prepared by prepareLaplacian
+		*			Coarse eigen vectors are prolonged to the mesh by nearest coarse vertices and refined by Chebyshev filtered subspace iterations,
+		*			each followed by Rayleigh-Ritz on the subspace. Iterations work on the laplacian negated if it is negative semidefinite
+		*			Residuals of the iterations and the eigen value error bound given by the final residuals are reported
+		*			If validation is enabled, a cold decomposition is also run to report the speedup and the actual eigen value errors
+		* @param	mesh Polygonial mesh whose eigen basis is calculated
+		* @param [out] outEigVals Eigen values in ascending order of their magnitudes
+		* @param [out] outEigVecs Eigen vectors, one column for each eigen value
+		* @return	TACORE_OK if everything goes fine.
+		* @return	TACORE_INVALID_OPERATION if there is no coarse mesh or the coarse mesh has too few vertices
+		* @return	Error of the laplacian construction or coarse decomposition otherwise
+		*/
+		Result calcEigenDecompositionFromCoarseMesh(PolygonMesh *mesh, arma::vec& outEigVals, arma::mat& outEigVecs);
+
+		/**
+		* @brief	Query if the descriptor has an eigen value beyond which the eigen pairs do not change it, i.e. if the adaptive eigen count mode can stop early
+		*			Default implementation has none, the number of eigen values is calculated at once in the adaptive eigen count mode
+		* @return	true if countSignificantEigenVals gives the eigen pairs changing the descriptor, false otherwise
+		*/
+		virtual bool supportsAdaptiveEigenCount() const;
+
+		/**
+		* @brief	Counts the eigen values that change the descriptor, used to stop the adaptive eigen count mode
+		*			Default implementation counts all of them
+		* @param	eigVals Eigen values of the laplacian
+		* @param	sumRingAreas Sum of the ring areas of the vertices, i.e. the scale of the eigen values
+		* @return	Number of significant eigen values, if it is smaller than the size of eigVals no more eigen values are needed
+		*/
+		virtual unsigned int countSignificantEigenVals(const arma::vec& eigVals, const double& sumRingAreas) const;
+
+		/**
+		* @brief	Number of eigen pairs of the eigen basis used by the descriptors
+		* @return	Minimum of the number of eigen values and the size of the eigen basis, 0 if there is no basis
+		*/
+		unsigned int getNumberOfEigenValsUsed() const;
+
+		/**
+		* @brief	Evaluates the spectral filters at every vertex by a single matrix product
+		*			outDescriptors(:, v) = sumRingAreas * sum_k filters(k, :) * phi_k(v)^2
+		* @param	filters Filter values, one row for each eigen value and one column for each descriptor dimension
+		* @param [out] outDescriptors Descriptors, one column for each vertex so that the descriptor of a vertex is contiguous
+		* @return	TACORE_OK if everything goes fine.
+		* @return	TACORE_INVALID_OPERATION if there is no eigen basis
+		* @return	TACORE_BAD_ARGS if filters has no rows or more rows than the eigen value count of the basis
+		*/
+		Result evaluateSpectralFilters(const arma::mat& filters, arma::mat& outDescriptors) const;
+
+		/**
+		* @brief	Clears the object by setting default parameters and deleting heap space
+		* @return	void
+		*/
+		virtual void clear();
+
+		//Setters
+		void setTypeOfLaplacian(const TypeOfLaplacian& typeLap);
+		void setNumberOfEigenVals(const unsigned int& noEigenVals);
+		void setEigenBasis(const SpectralEigenBasisPtr& eigenBasis);
+		void setLaplacian(const SpectralLaplacianPtr& laplacian);
+		void setCoarseMesh(PolygonMesh *coarseMesh);
+		void setNumberOfRefinementIterations(const unsigned int& noRefinementIterations);
+		void setRefinementFilterDegree(const unsigned int& filterDegree);
+		void setValidateCoarseToFine(const bool& validate);
+		void setAdaptiveEigenCount(const bool& adaptive);
+		void setEigenValBlockSize(const unsigned int& blockSize);
+		void setAdaptiveEigenTolerance(const double& tolerance);
+
+		//Getters
+		TypeOfLaplacian getTypeOfLaplacian() const;
+		unsigned int getNumberOfEigenVals() const;
+		SpectralEigenBasisPtr getEigenBasis() const;
+		SpectralLaplacianPtr getLaplacian() const;
+		PolygonMesh* getCoarseMesh() const;
+		unsigned int getNumberOfRefinementIterations() const;
+		unsigned int getRefinementFilterDegree() const;
+		bool getValidateCoarseToFine() const;
+		bool getAdaptiveEigenCount() const;
+		unsigned int getEigenValBlockSize() const;
+		double getAdaptiveEigenTolerance() const;
+
+	protected:
+
+		TypeOfLaplacian m_LaplacianUsed;		//< Type of the laplacian used in the extraction
+		unsigned int m_nNoEigenVal;				//< Number of eigen vals and vects extracted from the laplacian matrix
+
+		std::shared_ptr<arma::SpMat<double> > m_mLaplacian;	//< Laplacian matrix the solvers work on, it is a class member because multiple executions for different time intervals should be enabled without re-construction.
+		SpectralLaplacianPtr m_pLaplacian;		//< Laplacian of the mesh with its ring areas, NULL until it is prepared or set
+		SpectralEigenBasisPtr m_pEigenBasis;	//< Eigen decomposition of the laplacian, NULL until it is calculated or set
+
+		PolygonMesh *m_pCoarseMesh;				//< Low resolution version of the mesh whose eigen basis seeds the decomposition, not owned, NULL for cold decomposition
+		unsigned int m_nNoRefinementIterations;	//< Number of subspace iterations refining the prolonged coarse eigen vectors
+		unsigned int m_nRefinementFilterDegree;	//< Degree of the Chebyshev filter applied in each subspace iteration
+		bool m_bValidateCoarseToFine;			//< If true, a cold decomposition is also run to report the speedup and the eigen value errors
+
+		bool m_bAdaptiveEigenCount;				//< If true, eigen pairs are calculated in blocks until the rest are insignificant, not used with a coarse mesh or a descriptor not supporting it
+		unsigned int m_nEigenValBlockSize;		//< Number of eigen pairs added in each step of the adaptive eigen count mode
+		double m_fAdaptiveEigenTolerance;		//< Contribution below which an eigen pair is insignificant in the adaptive eigen count mode
+
+		/**
+		* @brief	Sign which makes the spectrum of the laplacian of the object nonnegative
+		*			STAR laplacian is positive semidefinite, the discrete laplacian is negative semidefinite
+		* @return	1 for the STAR laplacian, -1 for the discrete laplacian
+		*/
+		double getSpectrumSign() const;
+
+		/**
+		* @brief	Refines approximate eigen vectors of the laplacian saved in the object by Chebyshev filtered subspace iterations, each followed by Rayleigh-Ritz
+		*			Iterations work on sign * laplacian whose spectrum is in [0, spectrumBound], residuals of the iterations are reported
+		* @param	laplacianRows Transpose of the laplacian, i.e. the laplacian in compressed row form
+		* @param	spectrumBound Upper bound of the spectrum of the laplacian
+		* @param	noWanted Number of eigen pairs whose residuals are checked, the rest of the subspace speeds up their convergence
+		* @param [in,out] subspace Approximate eigen vectors as input, Ritz vectors in the order of the Ritz values as output
+		* @param [out] outRitzVals Ritz values of sign * laplacian in ascending order, i.e. magnitudes of the eigen values
+		* @param [out] outErrorBound Maximum error of the wanted nonzero Ritz values relative to themselves, bounded by the residuals
+		* @return	TACORE_OK if everything goes fine.
+		* @return	TACORE_INVALID_OPERATION if laplacian matrix is not constructed
+		* @return	TACORE_BAD_ARGS if noWanted is 0 or larger than the subspace
+		* @return	TACORE_ERROR if the orthonormalization or the projected eigen problem fails
+		*/
+		Result refineEigenSubspace(const arma::SpMat<double>& laplacianRows, const double& spectrumBound, const unsigned int& noWanted,
+			arma::mat& subspace, arma::vec& outRitzVals, double& outErrorBound) const;
+
+		/**
+		* @brief	Upper bound of the spectrum of the laplacian saved in the object from the Gershgorin discs of its rows
+		* @param	laplacianRows Transpose of the laplacian, i.e. the laplacian in compressed row form
+		* @return	Maximum absolute row sum of the laplacian
+		*/
+		static double calcSpectrumUpperBound(const arma::SpMat<double>& laplacianRows);
+
+		/**
+		* @brief	One step of the Chebyshev recurrence on the shifted and scaled laplacian Y = alpha * L + beta * I
+		*			Blocks are kept transposed (block size x vertex count) so that the values of a vertex are contiguous during the product
+		*			Rows of the laplacian are independent, they are processed in parallel
+		* @param	laplacianRows Transpose of the laplacian, i.e. the laplacian in compressed row form
+		* @param	alpha Scale of the laplacian
+		* @param	beta Shift of the laplacian
+		* @param	curr T_k(Y) applied to the block
+		* @param [in,out] prevToNext T_(k-1)(Y) applied to the block as input, overwritten by T_(k+1)(Y) applied to the block
+		* @param	isFirstStep If true, prevToNext is only written: T_1(Y) = Y * T_0(Y)
+		* @return	void
+		*/
+		static void chebyshevStep(const arma::SpMat<double>& laplacianRows, const double& alpha, const double& beta,
+			const arma::mat& curr, arma::mat& prevToNext, const bool& isFirstStep);
+
+	private:
+
+		/**
+		* @brief	Create the STAR laplacian matrix from the polygon mesh saves it into the object
+		*			Each triangle is visited once for the cotangents and the matrix is filled in compressed form in parallel
+		*			[Currently] Only Triangular mesh is supported
+		* @param	mesh Polygonial mesh from which the laplacian matrix will be created
+		* @param	vertexRingAreas Area sums around a vertex
+		* @return	TACORE_OK if everything goes fine.
+		*/
+		Result createStarLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas);
+
+		/**
+		* @brief	Create the Discrete laplacian matrix from the polygon mesh saves it into the object
+		*			[Currently] Only Triangular mesh is supported
+		*			Each row only visits the vertices inside the effective support radius of its Gaussian, found by a VertexGrid, rows are built in parallel
+		* @param	mesh Polygonial mesh from which the laplacian matrix will be created
+		* @param	vertexRingAreas Area sums around a vertex
+		* @return	TACORE_OK if everything goes fine.
+		*/
+		Result createDiscreteLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas);
+
+		/**
+		* @brief	Computes the cotangent of the angle at apex inside the triangle (apex, p, q) for STAR Laplacian Matrix
+		*			Calculated from dot and cross products, no trigonometric function is used
+		* @param	apex Coordinates of the vertex whose angle is calculated
+		* @param	p Coordinates of the second vertex of the triangle
+		* @param	q Coordinates of the third vertex of the triangle
+		* @return	Cotangent of the angle, 0 for degenerate triangles
+		*/
+		static double cotangentOfAngle(const float* apex, const float* p, const float* q);
+	};
+}
+
+#endif
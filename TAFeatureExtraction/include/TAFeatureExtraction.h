@@ -5,6 +5,7 @@
 #include <core/Defs.h>
 #include <core/PolygonMesh.h>
 #include <TAFeature.h>
+#include <FeatureMatrix.h>
 
 using namespace TACore;
 using namespace TAShape;
@@ -83,6 +84,23 @@ namespace TAFeaExt
 		PerVertexFeatureExtraction(const PerVertexFeatureExtraction& other) {}
 
 		virtual LocalFeaExtSourceType getLocalFeatureExtractionSourceType() const { return LOCAL_FEA_EXT_SOURCE_VERTEX; }
+
+		/**
+		* @brief	Extracts the features of all vertices into a single contiguous matrix, row i is the feature of vertex i
+		*			Default implementation converts the output of extract, extractors override it to fill the matrix without feature objects
+		*
+		* @param	mesh Mesh whose vertex features are extracted
+		* @param	[out] outMatrix Features of all vertices
+		* @return	TACORE_OK if everything goes fine
+		* @return	Result of extract if it fails
+		* @return	TACORE_BAD_ARGS if the features cannot be put into a matrix
+		*/
+		virtual Result extractToMatrix(PolygonMesh *mesh, FeatureMatrix<double>& outMatrix);
+
+		/**
+		* @brief	Extracts the features of all vertices into a single precision matrix, see the double precision one
+		*/
+		Result extractToMatrix(PolygonMesh *mesh, FeatureMatrix<float>& outMatrix);
 	protected:
 	private:
 	};
@@ -0,0 +1,46 @@
+#ifndef WAVE_KERNEL_SIGNATURE_DESC_EXTRACTION_H
+#define WAVE_KERNEL_SIGNATURE_DESC_EXTRACTION_H
+
+#include "SpectralDescExtraction.h"
+
+namespace TAFeaExt
+{
+	//Wave Kernel Signature for a single vertex in a mesh
+	//Technical Details of the feature is described in http://imagine.enpc.fr/~aubrym/projects/wks/texts/2011-wave-kernel-signature.pdf
+	//Energies are sampled evenly between the logarithms of the smallest non zero and the largest eigen values,
+	//each energy is a log-normal band pass filter on the eigen values normalized by its sum over the eigen values
+	//Eigen values are scaled by the sum of the ring areas like in HKSDescExtraction, so both can share the same eigen basis
+	//WKSDescExtraction is a SpectralDescExtraction
+	class WKSDescExtraction : public SpectralDescExtraction
+	{
+	public:
+
+		virtual ~WKSDescExtraction();
+		WKSDescExtraction();
+		WKSDescExtraction(const WKSDescExtraction& other);
+
+		virtual Result extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures);
+		virtual Result extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr);
+
+		/**
+		* @brief	Clears the object by setting default parameters and deleting heap space
+		* @return	void
+		*/
+		virtual void clear();
+
+		//Setters
+		void setNumberOfEnergySamples(const unsigned int& noEnergySamples);
+		void setVarianceFactor(const double& varianceFactor);
+
+		//Getters
+		unsigned int getNumberOfEnergySamples() const;
+		double getVarianceFactor() const;
+
+	private:
+
+		unsigned int m_nNumberOfEnergySamples;	//< Number of energy values in the interval, i.e. dimension of the descriptor
+		double m_fVarianceFactor;				//< Standard deviation of the band pass filters as a multiple of the energy increment
+	};
+}
+
+#endif
@@ -0,0 +1,595 @@
+#include "ExtractionPipeline.h"
+#include "GeodesicDistanceMatrix.h"
+#include "GeodesicDistanceMatrixExtraction.h"
+#include "OnEdgeAvgGeoDistExtraction.h"
+#include "HKSDescExtraction.h"
+#include "PatchBasedPerVertexFeatureExtraction.h"
+#include "PatchBasedShapeDistributionDescExtraction.h"
+#include <core/TriangularMesh.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	//Shape distribution functions whose maximum possible sample value comes from the auxilary info of the mesh
+	bool needsMaxPossibleSample(const TAFeaExt::PatchBasedShapeDistributionDescExtraction* extractor)
+	{
+		typedef TAFeaExt::PatchBasedShapeDistributionDescExtraction PBSDExtraction;
+		const PBSDExtraction::ShapeDistributionFunction function = extractor->getShapeDistributionFunction();
+		return extractor->getMaxPossibleSampleValue() < 0.0
+			&& (function == PBSDExtraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT
+			|| function == PBSDExtraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS
+			|| function == PBSDExtraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS
+			|| function == PBSDExtraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS);
+	}
+
+	//Spectral extractors which use the eigen basis, HKS with the Chebyshev backend works on the laplacian only
+	bool usesEigenBasis(TAFeaExt::PerVertexFeatureExtraction* extractor)
+	{
+		if (dynamic_cast<TAFeaExt::SpectralDescExtraction*>(extractor) == NULL)
+		{
+			return false;
+		}
+		TAFeaExt::HKSDescExtraction* hks = dynamic_cast<TAFeaExt::HKSDescExtraction*>(extractor);
+		return !(hks != NULL && hks->getHeatKernelBackend() == TAFeaExt::HKSDescExtraction::HKS_BACKEND_CHEBYSHEV);
+	}
+
+	//Patch based extractors which calculate their patches from the geodesic distances
+	bool calculatesPatches(TAFeaExt::PerVertexFeatureExtraction* extractor)
+	{
+		TAFeaExt::PatchBasedPerVertexFeatureExtraction* patchBased = dynamic_cast<TAFeaExt::PatchBasedPerVertexFeatureExtraction*>(extractor);
+		return patchBased != NULL && !patchBased->isPatchFileOpen();
+	}
+
+	//Hands a geodesic distance matrix to the extractors which can use it
+	void setGeodesicDistanceMatrixOfExtractor(TAFeaExt::PerVertexFeatureExtraction* extractor, TAFea::GeodesicDistanceMatrix* gdMatrix)
+	{
+		if (TAFeaExt::PatchBasedPerVertexFeatureExtraction* patchBased = dynamic_cast<TAFeaExt::PatchBasedPerVertexFeatureExtraction*>(extractor))
+		{
+			patchBased->setGeodesicDistanceMatrix(gdMatrix);
+		}
+		else if (TAFeaExt::OnEdgeAvgGeoDistExtraction* avgGeoDist = dynamic_cast<TAFeaExt::OnEdgeAvgGeoDistExtraction*>(extractor))
+		{
+			avgGeoDist->setGeodesicDistanceMatrix(gdMatrix);
+		}
+	}
+}
+
+namespace TAFeaExt
+{
+	ExtractionPipeline::ExtractionPipeline()
+	{
+		this->m_pGeodesicDistanceMatrix = NULL;
+		this->m_bHasAuxInfo = false;
+		this->m_nNumberOfWorkers = MAX(std::thread::hardware_concurrency(), 1u);
+		this->m_pMesh = NULL;
+		this->m_nNextNodeId = 0;
+	}
+
+	ExtractionPipeline::~ExtractionPipeline()
+	{
+
+	}
+
+	int ExtractionPipeline::addDescriptor(PerVertexFeatureExtraction* extractor)
+	{
+		this->m_vExtractors.push_back(extractor);
+		this->m_vFeatures.push_back(std::vector<LocalFeaturePtr>());
+		this->m_vResults.push_back(TACORE_OK);
+		return (int)this->m_vExtractors.size() - 1;
+	}
+
+	Result ExtractionPipeline::run(TriangularMesh* triMesh)
+	{
+		TACORE_CHECK_ARGS(triMesh != NULL);
+		for (size_t d = 0; d < this->m_vExtractors.size(); d++)
+		{
+			TACORE_CHECK_ARGS(this->m_vExtractors[d] != NULL);
+		}
+
+		this->m_pMesh = triMesh;
+		this->m_vFeatures.assign(this->m_vExtractors.size(), std::vector<LocalFeaturePtr>());
+		this->m_vResults.assign(this->m_vExtractors.size(), TACORE_OK);
+		createNodes(triMesh);
+
+		//Futures of all nodes exist before the workers start, so a node can wait for any of its dependencies
+		const int noNodes = (int)this->m_vNodes.size();
+		this->m_vNodePromises = std::vector<std::promise<Result> >(noNodes);
+		this->m_vNodeFutures = std::vector<std::shared_future<Result> >(noNodes);
+		for (int n = 0; n < noNodes; n++)
+		{
+			this->m_vNodeFutures[n] = this->m_vNodePromises[n].get_future().share();
+		}
+		this->m_nNextNodeId = 0;
+
+		const int noWorkers = MIN((int)MAX(this->m_nNumberOfWorkers, 1u), noNodes);
+		std::vector<std::thread> workers;
+		for (int w = 0; w < noWorkers; w++)
+		{
+			workers.push_back(std::thread(&ExtractionPipeline::runWorker, this));
+		}
+
+		Result result = TACORE_OK;
+		for (int n = 0; n < noNodes; n++)
+		{
+			const Result nodeResult = this->m_vNodeFutures[n].get();
+			if (result == TACORE_OK)
+			{
+				result = nodeResult;
+			}
+		}
+		for (size_t w = 0; w < workers.size(); w++)
+		{
+			workers[w].join();
+		}
+
+		this->m_vNodeFutures.clear();
+		this->m_vNodePromises.clear();
+		this->m_vNodes.clear();
+		this->m_pCalculatedGeodesicMatrix.reset();
+		this->m_pMesh = NULL;
+
+		return result;
+	}
+
+	void ExtractionPipeline::clear()
+	{
+		this->m_vExtractors.clear();
+		this->m_vFeatures.clear();
+		this->m_vResults.clear();
+	}
+
+	const std::vector<LocalFeaturePtr>& ExtractionPipeline::getFeatures(const int& descriptorId) const
+	{
+		return this->m_vFeatures[descriptorId];
+	}
+
+	Result ExtractionPipeline::getResult(const int& descriptorId) const
+	{
+		return this->m_vResults[descriptorId];
+	}
+
+	void ExtractionPipeline::createNodes(TriangularMesh* triMesh)
+	{
+		this->m_vNodes.clear();
+		const int noDescriptors = (int)this->m_vExtractors.size();
+
+		//Spectral extractors with the same laplacian share the basis, the one with the most eigen values calculates it
+		//Patch based extractors with the same patch parameters share the patches, the first one calculates them
+		std::vector<std::vector<int> > spectralGroups;
+		std::vector<std::vector<int> > patchGroups;
+		std::vector<int> avgGeoDistIds;
+		std::vector<int> maxPossibleSampleIds;
+		for (int d = 0; d < noDescriptors; d++)
+		{
+			PerVertexFeatureExtraction* extractor = this->m_vExtractors[d];
+			if (usesEigenBasis(extractor))
+			{
+				SpectralDescExtraction* spectral = (SpectralDescExtraction*)extractor;
+				size_t g = 0;
+				for (; g < spectralGroups.size(); g++)
+				{
+					SpectralDescExtraction* groupSpectral = (SpectralDescExtraction*)this->m_vExtractors[spectralGroups[g][0]];
+					if (groupSpectral->getTypeOfLaplacian() == spectral->getTypeOfLaplacian() && groupSpectral->getCoarseMesh() == spectral->getCoarseMesh())
+					{
+						break;
+					}
+				}
+				if (g == spectralGroups.size())
+				{
+					spectralGroups.push_back(std::vector<int>());
+				}
+				spectralGroups[g].push_back(d);
+			}
+			else if (calculatesPatches(extractor))
+			{
+				PatchBasedPerVertexFeatureExtraction* patchBased = (PatchBasedPerVertexFeatureExtraction*)extractor;
+				size_t g = 0;
+				for (; g < patchGroups.size(); g++)
+				{
+					PatchBasedPerVertexFeatureExtraction* groupPatchBased = (PatchBasedPerVertexFeatureExtraction*)this->m_vExtractors[patchGroups[g][0]];
+					if (groupPatchBased->getMinGeodesicDistance() == patchBased->getMinGeodesicDistance()
+						&& groupPatchBased->getMaxGeodesicDistance() == patchBased->getMaxGeodesicDistance()
+						&& groupPatchBased->getNumberOfPatches() == patchBased->getNumberOfPatches())
+					{
+						break;
+					}
+				}
+				if (g == patchGroups.size())
+				{
+					patchGroups.push_back(std::vector<int>());
+				}
+				patchGroups[g].push_back(d);
+			}
+			else if (dynamic_cast<OnEdgeAvgGeoDistExtraction*>(extractor) != NULL)
+			{
+				avgGeoDistIds.push_back(d);
+			}
+
+			PatchBasedShapeDistributionDescExtraction* pbsd = dynamic_cast<PatchBasedShapeDistributionDescExtraction*>(extractor);
+			if (pbsd != NULL && needsMaxPossibleSample(pbsd))
+			{
+				maxPossibleSampleIds.push_back(d);
+			}
+		}
+
+		//Source of each descriptor in a group, -1 for the descriptors without a group
+		std::vector<int> sourceIds(noDescriptors, -1);
+		std::vector<std::vector<int> > groupsOfSources(noDescriptors);
+		for (size_t g = 0; g < spectralGroups.size(); g++)
+		{
+			int sourceId = spectralGroups[g][0];
+			for (size_t i = 1; i < spectralGroups[g].size(); i++)
+			{
+				const int d = spectralGroups[g][i];
+				if (((SpectralDescExtraction*)this->m_vExtractors[d])->getNumberOfEigenVals() > ((SpectralDescExtraction*)this->m_vExtractors[sourceId])->getNumberOfEigenVals())
+				{
+					sourceId = d;
+				}
+			}
+			for (size_t i = 0; i < spectralGroups[g].size(); i++)
+			{
+				sourceIds[spectralGroups[g][i]] = sourceId;
+			}
+			groupsOfSources[sourceId] = spectralGroups[g];
+		}
+		std::vector<int> geodesicHolderIds = avgGeoDistIds;
+		for (size_t g = 0; g < patchGroups.size(); g++)
+		{
+			const int sourceId = patchGroups[g][0];
+			for (size_t i = 0; i < patchGroups[g].size(); i++)
+			{
+				sourceIds[patchGroups[g][i]] = sourceId;
+			}
+			groupsOfSources[sourceId] = patchGroups[g];
+			geodesicHolderIds.push_back(sourceId);
+		}
+
+		//Ring areas and the laplacian are needed by the sources of the eigen bases and the spectral extractors without an eigen basis
+		//They are calculated by a node only if more than one of them needs the same laplacian, otherwise the extractor calculates them itself
+		std::vector<std::vector<int> > laplacianGroups;
+		for (int d = 0; d < noDescriptors; d++)
+		{
+			SpectralDescExtraction* spectral = dynamic_cast<SpectralDescExtraction*>(this->m_vExtractors[d]);
+			if (spectral == NULL || (usesEigenBasis(spectral) && sourceIds[d] != d))
+			{
+				continue;
+			}
+			size_t g = 0;
+			for (; g < laplacianGroups.size(); g++)
+			{
+				if (((SpectralDescExtraction*)this->m_vExtractors[laplacianGroups[g][0]])->getTypeOfLaplacian() == spectral->getTypeOfLaplacian())
+				{
+					break;
+				}
+			}
+			if (g == laplacianGroups.size())
+			{
+				laplacianGroups.push_back(std::vector<int>());
+			}
+			laplacianGroups[g].push_back(d);
+		}
+		std::vector<int> laplacianNodeIdsOfDescriptors(noDescriptors, -1);
+		for (size_t g = 0; g < laplacianGroups.size(); g++)
+		{
+			if (laplacianGroups[g].size() < 2)
+			{
+				continue;
+			}
+			Node node;
+			node.m_Type = LAPLACIAN_NODE;
+			node.m_nDescriptorId = -1;
+			node.m_nSourceDescriptorId = -1;
+			node.m_vHolderDescriptorIds = laplacianGroups[g];
+			for (size_t i = 0; i < laplacianGroups[g].size(); i++)
+			{
+				laplacianNodeIdsOfDescriptors[laplacianGroups[g][i]] = (int)this->m_vNodes.size();
+			}
+			this->m_vNodes.push_back(node);
+		}
+
+		//The matrix is calculated only if some patches are calculated, average geodesic distances are streamed otherwise
+		int geodesicNodeId = -1;
+		if (this->m_pGeodesicDistanceMatrix != NULL)
+		{
+			for (size_t i = 0; i < geodesicHolderIds.size(); i++)
+			{
+				setGeodesicDistanceMatrixOfExtractor(this->m_vExtractors[geodesicHolderIds[i]], this->m_pGeodesicDistanceMatrix);
+			}
+		}
+		else if (!patchGroups.empty())
+		{
+			Node node;
+			node.m_Type = GEODESIC_DISTANCE_MATRIX_NODE;
+			node.m_nDescriptorId = -1;
+			node.m_nSourceDescriptorId = -1;
+			node.m_vHolderDescriptorIds = geodesicHolderIds;
+			geodesicNodeId = (int)this->m_vNodes.size();
+			this->m_vNodes.push_back(node);
+		}
+
+		int maxPossibleSampleNodeId = -1;
+		if (!maxPossibleSampleIds.empty())
+		{
+			Node node;
+			node.m_Type = MAX_POSSIBLE_SAMPLES_NODE;
+			node.m_nDescriptorId = -1;
+			node.m_nSourceDescriptorId = -1;
+			node.m_vHolderDescriptorIds = maxPossibleSampleIds;
+			maxPossibleSampleNodeId = (int)this->m_vNodes.size();
+			this->m_vNodes.push_back(node);
+		}
+
+		//Sources and the descriptors without a group come before the other members of the groups
+		std::vector<int> nodeIdsOfDescriptors(noDescriptors, -1);
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (int d = 0; d < noDescriptors; d++)
+			{
+				const bool isMember = (sourceIds[d] != -1 && sourceIds[d] != d);
+				if (isMember != (pass == 1))
+				{
+					continue;
+				}
+
+				Node node;
+				node.m_Type = DESCRIPTOR_NODE;
+				node.m_nDescriptorId = d;
+				node.m_nSourceDescriptorId = isMember ? sourceIds[d] : -1;
+				if (isMember)
+				{
+					node.m_vDependencies.push_back(nodeIdsOfDescriptors[sourceIds[d]]);
+				}
+				else
+				{
+					node.m_vHolderDescriptorIds = groupsOfSources[d];
+				}
+				if (geodesicNodeId != -1 && std::find(geodesicHolderIds.begin(), geodesicHolderIds.end(), d) != geodesicHolderIds.end())
+				{
+					node.m_vDependencies.push_back(geodesicNodeId);
+				}
+				if (maxPossibleSampleNodeId != -1 && std::find(maxPossibleSampleIds.begin(), maxPossibleSampleIds.end(), d) != maxPossibleSampleIds.end())
+				{
+					node.m_vDependencies.push_back(maxPossibleSampleNodeId);
+				}
+				if (laplacianNodeIdsOfDescriptors[d] != -1)
+				{
+					node.m_vDependencies.push_back(laplacianNodeIdsOfDescriptors[d]);
+				}
+				nodeIdsOfDescriptors[d] = (int)this->m_vNodes.size();
+				this->m_vNodes.push_back(node);
+			}
+		}
+
+		for (size_t n = 0; n < this->m_vNodes.size(); n++)
+		{
+			this->m_vNodes[n].m_nRemainingConsumers = 0;
+		}
+		for (size_t n = 0; n < this->m_vNodes.size(); n++)
+		{
+			for (size_t i = 0; i < this->m_vNodes[n].m_vDependencies.size(); i++)
+			{
+				this->m_vNodes[this->m_vNodes[n].m_vDependencies[i]].m_nRemainingConsumers++;
+			}
+		}
+	}
+
+	void ExtractionPipeline::runWorker()
+	{
+		const int noNodes = (int)this->m_vNodes.size();
+		while (true)
+		{
+			const int nodeId = this->m_nNextNodeId++;
+			if (nodeId >= noNodes)
+			{
+				break;
+			}
+			this->m_vNodePromises[nodeId].set_value(runNode(nodeId));
+		}
+	}
+
+	Result ExtractionPipeline::runNode(const int& nodeId)
+	{
+		const Node& node = this->m_vNodes[nodeId];
+
+		Result result = TACORE_OK;
+		for (size_t i = 0; i < node.m_vDependencies.size(); i++)
+		{
+			const Result dependencyResult = this->m_vNodeFutures[node.m_vDependencies[i]].get();
+			if (result == TACORE_OK)
+			{
+				result = dependencyResult;
+			}
+		}
+
+		if (result == TACORE_OK)
+		{
+			result = executeNode(nodeId);
+		}
+		if (node.m_Type == DESCRIPTOR_NODE)
+		{
+			this->m_vResults[node.m_nDescriptorId] = result;
+		}
+
+		for (size_t i = 0; i < node.m_vDependencies.size(); i++)
+		{
+			completeConsumer(node.m_vDependencies[i]);
+		}
+
+		//Consumers wait for the result of this node, so none of them is completed yet
+		{
+			std::lock_guard<std::mutex> lock(this->m_ConsumerMutex);
+			if (node.m_nRemainingConsumers == 0)
+			{
+				releaseNode(nodeId);
+			}
+		}
+
+		return result;
+	}
+
+	Result ExtractionPipeline::executeNode(const int& nodeId)
+	{
+		const Node& node = this->m_vNodes[nodeId];
+
+		Result result = TACORE_OK;
+		if (node.m_Type == GEODESIC_DISTANCE_MATRIX_NODE)
+		{
+			GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
+			geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+			result = geoDistMatrixExtraction.extract(this->m_pMesh, this->m_pCalculatedGeodesicMatrix);
+			if (result == TACORE_OK)
+			{
+				for (size_t i = 0; i < node.m_vHolderDescriptorIds.size(); i++)
+				{
+					setGeodesicDistanceMatrixOfExtractor(this->m_vExtractors[node.m_vHolderDescriptorIds[i]], (GeodesicDistanceMatrix*)this->m_pCalculatedGeodesicMatrix.get());
+				}
+			}
+		}
+		else if (node.m_Type == LAPLACIAN_NODE)
+		{
+			//First holder creates the laplacian, the others take it
+			SpectralDescExtraction* creator = (SpectralDescExtraction*)this->m_vExtractors[node.m_vHolderDescriptorIds[0]];
+			result = creator->prepareLaplacian(this->m_pMesh);
+			if (result == TACORE_OK)
+			{
+				for (size_t i = 1; i < node.m_vHolderDescriptorIds.size(); i++)
+				{
+					((SpectralDescExtraction*)this->m_vExtractors[node.m_vHolderDescriptorIds[i]])->setLaplacian(creator->getLaplacian());
+				}
+			}
+		}
+		else if (node.m_Type == MAX_POSSIBLE_SAMPLES_NODE)
+		{
+			//Only the maxima needed by the shape distribution functions are calculated, the volume one is especially expensive
+			TriMeshAuxInfo auxInfo = this->m_AuxInfo;
+			bool isDistanceCalculated = this->m_bHasAuxInfo;
+			bool isAreaCalculated = this->m_bHasAuxInfo;
+			bool isVolumeCalculated = this->m_bHasAuxInfo;
+			for (size_t i = 0; i < node.m_vHolderDescriptorIds.size(); i++)
+			{
+				PatchBasedShapeDistributionDescExtraction* pbsd = (PatchBasedShapeDistributionDescExtraction*)this->m_vExtractors[node.m_vHolderDescriptorIds[i]];
+				const PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction function = pbsd->getShapeDistributionFunction();
+				if (function == PatchBasedShapeDistributionDescExtraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS)
+				{
+					if (!isAreaCalculated)
+					{
+						auxInfo.m_lfMaxAreaOfTriangleConstructedByThreeVertices = this->m_pMesh->calcMaxAreaBetweenThreeVertices();
+						isAreaCalculated = true;
+					}
+					pbsd->setMaxPossibleSampleValue(sqrt(auxInfo.m_lfMaxAreaOfTriangleConstructedByThreeVertices));
+				}
+				else if (function == PatchBasedShapeDistributionDescExtraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS)
+				{
+					if (!isVolumeCalculated)
+					{
+						auxInfo.m_lfMaxVolumeOfTetrahedronConstructedByForVertices = this->m_pMesh->calcMaxVolumeOfTetrahedronBetweenFourVertices();
+						isVolumeCalculated = true;
+					}
+					pbsd->setMaxPossibleSampleValue(cbrt(auxInfo.m_lfMaxVolumeOfTetrahedronConstructedByForVertices));
+				}
+				else
+				{
+					if (!isDistanceCalculated)
+					{
+						auxInfo.m_lfMaxEucDistanceBetweenTwoVertices = this->m_pMesh->calcMaxEucDistanceBetweenTwoVertices();
+						isDistanceCalculated = true;
+					}
+					pbsd->setMaxPossibleSampleValue(auxInfo.m_lfMaxEucDistanceBetweenTwoVertices);
+				}
+			}
+		}
+		else
+		{
+			PerVertexFeatureExtraction* extractor = this->m_vExtractors[node.m_nDescriptorId];
+			if (node.m_nSourceDescriptorId != -1)
+			{
+				PerVertexFeatureExtraction* source = this->m_vExtractors[node.m_nSourceDescriptorId];
+				if (usesEigenBasis(extractor))
+				{
+					((SpectralDescExtraction*)extractor)->setEigenBasis(((SpectralDescExtraction*)source)->getEigenBasis());
+				}
+				else
+				{
+					((PatchBasedPerVertexFeatureExtraction*)extractor)->setPatchesForAllVertices(((PatchBasedPerVertexFeatureExtraction*)source)->getPatchesForAllVertices());
+				}
+			}
+			result = extractor->extract(this->m_pMesh, this->m_vFeatures[node.m_nDescriptorId]);
+		}
+
+		return result;
+	}
+
+	void ExtractionPipeline::completeConsumer(const int& nodeId)
+	{
+		std::lock_guard<std::mutex> lock(this->m_ConsumerMutex);
+		this->m_vNodes[nodeId].m_nRemainingConsumers--;
+		if (this->m_vNodes[nodeId].m_nRemainingConsumers == 0)
+		{
+			releaseNode(nodeId);
+		}
+	}
+
+	void ExtractionPipeline::releaseNode(const int& nodeId)
+	{
+		const Node& node = this->m_vNodes[nodeId];
+		if (node.m_Type == GEODESIC_DISTANCE_MATRIX_NODE)
+		{
+			for (size_t i = 0; i < node.m_vHolderDescriptorIds.size(); i++)
+			{
+				setGeodesicDistanceMatrixOfExtractor(this->m_vExtractors[node.m_vHolderDescriptorIds[i]], NULL);
+			}
+			this->m_pCalculatedGeodesicMatrix.reset();
+		}
+		else if (node.m_Type == LAPLACIAN_NODE)
+		{
+			for (size_t i = 0; i < node.m_vHolderDescriptorIds.size(); i++)
+			{
+				((SpectralDescExtraction*)this->m_vExtractors[node.m_vHolderDescriptorIds[i]])->setLaplacian(SpectralLaplacianPtr());
+			}
+		}
+		else if (node.m_Type == DESCRIPTOR_NODE)
+		{
+			//Holders are the members of the group of a source node
+			for (size_t i = 0; i < node.m_vHolderDescriptorIds.size(); i++)
+			{
+				PerVertexFeatureExtraction* holder = this->m_vExtractors[node.m_vHolderDescriptorIds[i]];
+				if (usesEigenBasis(holder))
+				{
+					((SpectralDescExtraction*)holder)->setEigenBasis(SpectralEigenBasisPtr());
+				}
+				else
+				{
+					((PatchBasedPerVertexFeatureExtraction*)holder)->setPatchesForAllVertices(PatchBasedPerVertexFeatureExtraction::VertexPatchesListPtr());
+				}
+			}
+		}
+	}
+
+	void ExtractionPipeline::setGeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix* gdMatrix)
+	{
+		this->m_pGeodesicDistanceMatrix = gdMatrix;
+	}
+
+	void ExtractionPipeline::setAuxInfo(const TriMeshAuxInfo& auxInfo)
+	{
+		this->m_AuxInfo = auxInfo;
+		this->m_bHasAuxInfo = true;
+	}
+
+	void ExtractionPipeline::setNumberOfWorkers(const unsigned int& noWorkers)
+	{
+		this->m_nNumberOfWorkers = noWorkers;
+	}
+
+	int ExtractionPipeline::getNumberOfDescriptors() const
+	{
+		return (int)this->m_vExtractors.size();
+	}
+
+	unsigned int ExtractionPipeline::getNumberOfWorkers() const
+	{
+		return this->m_nNumberOfWorkers;
+	}
+}
@@ -2,8 +2,9 @@
 #include "HeatKernelSignatureDesc.h"
 #include <core/NDimVector.h>
 #include <core/TriangularMesh.h>
-#include <set>
+#include <cmath>
 #include <numeric>
+#include <random>
 
 #ifdef ENABLE_TIMING_REPORTS
 #include <core/Timer.h>
@@ -18,78 +19,73 @@ namespace TAFeaExt
 
 	HKSDescExtraction::HKSDescExtraction()
 	{
-		this->m_LaplacianUsed = STAR_LAPLACIAN;
-		this->m_nNoEigenVal = 125;
 		this->m_fTMin = 1.0;
 		this->m_fTMax = 1000000;
 		this->m_nNumberOfTimeSamples = 100;
 		this->m_bCalcTimeValsFromEigenVals = true;
-		this->m_mLaplacian = NULL;
+		this->m_Backend = HKS_BACKEND_EIGEN_DECOMPOSITION;
+		this->m_nChebyshevMaxDegree = 500;
+		this->m_fChebyshevTolerance = 1e-8;
+		this->m_nNumberOfProbeVectors = 64;
+		this->m_nProbeBlockSize = 16;
+		this->m_nProbeSeed = 5489;
 	}
 
-	HKSDescExtraction::HKSDescExtraction(const HKSDescExtraction& other)
+	HKSDescExtraction::HKSDescExtraction(const HKSDescExtraction& other) : SpectralDescExtraction(other)
 	{
-		this->m_LaplacianUsed = other.m_LaplacianUsed;
-		this->m_nNoEigenVal = other.m_nNoEigenVal;
 		this->m_fTMin = other.m_fTMin;
 		this->m_fTMax = other.m_fTMax;
 		this->m_nNumberOfTimeSamples = other.m_nNumberOfTimeSamples;
 		this->m_bCalcTimeValsFromEigenVals = other.m_bCalcTimeValsFromEigenVals;
-		this->m_mLaplacian = other.m_mLaplacian; //Shallow copy
+		this->m_Backend = other.m_Backend;
+		this->m_nChebyshevMaxDegree = other.m_nChebyshevMaxDegree;
+		this->m_fChebyshevTolerance = other.m_fChebyshevTolerance;
+		this->m_nNumberOfProbeVectors = other.m_nNumberOfProbeVectors;
+		this->m_nProbeBlockSize = other.m_nProbeBlockSize;
+		this->m_nProbeSeed = other.m_nProbeSeed;
 	}
 
 	void HKSDescExtraction::clear()
 	{
-		this->m_LaplacianUsed = STAR_LAPLACIAN;
-		this->m_nNoEigenVal = 125;
+		SpectralDescExtraction::clear();
 		this->m_fTMin = 1.0;
 		this->m_fTMax = 1000000.0;
 		this->m_nNumberOfTimeSamples = 100;
 		this->m_bCalcTimeValsFromEigenVals = true;
-		if (this->m_mLaplacian != NULL)
-		{
-			delete this->m_mLaplacian;
-			this->m_mLaplacian = NULL;
-		}
+		this->m_Backend = HKS_BACKEND_EIGEN_DECOMPOSITION;
+		this->m_nChebyshevMaxDegree = 500;
+		this->m_fChebyshevTolerance = 1e-8;
+		this->m_nNumberOfProbeVectors = 64;
+		this->m_nProbeBlockSize = 16;
+		this->m_nProbeSeed = 5489;
 	}
 
 	Result HKSDescExtraction::extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures)
 	{
-		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		if (this->m_Backend == HKS_BACKEND_CHEBYSHEV)
 		{
-			return TACORE_BAD_ARGS;
+			return extractWithChebyshev(mesh, outFeatures);
 		}
 
-		//We, now, know that the mesh is a triangular mesh
-		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+		TACORE_CHECK_RESULT(prepareEigenBasis(mesh));
 
-		std::vector<double> ringAreas;
-		triMesh->calcRingAreasOfVertices(ringAreas);
-
-		Result res;
-		res = createLaplacianMatrix(mesh, this->m_LaplacianUsed, ringAreas);
-		if (res != TACore::TACORE_OK)
-		{
-			return res;
-		}
-
-		arma::cx_vec eigval;
-		arma::cx_mat eigvec;
-		res = calcEigenDecomposition(this->m_nNoEigenVal, &eigval, &eigvec);
-
-		if (res != TACore::TACORE_OK)
-		{
-			return res;
-		}
 #ifdef ENABLE_TIMING_REPORTS
 		TACore::Timer timer;
 #endif
+		const arma::vec& eigval = this->m_pEigenBasis->m_vEigenValues;
+		const double sumRingAreas = this->m_pEigenBasis->m_fSumRingAreas;
+		const unsigned int noEigenVal = getNumberOfEigenValsUsed();
+
+		//In the adaptive eigen count mode the count follows the minimum time, so it is not calculated from the largest eigen value
 		double minT = this->m_fTMin;
 		double maxT = this->m_fTMax;
 		if (this->m_bCalcTimeValsFromEigenVals)
 		{
-			minT = (abs(4 * log(10) / eigval(eigval.size() - 1).real()));
-			maxT = (abs(4 * log(10) / eigval(1).real()));
+			if (!this->m_bAdaptiveEigenCount || this->m_pCoarseMesh != NULL)
+			{
+				minT = (std::fabs(4 * log(10) / eigval(noEigenVal - 1)));
+			}
+			maxT = (std::fabs(4 * log(10) / eigval(1)));
 		}
 
 		const double logTMin = log(minT);
@@ -97,44 +93,34 @@ namespace TAFeaExt
 
 		const double tIncrement = (logTMax - logTMin) / (this->m_nNumberOfTimeSamples - 1);
 
-		double sumRingAreas = std::accumulate(ringAreas.begin(), ringAreas.end(), 0.0);
-		double sqrtSumRingAreas = sqrt(sumRingAreas);
-
-		const size_t verSize = triMesh->verts.size();
-		outFeatures = std::vector<LocalFeaturePtr>(verSize);
-
-		for (size_t v = 0; v < verSize; v++)
+		//Heat trace does not depend on the vertex, so each time sample is a filter normalized by its heat trace
+		arma::mat filters(noEigenVal, this->m_nNumberOfTimeSamples);
+		double currT = logTMin;
+		for (unsigned int t = 0; t < this->m_nNumberOfTimeSamples; t++)
 		{
-			if (v < verSize - 1)
+			const double logScaleCurrT = exp(currT);
+			double heatTrace = 0.0;
+			for (unsigned int eig = 0; eig < noEigenVal; eig++)
 			{
-				std::cout << "%" << (100 * v) / verSize << " completed for calculating hks descriptor" << "\r";
-			}
-			else
-			{
-				std::cout << "%" <<100 << " completed for calculating hks descriptor" << "\n";
+				const double expInvEigVal = exp(sumRingAreas * std::fabs(eigval(eig)) * logScaleCurrT * (-1.0));
+				filters(eig, t) = expInvEigVal;
+				heatTrace += expInvEigVal;
 			}
+			filters.col(t) /= heatTrace;
+			currT += tIncrement;
+		}
 
-			//Initialize descriptor of the vertex
-			HeatKernelSignatureDesc *pDesc = new HeatKernelSignatureDesc(v);
-			pDesc->m_vDescriptor = std::vector<double>(this->m_nNumberOfTimeSamples);
+		arma::mat descriptors;
+		TACORE_CHECK_RESULT(evaluateSpectralFilters(filters, descriptors));
 
-			double currT = logTMin;
-			for (size_t t = 0; t < this->m_nNumberOfTimeSamples; t++)
-			{
-				const double logScaleCurrT = exp(currT);
-				double heatTrace = 0.0;
-				double descVal = 0.0;
-				for (size_t eig = 0; eig < this->m_nNoEigenVal; eig++)
-				{
-					const double expInvEigVal = exp(sumRingAreas * abs(eigval(eig).real()) * logScaleCurrT * (-1.0));
-					const double EigFuncVal = sqrtSumRingAreas * eigvec(v, eig).real();
-					const double sqEigFuncVal = EigFuncVal * EigFuncVal;
-					descVal += (expInvEigVal * sqEigFuncVal);
-					heatTrace += expInvEigVal;
-				}
-				pDesc->m_vDescriptor[t] = descVal / heatTrace;
-				currT += tIncrement;
-			}
+		const int verSize = (int)descriptors.n_cols;
+		outFeatures = std::vector<LocalFeaturePtr>(verSize);
+#pragma omp parallel for
+		for (int v = 0; v < verSize; v++)
+		{
+			HeatKernelSignatureDesc *pDesc = new HeatKernelSignatureDesc(v);
+			const double* vertexDesc = descriptors.colptr(v);
+			pDesc->m_vDescriptor = std::vector<double>(vertexDesc, vertexDesc + descriptors.n_rows);
 			outFeatures[v] = LocalFeaturePtr(pDesc);
 		}
 #ifdef ENABLE_TIMING_REPORTS
@@ -144,6 +130,25 @@ namespace TAFeaExt
 		return TACORE_OK;
 	}
 
+	bool HKSDescExtraction::supportsAdaptiveEigenCount() const
+	{
+		return true;
+	}
+
+	unsigned int HKSDescExtraction::countSignificantEigenVals(const arma::vec& eigVals, const double& sumRingAreas) const
+	{
+		//Heat kernel terms decrease with the eigen value, so the largest terms are at the minimum time
+		unsigned int noSignificant = 0;
+		for (arma::uword eig = 0; eig < eigVals.n_elem; eig++)
+		{
+			if (exp(sumRingAreas * std::fabs(eigVals(eig)) * this->m_fTMin * (-1.0)) >= this->m_fAdaptiveEigenTolerance)
+			{
+				noSignificant++;
+			}
+		}
+		return noSignificant;
+	}
+
 	Result HKSDescExtraction::extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr)
 	{
 		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
@@ -157,24 +162,197 @@ namespace TAFeaExt
 		return TACORE_OK;
 	}
 
-	void HKSDescExtraction::setTypeOfLaplacian(const HKSDescExtraction::TypeOfLaplacian& typeLap)
+	Result HKSDescExtraction::extractWithChebyshev(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures)
 	{
-		this->m_LaplacianUsed = typeLap;
-	}
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+		if (this->m_fTMin <= 0.0 || this->m_fTMax < this->m_fTMin || this->m_nNumberOfTimeSamples < 2
+			|| this->m_nNumberOfProbeVectors == 0 || this->m_nProbeBlockSize == 0 || this->m_nChebyshevMaxDegree == 0)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+		//Time boundaries of the eigen decomposition backend come from the smallest nonzero eigen value, which is not known here
+		if (this->m_bCalcTimeValsFromEigenVals)
+		{
+			std::cerr << "Chebyshev backend of HKS needs the time boundaries to be set, they cannot be calculated from the eigen values!" << std::endl;
+			return TACORE_INVALID_OPERATION;
+		}
 
-	HKSDescExtraction::TypeOfLaplacian HKSDescExtraction::getTypeOfLaplacian() const
-	{
-		return this->m_LaplacianUsed;
-	}
+		//Laplacian may be shared with the other spectral extractors of the mesh
+		TACORE_CHECK_RESULT(prepareLaplacian(mesh));
+		const std::vector<double>& ringAreas = this->m_pLaplacian->m_vRingAreas;
 
-	void HKSDescExtraction::setNumberOfEigenVals(const unsigned int& noEigenVals)
-	{
-		this->m_nNoEigenVal = noEigenVals;
-	}
+#ifdef ENABLE_TIMING_REPORTS
+		TACore::Timer timer;
+#endif
+		const double pi = 3.14159265358979323846;
+		const double sumRingAreas = std::accumulate(ringAreas.begin(), ringAreas.end(), 0.0);
+		const int numberOfVertices = (int)this->m_mLaplacian->n_rows;
+		const unsigned int noTimeSamples = this->m_nNumberOfTimeSamples;
+
+		//Laplacian in compressed row form, so that the rows of a product are independent
+		const arma::SpMat<double> laplacianRows = this->m_mLaplacian->t();
+		const double laplacianBound = calcSpectrumUpperBound(laplacianRows);
+		if (!(laplacianBound > 0.0))
+		{
+			return TACORE_ERROR;
+		}
+		//Like the absolute eigen values, the laplacian is scaled by the sum of the ring areas and its sign: A = sign * sumRingAreas * L,
+		//so that the spectrum of A is in [0, spectrumBound] for the discrete laplacian as well
+		const double spectrumSign = getSpectrumSign();
+		const double spectrumBound = sumRingAreas * laplacianBound;
+
+		//Same logarithmic time samples as the eigen decomposition backend
+		std::vector<double> timeSamples(noTimeSamples);
+		const double logTMin = log(this->m_fTMin);
+		const double tIncrement = (log(this->m_fTMax) - logTMin) / (noTimeSamples - 1);
+		for (unsigned int t = 0; t < noTimeSamples; t++)
+		{
+			timeSamples[t] = exp(logTMin + t * tIncrement);
+		}
 
-	unsigned int HKSDescExtraction::getNumberOfEigenVals() const
-	{
-		return this->m_nNoEigenVal;
+		//Chebyshev coefficients of exp(-tx) on [0, spectrumBound] by Chebyshev-Gauss quadrature
+		//c_k(t) = 2 / M * sum_j exp(-t * x_j) * cos(k * theta_j), x_j = (cos(theta_j) + 1) * spectrumBound / 2
+		const unsigned int maxDegree = this->m_nChebyshevMaxDegree;
+		const unsigned int noNodes = 2 * (maxDegree + 1);
+		arma::mat cosTable(noNodes, maxDegree + 1);
+		arma::mat nodeVals(noNodes, noTimeSamples);
+		for (unsigned int j = 0; j < noNodes; j++)
+		{
+			const double theta = pi * (j + 0.5) / noNodes;
+			const double x = (cos(theta) + 1.0) * spectrumBound / 2.0;
+			for (unsigned int k = 0; k <= maxDegree; k++)
+			{
+				cosTable(j, k) = cos(k * theta);
+			}
+			for (unsigned int t = 0; t < noTimeSamples; t++)
+			{
+				nodeVals(j, t) = exp((-1.0) * timeSamples[t] * x);
+			}
+		}
+		arma::mat coefs = cosTable.t() * nodeVals;
+		coefs *= 2.0 / noNodes;
+		for (unsigned int t = 0; t < noTimeSamples; t++)
+		{
+			coefs(0, t) *= 0.5;
+		}
+
+		//exp(-tx) is bounded by 1, so the expansions are truncated at an absolute tolerance, common for all of the time samples
+		//The largest time needs the highest degree, if its coefficients are still above the tolerance at the maximum degree the descriptors would be wrong
+		unsigned int degree = 0;
+		for (unsigned int k = 0; k <= maxDegree; k++)
+		{
+			for (unsigned int t = 0; t < noTimeSamples; t++)
+			{
+				if (std::fabs(coefs(k, t)) > this->m_fChebyshevTolerance)
+				{
+					degree = k;
+					break;
+				}
+			}
+		}
+		if (degree == maxDegree)
+		{
+			std::cerr << "Chebyshev expansion does not converge within the maximum degree " << maxDegree << ", increase it or decrease the maximum time value!" << std::endl;
+			return TACORE_INVALID_OPERATION;
+		}
+		std::cout << "Degree of the Chebyshev expansion: " << degree << std::endl;
+
+		//Y = (2 / spectrumBound) * A - I maps the spectrum into [-1, 1]
+		const double alpha = spectrumSign * 2.0 / laplacianBound;
+		const double beta = -1.0;
+
+		//descriptors(t, v) accumulates sum_k c_k(t) * sum_z z(v) * (T_k(Y) z)(v)
+		//Per degree diagonals are buffered and added by a matrix product, so that memory does not grow with the degree
+		const unsigned int degreeChunk = 32;
+		arma::mat descriptors(noTimeSamples, numberOfVertices, arma::fill::zeros);
+		arma::mat diagChunk(degreeChunk, numberOfVertices);
+
+		//Rademacher probes from a fixed seed, the same seed gives the same descriptors
+		std::mt19937 probeGenerator(this->m_nProbeSeed);
+
+		const unsigned int noProbes = this->m_nNumberOfProbeVectors;
+		for (unsigned int probeStart = 0; probeStart < noProbes; probeStart += this->m_nProbeBlockSize)
+		{
+			const unsigned int blockSize = MIN(this->m_nProbeBlockSize, noProbes - probeStart);
+
+			//Blocks are transposed: the probe values of a vertex are contiguous
+			arma::mat probes(blockSize, numberOfVertices);
+			double* probeVals = probes.memptr();
+			const size_t noProbeVals = (size_t)blockSize * numberOfVertices;
+			for (size_t i = 0; i < noProbeVals; i += 32)
+			{
+				unsigned int bits = (unsigned int)probeGenerator();
+				for (size_t b = i; b < MIN(i + 32, noProbeVals); b++)
+				{
+					probeVals[b] = (bits & 1) ? 1.0 : -1.0;
+					bits >>= 1;
+				}
+			}
+
+			arma::mat curr = probes;
+			arma::mat prevToNext(blockSize, numberOfVertices);
+			unsigned int chunkStart = 0;
+			for (unsigned int k = 0; k <= degree; k++)
+			{
+				if (k > 0)
+				{
+					chebyshevStep(laplacianRows, alpha, beta, curr, prevToNext, k == 1);
+					curr.swap(prevToNext);
+				}
+
+				const unsigned int chunkRow = k - chunkStart;
+#pragma omp parallel for
+				for (int v = 0; v < numberOfVertices; v++)
+				{
+					const double* z = probes.colptr(v);
+					const double* tz = curr.colptr(v);
+					double diagVal = 0.0;
+					for (unsigned int b = 0; b < blockSize; b++)
+					{
+						diagVal += z[b] * tz[b];
+					}
+					diagChunk(chunkRow, v) = diagVal;
+				}
+
+				if (chunkRow == degreeChunk - 1 || k == degree)
+				{
+					descriptors += coefs.rows(chunkStart, k).t() * diagChunk.rows(0, chunkRow);
+					chunkStart = k + 1;
+				}
+			}
+		}
+
+		//Estimated heat trace of each time sample normalizes the descriptors, as the eigen value sum does in the eigen decomposition backend
+		std::vector<double> heatTraces(noTimeSamples, 0.0);
+		for (int v = 0; v < numberOfVertices; v++)
+		{
+			for (unsigned int t = 0; t < noTimeSamples; t++)
+			{
+				heatTraces[t] += descriptors(t, v);
+			}
+		}
+
+		outFeatures = std::vector<LocalFeaturePtr>(numberOfVertices);
+#pragma omp parallel for
+		for (int v = 0; v < numberOfVertices; v++)
+		{
+			HeatKernelSignatureDesc *pDesc = new HeatKernelSignatureDesc(v);
+			pDesc->m_vDescriptor = std::vector<double>(noTimeSamples);
+			for (unsigned int t = 0; t < noTimeSamples; t++)
+			{
+				//1 / noProbes of the probe mean cancels in the ratio
+				pDesc->m_vDescriptor[t] = sumRingAreas * descriptors(t, v) / heatTraces[t];
+			}
+			outFeatures[v] = LocalFeaturePtr(pDesc);
+		}
+#ifdef ENABLE_TIMING_REPORTS
+		std::cout << "Time Passed to Calculate HKS by Chebyshev Expansion of Degree " << degree << ": " << timer.seconds() << " secs." << std::endl;
+#endif
+
+		return TACORE_OK;
 	}
 
 	void HKSDescExtraction::setMinTimeVal(const double& minTime)
@@ -217,270 +395,63 @@ namespace TAFeaExt
 		return this->m_bCalcTimeValsFromEigenVals;
 	}
 
-	Result HKSDescExtraction::createLaplacianMatrix(PolygonMesh *mesh, const TypeOfLaplacian& typeLap, const std::vector<double>& vertexRingAreas)
+	void HKSDescExtraction::setHeatKernelBackend(const HKSDescExtraction::HeatKernelBackend& backend)
 	{
-#ifdef ENABLE_TIMING_REPORTS
-		TACore::Timer timer;
-#endif
-		Result res = TACore::TACORE_OK;
-		if (typeLap == HKSDescExtraction::STAR_LAPLACIAN)
-		{
-			res = createStarLaplacianMatrix(mesh, vertexRingAreas);
-		}
-		if (typeLap == HKSDescExtraction::DISCRETE_LAPLACIAN)
-		{
-			res = createDiscreteLaplacianMatrix(mesh, vertexRingAreas);
-		}
-#ifdef ENABLE_TIMING_REPORTS
-		std::cout << "Time Passed to Create Laplacian: " << timer.seconds() << " secs." << std::endl;
-#endif
-		return res;
+		this->m_Backend = backend;
 	}
 
-	Result HKSDescExtraction::calcEigenDecomposition(const unsigned int& noEigenVals, arma::cx_vec *pEigVals, arma::cx_mat *pEigVecs)
+	HKSDescExtraction::HeatKernelBackend HKSDescExtraction::getHeatKernelBackend() const
 	{
-#ifdef ENABLE_TIMING_REPORTS
-		TACore::Timer timer;
-#endif
-		if (noEigenVals < 2)
-		{
-			std::cerr << "Number of eigen values and vectors must be greater than or equal to 2!" << std::endl;
-			return TACore::TACORE_BAD_ARGS;
-		}
-		if (this->m_mLaplacian == NULL)
-		{
-			return TACore::TACORE_INVALID_OPERATION;
-		}
-
-		const bool ret = arma::eigs_gen(*pEigVals, *pEigVecs, *(this->m_mLaplacian), noEigenVals, "sm");
-		if (ret == false)
-		{
-			std::cout << "eigs_gen is failed to converge to find the eigen values of the Laplacian matrix" << std::endl;
-			return TACore::TACORE_ERROR;
-		}
-#ifdef ENABLE_TIMING_REPORTS
-		std::cout << "Time Passed to Calculate the Eigenvalues of the Laplacian: " << timer.seconds() << " secs." << std::endl;
-#endif
-		return TACore::TACORE_OK;
+		return this->m_Backend;
 	}
 
-	Result HKSDescExtraction::createStarLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas)
+	void HKSDescExtraction::setChebyshevMaxDegree(const unsigned int& maxDegree)
 	{
-		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
-		{
-			return TACORE_BAD_ARGS;
-		}
-
-		//We, now, know that the mesh is a triangular mesh
-		TriangularMesh *triMesh = (TriangularMesh*)mesh;
-
-		if (this->m_mLaplacian != NULL)
-		{
-			delete this->m_mLaplacian;
-		}
-
-		const size_t numberOfVertices = triMesh->verts.size();
-
-		std::vector<unsigned int> vRowIndices;
-		std::vector<unsigned int> vColIndices;
-		std::vector<double> vValues;
-		for (size_t i = 0; i < numberOfVertices; i++)
-		{
-			if (i < numberOfVertices-1)
-			{
-				std::cout << "%" << (100 * i) / numberOfVertices << " completed for creating laplacian" << "\r";
-			}
-			else
-			{
-				std::cout << "%" << 100 << " completed for creating laplacian" << "\n";
-			}
-			
-			double sum_w = 0.0;
-			for (int j = 0; j < (int) triMesh->verts[i]->vertList.size(); j++) 
-			{
-				double w_ij = cotangentWeight(triMesh, i, triMesh->verts[i]->vertList[j]);
-				sum_w += w_ij;
-			}
-			for (int j = 0; j < (int) triMesh->verts[i]->vertList.size(); j++) 
-			{
-				double w_ij = cotangentWeight(triMesh, i, triMesh->verts[i]->vertList[j]);
-
-				if (i != triMesh->verts[i]->vertList[j]) {
-					double entry = (double((-1.0)*w_ij / sum_w));
-					vRowIndices.push_back(i);
-					vColIndices.push_back(triMesh->verts[i]->vertList[j]);
-					vValues.push_back(entry);
-				}
-			}
-			vRowIndices.push_back(i);
-			vColIndices.push_back(i);
-			vValues.push_back(1.0);
-		}
-
-		arma::umat locations(2, vRowIndices.size());
-		arma::vec values(vValues);
-		for (size_t i = 0; i < vRowIndices.size(); i++)
-		{
-			locations(0, i) = vRowIndices[i];
-			locations(1, i) = vColIndices[i];
-		}
-		this->m_mLaplacian = new arma::SpMat<double>(locations, values, true);
-
-		//Normalize the laplacian
-		double sumRingAreas = std::accumulate(vertexRingAreas.begin(), vertexRingAreas.end(), 0.0);
-		*(this->m_mLaplacian) = *(this->m_mLaplacian) / sumRingAreas;
-
-		return TACore::TACORE_OK;
+		this->m_nChebyshevMaxDegree = maxDegree;
 	}
 
-	Result HKSDescExtraction::createDiscreteLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas)
+	unsigned int HKSDescExtraction::getChebyshevMaxDegree() const
 	{
-		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
-		{
-			return TACORE_BAD_ARGS;
-		}
-
-		//We, now, know that the mesh is a triangular mesh
-		TriangularMesh *triMesh = (TriangularMesh*)mesh;
-
-		if (this->m_mLaplacian != NULL)
-		{
-			delete this->m_mLaplacian;
-		}
-
-		const size_t numberOfVertices = triMesh->verts.size();
-		const double FOUR_PI = 4.0 * 3.14159265358979323846;
-
-		std::vector<unsigned int> vRowIndices;
-		std::vector<unsigned int> vColIndices;
-		std::vector<double> vValues;
-
-		const double epsilon = 1e-5;
-
-		for (size_t i = 0; i < numberOfVertices; i++)
-		{
-			if (i < numberOfVertices - 1)
-			{
-				std::cout << "%" << (100 * i) / numberOfVertices << " completed for creating laplacian" << "\r";
-			}
-			else
-			{
-				std::cout << "%" << 100 << " completed for creating laplacian" << "\n";
-			}
-
-			Vertex *vi = triMesh->verts[i];
-
-			const std::vector<int>& vertexTriList = vi->triList;
-			std::set<int> neighborEdgeIndicesList;
-			for (size_t t = 0; t < vertexTriList.size(); t++)
-			{
-				neighborEdgeIndicesList.insert(triMesh->tris[vertexTriList[t]]->e1);
-			}
-			double neighborEdgeLengthSum = 0.0;
-			for (std::set<int>::iterator it = neighborEdgeIndicesList.begin(); it != neighborEdgeIndicesList.end(); ++it) {
-				neighborEdgeLengthSum += triMesh->edges[*it]->length;
-			}
-			const double h = neighborEdgeLengthSum / neighborEdgeIndicesList.size(); //Adaptive h according to the edge lengths around the vertex
-			const double hh = h * h;
-			const double pi = 3.1415926535897;
-			const double fourOverPIhhhh = 4.0 / (pi * hh * hh);
-
-			const double epsilon = 1e-10;
-
-			double diagonalEntry = 0.0;
-			for (size_t j = 0; j < numberOfVertices; j++)
-			{
-				if (i != j)
-				{
-					Vertex *vj = triMesh->verts[j];
-					const float eucDistanceBetweenTwo = triMesh->eucDistanceBetween(vi, vj);
-					const double entry = (vertexRingAreas[j] / 3.0) * exp((-1.0 * eucDistanceBetweenTwo * eucDistanceBetweenTwo) / hh) * fourOverPIhhhh;
-
-					if (entry > epsilon)
-					{
-						vRowIndices.push_back(i);
-						vColIndices.push_back(j);
-						vValues.push_back(entry);
-						diagonalEntry += (-1.0) * entry;
-					}
-				}
-				
-			}
+		return this->m_nChebyshevMaxDegree;
+	}
 
-			vRowIndices.push_back(i);
-			vColIndices.push_back(i);
-			vValues.push_back(diagonalEntry);
-		}
+	void HKSDescExtraction::setChebyshevTolerance(const double& tolerance)
+	{
+		this->m_fChebyshevTolerance = tolerance;
+	}
 
-		arma::umat locations(2, vRowIndices.size());
-		arma::vec values(vValues);
-		for (size_t i = 0; i < vRowIndices.size(); i++)
-		{
-			locations(0, i) = vRowIndices[i];
-			locations(1, i) = vColIndices[i];
-		}
-		this->m_mLaplacian = new arma::SpMat<double>(locations, values, true);
+	double HKSDescExtraction::getChebyshevTolerance() const
+	{
+		return this->m_fChebyshevTolerance;
+	}
 
-		return TACore::TACORE_OK;
+	void HKSDescExtraction::setNumberOfProbeVectors(const unsigned int& noProbeVectors)
+	{
+		this->m_nNumberOfProbeVectors = noProbeVectors;
 	}
 
+	unsigned int HKSDescExtraction::getNumberOfProbeVectors() const
+	{
+		return this->m_nNumberOfProbeVectors;
+	}
 
-	double HKSDescExtraction::cotangentWeight(TriangularMesh* mesh, int iv, int jv)
+	void HKSDescExtraction::setProbeBlockSize(const unsigned int& probeBlockSize)
 	{
-		int noTri = 0;
-		double cots = 0.0;
-		for (size_t i = 0; i < mesh->verts[iv]->triList.size(); i++) {
-			Triangle* ivTri = mesh->tris[mesh->verts[iv]->triList[i]];
-			int b, n1 = iv, n2 = jv;
-			bool shareTriangle = false;
-
-			if (ivTri->v1i == jv) {
-				noTri++;
-				shareTriangle = true;
-				if (ivTri->v2i == iv) {
-					b = ivTri->v3i;
-				}
-				else {
-					b = ivTri->v2i;
-				}
-			}
-			else if (ivTri->v2i == jv) {
-				noTri++;
-				shareTriangle = true;
-				if (ivTri->v1i == iv) {
-					b = ivTri->v3i;
-				}
-				else {
-					b = ivTri->v1i;
-				}
-			}
-			else if (ivTri->v3i == jv) {
-				noTri++;
-				shareTriangle = true;
-				if (ivTri->v1i == iv) {
-					b = ivTri->v2i;
-				}
-				else {
-					b = ivTri->v1i;
-				}
-			}
-			if (shareTriangle) {
-				Vertex *vn1 = mesh->verts[n1];
-				Vertex *vn2 = mesh->verts[n2];
-				TACore::Vector3D base(mesh->verts[b]->coords[0], mesh->verts[b]->coords[1], mesh->verts[b]->coords[2]);
-				TACore::Vector3D ne1(vn1->coords[0], vn1->coords[1], vn1->coords[2]);
-				TACore::Vector3D ne2(vn2->coords[0], vn2->coords[1], vn2->coords[2]);
+		this->m_nProbeBlockSize = probeBlockSize;
+	}
 
-				//TO DO: Use get angle class of NDimVector
-				TACore::Vector3D v1 = ne1 - base; v1.normalize();
-				TACore::Vector3D v2 = ne2 - base; v2.normalize();
+	unsigned int HKSDescExtraction::getProbeBlockSize() const
+	{
+		return this->m_nProbeBlockSize;
+	}
 
-				double dot = (v1 % v2);
-				double angle = acos(dot);
+	void HKSDescExtraction::setProbeSeed(const unsigned int& probeSeed)
+	{
+		this->m_nProbeSeed = probeSeed;
+	}
 
-				cots += 1.0 / tan(angle);
-			}
-		}
-		return cots / noTri;
+	unsigned int HKSDescExtraction::getProbeSeed() const
+	{
+		return this->m_nProbeSeed;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,828 @@
+#include "MultiParameterPerVertexDescriptorRun/BatchFeatureExtractionMain.h"
+#include <core/CommandLineParser.h>
+#include <core/TriangularMesh.h>
+#include <core/BoundedQueue.h>
+#include <core/FileJobQueue.h>
+#include <core/StringUtil.h>
+#include <core/PathUtil.h>
+#include <core/Timer.h>
+#include <TAFeatureFileIO.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
+
+//Extractors
+#include "ExtractionPipeline.h"
+#include "OnEdgeAvgGeoDistExtraction.h"
+#include "PatchBasedSumOfCenterDistancesExtraction.h"
+#include "PatchBasedShapeDistributionDescExtraction.h"
+#include "HKSDescExtraction.h"
+#include "WKSDescExtraction.h"
+
+namespace
+{
+	typedef std::shared_ptr<TAShape::TriangularMesh> TriangularMeshPtr;
+
+	//Parameters of the descriptors given in the command line
+	struct DescriptorParameters
+	{
+		float m_fMinGeodesicDistance;
+		float m_fMaxGeodesicDistance;
+		int m_nNumberOfPatches;
+		TAFeaExt::PatchBasedSumOfCenterDistancesExtraction::SpreadMeasure m_SpreadMeasure;
+		int m_nNumberOfBins;
+		int m_nSampleCount;
+		int m_nSamplingMethod;
+		int m_nShapeDistributionFunction;
+		unsigned int m_nRandomSeed;
+		TAFeaExt::SpectralDescExtraction::TypeOfLaplacian m_LaplacianType;
+		TAFeaExt::HKSDescExtraction::HeatKernelBackend m_HeatKernelBackend;
+		double m_fMinTime;
+		double m_fMaxTime;
+		int m_nChebyshevMaxDegree;
+		int m_nNumberOfProbeVectors;
+		int m_nNumberOfEigenVals;
+		bool m_bAdaptiveEigenCount;
+	};
+
+	//Mesh parsed by the loader thread, NULL if it cannot be loaded or it has no vertices
+	//Job name is empty unless the mesh is taken from a job queue
+	//Coarse mesh is its low resolution version seeding the eigen decomposition, NULL if it is not asked for or it cannot be loaded
+	struct LoadedMesh
+	{
+		std::string m_sPath;
+		std::string m_sJobName;
+		TriangularMeshPtr m_pMesh;
+		TriangularMeshPtr m_pCoarseMesh;
+		double m_fLoadSeconds;
+	};
+
+	//Features of a mesh waiting for the writer thread
+	struct ExtractedMesh
+	{
+		std::string m_sPath;
+		std::string m_sJobName;
+		int m_nNumberOfVertices;
+		bool m_bIsLoaded;
+		double m_fLoadSeconds;
+		double m_fExtractSeconds;
+		std::vector<std::string> m_vFeatureFilePaths;
+		std::vector<std::vector<LocalFeaturePtr> > m_vFeatures;
+		std::vector<TAFea::FeatureFileInfo> m_vFeatureFileInfos;
+		std::vector<TACore::Result> m_vResults;
+	};
+
+	//Meshes are taken from the paths, or from the job queue if it is given
+	struct LoaderContext
+	{
+		const std::vector<std::string>* m_pMeshPaths;
+		TACore::BoundedQueue<LoadedMesh>* m_pQueue;
+		TACore::FileJobQueue* m_pJobQueue;
+		unsigned int m_nJobTimeout;
+		std::string m_sCoarseSuffix;
+	};
+
+	struct WriterContext
+	{
+		TACore::BoundedQueue<ExtractedMesh>* m_pQueue;
+		TACore::FileJobQueue* m_pJobQueue;
+		std::ofstream* m_pReport;
+		int m_nNumberOfMeshes;
+		int m_nNumberOfFailedMeshes;
+		double m_fTotalWriteSeconds;
+	};
+
+	//Jobs of the meshes start with it, so the queue folder can also hold the jobs of parameter sweeps
+	const std::string MESH_JOB_PREFIX = "mesh_";
+
+	//Time the loader sleeps while the remaining meshes are processed by the other workers
+	const unsigned int JOB_POLL_INTERVAL_IN_SECONDS = 2;
+
+	//Claimed jobs are renewed this many times within the job timeout, so a late renewal does not lose a job
+	const unsigned int JOB_RENEWALS_PER_TIMEOUT = 4;
+
+	//Header of the report, reports of the workers of a queue start with the job column
+	const std::string REPORT_HEADER = "Mesh,Vertices,LoadSeconds,ExtractSeconds,WriteSeconds,Result";
+
+	//Name of the job of a mesh, the padded index keeps the order of the meshes in the folder or the manifest
+	std::string createMeshJobName(const size_t& meshIdx, const std::string& meshPath)
+	{
+		std::string id = TACore::StringUtil::str(meshIdx);
+		if (id.size() < 8)
+		{
+			id.insert(0, 8 - id.size(), '0');
+		}
+		return MESH_JOB_PREFIX + id + "_" + TACore::PathUtil::stripExtension(TACore::PathUtil::getFileNameFromPath(meshPath));
+	}
+
+	//Base name of the feature files of a mesh, the mesh name followed by 8 hex digits of the FNV-1a hash of its absolute path
+	//Meshes with the same name in different folders get different files, and a mesh gets the same files with or without a job queue
+	std::string createOutputBaseName(const std::string& meshPath)
+	{
+		const std::string absolutePath = TACore::PathUtil::isAbsolutePath(meshPath) ? meshPath : TACore::PathUtil::joinPath(TACore::PathUtil::getCurrentDirectory(), meshPath);
+		unsigned int hash = 2166136261U;
+		for (size_t i = 0; i < absolutePath.size(); i++)
+		{
+			hash ^= (unsigned char)absolutePath[i];
+			hash *= 16777619U;
+		}
+
+		const char* hexDigits = "0123456789abcdef";
+		std::string hexHash(8, '0');
+		for (int i = 7; i >= 0; i--)
+		{
+			hexHash[i] = hexDigits[hash & 0xF];
+			hash >>= 4;
+		}
+		return TACore::PathUtil::stripExtension(TACore::PathUtil::getFileNameFromPath(meshPath)) + "_" + hexHash;
+	}
+
+	//Path of the low resolution version of a mesh, named after the mesh followed by a suffix, e.g. dragon_finalLowReso.off for dragon_final.off
+	std::string getCoarseMeshPath(const std::string& meshPath, const std::string& coarseSuffix)
+	{
+		const std::string extension = TACore::PathUtil::getExtension(meshPath);
+		if (extension.empty())
+		{
+			return meshPath + coarseSuffix;
+		}
+		return TACore::PathUtil::addExtension(TACore::PathUtil::stripExtension(meshPath) + coarseSuffix, extension);
+	}
+
+	//Approximate number of bytes held by a loaded mesh, used to bound the meshes waiting for the extraction
+	unsigned long long estimateMeshBytes(const TAShape::TriangularMesh& triMesh)
+	{
+		unsigned long long bytes = 0;
+		for (size_t v = 0; v < triMesh.verts.size(); v++)
+		{
+			const TAShape::Vertex* vertex = triMesh.verts[v];
+			bytes += sizeof(TAShape::Vertex*) + sizeof(TAShape::Vertex) + 3 * sizeof(float);
+			bytes += (vertex->triList.capacity() + vertex->edgeList.capacity() + vertex->vertList.capacity()) * sizeof(int);
+		}
+		bytes += triMesh.tris.size() * (sizeof(TAShape::Triangle*) + sizeof(TAShape::Triangle));
+		bytes += triMesh.edges.size() * (sizeof(TAShape::Edge*) + sizeof(TAShape::Edge));
+		return bytes;
+	}
+
+	//Creates the extractor of a descriptor type, NULL if the type is not known
+	TAFeaExt::PerVertexFeatureExtraction* createExtractor(const std::string& descType, const DescriptorParameters& params)
+	{
+		if (descType == "agd")
+		{
+			return new TAFeaExt::OnEdgeAvgGeoDistExtraction();
+		}
+		else if (descType == "scd")
+		{
+			TAFeaExt::PatchBasedSumOfCenterDistancesExtraction* extractor = new TAFeaExt::PatchBasedSumOfCenterDistancesExtraction();
+			extractor->setMinGeodesicDistance(params.m_fMinGeodesicDistance);
+			extractor->setMaxGeodesicDistance(params.m_fMaxGeodesicDistance);
+			extractor->setNumberOfPatches(params.m_nNumberOfPatches);
+			extractor->setSpreadMeasure(params.m_SpreadMeasure);
+			return extractor;
+		}
+		else if (descType == "pbsd")
+		{
+			TAFeaExt::PatchBasedShapeDistributionDescExtraction* extractor = new TAFeaExt::PatchBasedShapeDistributionDescExtraction();
+			extractor->setMinGeodesicDistance(params.m_fMinGeodesicDistance);
+			extractor->setMaxGeodesicDistance(params.m_fMaxGeodesicDistance);
+			extractor->setNumberOfPatches(params.m_nNumberOfPatches);
+			extractor->setNumberOfBins(params.m_nNumberOfBins);
+			extractor->setSampleCount(params.m_nSampleCount);
+			extractor->setSamplingMethod(TAFeaExt::PatchBasedShapeDistributionDescExtraction::SamplingMethod(params.m_nSamplingMethod));
+			extractor->setShapeDistributionFunction(TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(params.m_nShapeDistributionFunction));
+			extractor->setRandomSeed(params.m_nRandomSeed);
+			return extractor;
+		}
+		else if (descType == "hks")
+		{
+			TAFeaExt::HKSDescExtraction* extractor = new TAFeaExt::HKSDescExtraction();
+			extractor->setTypeOfLaplacian(params.m_LaplacianType);
+			extractor->setNumberOfEigenVals((unsigned int)params.m_nNumberOfEigenVals);
+			extractor->setAdaptiveEigenCount(params.m_bAdaptiveEigenCount);
+			extractor->setHeatKernelBackend(params.m_HeatKernelBackend);
+			extractor->setChebyshevMaxDegree((unsigned int)params.m_nChebyshevMaxDegree);
+			extractor->setNumberOfProbeVectors((unsigned int)params.m_nNumberOfProbeVectors);
+			//Time boundaries are calculated from the eigen values unless both are given, the adaptive eigen count stops at the minimum time anyway
+			if (params.m_fMinTime > 0.0)
+			{
+				extractor->setMinTimeVal(params.m_fMinTime);
+			}
+			if (params.m_fMinTime > 0.0 && params.m_fMaxTime > 0.0)
+			{
+				extractor->setUseEigenValuesForTimeBoundaries(false);
+				extractor->setMaxTimeVal(params.m_fMaxTime);
+			}
+			return extractor;
+		}
+		else if (descType == "wks")
+		{
+			TAFeaExt::WKSDescExtraction* extractor = new TAFeaExt::WKSDescExtraction();
+			extractor->setTypeOfLaplacian(params.m_LaplacianType);
+			extractor->setNumberOfEigenVals((unsigned int)params.m_nNumberOfEigenVals);
+			extractor->setAdaptiveEigenCount(params.m_bAdaptiveEigenCount);
+			return extractor;
+		}
+		return NULL;
+	}
+
+	//Names and values of the parameters of a descriptor type kept in its feature files
+	std::vector<std::pair<std::string, std::string> > getParameterValues(const std::string& descType, const DescriptorParameters& params)
+	{
+		std::vector<std::pair<std::string, std::string> > values;
+		values.push_back(std::make_pair(std::string("DescriptorType"), descType));
+		if (descType == "scd" || descType == "pbsd")
+		{
+			values.push_back(std::make_pair(std::string("MinGeodesicDistance"), TACore::StringUtil::str(params.m_fMinGeodesicDistance)));
+			values.push_back(std::make_pair(std::string("MaxGeodesicDistance"), TACore::StringUtil::str(params.m_fMaxGeodesicDistance)));
+			values.push_back(std::make_pair(std::string("NumberOfPatches"), TACore::StringUtil::str(params.m_nNumberOfPatches)));
+		}
+		if (descType == "scd" && params.m_SpreadMeasure != TAFeaExt::PatchBasedSumOfCenterDistancesExtraction::MEAN_DISTANCE_TO_CENTER)
+		{
+			values.push_back(std::make_pair(std::string("SpreadMeasure"), TACore::StringUtil::str((int)params.m_SpreadMeasure)));
+		}
+		if (descType == "pbsd")
+		{
+			values.push_back(std::make_pair(std::string("NumberOfBins"), TACore::StringUtil::str(params.m_nNumberOfBins)));
+			values.push_back(std::make_pair(std::string("SampleCount"), TACore::StringUtil::str(params.m_nSampleCount)));
+			values.push_back(std::make_pair(std::string("SamplingMethod"), TACore::StringUtil::str(params.m_nSamplingMethod)));
+			values.push_back(std::make_pair(std::string("ShapeDistributionFunction"), TACore::StringUtil::str(params.m_nShapeDistributionFunction)));
+			values.push_back(std::make_pair(std::string("RandomSeed"), TACore::StringUtil::str(params.m_nRandomSeed)));
+		}
+		if (descType == "hks" || descType == "wks")
+		{
+			values.push_back(std::make_pair(std::string("Laplacian"), TACore::StringUtil::str((int)params.m_LaplacianType)));
+			values.push_back(std::make_pair(std::string("NumberOfEigenVals"), TACore::StringUtil::str(params.m_nNumberOfEigenVals)));
+			values.push_back(std::make_pair(std::string("AdaptiveEigenCount"), TACore::StringUtil::str((int)params.m_bAdaptiveEigenCount)));
+		}
+		if (descType == "hks")
+		{
+			values.push_back(std::make_pair(std::string("HeatKernelBackend"), TACore::StringUtil::str((int)params.m_HeatKernelBackend)));
+			if (params.m_fMinTime > 0.0 && params.m_fMaxTime > 0.0)
+			{
+				values.push_back(std::make_pair(std::string("MinTime"), TACore::StringUtil::str(params.m_fMinTime)));
+				values.push_back(std::make_pair(std::string("MaxTime"), TACore::StringUtil::str(params.m_fMaxTime)));
+			}
+		}
+		return values;
+	}
+
+	//Reads the mesh paths of a manifest, one path in each line, relative paths are relative to the folder of the manifest
+	//Empty lines and lines starting with # are skipped
+	bool readManifest(const std::string& manifestPath, std::vector<std::string>& meshPaths)
+	{
+		std::ifstream manifest(manifestPath.c_str());
+		if (!manifest.is_open())
+		{
+			return false;
+		}
+
+		const std::string manifestFolder = TACore::PathUtil::getFolderNameFromPath(manifestPath);
+		const bool isInCurrentFolder = (manifestFolder == manifestPath);
+		std::string line;
+		while (std::getline(manifest, line))
+		{
+			line = TACore::StringUtil::trim(line);
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+			meshPaths.push_back(isInCurrentFolder ? line : TACore::PathUtil::joinPath(manifestFolder, line));
+		}
+		return true;
+	}
+
+	//Parses a mesh and passes it to the extraction, waits while the queue holds enough meshes
+	//Returns false if the queue is closed
+	bool loadMesh(LoaderContext* context, const std::string& meshPath, const std::string& jobName)
+	{
+		TACore::Timer timer;
+		LoadedMesh loaded;
+		loaded.m_sPath = meshPath;
+		loaded.m_sJobName = jobName;
+		loaded.m_pMesh = TriangularMeshPtr(new TAShape::TriangularMesh());
+		if (loaded.m_pMesh->load(meshPath.c_str()) != TACore::TACORE_OK || loaded.m_pMesh->verts.empty())
+		{
+			loaded.m_pMesh.reset();
+		}
+		//Without its low resolution version the eigen decomposition of the mesh is cold
+		if (loaded.m_pMesh && !context->m_sCoarseSuffix.empty())
+		{
+			const std::string coarseMeshPath = getCoarseMeshPath(meshPath, context->m_sCoarseSuffix);
+			loaded.m_pCoarseMesh = TriangularMeshPtr(new TAShape::TriangularMesh());
+			if (loaded.m_pCoarseMesh->load(coarseMeshPath.c_str()) != TACore::TACORE_OK || loaded.m_pCoarseMesh->verts.empty())
+			{
+				std::cout << "Coarse mesh " << coarseMeshPath << " cannot be loaded, eigen decomposition of " << meshPath << " is not seeded" << std::endl;
+				loaded.m_pCoarseMesh.reset();
+			}
+		}
+		loaded.m_fLoadSeconds = timer.seconds();
+
+		unsigned long long bytes = loaded.m_pMesh ? estimateMeshBytes(*loaded.m_pMesh) : 0;
+		if (loaded.m_pCoarseMesh)
+		{
+			bytes += estimateMeshBytes(*loaded.m_pCoarseMesh);
+		}
+		return context->m_pQueue->push(loaded, bytes);
+	}
+
+	//Parses the meshes one after the other, with a job queue until no job is left
+	void runLoader(LoaderContext* context)
+	{
+		if (context->m_pJobQueue == NULL)
+		{
+			const std::vector<std::string>& meshPaths = *context->m_pMeshPaths;
+			for (size_t m = 0; m < meshPaths.size(); m++)
+			{
+				if (!loadMesh(context, meshPaths[m], ""))
+				{
+					break;
+				}
+			}
+		}
+		else
+		{
+			//Content of a job is the path of its mesh
+			std::string jobName;
+			std::string jobContent;
+			while (context->m_pJobQueue->waitForJob(MESH_JOB_PREFIX, context->m_nJobTimeout, JOB_POLL_INTERVAL_IN_SECONDS, jobName, jobContent))
+			{
+				if (!loadMesh(context, TACore::StringUtil::trim(jobContent), jobName))
+				{
+					break;
+				}
+			}
+		}
+		context->m_pQueue->close();
+	}
+
+	//Writes the feature files of the extracted meshes and reports the timings of each mesh
+	void runWriter(WriterContext* context)
+	{
+		ExtractedMesh extracted;
+		while (context->m_pQueue->pop(extracted))
+		{
+			//Descriptors which are extracted are written even if the others failed
+			TACore::Timer timer;
+			bool isExtracted = extracted.m_bIsLoaded;
+			bool isWritten = true;
+			for (size_t d = 0; d < extracted.m_vResults.size(); d++)
+			{
+				if (extracted.m_vResults[d] != TACore::TACORE_OK)
+				{
+					isExtracted = false;
+				}
+				else if (TAFea::TAFeatureFileIO::writeFeatures(extracted.m_vFeatures[d], extracted.m_vFeatureFileInfos[d], extracted.m_vFeatureFilePaths[d]) != TACore::TACORE_OK)
+				{
+					isWritten = false;
+				}
+			}
+			const double writeSeconds = timer.seconds();
+			context->m_fTotalWriteSeconds += writeSeconds;
+
+			std::string status = "OK";
+			if (!extracted.m_bIsLoaded)
+			{
+				status = "LOAD_ERROR";
+			}
+			else if (!isExtracted)
+			{
+				status = "EXTRACTION_ERROR";
+			}
+			else if (!isWritten)
+			{
+				status = "WRITE_ERROR";
+			}
+			context->m_nNumberOfMeshes++;
+			if (status != "OK")
+			{
+				context->m_nNumberOfFailedMeshes++;
+			}
+			if (context->m_pJobQueue != NULL && context->m_pJobQueue->finishJob(extracted.m_sJobName, status == "OK") != TACore::TACORE_OK)
+			{
+				std::cout << "Job " << extracted.m_sJobName << " is taken back from this worker, it is run again by another one" << std::endl;
+			}
+
+			const std::string meshName = TACore::PathUtil::getFileNameFromPath(extracted.m_sPath);
+			std::cout << meshName << ": " << extracted.m_nNumberOfVertices << " vertices, load " << extracted.m_fLoadSeconds << " secs, extract "
+				<< extracted.m_fExtractSeconds << " secs, write " << writeSeconds << " secs, " << status << std::endl;
+			if (context->m_pReport != NULL)
+			{
+				if (context->m_pJobQueue != NULL)
+				{
+					*context->m_pReport << extracted.m_sJobName << ",";
+				}
+				*context->m_pReport << meshName << "," << extracted.m_nNumberOfVertices << "," << extracted.m_fLoadSeconds << ","
+					<< extracted.m_fExtractSeconds << "," << writeSeconds << "," << status << std::endl;
+			}
+
+			extracted = ExtractedMesh();
+		}
+	}
+
+	//Gets the reports written by the worker processes of a job queue, they are named after the report followed by the worker id
+	void getWorkerReportPaths(const std::string& reportPath, std::vector<std::string>& outPaths)
+	{
+		outPaths.clear();
+		std::string reportFolder = TACore::PathUtil::getFolderNameFromPath(reportPath);
+		if (reportFolder == "")
+		{
+			reportFolder = ".";
+		}
+		const std::string reportFileName = TACore::PathUtil::getFileNameFromPath(reportPath) + ".";
+		std::vector<std::string> paths;
+		TACore::PathUtil::getDirectoryEntries(reportFolder, paths);
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			const std::string fileName = TACore::PathUtil::getFileNameFromPath(paths[i]);
+			if (fileName.size() > reportFileName.size() && fileName.compare(0, reportFileName.size(), reportFileName) == 0
+				&& TACore::PathUtil::getExtension(fileName) != "tmp")
+			{
+				outPaths.push_back(paths[i]);
+			}
+		}
+	}
+
+	//Merges the reports of the workers into one report in the order of the jobs, i.e. the order of the meshes when they are enqueued
+	//A mesh run twice, e.g. after its worker is assumed dead, keeps its successful row, the worker reports are removed once merged
+	bool mergeWorkerReports(const std::string& reportPath, size_t& outNumberOfMeshes)
+	{
+		std::vector<std::string> workerReportPaths;
+		getWorkerReportPaths(reportPath, workerReportPaths);
+		std::map<std::string, std::string> rowsOfJobs;
+		for (size_t i = 0; i < workerReportPaths.size(); i++)
+		{
+			std::ifstream workerReport(workerReportPaths[i].c_str());
+			std::string line;
+			while (std::getline(workerReport, line))
+			{
+				line = TACore::StringUtil::trim(line);
+				const size_t jobEnd = line.find(',');
+				if (line.empty() || jobEnd == std::string::npos || line.compare(0, MESH_JOB_PREFIX.size(), MESH_JOB_PREFIX) != 0)
+				{
+					continue;
+				}
+				const std::string jobName = line.substr(0, jobEnd);
+				const std::string row = line.substr(jobEnd + 1);
+				std::map<std::string, std::string>::iterator it = rowsOfJobs.find(jobName);
+				if (it == rowsOfJobs.end() || row.substr(row.rfind(',') + 1) == "OK")
+				{
+					rowsOfJobs[jobName] = row;
+				}
+			}
+		}
+
+		const std::string temporaryReportPath = reportPath + ".tmp";
+		std::ofstream report(temporaryReportPath.c_str(), std::ios::trunc);
+		report << REPORT_HEADER << std::endl;
+		for (std::map<std::string, std::string>::const_iterator it = rowsOfJobs.begin(); it != rowsOfJobs.end(); ++it)
+		{
+			report << it->second << std::endl;
+		}
+		report.close();
+		if (report.fail() || !TACore::PathUtil::moveFile(temporaryReportPath, reportPath))
+		{
+			remove(temporaryReportPath.c_str());
+			return false;
+		}
+
+		for (size_t i = 0; i < workerReportPaths.size(); i++)
+		{
+			remove(workerReportPaths[i].c_str());
+		}
+		outNumberOfMeshes = rowsOfJobs.size();
+		return true;
+	}
+}
+
+BatchFeatureExtractionMain::Result BatchFeatureExtractionMain::run(int argc, char* argv[])
+{
+	Result res = BFER_OK;
+
+	// Parse args
+	TACore::ArgParser parser("BatchFeatureExtractionMain::Run", "Runs feature extraction tool for all meshes of a folder or a manifest");
+	parser.addArg("input-folder", "", false, 1, "", "Folder whose meshes are processed");
+	parser.addArg("mesh-ext", "", false, 1, "off", "Extension of the meshes taken from the input folder");
+	parser.addArg("manifest", "", false, 1, "", "File listing the meshes to be processed, one path in each line");
+	parser.addArg("desc-types", "", true, 1, "", "Comma separated types of the descriptors extracted: agd, scd, pbsd, hks, wks");
+	parser.addArg("out-fea-folder", "", true, 1, "", "The folder in which the output feature files are created, named after the mesh, 8 hex digits of the hash of its absolute path and the descriptor type");
+	parser.addArg("report-path", "", false, 1, "", "Csv file to which the timings of each mesh are written");
+	parser.addArg("min-gd", "", false, 1, "20", "Minimum geodesic distance of the patches of scd and pbsd");
+	parser.addArg("max-gd", "", false, 1, "100", "Maximum geodesic distance of the patches of scd and pbsd");
+	parser.addArg("no-patches", "", false, 1, "10", "Number of patches of scd and pbsd");
+	parser.addArg("scd-spread", "", false, 1, "mean", "Spread of scd around the patch centers: mean is the original descriptor and visits the vertices of each patch, rms is found for all patches in a single pass over the biggest patch but its descriptors differ from the mean ones");
+	parser.addArg("no-bins", "", false, 1, "8", "Number of bins of pbsd");
+	parser.addArg("sample-count", "", false, 1, "256", "Number of samples of each patch of pbsd");
+	parser.addArg("sampling-method", "", false, 1, "1", "Sampling method of pbsd, see PatchBasedShapeDistributionDescExtraction::SamplingMethod");
+	parser.addArg("sdf", "", false, 1, "3", "Shape distribution function of pbsd, see PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction");
+	parser.addArg("random-seed", "", false, 1, "5489", "Seed of the random sampling, same seed gives the same features");
+	parser.addArg("laplacian", "", false, 1, "star", "Laplacian of hks and wks: star or discrete");
+	parser.addArg("no-eigen-vals", "", false, 1, "125", "Number of eigen values of hks and wks, the upper limit in the adaptive eigen count mode");
+	parser.addArg("adaptive-eigen", "", false, 1, "0", "If 1, eigen values of hks are calculated in blocks until the rest are insignificant at the minimum time of hks, see --hks-min-time");
+	parser.addArg("hks-backend", "", false, 1, "eigen", "Backend of hks: eigen evaluates the heat kernel from the eigen decomposition of the laplacian, chebyshev approximates it by Chebyshev polynomials of the laplacian without eigen decomposition");
+	parser.addArg("hks-min-time", "", false, 1, "", "Minimum time of hks, time boundaries are calculated from the eigen values if they are not given. Needed by the chebyshev backend, the adaptive eigen count stops at it");
+	parser.addArg("hks-max-time", "", false, 1, "", "Maximum time of hks, time boundaries are calculated from the eigen values if they are not given. Needed by the chebyshev backend");
+	parser.addArg("hks-max-degree", "", false, 1, "500", "Maximum degree of the Chebyshev expansions of the chebyshev backend of hks");
+	parser.addArg("hks-probes", "", false, 1, "64", "Number of probe vectors of the chebyshev backend of hks");
+	parser.addArg("coarse-suffix", "", false, 1, "", "Suffix of the low resolution versions of the meshes, e.g. LowReso. If given, eigen decompositions of hks and wks are seeded from the low resolution version next to each mesh, which is not processed itself");
+	parser.addArg("coarse-validations", "", false, 1, "1", "Number of meshes whose eigen decompositions seeded from the low resolution versions are compared with cold ones, to report the speedup and the eigen value error");
+	parser.addArg("pipeline-workers", "", false, 1, "0", "Maximum number of descriptors and intermediates of a mesh extracted at the same time, 0 for the number of hardware threads");
+	parser.addArg("prefetch", "", false, 1, "2", "Maximum number of meshes loaded ahead of the extraction");
+	parser.addArg("prefetch-mb", "", false, 1, "1024", "Maximum memory in megabytes of the meshes loaded ahead of the extraction, 0 for no limit");
+	parser.addArg("queue-dir", "", false, 1, "", "Folder of a job queue shared by worker processes, possibly on several machines through a shared file system. All meshes are processed by this process if not given");
+	parser.addArg("role", "", false, 1, "worker", "Role of this process with a job queue: enqueue adds the meshes as jobs, worker processes the jobs until none is left, merge merges the reports of the workers");
+	parser.addArg("worker-id", "", false, 1, "", "Name of this worker in the job queue, its report is the report path followed by it. Defaults to the host name and the process id");
+	parser.addArg("job-timeout", "", false, 1, "3600", "Seconds after which a mesh whose worker stopped renewing its job is given to another worker, jobs are renewed every quarter of it");
+
+	if (!parser.parseCommandLine(argc, argv))
+	{
+		res = BFER_COMMAND_LINE_PARSE_ERROR;
+	}
+
+	//Without a queue all meshes are processed by this process
+	TACore::FileJobQueue jobQueue;
+	std::string role = "worker";
+	std::string workerId = "";
+	unsigned int jobTimeout = 0;
+	if (res == BFER_OK)
+	{
+		role = parser.get("role");
+		workerId = parser.exists("worker-id") ? parser.get("worker-id") : TACore::FileJobQueue::createWorkerId();
+		jobTimeout = (unsigned int)MAX(parser.getInt("job-timeout"), 1);
+		if ((role != "worker" && role != "enqueue" && role != "merge") || (role != "worker" && !parser.exists("queue-dir")))
+		{
+			std::cout << "Role " << role << " is not known or needs a queue folder" << std::endl;
+			res = BFER_COMMAND_LINE_PARSE_ERROR;
+		}
+		else if (parser.exists("queue-dir") && jobQueue.open(parser.get("queue-dir")) != TACore::TACORE_OK)
+		{
+			std::cout << "Queue folder " << parser.get("queue-dir") << " cannot be opened" << std::endl;
+			res = BFER_FILE_ERROR;
+		}
+	}
+
+	//Workers of a queue merge their reports only when all meshes are processed
+	if (res == BFER_OK && jobQueue.isOpen() && role == "merge")
+	{
+		std::vector<std::string> pendingJobs;
+		std::vector<std::string> runningJobs;
+		std::vector<std::string> failedJobs;
+		jobQueue.getJobNames(TACore::FileJobQueue::JOB_PENDING, MESH_JOB_PREFIX, pendingJobs);
+		jobQueue.getJobNames(TACore::FileJobQueue::JOB_RUNNING, MESH_JOB_PREFIX, runningJobs);
+		jobQueue.getJobNames(TACore::FileJobQueue::JOB_FAILED, MESH_JOB_PREFIX, failedJobs);
+		std::cout << "Number of Jobs Pending: " << pendingJobs.size() << ", Running: " << runningJobs.size() << ", Failed: " << failedJobs.size() << std::endl;
+
+		size_t numberOfMeshes = 0;
+		if (!pendingJobs.empty() || !runningJobs.empty())
+		{
+			res = BFER_UNFINISHED_ERROR;
+		}
+		else if (parser.exists("report-path") && !mergeWorkerReports(parser.get("report-path"), numberOfMeshes))
+		{
+			res = BFER_FILE_ERROR;
+		}
+		else
+		{
+			std::cout << "Number of Meshes Merged: " << numberOfMeshes << std::endl;
+		}
+	}
+
+	//Collect the meshes, workers of a queue take them from the jobs instead
+	std::vector<std::string> meshPaths;
+	if (res == BFER_OK && (!jobQueue.isOpen() || role == "enqueue"))
+	{
+		if (parser.exists("input-folder"))
+		{
+			TACore::PathUtil::getDirectoryEntries(parser.get("input-folder"), meshPaths, parser.get("mesh-ext"));
+		}
+		if (parser.exists("manifest") && !readManifest(parser.get("manifest"), meshPaths))
+		{
+			std::cout << "Manifest " << parser.get("manifest") << " cannot be read" << std::endl;
+		}
+		//Low resolution versions in the same folder only seed the eigen decompositions
+		const std::string coarseSuffix = parser.get("coarse-suffix");
+		if (!coarseSuffix.empty())
+		{
+			std::vector<std::string> fineMeshPaths;
+			for (size_t m = 0; m < meshPaths.size(); m++)
+			{
+				const std::string meshName = TACore::PathUtil::stripExtension(TACore::PathUtil::getFileNameFromPath(meshPaths[m]));
+				if (meshName.size() <= coarseSuffix.size() || meshName.compare(meshName.size() - coarseSuffix.size(), coarseSuffix.size(), coarseSuffix) != 0)
+				{
+					fineMeshPaths.push_back(meshPaths[m]);
+				}
+			}
+			meshPaths.swap(fineMeshPaths);
+		}
+		if (meshPaths.empty())
+		{
+			res = BFER_INPUT_ERROR;
+		}
+	}
+
+	DescriptorParameters params;
+	std::vector<std::string> descTypes;
+	if (res == BFER_OK)
+	{
+		params.m_fMinGeodesicDistance = (float)parser.getDouble("min-gd");
+		params.m_fMaxGeodesicDistance = (float)parser.getDouble("max-gd");
+		params.m_nNumberOfPatches = parser.getInt("no-patches");
+		params.m_SpreadMeasure = (parser.get("scd-spread") == "rms") ? TAFeaExt::PatchBasedSumOfCenterDistancesExtraction::RMS_DISTANCE_TO_CENTER
+			: TAFeaExt::PatchBasedSumOfCenterDistancesExtraction::MEAN_DISTANCE_TO_CENTER;
+		params.m_nNumberOfBins = parser.getInt("no-bins");
+		params.m_nSampleCount = parser.getInt("sample-count");
+		params.m_nSamplingMethod = parser.getInt("sampling-method");
+		params.m_nShapeDistributionFunction = parser.getInt("sdf");
+		params.m_nRandomSeed = (unsigned int)parser.getInt("random-seed");
+		params.m_LaplacianType = (parser.get("laplacian") == "discrete") ? TAFeaExt::SpectralDescExtraction::DISCRETE_LAPLACIAN : TAFeaExt::SpectralDescExtraction::STAR_LAPLACIAN;
+		params.m_HeatKernelBackend = (parser.get("hks-backend") == "chebyshev") ? TAFeaExt::HKSDescExtraction::HKS_BACKEND_CHEBYSHEV : TAFeaExt::HKSDescExtraction::HKS_BACKEND_EIGEN_DECOMPOSITION;
+		params.m_fMinTime = parser.getDouble("hks-min-time");
+		params.m_fMaxTime = parser.getDouble("hks-max-time");
+		params.m_nChebyshevMaxDegree = MAX(parser.getInt("hks-max-degree"), 1);
+		params.m_nNumberOfProbeVectors = MAX(parser.getInt("hks-probes"), 1);
+		params.m_nNumberOfEigenVals = MAX(parser.getInt("no-eigen-vals"), 2);
+		params.m_bAdaptiveEigenCount = parser.getBool("adaptive-eigen");
+		if ((parser.get("laplacian") != "star" && parser.get("laplacian") != "discrete") || (parser.get("hks-backend") != "eigen" && parser.get("hks-backend") != "chebyshev"))
+		{
+			std::cout << "Laplacian " << parser.get("laplacian") << " or hks backend " << parser.get("hks-backend") << " is not known" << std::endl;
+			res = BFER_COMMAND_LINE_PARSE_ERROR;
+		}
+		else if (parser.get("scd-spread") != "mean" && parser.get("scd-spread") != "rms")
+		{
+			std::cout << "Spread " << parser.get("scd-spread") << " of scd is not known" << std::endl;
+			res = BFER_COMMAND_LINE_PARSE_ERROR;
+		}
+		else if (params.m_HeatKernelBackend == TAFeaExt::HKSDescExtraction::HKS_BACKEND_CHEBYSHEV && !(params.m_fMinTime > 0.0 && params.m_fMaxTime >= params.m_fMinTime))
+		{
+			std::cout << "Chebyshev backend of hks needs positive time boundaries" << std::endl;
+			res = BFER_COMMAND_LINE_PARSE_ERROR;
+		}
+	}
+	if (res == BFER_OK)
+	{
+		std::vector<std::string> splitTypes;
+		TACore::StringUtil::split(parser.get("desc-types"), ',', splitTypes);
+		for (size_t i = 0; i < splitTypes.size(); i++)
+		{
+			const std::string descType = TACore::StringUtil::trim(splitTypes[i]);
+			TAFeaExt::PerVertexFeatureExtraction* extractor = createExtractor(descType, params);
+			if (extractor == NULL)
+			{
+				std::cout << "Unknown descriptor type " << descType << std::endl;
+				res = BFER_INPUT_ERROR;
+				break;
+			}
+			delete extractor;
+			descTypes.push_back(descType);
+		}
+	}
+
+	//Jobs are added in the order of the meshes, a mesh which is already pending or running is kept
+	//Relative paths would be resolved against the folder of each worker, so they are made absolute
+	if (res == BFER_OK && jobQueue.isOpen() && role == "enqueue")
+	{
+		size_t numberOfAdded = 0;
+		for (size_t m = 0; m < meshPaths.size(); m++)
+		{
+			const std::string meshPath = TACore::PathUtil::isAbsolutePath(meshPaths[m]) ? meshPaths[m] : TACore::PathUtil::joinPath(TACore::PathUtil::getCurrentDirectory(), meshPaths[m]);
+			const TACore::Result addResult = jobQueue.addJob(createMeshJobName(m, meshPath), meshPath);
+			if (addResult == TACore::TACORE_OK)
+			{
+				numberOfAdded++;
+			}
+			else if (addResult == TACore::TACORE_FILE_ERROR)
+			{
+				res = BFER_FILE_ERROR;
+			}
+		}
+		std::cout << "Number of Jobs Added: " << numberOfAdded << std::endl;
+	}
+
+	std::ofstream report;
+	if (res == BFER_OK && role == "worker" && parser.exists("report-path"))
+	{
+		report.open((jobQueue.isOpen() ? parser.get("report-path") + "." + workerId : parser.get("report-path")).c_str());
+		if (!report.is_open())
+		{
+			res = BFER_FILE_ERROR;
+		}
+		else
+		{
+			report << (jobQueue.isOpen() ? "Job," : "") << REPORT_HEADER << std::endl;
+		}
+	}
+
+	if (res == BFER_OK && role == "worker")
+	{
+		const std::string outFeaFolder = parser.get("out-fea-folder");
+		const int prefetch = parser.getInt("prefetch");
+		const unsigned long long prefetchInMB = (unsigned long long)parser.getInt("prefetch-mb");
+
+		if (!jobQueue.isOpen())
+		{
+			std::cout << "Number of Meshes: " << meshPaths.size() << std::endl;
+		}
+		TACore::Timer totalTimer;
+
+		//Extraction waits for at most one mesh being written and one waiting for it
+		TACore::BoundedQueue<LoadedMesh> loadedMeshes((size_t)MAX(prefetch, 1), prefetchInMB * 1024 * 1024);
+		TACore::BoundedQueue<ExtractedMesh> extractedMeshes(1, 0);
+
+		//Jobs are claimed by the loader ahead of the extraction, so all of them are renewed until they are finished by the writer
+		if (jobQueue.isOpen())
+		{
+			jobQueue.startHeartbeat(jobTimeout / JOB_RENEWALS_PER_TIMEOUT);
+		}
+
+		LoaderContext loaderContext;
+		loaderContext.m_pMeshPaths = &meshPaths;
+		loaderContext.m_pQueue = &loadedMeshes;
+		loaderContext.m_pJobQueue = jobQueue.isOpen() ? &jobQueue : NULL;
+		loaderContext.m_nJobTimeout = jobTimeout;
+		loaderContext.m_sCoarseSuffix = parser.get("coarse-suffix");
+		int numberOfCoarseValidations = parser.getInt("coarse-validations");
+		const int numberOfPipelineWorkers = parser.getInt("pipeline-workers");
+		WriterContext writerContext;
+		writerContext.m_pQueue = &extractedMeshes;
+		writerContext.m_pJobQueue = jobQueue.isOpen() ? &jobQueue : NULL;
+		writerContext.m_pReport = report.is_open() ? &report : NULL;
+		writerContext.m_nNumberOfMeshes = 0;
+		writerContext.m_nNumberOfFailedMeshes = 0;
+		writerContext.m_fTotalWriteSeconds = 0.0;
+
+		std::thread loaderThread(runLoader, &loaderContext);
+		std::thread writerThread(runWriter, &writerContext);
+
+		double totalLoadSeconds = 0.0;
+		double totalExtractSeconds = 0.0;
+		LoadedMesh loaded;
+		while (loadedMeshes.pop(loaded))
+		{
+			TACore::Timer timer;
+			ExtractedMesh extracted;
+			extracted.m_sPath = loaded.m_sPath;
+			extracted.m_sJobName = loaded.m_sJobName;
+			extracted.m_nNumberOfVertices = loaded.m_pMesh ? (int)loaded.m_pMesh->verts.size() : 0;
+			extracted.m_bIsLoaded = (bool)loaded.m_pMesh;
+			extracted.m_fLoadSeconds = loaded.m_fLoadSeconds;
+			totalLoadSeconds += loaded.m_fLoadSeconds;
+
+			if (loaded.m_pMesh)
+			{
+				//Extractors keep their intermediates, so they are created for each mesh
+				const unsigned long long meshHash = loaded.m_pMesh->calcContentHash();
+				const std::string outputBaseName = createOutputBaseName(loaded.m_sPath);
+				std::vector<TAFeaExt::PerVertexFeatureExtraction*> extractors(descTypes.size());
+				TAFeaExt::ExtractionPipeline pipeline;
+				if (numberOfPipelineWorkers > 0)
+				{
+					pipeline.setNumberOfWorkers((unsigned int)numberOfPipelineWorkers);
+				}
+				bool isCoarseToFine = false;
+				for (size_t d = 0; d < descTypes.size(); d++)
+				{
+					extractors[d] = createExtractor(descTypes[d], params);
+					TAFeaExt::SpectralDescExtraction* spectral = dynamic_cast<TAFeaExt::SpectralDescExtraction*>(extractors[d]);
+					if (spectral != NULL && loaded.m_pCoarseMesh)
+					{
+						spectral->setCoarseMesh(loaded.m_pCoarseMesh.get());
+						spectral->setValidateCoarseToFine(numberOfCoarseValidations > 0);
+						isCoarseToFine = true;
+					}
+					pipeline.addDescriptor(extractors[d]);
+				}
+				pipeline.run(loaded.m_pMesh.get());
+				if (isCoarseToFine)
+				{
+					numberOfCoarseValidations--;
+				}
+
+				for (size_t d = 0; d < descTypes.size(); d++)
+				{
+					TAFea::FeatureFileInfo featureFileInfo;
+					featureFileInfo.m_nMeshHash = meshHash;
+					featureFileInfo.m_vParameters = getParameterValues(descTypes[d], params);
+
+					extracted.m_vFeatureFilePaths.push_back(TACore::PathUtil::joinPath(outFeaFolder, TACore::PathUtil::addExtension(outputBaseName + "_" + descTypes[d], "fea")));
+					extracted.m_vFeatures.push_back(pipeline.getFeatures((int)d));
+					extracted.m_vFeatureFileInfos.push_back(featureFileInfo);
+					extracted.m_vResults.push_back(pipeline.getResult((int)d));
+					delete extractors[d];
+				}
+			}
+			loaded = LoadedMesh();
+
+			extracted.m_fExtractSeconds = timer.seconds();
+			totalExtractSeconds += extracted.m_fExtractSeconds;
+			extractedMeshes.push(extracted, 0);
+		}
+		extractedMeshes.close();
+		loaderThread.join();
+		writerThread.join();
+		jobQueue.stopHeartbeat();
+
+		std::cout << "Processed " << writerContext.m_nNumberOfMeshes << " meshes in " << totalTimer.seconds() << " secs, " << writerContext.m_nNumberOfFailedMeshes << " failed" << std::endl;
+		std::cout << "Total load " << totalLoadSeconds << " secs, extract " << totalExtractSeconds << " secs, write " << writerContext.m_fTotalWriteSeconds << " secs" << std::endl;
+	}
+
+	return res;
+}
@@ -25,8 +25,10 @@ MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain:
 	parser.addArg("src-desc-type", "", true, 1, "", "Type of the source descriptor read");
 	parser.addArg("ref-desc-type", "", true, 1, "", "Type of the reference descriptor extracted");
 	parser.addArg("input-src-fea-folder", "", true, 1, "", "Input folder for source features");
-	parser.addArg("ref-vertex", "", true, 1, "", "Reference vertex which is used to calculate comparison metrics");
+	parser.addArg("ref-vertex", "", true, 1, "", "Reference vertices which are used to calculate comparison metrics, separated by commas, e.g. 12,40,77");
 	parser.addArg("out-report-path", "", true, 1, "", "Path to output report file");
+	parser.addArg("out-score-matrix-path", "", false, 1, "", "Path to output csv file of the permutations x reference vertices scores");
+	parser.addArg("agd-source-samples", "", false, 1, "0", "Number of random source vertices the average geodesic distances are estimated from, 0 uses all vertices");
 
 	if (!parser.parseCommandLine(argc, argv))
 	{
@@ -39,8 +41,9 @@ MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain:
 		std::string srcDescType = parser.get("src-desc-type");
 		std::string refDescType = parser.get("ref-desc-type");
 		std::string inpSrcFeaFolder = parser.get("input-src-fea-folder");
-		int refVertex = parser.getInt("ref-vertex");
 		std::string outReportPath = parser.get("out-report-path");
+		std::string outScoreMatrixPath = parser.get("out-score-matrix-path");
+		const int agdSourceSamples = parser.getInt("agd-source-samples");
 
 		//Read the mesh
 		TAShape::TriangularMesh triMesh;
@@ -49,6 +52,28 @@ MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain:
 			res = MPFCR_MESH_LOAD_ERROR;
 		}
 
+		//All reference vertices are compared in the same pass over the feature files
+		std::vector<int> refVertices;
+		if (res == MPFCR_OK)
+		{
+			std::vector<std::string> refVertexValues = TACore::StringUtil::split(parser.get("ref-vertex"), ',');
+			for (size_t i = 0; i < refVertexValues.size(); i++)
+			{
+				const int refVertex = TACore::StringUtil::strToVal<int>(refVertexValues[i]);
+				if (refVertex < 0 || refVertex >= (int)triMesh.verts.size())
+				{
+					std::cerr << "Reference vertex " << refVertexValues[i] << " is not a vertex of the mesh!" << std::endl;
+					res = MPFCR_COMMAND_LINE_PARSE_ERROR;
+					break;
+				}
+				refVertices.push_back(refVertex);
+			}
+			if (refVertices.empty())
+			{
+				res = MPFCR_COMMAND_LINE_PARSE_ERROR;
+			}
+		}
+
 		if (res == MPFCR_OK)
 		{
 			std::vector<std::string> featureFilePaths;
@@ -71,105 +96,211 @@ MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain:
 			//Create the permutation id to source parameters map
 			std::map<int, std::vector< std::pair< std::string, double > > > srcPermutationParameters = createPermutationIdToParameterValuesMap(featureFilePaths);
 
-			//Comparison values of the source features from all permutation of parameters
-			std::map<int, std::vector<double> > srcPermutationMagnitudes;
-			
-			if (readPBSDSourcePermutations == true)
+			//Reference magnitudes are needed while the files are read, so they are created first
+			std::vector<std::vector<double> > refMagnitudes;
+			if (extractAGDReference == true)
 			{
-				srcPermutationMagnitudes = createPermutationIdToMagnitudesMapForPBSD(featureFilePaths, refVertex);
+				refMagnitudes = createAGDMagnitudes(&triMesh, refVertices, agdSourceSamples);
 			}
 
-			std::vector<double> refMagnitudes;
-			if (extractAGDReference == true)
+			//Scores of the source features from all permutation of parameters against all reference vertices
+			std::map<int, std::vector<double> > srcPermutationScores;
+			if (readPBSDSourcePermutations == true && !refMagnitudes.empty())
 			{
-				refMagnitudes = createAGDMagnitudes(&triMesh, refVertex);
+				srcPermutationScores = createPermutationIdToScoresMapForPBSD(featureFilePaths, refVertices, refMagnitudes, triMesh.calcContentHash());
 			}
 
-			res = generateComparisonResult(refMagnitudes, srcPermutationMagnitudes, srcPermutationParameters, outReportPath);
+			res = generateComparisonResult(srcPermutationScores, srcPermutationParameters, outReportPath);
+			if (res == MPFCR_OK && outScoreMatrixPath != "")
+			{
+				res = generateScoreMatrix(refVertices, srcPermutationScores, srcPermutationParameters, outScoreMatrixPath);
+			}
 		}
 	}
 	return res;
 }
 
-std::map<int, std::vector<double> > MultiParameterFeatureComparisonMain::createPermutationIdToMagnitudesMapForPBSD(const std::vector<std::string>& featureFilePaths, const int& refVertex)
+std::map<int, std::vector<double> > MultiParameterFeatureComparisonMain::createPermutationIdToScoresMapForPBSD(const std::vector<std::string>& featureFilePaths,
+																												const std::vector<int>& refVertices,
+																												const std::vector<std::vector<double> >& refMagnitudes,
+																												const unsigned long long& meshHash)
 {
-	std::map<int, std::vector<double> > resultMap;
-	for (size_t i = 0; i < featureFilePaths.size(); i++)
+	const int noFiles = (int)featureFilePaths.size();
+	const int noRefs = (int)refVertices.size();
+	std::vector<int> filePermutationIds(noFiles, -1);
+	std::vector<std::vector<double> > fileScores(noFiles);
+	int noProcessedFiles = 0;
+
+	//Each file is read and scored by a single thread, so only the scores of a file are kept instead of its magnitudes
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < noFiles; i++)
 	{
-		if (i < featureFilePaths.size() - 1)
-		{
-			std::cout << "%" << (100 * i) / featureFilePaths.size() << " completed for parsing the feature files" << "\r";
-		}
-		else
-		{
-			std::cout << "%" << 100 << " completed for parsing the feature files" << "\n";
-		}
-
-		const std::string filePath = featureFilePaths[i];
+		const std::string& filePath = featureFilePaths[i];
 		const std::string fileName = TACore::PathUtil::stripExtension(TACore::PathUtil::getFileNameFromPath(filePath));
 
 		std::vector<std::string> splitValues = TACore::StringUtil::split(fileName, '_');
 
 		const int permutationId = TACore::StringUtil::strToVal<int>(splitValues[0]); //permutationId must be in the 0th index.
 
-		std::vector<TAFea::LocalFeaturePtr> fileFeatures;
-		TAFea::TAFeatureFileIO::readPBSDInBinary(filePath, fileFeatures);
-
-		TAFea::PatchBasedShapeDistributionHistogram* feaV_Ref = (TAFea::PatchBasedShapeDistributionHistogram*)(fileFeatures[refVertex].get());
-		std::vector<double> magnitudes(fileFeatures.size());
-		for (size_t v = 0; v < fileFeatures.size(); v++)
+		const int noVerts = (int)refMagnitudes[0].size();
+		std::vector<double> magnitudes;
+		std::string skipReason;
+		if (TAFea::TAFeatureFileIO::isFeatureContainer(filePath))
+		{
+			//Distances are calculated over the mapped file, so no per vertex object is created
+			TAFea::MappedFeatureFile featureFile;
+			if (featureFile.open(filePath) != TACore::TACORE_OK)
+			{
+				skipReason = "cannot be read";
+			}
+			else if (featureFile.getInfo().m_nMeshHash != 0 && featureFile.getInfo().m_nMeshHash != meshHash)
+			{
+				skipReason = "is extracted from another mesh";
+			}
+			else if (featureFile.rows() != noVerts)
+			{
+				skipReason = "does not have a descriptor for each vertex";
+			}
+			else
+			{
+				//L2 norm of the patch distances is the L2 distance of the whole rows
+				const int noCols = featureFile.cols();
+				std::vector<double> refDescriptors((size_t)noRefs * noCols);
+				for (int r = 0; r < noRefs && noCols > 0; r++)
+				{
+					featureFile.readRow(refVertices[r], &refDescriptors[(size_t)r * noCols]);
+				}
+				featureFile.calcL2Distances(refDescriptors.empty() ? NULL : &refDescriptors[0], noRefs, magnitudes);
+			}
+		}
+		else
 		{
-			TAFea::PatchBasedShapeDistributionHistogram* feaVV = (TAFea::PatchBasedShapeDistributionHistogram*)(fileFeatures[v].get());
-			std::vector<double> vertexPatchMagnitudes(feaVV->m_vDescriptor.size());
-			for (size_t patchIdx = 0; patchIdx < vertexPatchMagnitudes.size(); patchIdx++)
+			//Files written by writePBSDInBinary before the feature container have neither a header nor a mesh hash
+			std::vector<LocalFeaturePtr> feas;
+			TAFea::FeatureMatrix<double> feaMatrix;
+			if (TAFea::TAFeatureFileIO::readPBSDInBinary(filePath, feas) != TACore::TACORE_OK || TAFea::createFeatureMatrix(feas, feaMatrix) != TACore::TACORE_OK)
 			{
-				vertexPatchMagnitudes[patchIdx] = StdVecL2Norm(feaVV->m_vDescriptor[patchIdx] - feaV_Ref->m_vDescriptor[patchIdx]);
+				skipReason = "cannot be read";
+			}
+			else if (feaMatrix.rows() != noVerts)
+			{
+				skipReason = "does not have a descriptor for each vertex";
+			}
+			else
+			{
+				magnitudes.resize((size_t)noRefs * noVerts);
+				for (int r = 0; r < noRefs; r++)
+				{
+					for (int v = 0; v < noVerts; v++)
+					{
+						magnitudes[(size_t)r * noVerts + v] = feaMatrix.L2Distance(v, refVertices[r]);
+					}
+				}
 			}
-			magnitudes[v] = StdVecL2Norm(vertexPatchMagnitudes);
 		}
 
-		const double maxMag = *std::max_element(magnitudes.begin(), magnitudes.end());
-		const double minMag = *std::min_element(magnitudes.begin(), magnitudes.end());
+		if (skipReason.empty())
+		{
+			std::vector<double> scores = calcScores(magnitudes, refMagnitudes);
 
-		for (size_t i = 0; i < magnitudes.size(); i++)
+			filePermutationIds[i] = permutationId;
+			fileScores[i].swap(scores);
+		}
+		else
 		{
-			magnitudes[i] = (magnitudes[i] - minMag) / (maxMag - minMag);
+#pragma omp critical
+			std::cerr << "Warning: " << filePath << " " << skipReason << ", skipped!" << std::endl;
 		}
 
-		resultMap[permutationId] = magnitudes;
+#pragma omp critical
+		{
+			noProcessedFiles++;
+			std::cout << "%" << (100 * noProcessedFiles) / noFiles << " completed for scoring the feature files" << ((noProcessedFiles < noFiles) ? "\r" : "\n");
+		}
+	}
+
+	std::map<int, std::vector<double> > resultMap;
+	for (int i = 0; i < noFiles; i++)
+	{
+		if (filePermutationIds[i] != -1)
+		{
+			resultMap[filePermutationIds[i]] = fileScores[i];
+		}
 	}
 
 	return resultMap;
 }
 
-std::vector<double> MultiParameterFeatureComparisonMain::createAGDMagnitudes(TAShape::TriangularMesh* triMesh, const int& refVertex)
+std::vector<double> MultiParameterFeatureComparisonMain::calcScores(std::vector<double>& magnitudes, const std::vector<std::vector<double> >& refMagnitudes)
 {
-	TAFeaExt::OnEdgeAvgGeoDistExtraction avgGeoExtractor;
-	std::vector<LocalFeaturePtr> feas;
-	avgGeoExtractor.extract(triMesh, feas);
+	const size_t noRefs = refMagnitudes.size();
+	const size_t noVerts = noRefs > 0 ? magnitudes.size() / noRefs : 0;
+	std::vector<double> scores(noRefs);
+	for (size_t r = 0; r < noRefs; r++)
+	{
+		double* refVertexMagnitudes = &magnitudes[r * noVerts];
+		const double maxMag = *std::max_element(refVertexMagnitudes, refVertexMagnitudes + noVerts);
+		const double minMag = *std::min_element(refVertexMagnitudes, refVertexMagnitudes + noVerts);
 
-	std::vector<double> magnitudes(feas.size());
-	AvgGeodesicDistance* avgGeoDistFeaPtrRefVertex = (AvgGeodesicDistance*)(feas[refVertex].get());
-	for (size_t v = 0; v < feas.size(); v++)
+		double sqScore = 0.0;
+		for (size_t v = 0; v < noVerts; v++)
+		{
+			refVertexMagnitudes[v] = (refVertexMagnitudes[v] - minMag) / (maxMag - minMag);
+			const double diff = refVertexMagnitudes[v] - refMagnitudes[r][v];
+			sqScore += diff * diff;
+		}
+		scores[r] = sqrt(sqScore);
+	}
+	return scores;
+}
+
+double MultiParameterFeatureComparisonMain::calcMeanScore(const std::vector<double>& scores)
+{
+	double meanScore = 0.0;
+	for (size_t r = 0; r < scores.size(); r++)
 	{
-		AvgGeodesicDistance* avgGeoDistFeaPtr = (AvgGeodesicDistance*)(feas[v].get());
-		magnitudes[v] = sqrt((avgGeoDistFeaPtr->m_distance - avgGeoDistFeaPtrRefVertex->m_distance) * 
-							(avgGeoDistFeaPtr->m_distance - avgGeoDistFeaPtrRefVertex->m_distance));
+		meanScore += scores[r];
 	}
+	return meanScore / scores.size();
+}
 
-	const double maxDistance = *std::max_element(magnitudes.begin(), magnitudes.end());
-	const double minDistance = *std::min_element(magnitudes.begin(), magnitudes.end());
+std::vector<std::vector<double> > MultiParameterFeatureComparisonMain::createAGDMagnitudes(TAShape::TriangularMesh* triMesh, const std::vector<int>& refVertices, const int& noSourceSamples)
+{
+	TAFeaExt::OnEdgeAvgGeoDistExtraction avgGeoExtractor;
+	avgGeoExtractor.setNumberOfSourceSamples(noSourceSamples);
+	std::vector<LocalFeaturePtr> feas;
+	if (avgGeoExtractor.extract(triMesh, feas) != TACore::TACORE_OK || feas.empty())
+	{
+		std::cerr << "Average geodesic distances cannot be extracted!" << std::endl;
+		return std::vector<std::vector<double> >();
+	}
 
-	for (size_t i = 0; i < magnitudes.size(); i++)
+	std::vector<std::vector<double> > refMagnitudes(refVertices.size());
+	for (size_t r = 0; r < refVertices.size(); r++)
 	{
-		magnitudes[i] = (magnitudes[i] - minDistance) / (maxDistance - minDistance);
+		std::vector<double>& magnitudes = refMagnitudes[r];
+		magnitudes.resize(feas.size());
+		AvgGeodesicDistance* avgGeoDistFeaPtrRefVertex = (AvgGeodesicDistance*)(feas[refVertices[r]].get());
+		for (size_t v = 0; v < feas.size(); v++)
+		{
+			AvgGeodesicDistance* avgGeoDistFeaPtr = (AvgGeodesicDistance*)(feas[v].get());
+			magnitudes[v] = sqrt((avgGeoDistFeaPtr->m_distance - avgGeoDistFeaPtrRefVertex->m_distance) *
+								(avgGeoDistFeaPtr->m_distance - avgGeoDistFeaPtrRefVertex->m_distance));
+		}
+
+		const double maxDistance = *std::max_element(magnitudes.begin(), magnitudes.end());
+		const double minDistance = *std::min_element(magnitudes.begin(), magnitudes.end());
+
+		for (size_t i = 0; i < magnitudes.size(); i++)
+		{
+			magnitudes[i] = (magnitudes[i] - minDistance) / (maxDistance - minDistance);
+		}
 	}
 
-	return magnitudes;
+	return refMagnitudes;
 }
 
-MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain::generateComparisonResult(const std::vector<double>& referenceMagnitudes, 
-																											const std::map<int, std::vector<double> >& permutationIdToSourceMagnitudesMap, 
+MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain::generateComparisonResult(const std::map<int, std::vector<double> >& permutationIdToScoresMap,
 																											const std::map<int, std::vector< std::pair< std::string, double > > >& permutationIdToParametersMap, 
 																											const std::string& outFileName)
 {
@@ -178,15 +309,15 @@ MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain:
 	std::ofstream out(outFileName, std::ios::out);
 	if (out.is_open())
 	{
-		std::map<double, int> scoreMap;
-		std::map<int, std::vector<double> >::const_iterator itr = permutationIdToSourceMagnitudesMap.begin();
-		for (; itr != permutationIdToSourceMagnitudesMap.end(); itr++)
+		std::multimap<double, int> scoreMap;
+		std::map<int, std::vector<double> >::const_iterator itr = permutationIdToScoresMap.begin();
+		for (; itr != permutationIdToScoresMap.end(); itr++)
 		{
-			const double scoreOfPermutation = StdVecL2Distance(itr->second, referenceMagnitudes);
-			scoreMap[scoreOfPermutation] = itr->first;
+			const double scoreOfPermutation = calcMeanScore(itr->second);
+			scoreMap.insert(std::make_pair(scoreOfPermutation, itr->first));
 		}
 
-		std::map<double, int>::const_iterator scitr = scoreMap.begin();
+		std::multimap<double, int>::const_iterator scitr = scoreMap.begin();
 		for (; scitr != scoreMap.end(); scitr++)
 		{
 			const std::vector< std::pair< std::string, double > >& paramVals = permutationIdToParametersMap.find(scitr->second)->second;
@@ -209,6 +340,59 @@ MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain:
 	return res;
 }
 
+MultiParameterFeatureComparisonMain::Result MultiParameterFeatureComparisonMain::generateScoreMatrix(const std::vector<int>& refVertices,
+																										const std::map<int, std::vector<double> >& permutationIdToScoresMap,
+																										const std::map<int, std::vector< std::pair< std::string, double > > >& permutationIdToParametersMap,
+																										const std::string& outFileName)
+{
+	Result res = MPFCR_OK;
+
+	std::ofstream out(outFileName, std::ios::out);
+	if (out.is_open())
+	{
+		//Parameter names are taken from the first permutation, all permutations have the same parameters
+		out << "PermutationId";
+		if (!permutationIdToScoresMap.empty())
+		{
+			const std::vector< std::pair< std::string, double > >& paramVals = permutationIdToParametersMap.find(permutationIdToScoresMap.begin()->first)->second;
+			for (size_t i = 0; i < paramVals.size(); i++)
+			{
+				out << "," << paramVals[i].first;
+			}
+		}
+		for (size_t r = 0; r < refVertices.size(); r++)
+		{
+			out << ",Ref_" << refVertices[r];
+		}
+		out << std::endl;
+
+		std::map<int, std::vector<double> >::const_iterator itr = permutationIdToScoresMap.begin();
+		for (; itr != permutationIdToScoresMap.end(); itr++)
+		{
+			const std::vector< std::pair< std::string, double > >& paramVals = permutationIdToParametersMap.find(itr->first)->second;
+			out << itr->first;
+			for (size_t i = 0; i < paramVals.size(); i++)
+			{
+				out << "," << paramVals[i].second;
+			}
+			for (size_t r = 0; r < itr->second.size(); r++)
+			{
+				out << "," << itr->second[r];
+			}
+			out << std::endl;
+		}
+
+		std::cout << "Score Matrix Generation is Completed..." << std::endl;
+
+		out.close();
+	}
+	else
+	{
+		res = MPFCR_FILE_ERROR;
+	}
+	return res;
+}
+
 std::map<int, std::vector< std::pair< std::string, double > > > MultiParameterFeatureComparisonMain::createPermutationIdToParameterValuesMap(const std::vector<std::string>& featureFilePaths)
 {
 	std::map<int, std::vector< std::pair< std::string, double > > > resultMap;
@@ -3,18 +3,564 @@
 #include <core/CommandLineParser.h>
 #include <core/TriangularMesh.h>
 #include <core/TriMeshAuxInfo.h>
-#include <core/StdVectorUtil.h>
+#include <core/FileCache.h>
+#include <core/FileJobQueue.h>
 #include <core/StringUtil.h>
 #include <core/PathUtil.h>
 #include <TAFeatureFileIO.h>
+#include <FeatureMatrix.h>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //Descriptors
 #include "GeodesicDistanceMatrix.h"
-#include "PatchBasedShapeDistributionHistogram.h"
 
 //Extractors
+#include "GeodesicDistanceMatrixExtraction.h"
 #include "PatchBasedShapeDistributionDescExtraction.h"
 
+namespace
+{
+	//Versions of the producers of the cache entries, a version must be increased when the content or the format of its entries changes
+	const unsigned int GEODESIC_DISTANCE_MATRIX_CACHE_VERSION = 1;
+	const unsigned int AUX_INFO_CACHE_VERSION = 1;
+	const unsigned int PATCHES_CACHE_VERSION = 1;
+	const unsigned int PBSD_FEATURES_CACHE_VERSION = 1;
+
+	//Loads the geodesic distance matrix from the given path, or from the cache, or calculates it and puts it into the cache
+	TACore::Result prepareGeodesicDistanceMatrix(TAShape::TriangularMesh& triMesh, const unsigned long long& meshHash, const std::string& gdMatrixPath,
+		TACore::FileCache& cache, TAFea::GlobalFeaturePtr& outGdMatrix)
+	{
+		TAFea::GeodesicDistanceMatrix* gdMatrix = new TAFea::GeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+		outGdMatrix = TAFea::GlobalFeaturePtr(gdMatrix);
+		if (gdMatrixPath != "")
+		{
+			return gdMatrix->m_GeoMatrix.loadBinary(gdMatrixPath) ? TACore::TACORE_OK : TACore::TACORE_FILE_ERROR;
+		}
+
+		std::vector<std::pair<std::string, std::string> > parameters;
+		parameters.push_back(std::make_pair(std::string("GeodesicDistanceType"), TACore::StringUtil::str((int)TAFea::GeodesicDistanceMatrix::ON_EDGE_GEODESIC)));
+		const std::string key = TACore::FileCache::createKey(meshHash, "GeodesicDistanceMatrix", GEODESIC_DISTANCE_MATRIX_CACHE_VERSION, parameters, "bin");
+		std::string cachedPath;
+		if (cache.find(key, cachedPath) && gdMatrix->m_GeoMatrix.loadBinary(cachedPath) && gdMatrix->m_GeoMatrix.rows() == (int)triMesh.verts.size())
+		{
+			return TACore::TACORE_OK;
+		}
+
+		TAFeaExt::GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
+		geoDistMatrixExtraction.setGeodesicDistanceType(TAFea::GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+		TACORE_CHECK_RESULT(geoDistMatrixExtraction.extract(&triMesh, outGdMatrix));
+		if (cache.isOpen())
+		{
+			const std::string temporaryPath = cache.getTemporaryPath(key);
+			if (((TAFea::GeodesicDistanceMatrix*)outGdMatrix.get())->m_GeoMatrix.saveBinary(temporaryPath))
+			{
+				cache.insert(key, temporaryPath);
+			}
+		}
+		return TACore::TACORE_OK;
+	}
+
+	//Loads the auxilary info from the given path, or from the cache, or calculates it and puts it into the cache
+	TACore::Result prepareAuxInfo(TAShape::TriangularMesh& triMesh, const unsigned long long& meshHash, const std::string& auxInfoPath,
+		TACore::FileCache& cache, TAShape::TriMeshAuxInfo& outAuxInfo)
+	{
+		if (auxInfoPath != "")
+		{
+			return outAuxInfo.load(auxInfoPath);
+		}
+
+		const std::string key = TACore::FileCache::createKey(meshHash, "AuxInfo", AUX_INFO_CACHE_VERSION, std::vector<std::pair<std::string, std::string> >(), "txt");
+		std::string cachedPath;
+		if (cache.find(key, cachedPath) && outAuxInfo.load(cachedPath) == TACore::TACORE_OK)
+		{
+			return TACore::TACORE_OK;
+		}
+
+		outAuxInfo = triMesh.calcAuxInfo();
+		if (cache.isOpen())
+		{
+			const std::string temporaryPath = cache.getTemporaryPath(key);
+			if (outAuxInfo.save(temporaryPath) == TACore::TACORE_OK)
+			{
+				cache.insert(key, temporaryPath);
+			}
+		}
+		return TACore::TACORE_OK;
+	}
+
+	//Saves a ply colored by the normalized distances of the descriptors to the descriptor of the reference vertex
+	void saveComparisonPly(TAShape::TriangularMesh& triMesh, const TAFea::FeatureMatrix<double>& feaMatrix, const int& refVertex, const std::string& plyFilePath)
+	{
+		std::vector<double> magnitudes(feaMatrix.rows());
+		for (int v = 0; v < feaMatrix.rows(); v++)
+		{
+			magnitudes[v] = feaMatrix.L2Distance(v, refVertex);
+		}
+
+		const double maxMag = *std::max_element(magnitudes.begin(), magnitudes.end());
+		const double minMag = *std::min_element(magnitudes.begin(), magnitudes.end());
+
+		for (size_t i = 0; i < magnitudes.size(); i++)
+		{
+			magnitudes[i] = (magnitudes[i] - minMag) / (maxMag - minMag);
+		}
+
+		triMesh.save(plyFilePath.c_str(), magnitudes);
+	}
+
+	//Header info of the feature file of a permutation, a feature file is valid only if its header has the same info
+	TAFea::FeatureFileInfo createFeatureFileInfo(const PBSDParameterSet& permutation, const unsigned long long& meshHash, const unsigned int& randomSeed, const int& exactSampleThreshold)
+	{
+		TAFea::FeatureFileInfo info;
+		info.m_nMeshHash = meshHash;
+		info.m_vParameters = permutation.getParameterValues();
+		info.m_vParameters.push_back(std::make_pair(std::string("RandomSeed"), TACore::StringUtil::str(randomSeed)));
+		info.m_vParameters.push_back(std::make_pair(std::string("ExactSampleThreshold"), TACore::StringUtil::str(exactSampleThreshold)));
+		return info;
+	}
+
+	//Checks whether a feature file is complete and holds the features of a mesh extracted with the given parameters
+	bool isFeatureFileValid(const std::string& featureFilePath, const TAFea::FeatureFileInfo& info, const int& numberOfVertices)
+	{
+		TAFea::MappedFeatureFile featureFile;
+		if (featureFile.open(featureFilePath) != TACore::TACORE_OK)
+		{
+			return false;
+		}
+		return featureFile.rows() == numberOfVertices
+			&& featureFile.getInfo().m_nMeshHash == info.m_nMeshHash
+			&& featureFile.getInfo().m_vParameters == info.m_vParameters;
+	}
+
+	//Marks the permutations completed by the previous runs in the journal, a missing journal marks none of them
+	//Each line is the name of a permutation which starts with its id, a line which is not the name of that permutation is ignored,
+	//e.g. a partially written last line of a killed run
+	//Marks are only added, so the journals of several workers can be read into the same vector
+	void readJournal(const std::string& journalPath, const std::vector<std::string>& permutationNames, std::vector<char>& outIsJournaled)
+	{
+		outIsJournaled.resize(permutationNames.size(), 0);
+		std::ifstream journal(journalPath.c_str());
+		std::string line;
+		while (std::getline(journal, line))
+		{
+			line = TACore::StringUtil::trim(line);
+			const size_t permId = (size_t)strtoul(line.c_str(), NULL, 10);
+			if (permId < permutationNames.size() && permutationNames[permId] == line)
+			{
+				outIsJournaled[permId] = 1;
+			}
+		}
+	}
+
+	//Gets the journals written by the worker processes of a job queue, they are named after the journal followed by the worker id
+	void getWorkerJournalPaths(const std::string& journalPath, std::vector<std::string>& outPaths)
+	{
+		outPaths.clear();
+		std::string journalFolder = TACore::PathUtil::getFolderNameFromPath(journalPath);
+		if (journalFolder == "")
+		{
+			journalFolder = ".";
+		}
+		const std::string journalFileName = TACore::PathUtil::getFileNameFromPath(journalPath) + ".";
+		std::vector<std::string> paths;
+		TACore::PathUtil::getDirectoryEntries(journalFolder, paths);
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			const std::string fileName = TACore::PathUtil::getFileNameFromPath(paths[i]);
+			if (fileName.size() > journalFileName.size() && fileName.compare(0, journalFileName.size(), journalFileName) == 0
+				&& TACore::PathUtil::getExtension(fileName) != "tmp")
+			{
+				outPaths.push_back(paths[i]);
+			}
+		}
+	}
+
+	//Content of the job of a patch group, the hash keeps a worker from extracting the job of another mesh with the same name
+	std::string createSweepJobContent(const unsigned long long& meshHash, const size_t& patchGroup)
+	{
+		return "MeshHash=" + TACore::StringUtil::str(meshHash) + "\nPatchGroup=" + TACore::StringUtil::str(patchGroup) + "\n";
+	}
+
+	//Parses the content of the job of a patch group, false if it is not a job of the mesh
+	bool parseSweepJobContent(const std::string& content, const unsigned long long& meshHash, const size_t& numberOfPatchGroups, size_t& outPatchGroup)
+	{
+		bool isMeshHashMatched = false;
+		bool isPatchGroupFound = false;
+		std::vector<std::string> lines = TACore::StringUtil::split(content, '\n');
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			const std::vector<std::string> keyValue = TACore::StringUtil::split(TACore::StringUtil::trim(lines[i]), '=');
+			if (keyValue.size() != 2)
+			{
+				continue;
+			}
+			if (keyValue[0] == "MeshHash")
+			{
+				isMeshHashMatched = (strtoull(keyValue[1].c_str(), NULL, 10) == meshHash);
+			}
+			else if (keyValue[0] == "PatchGroup")
+			{
+				outPatchGroup = (size_t)strtoul(keyValue[1].c_str(), NULL, 10);
+				isPatchGroupFound = (outPatchGroup < numberOfPatchGroups);
+			}
+		}
+		return isMeshHashMatched && isPatchGroupFound;
+	}
+
+	//Name of the job of a patch group, ids are padded so that jobs are claimed in the order of the groups
+	std::string createSweepJobName(const std::string& jobPrefix, const size_t& patchGroup)
+	{
+		std::string id = TACore::StringUtil::str(patchGroup);
+		if (id.size() < 6)
+		{
+			id.insert(0, 6 - id.size(), '0');
+		}
+		return jobPrefix + id;
+	}
+
+	//Time a worker sleeps while the remaining jobs are running on the other workers
+	const unsigned int JOB_POLL_INTERVAL_IN_SECONDS = 2;
+
+	//Claimed jobs are renewed this many times within the job timeout, so a late renewal does not lose a job
+	const unsigned int JOB_RENEWALS_PER_TIMEOUT = 4;
+
+	//State of a parameter sweep shared by its workers
+	//Geodesic distance matrix is set once through its once flag, members after the mutex are changed by the workers and guarded by it,
+	//the others are set before the workers start
+	struct SweepContext
+	{
+		TAShape::TriangularMesh* m_pMesh;
+		const TAShape::TriMeshAuxInfo* m_pAuxInfo;
+		TACore::FileCache* m_pCache;
+		const std::vector<PBSDParameterSet>* m_pPermutations;
+		const std::vector<std::string>* m_pPermutationNames;
+		const std::vector<std::vector<std::vector<size_t> > >* m_pPermutationGroups;
+		const std::vector<char>* m_pIsCompleted;
+		unsigned long long m_nMeshHash;
+		std::string m_sGdMatrixPath;
+		std::string m_sOutFeaFolder;
+		std::string m_sOutPlyFolder;
+		int m_nRefVertex;
+		bool m_bCreateComparisonPly;
+		unsigned int m_nRandomSeed;
+		int m_nExactSampleThreshold;
+		bool m_bUsePatchCache;
+		bool m_bUseFeatureCache;
+		TACore::FileJobQueue* m_pQueue;
+		std::string m_sJobPrefix;
+		unsigned int m_nJobTimeout;
+		int m_nNumberOfThreadsPerWorker;
+		std::atomic<size_t> m_nNextPatchGroup;
+
+		std::once_flag m_GdMatrixOnceFlag;
+		TAFea::GlobalFeaturePtr m_pGdMatrix;
+
+		std::mutex m_Mutex;
+		std::ofstream m_Journal;
+		size_t m_nNumberOfCompleted;
+		size_t m_nNumberOfFailed;
+	};
+
+	//Prepares the geodesic distance matrix shared by the workers, called once through the once flag of the context
+	//Matrix is left empty if it cannot be prepared, so the workers needing it fail without trying again
+	void prepareSharedGeodesicDistanceMatrix(SweepContext* context)
+	{
+		if (prepareGeodesicDistanceMatrix(*context->m_pMesh, context->m_nMeshHash, context->m_sGdMatrixPath, *context->m_pCache, context->m_pGdMatrix) != TACore::TACORE_OK)
+		{
+			std::cout << "Geodesic distance matrix cannot be prepared" << std::endl;
+			context->m_pGdMatrix.reset();
+		}
+	}
+
+	//Header info, cache key and path of the feature file of a permutation of a sweep
+	void createFeatureFileEntry(SweepContext* context, const size_t& permId, TAFea::FeatureFileInfo& outInfo, std::string& outCacheKey, std::string& outPath)
+	{
+		outInfo = createFeatureFileInfo((*context->m_pPermutations)[permId], context->m_nMeshHash, context->m_nRandomSeed, context->m_nExactSampleThreshold);
+		outCacheKey = TACore::FileCache::createKey(context->m_nMeshHash, "PatchBasedShapeDistribution", PBSD_FEATURES_CACHE_VERSION, outInfo.m_vParameters, "fea");
+		outPath = TACore::PathUtil::joinPath(context->m_sOutFeaFolder, TACore::PathUtil::addExtension((*context->m_pPermutationNames)[permId], "fea"));
+	}
+
+	//Records the outcome of a permutation, a completed one is appended to the journal after all of its outputs are written
+	void finishPermutation(SweepContext* context, const size_t& permId, const bool& isCompleted)
+	{
+		std::lock_guard<std::mutex> lock(context->m_Mutex);
+		if (isCompleted)
+		{
+			context->m_Journal << (*context->m_pPermutationNames)[permId] << std::endl;
+			context->m_nNumberOfCompleted++;
+			std::cout << "Completed " << (*context->m_pPermutationNames)[permId] << std::endl;
+		}
+		else
+		{
+			context->m_nNumberOfFailed++;
+			std::cout << "Failed " << (*context->m_pPermutationNames)[permId] << std::endl;
+		}
+	}
+
+	//Extracts the permutations of a patch group which are not completed yet
+	//Returns false if some of them cannot be extracted or written
+	bool extractPatchGroup(SweepContext* context, const size_t& patchGroup)
+	{
+		TAShape::TriangularMesh& triMesh = *context->m_pMesh;
+		TACore::FileCache& cache = *context->m_pCache;
+		const std::vector<PBSDParameterSet>& permutations = *context->m_pPermutations;
+		const std::vector<std::vector<size_t> >& sampleGroups = (*context->m_pPermutationGroups)[patchGroup];
+		const PBSDParameterSet& patchParameters = permutations[sampleGroups[0][0]];
+
+		//Extractor keeps the patches after the first extraction, so they are created once for the group
+		TAFeaExt::PatchBasedShapeDistributionDescExtraction patchBasedExtractor;
+		patchBasedExtractor.setMinGeodesicDistance(patchParameters.m_fMinGeodesicDistance);
+		patchBasedExtractor.setMaxGeodesicDistance(patchParameters.m_fMaxGeodesicDistance);
+		patchBasedExtractor.setNumberOfPatches(patchParameters.m_nNumberOfPatches);
+		patchBasedExtractor.setRandomSeed(context->m_nRandomSeed);
+		patchBasedExtractor.setExactSampleThreshold(context->m_nExactSampleThreshold);
+
+		std::vector<std::pair<std::string, std::string> > patchCacheParameters;
+		patchCacheParameters.push_back(std::make_pair(std::string("MinGeodesicDistance"), TACore::StringUtil::str(patchParameters.m_fMinGeodesicDistance)));
+		patchCacheParameters.push_back(std::make_pair(std::string("MaxGeodesicDistance"), TACore::StringUtil::str(patchParameters.m_fMaxGeodesicDistance)));
+		patchCacheParameters.push_back(std::make_pair(std::string("NumberOfPatches"), TACore::StringUtil::str(patchParameters.m_nNumberOfPatches)));
+		const std::string patchCacheKey = TACore::FileCache::createKey(context->m_nMeshHash, "Patches", PATCHES_CACHE_VERSION, patchCacheParameters, "pat");
+		bool arePatchesPrepared = false;
+		bool arePatchesCached = false;
+		bool isGroupCompleted = true;
+
+		//Sample groups whose permutations are extracted with an earlier group, since their features cannot differ
+		std::vector<char> isSampleGroupMerged(sampleGroups.size(), 0);
+		for (size_t sampleGroup = 0; sampleGroup < sampleGroups.size(); sampleGroup++)
+		{
+			if (isSampleGroupMerged[sampleGroup])
+			{
+				continue;
+			}
+
+			//Samples do not depend on the other groups, so completed permutations are skipped without changing the features of the others
+			std::vector<size_t> permIds;
+			for (size_t i = 0; i < sampleGroups[sampleGroup].size(); i++)
+			{
+				if (!(*context->m_pIsCompleted)[sampleGroups[sampleGroup][i]])
+				{
+					permIds.push_back(sampleGroups[sampleGroup][i]);
+				}
+			}
+			if (permIds.empty())
+			{
+				continue;
+			}
+			const PBSDParameterSet& sampleParameters = permutations[permIds[0]];
+
+			//Header infos, cache keys and paths of the feature files of the group
+			//Cached files are copied right away, an entry may be evicted by another process at any time,
+			//so the group is extracted if any of them cannot be copied and the copied files are overwritten
+			std::vector<TAFea::FeatureFileInfo> featureFileInfos(permIds.size());
+			std::vector<std::string> featureCacheKeys(permIds.size());
+			std::vector<std::string> featureFilePaths(permIds.size());
+			bool areFeaturesCached = context->m_bUseFeatureCache;
+			for (size_t binsIdx = 0; binsIdx < permIds.size(); binsIdx++)
+			{
+				createFeatureFileEntry(context, permIds[binsIdx], featureFileInfos[binsIdx], featureCacheKeys[binsIdx], featureFilePaths[binsIdx]);
+				areFeaturesCached = areFeaturesCached && cache.copyEntry(featureCacheKeys[binsIdx], featureFilePaths[binsIdx]) == TACore::TACORE_OK;
+			}
+
+			std::vector<std::vector<LocalFeaturePtr> > feasOfBins;
+			std::vector<size_t> binsOfPermutation(permIds.size());
+			if (!areFeaturesCached)
+			{
+				//Patches are taken from the cache or calculated from the geodesic distance matrix by the first extraction
+				if (!arePatchesPrepared)
+				{
+					std::string cachedPath;
+					arePatchesCached = context->m_bUsePatchCache && cache.find(patchCacheKey, cachedPath) && patchBasedExtractor.openPatchFile(cachedPath) == TACore::TACORE_OK;
+					if (!arePatchesCached)
+					{
+						//Geodesic distance matrix is prepared once by the first worker which needs it and then shared
+						//Other workers needing it wait for it, the ones with cached patches or features keep going
+						std::call_once(context->m_GdMatrixOnceFlag, prepareSharedGeodesicDistanceMatrix, context);
+						const TAFea::GlobalFeaturePtr gdMatrix = context->m_pGdMatrix;
+						if (!gdMatrix)
+						{
+							for (size_t binsIdx = 0; binsIdx < permIds.size(); binsIdx++)
+							{
+								finishPermutation(context, permIds[binsIdx], false);
+							}
+							isGroupCompleted = false;
+							continue;
+						}
+						patchBasedExtractor.setGeodesicDistanceMatrix((TAFea::GeodesicDistanceMatrix*)gdMatrix.get());
+					}
+					arePatchesPrepared = true;
+				}
+
+				patchBasedExtractor.setSampleCount(sampleParameters.m_nSampleCount);
+				patchBasedExtractor.setSamplingMethod(TAFeaExt::PatchBasedShapeDistributionDescExtraction::SamplingMethod(sampleParameters.m_nSamplingMethod));
+				patchBasedExtractor.setShapeDistributionFunction(TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(sampleParameters.m_nShapeDistributionFunction));
+				if (TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(sampleParameters.m_nShapeDistributionFunction)
+					== TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS
+					|| TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(sampleParameters.m_nShapeDistributionFunction)
+					== TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT)
+				{
+					patchBasedExtractor.setMaxPossibleSampleValue(context->m_pAuxInfo->m_lfMaxEucDistanceBetweenTwoVertices);
+				}
+				else if (TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(sampleParameters.m_nShapeDistributionFunction)
+					== TAFeaExt::PatchBasedShapeDistributionDescExtraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS)
+				{
+					patchBasedExtractor.setMaxPossibleSampleValue(sqrt(context->m_pAuxInfo->m_lfMaxAreaOfTriangleConstructedByThreeVertices));
+				}
+				else if (TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(sampleParameters.m_nShapeDistributionFunction)
+					== TAFeaExt::PatchBasedShapeDistributionDescExtraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS)
+				{
+					patchBasedExtractor.setMaxPossibleSampleValue(cbrt(context->m_pAuxInfo->m_lfMaxVolumeOfTetrahedronConstructedByForVertices));
+				}
+
+				//If every patch is enumerated exactly, the features do not depend on the sample count,
+				//so the pending permutations of the later groups differing only in the sample count are extracted and written with this group
+				bool isSampleCountIndependent = false;
+				if (patchBasedExtractor.isSampleCountIndependent(&triMesh, isSampleCountIndependent) == TACore::TACORE_OK && isSampleCountIndependent)
+				{
+					for (size_t laterGroup = sampleGroup + 1; laterGroup < sampleGroups.size(); laterGroup++)
+					{
+						if (isSampleGroupMerged[laterGroup] || !permutations[sampleGroups[laterGroup][0]].hasSameExactSamples(sampleParameters))
+						{
+							continue;
+						}
+						isSampleGroupMerged[laterGroup] = 1;
+						for (size_t i = 0; i < sampleGroups[laterGroup].size(); i++)
+						{
+							if (!(*context->m_pIsCompleted)[sampleGroups[laterGroup][i]])
+							{
+								permIds.push_back(sampleGroups[laterGroup][i]);
+							}
+						}
+					}
+					const size_t noFeatureFiles = featureFileInfos.size();
+					featureFileInfos.resize(permIds.size());
+					featureCacheKeys.resize(permIds.size());
+					featureFilePaths.resize(permIds.size());
+					binsOfPermutation.resize(permIds.size());
+					for (size_t binsIdx = noFeatureFiles; binsIdx < permIds.size(); binsIdx++)
+					{
+						createFeatureFileEntry(context, permIds[binsIdx], featureFileInfos[binsIdx], featureCacheKeys[binsIdx], featureFilePaths[binsIdx]);
+					}
+				}
+
+				//All numbers of bins of the group are filled from the same samples, each number once
+				std::vector<int> numbersOfBins;
+				for (size_t i = 0; i < permIds.size(); i++)
+				{
+					const int numberOfBins = permutations[permIds[i]].m_nNumberOfBins;
+					binsOfPermutation[i] = std::find(numbersOfBins.begin(), numbersOfBins.end(), numberOfBins) - numbersOfBins.begin();
+					if (binsOfPermutation[i] == numbersOfBins.size())
+					{
+						numbersOfBins.push_back(numberOfBins);
+					}
+				}
+				if (patchBasedExtractor.extractForNumbersOfBins(&triMesh, numbersOfBins, feasOfBins) != TACore::TACORE_OK)
+				{
+					for (size_t binsIdx = 0; binsIdx < permIds.size(); binsIdx++)
+					{
+						finishPermutation(context, permIds[binsIdx], false);
+					}
+					isGroupCompleted = false;
+					continue;
+				}
+
+				//Patches calculated by the first extraction of the group are put into the cache
+				if (context->m_bUsePatchCache && !arePatchesCached)
+				{
+					const std::string temporaryPath = cache.getTemporaryPath(patchCacheKey);
+					if (patchBasedExtractor.savePatchesInCompactBinary(*patchBasedExtractor.getPatchesForAllVertices(), temporaryPath) == TACore::TACORE_OK)
+					{
+						cache.insert(patchCacheKey, temporaryPath);
+					}
+					arePatchesCached = true;
+				}
+			}
+
+			for (size_t binsIdx = 0; binsIdx < permIds.size(); binsIdx++)
+			{
+				const std::string& permutationName = (*context->m_pPermutationNames)[permIds[binsIdx]];
+
+				//Write the binary file of features, unless it is copied from the cache
+				const std::string& featureFilePath = featureFilePaths[binsIdx];
+				TACore::Result writeResult = TACore::TACORE_OK;
+				if (!areFeaturesCached)
+				{
+					writeResult = TAFea::TAFeatureFileIO::writeFeatures(feasOfBins[binsOfPermutation[binsIdx]], featureFileInfos[binsIdx], featureFilePath);
+					if (writeResult == TACore::TACORE_OK && context->m_bUseFeatureCache)
+					{
+						cache.insertCopy(featureCacheKeys[binsIdx], featureFilePath);
+					}
+				}
+
+				//Write ply file with color according to a reference vertex
+				if (writeResult == TACore::TACORE_OK && context->m_bCreateComparisonPly == true)
+				{
+					TAFea::FeatureMatrix<double> feaMatrix;
+					writeResult = areFeaturesCached ? TAFea::TAFeatureFileIO::readFeatureMatrix(featureFilePath, feaMatrix)
+						: TAFea::createFeatureMatrix(feasOfBins[binsOfPermutation[binsIdx]], feaMatrix);
+					if (writeResult == TACore::TACORE_OK && context->m_nRefVertex < feaMatrix.rows())
+					{
+						const std::string plyFilePath = TACore::PathUtil::joinPath(context->m_sOutPlyFolder, TACore::PathUtil::addExtension(permutationName, "ply"));
+						saveComparisonPly(triMesh, feaMatrix, context->m_nRefVertex, plyFilePath);
+					}
+				}
+
+				finishPermutation(context, permIds[binsIdx], writeResult == TACore::TACORE_OK);
+				isGroupCompleted = isGroupCompleted && (writeResult == TACore::TACORE_OK);
+			}
+		}
+
+		return isGroupCompleted;
+	}
+
+	//Extracts the patch groups one after the other until no group is left, several workers share the groups
+	//With a job queue the groups are claimed from it, so workers of other processes share them too
+	void runSweepWorker(SweepContext* context)
+	{
+#ifdef _OPENMP
+		//Parallel loops of the extraction in a worker use its share of the threads, otherwise the workers together run workers x cores threads
+		omp_set_num_threads(context->m_nNumberOfThreadsPerWorker);
+#endif
+		if (context->m_pQueue == NULL)
+		{
+			for (size_t patchGroup = context->m_nNextPatchGroup++; patchGroup < context->m_pPermutationGroups->size(); patchGroup = context->m_nNextPatchGroup++)
+			{
+				extractPatchGroup(context, patchGroup);
+			}
+		}
+		else
+		{
+			std::string jobName;
+			std::string jobContent;
+			while (context->m_pQueue->waitForJob(context->m_sJobPrefix, context->m_nJobTimeout, JOB_POLL_INTERVAL_IN_SECONDS, jobName, jobContent))
+			{
+				size_t patchGroup = 0;
+				bool isJobDone = parseSweepJobContent(jobContent, context->m_nMeshHash, context->m_pPermutationGroups->size(), patchGroup);
+				if (!isJobDone)
+				{
+					std::lock_guard<std::mutex> lock(context->m_Mutex);
+					std::cout << "Job " << jobName << " does not belong to this mesh" << std::endl;
+				}
+				else
+				{
+					isJobDone = extractPatchGroup(context, patchGroup);
+				}
+				if (context->m_pQueue->finishJob(jobName, isJobDone) != TACore::TACORE_OK)
+				{
+					std::lock_guard<std::mutex> lock(context->m_Mutex);
+					std::cout << "Job " << jobName << " is taken back from this worker, it is run again by another one" << std::endl;
+				}
+			}
+		}
+	}
+}
+
 MultiParameterFeatureExtractionMain::Result MultiParameterFeatureExtractionMain::run(int argc, char* argv[])
 {
 	Result res = MPFER_OK;
@@ -23,11 +569,21 @@ MultiParameterFeatureExtractionMain::Result MultiParameterFeatureExtractionMain:
 	TACore::ArgParser parser("MultiParameterFeatureExtractionMain::Run", "Runs feature extraction tool for a specified feature for a set of parametes");
 	parser.addArg("input-mesh", "", true, 1, "", "Input shape file to be loaded");
 	parser.addArg("desc-type", "", true, 1, "", "Type of the descriptor extracted");
-	parser.addArg("gd-matrix-path", "", true, 1, "", "Geodesic distance matrix of the mesh for efficiency");
-	parser.addArg("aux-info-path", "", true, 1, "", "Auxilary information about the mesh for efficiency");
+	parser.addArg("gd-matrix-path", "", false, 1, "", "Geodesic distance matrix of the mesh, calculated or taken from the cache if not given");
+	parser.addArg("aux-info-path", "", false, 1, "", "Auxilary information about the mesh, calculated or taken from the cache if not given");
 	parser.addArg("out-fea-folder", "", true, 1, "", "The folder in which the output feature files are created");
 	parser.addArg("ref-vertex", "", false, 1, "", "Reference vertex which is compared to other vertices"); //If this is given, a color ply file is also created as output
 	parser.addArg("out-ply-folder", "", false, 1, "", "The folder in which the output ply files are created");
+	parser.addArg("random-seed", "", false, 1, "5489", "Seed of the random sampling, same seed gives the same features");
+	parser.addArg("exact-sample-threshold", "", false, 1, "0", "Patches with at most this many vertex combinations get exact histograms instead of sampled ones, 0 disables it. If all patches of a group get them, its sample counts are extracted once");
+	parser.addArg("cache-dir", "", false, 1, "", "Folder caching geodesic matrices, auxilary infos, patches and features by the content of the mesh and the parameters");
+	parser.addArg("cache-size-mb", "", false, 1, "10240", "Maximum size of the cache in megabytes, least recently used entries are removed beyond it, 0 for no limit");
+	parser.addArg("journal-path", "", false, 1, "", "Journal of the completed permutations, a rerun skips them. Defaults to the mesh name with _journal.txt in the output feature folder");
+	parser.addArg("workers", "", false, 1, "1", "Number of groups of permutations sharing the same patches which are extracted at the same time, the parallel loops of each group use an equal share of the threads");
+	parser.addArg("queue-dir", "", false, 1, "", "Folder of a job queue shared by worker processes, possibly on several machines through a shared file system. The whole sweep runs in this process if not given");
+	parser.addArg("role", "", false, 1, "worker", "Role of this process with a job queue: enqueue adds the unfinished groups as jobs, worker extracts the jobs until none is left, merge checks the outputs and merges the journals of the workers");
+	parser.addArg("worker-id", "", false, 1, "", "Name of this worker in the job queue, its journal is the journal path followed by it. Defaults to the host name and the process id");
+	parser.addArg("job-timeout", "", false, 1, "3600", "Seconds after which a job whose worker stopped renewing it is given to another worker, jobs are renewed every quarter of it");
 
 	if (!parser.parseCommandLine(argc, argv))
 	{
@@ -38,8 +594,16 @@ MultiParameterFeatureExtractionMain::Result MultiParameterFeatureExtractionMain:
 	{
 		std::string inputMeshFile = parser.get("input-mesh");
 		std::string descType = parser.get("desc-type");
-		std::string gdMatrixPath = parser.get("gd-matrix-path");
-		std::string auxInfoPath = parser.get("aux-info-path");
+		std::string gdMatrixPath = "";
+		if (parser.exists("gd-matrix-path"))
+		{
+			gdMatrixPath = parser.get("gd-matrix-path");
+		}
+		std::string auxInfoPath = "";
+		if (parser.exists("aux-info-path"))
+		{
+			auxInfoPath = parser.get("aux-info-path");
+		}
 		std::string outFeaFolder = parser.get("out-fea-folder");
 		int refVertex = -1;
 		if (parser.exists("ref-vertex"))
@@ -50,18 +614,66 @@ MultiParameterFeatureExtractionMain::Result MultiParameterFeatureExtractionMain:
 		if (parser.exists("out-ply-folder"))
 		{
 			outPlyFolder = parser.get("out-ply-folder");
-		}	
+		}
+		const unsigned int randomSeed = (unsigned int)parser.getInt("random-seed");
+		const int exactSampleThreshold = parser.getInt("exact-sample-threshold");
+		std::string cacheDir = "";
+		if (parser.exists("cache-dir"))
+		{
+			cacheDir = parser.get("cache-dir");
+		}
+		const unsigned long long cacheSizeInMB = (unsigned long long)parser.getInt("cache-size-mb");
+		std::string journalPath = TACore::PathUtil::joinPath(outFeaFolder, TACore::PathUtil::stripExtension(TACore::PathUtil::getFileNameFromPath(inputMeshFile)) + "_journal.txt");
+		if (parser.exists("journal-path"))
+		{
+			journalPath = parser.get("journal-path");
+		}
+		const int numberOfWorkers = MAX(parser.getInt("workers"), 1);
+		std::string queueDir = "";
+		if (parser.exists("queue-dir"))
+		{
+			queueDir = parser.get("queue-dir");
+		}
+		const std::string role = parser.get("role");
+		std::string workerId = TACore::FileJobQueue::createWorkerId();
+		if (parser.exists("worker-id"))
+		{
+			workerId = parser.get("worker-id");
+		}
+		const unsigned int jobTimeout = (unsigned int)MAX(parser.getInt("job-timeout"), 1);
+
+		//Roles other than worker only make sense with a queue
+		if ((role != "worker" && role != "enqueue" && role != "merge") || (role != "worker" && queueDir == ""))
+		{
+			std::cout << "Role " << role << " is not known or needs a queue folder" << std::endl;
+			res = MPFER_COMMAND_LINE_PARSE_ERROR;
+		}
 
 		//Decide whether or not to create ply outputs
 		const bool createComparisonPly = (refVertex != -1) && (outPlyFolder != "");
 
 		//Read the mesh
 		TAShape::TriangularMesh triMesh;
-		if (triMesh.load(inputMeshFile.c_str()) != TACore::TACORE_OK)
+		if (res == MPFER_OK && triMesh.load(inputMeshFile.c_str()) != TACore::TACORE_OK)
 		{
 			res = MPFER_MESH_LOAD_ERROR;
 		}
 
+		//Without a queue the whole sweep runs in this process
+		TACore::FileJobQueue queue;
+		if (res == MPFER_OK && queueDir != "" && queue.open(queueDir) != TACore::TACORE_OK)
+		{
+			std::cout << "Queue folder " << queueDir << " cannot be opened" << std::endl;
+			res = MPFER_FILE_ERROR;
+		}
+
+		//Without a cache every stage is calculated
+		TACore::FileCache cache;
+		if (res == MPFER_OK && cacheDir != "" && cache.open(cacheDir, cacheSizeInMB * 1024 * 1024) != TACore::TACORE_OK)
+		{
+			std::cout << "Cache folder " << cacheDir << " cannot be opened, continuing without the cache" << std::endl;
+		}
+
 		if (res == MPFER_OK)
 		{
 			//Decide which descriptor is run
@@ -74,93 +686,219 @@ MultiParameterFeatureExtractionMain::Result MultiParameterFeatureExtractionMain:
 
 			if (runPBSDPermutations == true)
 			{
-				//Read Geodesic Distance Matrix
-				TAFea::GeodesicDistanceMatrix gdMatrix;
-				gdMatrix.m_GeoMatrix.loadBinary(gdMatrixPath);
+				//Feature files keep the hash of the mesh so that they are not compared against features of another mesh
+				//Cache keys also start from it, so entries of an edited mesh are never reused
+				const unsigned long long meshHash = triMesh.calcContentHash();
 
-				//Read Auxilary info about the mesh
-				TAShape::TriMeshAuxInfo auxInfo;
-				auxInfo.load(auxInfoPath);
+				//Files given by the user are not known to the cache, so the stages depending on them are not cached
+				const bool usePatchCache = cache.isOpen() && (gdMatrixPath == "");
+				const bool useFeatureCache = usePatchCache && (auxInfoPath == "");
 
-				PBSDParameterSet minValues(20.0f, 50.0f, 10, 8, 128, 1, 1);
-				PBSDParameterSet maxValues(21.0f, 301.0f, 50, 32, 1024, 2, 5);
-				PBSDParameterSet incrValues(10.0f, 50.0f, 20, 8, 128, 10, 1);
-				std::vector<PBSDParameterSet> permutations = PBSDParameterSet::createPermutations(minValues, maxValues, incrValues);
+				std::vector<PBSDParameterSet> permutations = PBSDParameterSet::createDefaultPermutations();
 
 				std::cout << "Number of Permutations: " << permutations.size() << std::endl;
 				std::cout << "Reference Vertex Id is " << refVertex << std::endl;
+
+				//Get the names of permutations. These will be used as the base names for the output files
+				std::vector<std::string> permutationNames(permutations.size());
 				for (size_t permId = 0; permId < permutations.size(); permId++)
 				{
-					const PBSDParameterSet& permutation = permutations[permId];
+					permutationNames[permId] = permutations[permId].getName(TACore::PathUtil::getFileNameFromPath(inputMeshFile), permId);
+				}
 
-					TAFeaExt::PatchBasedShapeDistributionDescExtraction patchBasedExtractor;
-					patchBasedExtractor.setGeodesicDistanceMatrix(&gdMatrix);
-					patchBasedExtractor.setMinGeodesicDistance(permutation.m_fMinGeodesicDistance);
-					patchBasedExtractor.setMaxGeodesicDistance(permutation.m_fMaxGeodesicDistance);
-					patchBasedExtractor.setNumberOfPatches(permutation.m_nNumberOfPatches);
-					patchBasedExtractor.setNumberOfBins(permutation.m_nNumberOfBins);
-					patchBasedExtractor.setSampleCount(permutation.m_nSampleCount);
-					patchBasedExtractor.setSamplingMethod(TAFeaExt::PatchBasedShapeDistributionDescExtraction::SamplingMethod(permutation.m_nSamplingMethod));
-					patchBasedExtractor.setShapeDistributionFunction(TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(permutation.m_nShapeDistributionFunction));
-					if (TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(permutation.m_nShapeDistributionFunction)
-						== TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS
-						|| TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(permutation.m_nShapeDistributionFunction)
-						== TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT)
+				//A journaled permutation is completed only if its outputs are still there and valid, e.g. not from an edited mesh or another seed
+				//Workers of a queue journal to their own files, which are merged into the journal at the end
+				std::vector<char> isCompleted;
+				readJournal(journalPath, permutationNames, isCompleted);
+				std::vector<std::string> workerJournalPaths;
+				if (queue.isOpen())
+				{
+					getWorkerJournalPaths(journalPath, workerJournalPaths);
+					for (size_t i = 0; i < workerJournalPaths.size(); i++)
 					{
-						patchBasedExtractor.setMaxPossibleSampleValue(auxInfo.m_lfMaxEucDistanceBetweenTwoVertices);
+						readJournal(workerJournalPaths[i], permutationNames, isCompleted);
 					}
-					else if (TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(permutation.m_nShapeDistributionFunction)
-						== TAFeaExt::PatchBasedShapeDistributionDescExtraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS)
+				}
+				size_t numberOfCompleted = 0;
+				for (size_t permId = 0; permId < permutations.size(); permId++)
+				{
+					if (isCompleted[permId])
 					{
-						patchBasedExtractor.setMaxPossibleSampleValue(sqrt(auxInfo.m_lfMaxAreaOfTriangleConstructedByThreeVertices));
+						const std::string featureFilePath = TACore::PathUtil::joinPath(outFeaFolder, TACore::PathUtil::addExtension(permutationNames[permId], "fea"));
+						const std::string plyFilePath = TACore::PathUtil::joinPath(outPlyFolder, TACore::PathUtil::addExtension(permutationNames[permId], "ply"));
+						isCompleted[permId] = isFeatureFileValid(featureFilePath, createFeatureFileInfo(permutations[permId], meshHash, randomSeed, exactSampleThreshold), (int)triMesh.verts.size())
+							&& (!createComparisonPly || std::ifstream(plyFilePath.c_str()).good());
 					}
-					else if (TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(permutation.m_nShapeDistributionFunction)
-						== TAFeaExt::PatchBasedShapeDistributionDescExtraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS)
+					if (isCompleted[permId])
 					{
-						patchBasedExtractor.setMaxPossibleSampleValue(cbrt(auxInfo.m_lfMaxVolumeOfTetrahedronConstructedByForVertices));
+						numberOfCompleted++;
 					}
+				}
+				std::cout << "Number of Permutations Completed Before: " << numberOfCompleted << std::endl;
 
-					std::vector<LocalFeaturePtr> feas;
-					patchBasedExtractor.extract(&triMesh, feas);
-
-					//Get the name of permutation. This will be used as the base names for the output files
-					const std::string permutationName = permutation.getName(TACore::PathUtil::getFileNameFromPath(inputMeshFile), permId);
+				//Workers share the patch groups, permutations differing only in the number of bins share the samples,
+				//the ones differing also in the sampling parameters share the patches
+				const std::vector<std::vector<std::vector<size_t> > > permutationGroups = PBSDParameterSet::groupPermutations(permutations);
+				const std::string jobPrefix = TACore::PathUtil::stripExtension(TACore::PathUtil::getFileNameFromPath(inputMeshFile)) + "_pbsd_";
 
-					//Write the binary file of features
-					const std::string featureFilePath = TACore::PathUtil::joinPath(outFeaFolder, TACore::PathUtil::addExtension(permutationName, "fea"));
-					TAFea::TAFeatureFileIO::writePBSDInBinary(feas, featureFilePath);
+				if (queue.isOpen() && role == "enqueue")
+				{
+					//Only the groups with unfinished permutations are added, a group which is already pending or running is kept
+					size_t numberOfAdded = 0;
+					for (size_t patchGroup = 0; patchGroup < permutationGroups.size(); patchGroup++)
+					{
+						bool isPatchGroupCompleted = true;
+						for (size_t sampleGroup = 0; sampleGroup < permutationGroups[patchGroup].size(); sampleGroup++)
+						{
+							for (size_t i = 0; i < permutationGroups[patchGroup][sampleGroup].size(); i++)
+							{
+								isPatchGroupCompleted = isPatchGroupCompleted && isCompleted[permutationGroups[patchGroup][sampleGroup][i]];
+							}
+						}
+						if (isPatchGroupCompleted)
+						{
+							continue;
+						}
 
-					//Write ply file with color according to a reference vertex
-					if (createComparisonPly == true)
+						const TACore::Result addResult = queue.addJob(createSweepJobName(jobPrefix, patchGroup), createSweepJobContent(meshHash, patchGroup));
+						if (addResult == TACore::TACORE_OK)
+						{
+							numberOfAdded++;
+						}
+						else if (addResult == TACore::TACORE_FILE_ERROR)
+						{
+							res = MPFER_FILE_ERROR;
+						}
+					}
+					std::cout << "Number of Jobs Added: " << numberOfAdded << std::endl;
+				}
+				else if (queue.isOpen() && role == "merge")
+				{
+					//Journals of the workers cannot be removed while they may still be written
+					std::vector<std::string> pendingJobs;
+					std::vector<std::string> runningJobs;
+					std::vector<std::string> failedJobs;
+					queue.getJobNames(TACore::FileJobQueue::JOB_PENDING, jobPrefix, pendingJobs);
+					queue.getJobNames(TACore::FileJobQueue::JOB_RUNNING, jobPrefix, runningJobs);
+					queue.getJobNames(TACore::FileJobQueue::JOB_FAILED, jobPrefix, failedJobs);
+					std::cout << "Number of Jobs Pending: " << pendingJobs.size() << ", Running: " << runningJobs.size() << ", Failed: " << failedJobs.size() << std::endl;
+					if (!pendingJobs.empty() || !runningJobs.empty())
 					{
-						PatchBasedShapeDistributionHistogram* feaV_Ref = (PatchBasedShapeDistributionHistogram*)(feas[refVertex].get());
+						res = MPFER_EXTRACTION_ERROR;
+					}
 
-						std::vector<double> magnitudes(feas.size());
-						for (size_t v = 0; v < feas.size(); v++)
+					//Outputs of the workers have the names they would have in a single run, so only the journals are merged
+					//Merged journal lists the valid permutations in the order of their ids, whichever worker extracted them
+					if (res == MPFER_OK)
+					{
+						const std::string temporaryJournalPath = journalPath + ".tmp";
+						std::ofstream mergedJournal(temporaryJournalPath.c_str(), std::ios::trunc);
+						for (size_t permId = 0; permId < permutations.size(); permId++)
 						{
-							PatchBasedShapeDistributionHistogram* feaVV = (PatchBasedShapeDistributionHistogram*)(feas[v].get());
-							std::vector<double> vertexPatchMagnitudes(feaVV->m_vDescriptor.size());
-							for (size_t patchIdx = 0; patchIdx < vertexPatchMagnitudes.size(); patchIdx++)
+							if (isCompleted[permId])
 							{
-								vertexPatchMagnitudes[patchIdx] = StdVecL2Norm(feaVV->m_vDescriptor[patchIdx] - feaV_Ref->m_vDescriptor[patchIdx]);
+								mergedJournal << permutationNames[permId] << std::endl;
 							}
-							magnitudes[v] = StdVecL2Norm(vertexPatchMagnitudes);
 						}
+						mergedJournal.close();
+						if (mergedJournal.fail() || !TACore::PathUtil::moveFile(temporaryJournalPath, journalPath))
+						{
+							remove(temporaryJournalPath.c_str());
+							res = MPFER_FILE_ERROR;
+						}
+					}
+					if (res == MPFER_OK)
+					{
+						for (size_t i = 0; i < workerJournalPaths.size(); i++)
+						{
+							remove(workerJournalPaths[i].c_str());
+						}
+						std::cout << "Number of Permutations Not Completed: " << permutations.size() - numberOfCompleted << std::endl;
+						if (numberOfCompleted < permutations.size())
+						{
+							res = MPFER_EXTRACTION_ERROR;
+						}
+					}
+				}
+				else
+				{
+					//Read Auxilary info about the mesh
+					TAShape::TriMeshAuxInfo auxInfo;
+					if (prepareAuxInfo(triMesh, meshHash, auxInfoPath, cache, auxInfo) != TACore::TACORE_OK)
+					{
+						std::cout << "Auxilary info " << auxInfoPath << " cannot be read" << std::endl;
+						res = MPFER_FILE_ERROR;
+					}
+
+					SweepContext context;
+					context.m_pMesh = &triMesh;
+					context.m_pAuxInfo = &auxInfo;
+					context.m_pCache = &cache;
+					context.m_pPermutations = &permutations;
+					context.m_pPermutationNames = &permutationNames;
+					context.m_pPermutationGroups = &permutationGroups;
+					context.m_pIsCompleted = &isCompleted;
+					context.m_nMeshHash = meshHash;
+					context.m_sGdMatrixPath = gdMatrixPath;
+					context.m_sOutFeaFolder = outFeaFolder;
+					context.m_sOutPlyFolder = outPlyFolder;
+					context.m_nRefVertex = refVertex;
+					context.m_bCreateComparisonPly = createComparisonPly;
+					context.m_nRandomSeed = randomSeed;
+					context.m_nExactSampleThreshold = exactSampleThreshold;
+					context.m_bUsePatchCache = usePatchCache;
+					context.m_bUseFeatureCache = useFeatureCache;
+					context.m_pQueue = queue.isOpen() ? &queue : NULL;
+					context.m_sJobPrefix = jobPrefix;
+					context.m_nJobTimeout = jobTimeout;
+#ifdef _OPENMP
+					context.m_nNumberOfThreadsPerWorker = MAX(omp_get_max_threads() / numberOfWorkers, 1);
+#else
+					context.m_nNumberOfThreadsPerWorker = 1;
+#endif
+					context.m_nNextPatchGroup = 0;
+					context.m_nNumberOfCompleted = 0;
+					context.m_nNumberOfFailed = 0;
+
+					if (res == MPFER_OK)
+					{
+						context.m_Journal.open((queue.isOpen() ? journalPath + "." + workerId : journalPath).c_str(), std::ios::app);
+						if (!context.m_Journal.is_open())
+						{
+							res = MPFER_FILE_ERROR;
+						}
+					}
 
-						const double maxMag = *std::max_element(magnitudes.begin(), magnitudes.end());
-						const double minMag = *std::min_element(magnitudes.begin(), magnitudes.end());
+					if (res == MPFER_OK)
+					{
+						//Jobs are renewed while they are extracted, however long a group of samples takes
+						if (queue.isOpen())
+						{
+							queue.startHeartbeat(jobTimeout / JOB_RENEWALS_PER_TIMEOUT);
+						}
 
-						for (size_t i = 0; i < magnitudes.size(); i++)
+						//Calling thread is one of the workers
+						std::vector<std::thread> workerThreads;
+						for (int w = 1; w < numberOfWorkers; w++)
 						{
-							magnitudes[i] = (magnitudes[i] - minMag) / (maxMag - minMag);
+							workerThreads.push_back(std::thread(runSweepWorker, &context));
 						}
+						runSweepWorker(&context);
+						for (size_t w = 0; w < workerThreads.size(); w++)
+						{
+							workerThreads[w].join();
+						}
+						queue.stopHeartbeat();
 
-						const std::string plyFilePath = TACore::PathUtil::joinPath(outPlyFolder, TACore::PathUtil::addExtension(permutationName, "ply"));
-						triMesh.save(plyFilePath.c_str(), magnitudes);
+						std::cout << "Number of Permutations Completed: " << context.m_nNumberOfCompleted << ", Failed: " << context.m_nNumberOfFailed << std::endl;
+						if (context.m_nNumberOfFailed > 0)
+						{
+							res = MPFER_EXTRACTION_ERROR;
+						}
 					}
 				}
 			}
 		}
 	}
 	return res;
-}
\ No newline at end of file
+}
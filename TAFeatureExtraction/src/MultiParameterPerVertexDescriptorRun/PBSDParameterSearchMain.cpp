@@ -0,0 +1,451 @@
+#include "MultiParameterPerVertexDescriptorRun/PBSDParameterSearchMain.h"
+#include "MultiParameterPerVertexDescriptorRun/PBSDParameterSet.h"
+#include "MultiParameterPerVertexDescriptorRun/MultiParameterFeatureComparisonMain.h"
+#include <core/CommandLineParser.h>
+#include <core/TriangularMesh.h>
+#include <core/TriMeshAuxInfo.h>
+#include <core/StringUtil.h>
+#include <core/PathUtil.h>
+#include <core/Timer.h>
+#include <TAFeatureFileIO.h>
+#include <FeatureMatrix.h>
+#include <fstream>
+#include <limits>
+
+//Descriptors
+#include "GeodesicDistanceMatrix.h"
+
+//Extractors
+#include "GeodesicDistanceMatrixExtraction.h"
+#include "PatchBasedShapeDistributionDescExtraction.h"
+
+namespace
+{
+	typedef std::shared_ptr<TAFeaExt::PatchBasedShapeDistributionDescExtraction> PBSDExtractionPtr;
+
+	//Permutation scored in a rung, ordered by the mean score and then by the id so that the ranking does not depend on the extraction order
+	struct ScoredPermutation
+	{
+		size_t m_nPermutationId;
+		double m_fMeanScore;
+		std::vector<double> m_vScores;
+
+		bool operator<(const ScoredPermutation& other) const
+		{
+			if (this->m_fMeanScore != other.m_fMeanScore)
+			{
+				return this->m_fMeanScore < other.m_fMeanScore;
+			}
+			return this->m_nPermutationId < other.m_nPermutationId;
+		}
+	};
+
+	//Sets the maximum value of the samples of the shape distribution function of the extractor
+	void setMaxPossibleSampleValue(TAFeaExt::PatchBasedShapeDistributionDescExtraction& extractor, const TAShape::TriMeshAuxInfo& auxInfo)
+	{
+		if (extractor.getShapeDistributionFunction() == TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS
+			|| extractor.getShapeDistributionFunction() == TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT)
+		{
+			extractor.setMaxPossibleSampleValue(auxInfo.m_lfMaxEucDistanceBetweenTwoVertices);
+		}
+		else if (extractor.getShapeDistributionFunction() == TAFeaExt::PatchBasedShapeDistributionDescExtraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS)
+		{
+			extractor.setMaxPossibleSampleValue(sqrt(auxInfo.m_lfMaxAreaOfTriangleConstructedByThreeVertices));
+		}
+		else if (extractor.getShapeDistributionFunction() == TAFeaExt::PatchBasedShapeDistributionDescExtraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS)
+		{
+			extractor.setMaxPossibleSampleValue(cbrt(auxInfo.m_lfMaxVolumeOfTetrahedronConstructedByForVertices));
+		}
+	}
+
+	//Sample count of a permutation in a rung, the fraction of its own sample count but not less than the minimum unless its own one is less
+	int getRungSampleCount(const int& sampleCount, const double& fraction, const int& minSampleCount)
+	{
+		const int rungSampleCount = (int)(sampleCount * fraction + 0.5);
+		return MIN(sampleCount, MAX(rungSampleCount, minSampleCount));
+	}
+}
+
+PBSDParameterSearchMain::Result PBSDParameterSearchMain::run(int argc, char* argv[])
+{
+	Result res = PPSR_OK;
+
+	// Parse args
+	TACore::ArgParser parser("PBSDParameterSearchMain::Run", "Searches the patch based shape distribution parameters agreeing with average geodesic distances the most by successive halving");
+	parser.addArg("input-mesh", "", true, 1, "", "Input shape file to be loaded");
+	parser.addArg("ref-vertex", "", true, 1, "", "Reference vertices which are used to calculate comparison metrics, separated by commas, e.g. 12,40,77");
+	parser.addArg("out-report-path", "", true, 1, "", "Path to output report file ranking the permutations of the last rung");
+	parser.addArg("out-rung-log-path", "", false, 1, "", "Path to output csv file of the sample count and the score of each permutation in each rung");
+	parser.addArg("out-fea-folder", "", false, 1, "", "The folder in which the feature files of the permutations of the last rung are created");
+	parser.addArg("gd-matrix-path", "", false, 1, "", "Geodesic distance matrix of the mesh, calculated if not given");
+	parser.addArg("aux-info-path", "", false, 1, "", "Auxilary information about the mesh, calculated if not given");
+	parser.addArg("agd-source-samples", "", false, 1, "0", "Number of random source vertices the average geodesic distances are estimated from, 0 uses all vertices");
+	parser.addArg("eta", "", false, 1, "3", "Reduction factor, the best 1 / eta of the permutations are kept and their sample counts are multiplied by eta in each rung");
+	parser.addArg("final-permutations", "", false, 1, "3", "Halving stops when at most this many permutations are left or the sample counts cannot be raised in another rung, the ones left are extracted with their own sample counts");
+	parser.addArg("min-sample-count", "", false, 1, "16", "Sample counts of the permutations are not reduced below this value in the early rungs");
+	parser.addArg("random-seed", "", false, 1, "5489", "Seed of the random sampling, same seed gives the same features");
+	parser.addArg("exact-sample-threshold", "", false, 1, "0", "Patches with at most this many vertex combinations get exact histograms instead of sampled ones, 0 disables it");
+
+	if (!parser.parseCommandLine(argc, argv))
+	{
+		res = PPSR_COMMAND_LINE_PARSE_ERROR;
+	}
+
+	const int eta = (res == PPSR_OK) ? parser.getInt("eta") : 0;
+	const int finalPermutations = (res == PPSR_OK) ? parser.getInt("final-permutations") : 0;
+	if (res == PPSR_OK && (eta < 2 || finalPermutations < 1))
+	{
+		std::cerr << "eta must be at least 2 and final-permutations must be at least 1!" << std::endl;
+		res = PPSR_COMMAND_LINE_PARSE_ERROR;
+	}
+
+	if (res == PPSR_OK)
+	{
+		std::string inputMeshFile = parser.get("input-mesh");
+		std::string outReportPath = parser.get("out-report-path");
+		std::string outRungLogPath = "";
+		if (parser.exists("out-rung-log-path"))
+		{
+			outRungLogPath = parser.get("out-rung-log-path");
+		}
+		std::string outFeaFolder = "";
+		if (parser.exists("out-fea-folder"))
+		{
+			outFeaFolder = parser.get("out-fea-folder");
+		}
+		std::string gdMatrixPath = "";
+		if (parser.exists("gd-matrix-path"))
+		{
+			gdMatrixPath = parser.get("gd-matrix-path");
+		}
+		std::string auxInfoPath = "";
+		if (parser.exists("aux-info-path"))
+		{
+			auxInfoPath = parser.get("aux-info-path");
+		}
+		const int agdSourceSamples = parser.getInt("agd-source-samples");
+		const int minSampleCount = parser.getInt("min-sample-count");
+		const unsigned int randomSeed = (unsigned int)parser.getInt("random-seed");
+		const int exactSampleThreshold = parser.getInt("exact-sample-threshold");
+
+		//Read the mesh
+		TAShape::TriangularMesh triMesh;
+		if (triMesh.load(inputMeshFile.c_str()) != TACore::TACORE_OK)
+		{
+			res = PPSR_MESH_LOAD_ERROR;
+		}
+
+		//All reference vertices are compared in each evaluation
+		std::vector<int> refVertices;
+		if (res == PPSR_OK)
+		{
+			std::vector<std::string> refVertexValues = TACore::StringUtil::split(parser.get("ref-vertex"), ',');
+			for (size_t i = 0; i < refVertexValues.size(); i++)
+			{
+				const int refVertex = TACore::StringUtil::strToVal<int>(refVertexValues[i]);
+				if (refVertex < 0 || refVertex >= (int)triMesh.verts.size())
+				{
+					std::cerr << "Reference vertex " << refVertexValues[i] << " is not a vertex of the mesh!" << std::endl;
+					res = PPSR_COMMAND_LINE_PARSE_ERROR;
+					break;
+				}
+				refVertices.push_back(refVertex);
+			}
+			if (refVertices.empty())
+			{
+				res = PPSR_COMMAND_LINE_PARSE_ERROR;
+			}
+		}
+
+		//Geodesic distance matrix and auxilary info are shared by all extractions
+		TAFea::GlobalFeaturePtr gdMatrix;
+		TAShape::TriMeshAuxInfo auxInfo;
+		if (res == PPSR_OK)
+		{
+			if (gdMatrixPath != "")
+			{
+				TAFea::GeodesicDistanceMatrix* loadedMatrix = new TAFea::GeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+				gdMatrix = TAFea::GlobalFeaturePtr(loadedMatrix);
+				if (!loadedMatrix->m_GeoMatrix.loadBinary(gdMatrixPath))
+				{
+					res = PPSR_MESH_LOAD_ERROR;
+				}
+			}
+			else
+			{
+				TAFeaExt::GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
+				geoDistMatrixExtraction.setGeodesicDistanceType(TAFea::GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+				if (geoDistMatrixExtraction.extract(&triMesh, gdMatrix) != TACore::TACORE_OK)
+				{
+					res = PPSR_MESH_LOAD_ERROR;
+				}
+			}
+
+			if (auxInfoPath != "")
+			{
+				if (auxInfo.load(auxInfoPath) != TACore::TACORE_OK)
+				{
+					res = PPSR_MESH_LOAD_ERROR;
+				}
+			}
+			else
+			{
+				auxInfo = triMesh.calcAuxInfo();
+			}
+		}
+
+		std::ofstream rungLog;
+		if (res == PPSR_OK && outRungLogPath != "")
+		{
+			rungLog.open(outRungLogPath.c_str(), std::ios::out);
+			if (!rungLog.is_open())
+			{
+				res = PPSR_FILE_ERROR;
+			}
+			else
+			{
+				rungLog << "Rung,PermutationId,SampleCount,Score" << std::endl;
+			}
+		}
+
+		std::vector<std::vector<double> > refMagnitudes;
+		if (res == PPSR_OK)
+		{
+			refMagnitudes = MultiParameterFeatureComparisonMain::createAGDMagnitudes(&triMesh, refVertices, agdSourceSamples);
+			if (refMagnitudes.empty())
+			{
+				res = PPSR_MESH_LOAD_ERROR;
+			}
+		}
+
+		if (res == PPSR_OK)
+		{
+			const std::vector<PBSDParameterSet> permutations = PBSDParameterSet::createDefaultPermutations();
+			const unsigned long long meshHash = triMesh.calcContentHash();
+			const int noVerts = (int)triMesh.verts.size();
+			const int noRefs = (int)refVertices.size();
+
+			//Extractor of a patch group keeps its patches, so they are created once for all rungs
+			//Cost of extracting all permutations is the sum of the sample counts of the sample groups
+			const std::vector<std::vector<std::vector<size_t> > > permutationGroups = PBSDParameterSet::groupPermutations(permutations);
+			std::vector<size_t> patchGroupOfPermutation(permutations.size());
+			double exhaustiveSampleCost = 0.0;
+			for (size_t patchGroup = 0; patchGroup < permutationGroups.size(); patchGroup++)
+			{
+				for (size_t sampleGroup = 0; sampleGroup < permutationGroups[patchGroup].size(); sampleGroup++)
+				{
+					const std::vector<size_t>& permIds = permutationGroups[patchGroup][sampleGroup];
+					for (size_t i = 0; i < permIds.size(); i++)
+					{
+						patchGroupOfPermutation[permIds[i]] = patchGroup;
+					}
+					exhaustiveSampleCost += permutations[permIds[0]].m_nSampleCount;
+				}
+			}
+			std::vector<PBSDExtractionPtr> extractors(permutationGroups.size());
+
+			//Permutations are divided by eta until at most the final number of them are left
+			int noRungs = 1;
+			for (size_t count = permutations.size(); count > (size_t)finalPermutations; count = (count + eta - 1) / eta)
+			{
+				noRungs++;
+			}
+
+			//Each rung must raise the fidelity, i.e. the largest sample count must be above the minimum one in the first rung,
+			//so rungs are limited to floor(log_eta(maxSampleCount / minSampleCount)) + 1 and more permutations may reach the last rung
+			int maxSampleCount = 0;
+			for (size_t permId = 0; permId < permutations.size(); permId++)
+			{
+				maxSampleCount = MAX(maxSampleCount, permutations[permId].m_nSampleCount);
+			}
+			int maxNoRungs = 1;
+			for (long long sampleCount = (long long)MAX(minSampleCount, 1) * eta; sampleCount <= (long long)maxSampleCount; sampleCount *= eta)
+			{
+				maxNoRungs++;
+			}
+			noRungs = MIN(noRungs, maxNoRungs);
+
+			std::cout << "Number of Permutations: " << permutations.size() << std::endl;
+			std::cout << "Number of Rungs: " << noRungs << std::endl;
+
+			TACore::Timer timer;
+			double searchSampleCost = 0.0;
+			std::vector<size_t> candidates(permutations.size());
+			for (size_t permId = 0; permId < permutations.size(); permId++)
+			{
+				candidates[permId] = permId;
+			}
+			std::vector<ScoredPermutation> ranking;
+
+			//Features of a permutation do not change while its sample count is clamped to the minimum, so its last score is reused
+			std::vector<ScoredPermutation> lastScores(permutations.size());
+			std::vector<int> lastSampleCounts(permutations.size(), 0);
+			for (int rung = 0; rung < noRungs; rung++)
+			{
+				const bool isLastRung = (rung == noRungs - 1);
+				const double fraction = pow((double)eta, rung - (noRungs - 1));
+
+				//Candidates with the same patches and the same samples in this rung are extracted together
+				ranking.clear();
+				std::vector<size_t> extractedCandidates;
+				std::vector<PBSDParameterSet> rungPermutations;
+				for (size_t i = 0; i < candidates.size(); i++)
+				{
+					PBSDParameterSet rungPermutation = permutations[candidates[i]];
+					rungPermutation.m_nSampleCount = getRungSampleCount(rungPermutation.m_nSampleCount, fraction, minSampleCount);
+					if (rungPermutation.m_nSampleCount == lastSampleCounts[candidates[i]] && !(isLastRung && outFeaFolder != ""))
+					{
+						ranking.push_back(lastScores[candidates[i]]);
+						if (rungLog.is_open())
+						{
+							rungLog << rung << "," << candidates[i] << "," << rungPermutation.m_nSampleCount << "," << lastScores[candidates[i]].m_fMeanScore << std::endl;
+						}
+						continue;
+					}
+					extractedCandidates.push_back(candidates[i]);
+					rungPermutations.push_back(rungPermutation);
+				}
+				const std::vector<std::vector<std::vector<size_t> > > rungGroups = PBSDParameterSet::groupPermutations(rungPermutations);
+
+				for (size_t rungPatchGroup = 0; rungPatchGroup < rungGroups.size(); rungPatchGroup++)
+				{
+					const size_t patchGroup = patchGroupOfPermutation[extractedCandidates[rungGroups[rungPatchGroup][0][0]]];
+					if (!extractors[patchGroup])
+					{
+						const PBSDParameterSet& patchParameters = permutations[extractedCandidates[rungGroups[rungPatchGroup][0][0]]];
+						extractors[patchGroup] = PBSDExtractionPtr(new TAFeaExt::PatchBasedShapeDistributionDescExtraction());
+						extractors[patchGroup]->setMinGeodesicDistance(patchParameters.m_fMinGeodesicDistance);
+						extractors[patchGroup]->setMaxGeodesicDistance(patchParameters.m_fMaxGeodesicDistance);
+						extractors[patchGroup]->setNumberOfPatches(patchParameters.m_nNumberOfPatches);
+						extractors[patchGroup]->setRandomSeed(randomSeed);
+						extractors[patchGroup]->setExactSampleThreshold(exactSampleThreshold);
+						extractors[patchGroup]->setGeodesicDistanceMatrix((TAFea::GeodesicDistanceMatrix*)gdMatrix.get());
+					}
+					TAFeaExt::PatchBasedShapeDistributionDescExtraction& patchBasedExtractor = *extractors[patchGroup];
+
+					for (size_t sampleGroup = 0; sampleGroup < rungGroups[rungPatchGroup].size(); sampleGroup++)
+					{
+						const std::vector<size_t>& indices = rungGroups[rungPatchGroup][sampleGroup];
+						const PBSDParameterSet& sampleParameters = rungPermutations[indices[0]];
+
+						patchBasedExtractor.setSampleCount(sampleParameters.m_nSampleCount);
+						patchBasedExtractor.setSamplingMethod(TAFeaExt::PatchBasedShapeDistributionDescExtraction::SamplingMethod(sampleParameters.m_nSamplingMethod));
+						patchBasedExtractor.setShapeDistributionFunction(TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction(sampleParameters.m_nShapeDistributionFunction));
+						setMaxPossibleSampleValue(patchBasedExtractor, auxInfo);
+
+						//All numbers of bins of the group are filled from the same samples
+						std::vector<int> numbersOfBins(indices.size());
+						for (size_t i = 0; i < indices.size(); i++)
+						{
+							numbersOfBins[i] = rungPermutations[indices[i]].m_nNumberOfBins;
+						}
+						std::vector<std::vector<LocalFeaturePtr> > feasOfBins;
+						if (patchBasedExtractor.extractForNumbersOfBins(&triMesh, numbersOfBins, feasOfBins) != TACore::TACORE_OK)
+						{
+							std::cerr << "Permutation " << extractedCandidates[indices[0]] << " and the ones sharing its samples cannot be extracted, they are dropped!" << std::endl;
+							continue;
+						}
+						searchSampleCost += sampleParameters.m_nSampleCount;
+
+						for (size_t binsIdx = 0; binsIdx < indices.size(); binsIdx++)
+						{
+							const size_t permId = extractedCandidates[indices[binsIdx]];
+							TAFea::FeatureMatrix<double> feaMatrix;
+							if (TAFea::createFeatureMatrix(feasOfBins[binsIdx], feaMatrix) != TACore::TACORE_OK)
+							{
+								continue;
+							}
+
+							//Scores are the ones of MultiParameterFeatureComparisonMain, a permutation which cannot be scored is ranked last
+							std::vector<double> magnitudes((size_t)noRefs * noVerts);
+							for (int r = 0; r < noRefs; r++)
+							{
+								for (int v = 0; v < noVerts; v++)
+								{
+									magnitudes[(size_t)r * noVerts + v] = feaMatrix.L2Distance(v, refVertices[r]);
+								}
+							}
+							ScoredPermutation scored;
+							scored.m_nPermutationId = permId;
+							scored.m_vScores = MultiParameterFeatureComparisonMain::calcScores(magnitudes, refMagnitudes);
+							scored.m_fMeanScore = MultiParameterFeatureComparisonMain::calcMeanScore(scored.m_vScores);
+							if (scored.m_fMeanScore != scored.m_fMeanScore)
+							{
+								scored.m_fMeanScore = std::numeric_limits<double>::max();
+							}
+							ranking.push_back(scored);
+							lastScores[permId] = scored;
+							lastSampleCounts[permId] = sampleParameters.m_nSampleCount;
+
+							if (rungLog.is_open())
+							{
+								rungLog << rung << "," << permId << "," << sampleParameters.m_nSampleCount << "," << scored.m_fMeanScore << std::endl;
+							}
+
+							//Feature files of the last rung are the same as the ones of MultiParameterFeatureExtractionMain
+							if (isLastRung && outFeaFolder != "")
+							{
+								TAFea::FeatureFileInfo featureFileInfo;
+								featureFileInfo.m_nMeshHash = meshHash;
+								featureFileInfo.m_vParameters = permutations[permId].getParameterValues();
+								featureFileInfo.m_vParameters.push_back(std::make_pair(std::string("RandomSeed"), TACore::StringUtil::str(randomSeed)));
+								featureFileInfo.m_vParameters.push_back(std::make_pair(std::string("ExactSampleThreshold"), TACore::StringUtil::str(exactSampleThreshold)));
+								const std::string featureFilePath = TACore::PathUtil::joinPath(outFeaFolder,
+									TACore::PathUtil::addExtension(permutations[permId].getName(TACore::PathUtil::getFileNameFromPath(inputMeshFile), permId), "fea"));
+								TAFea::TAFeatureFileIO::writeFeatures(feasOfBins[binsIdx], featureFileInfo, featureFilePath);
+							}
+						}
+					}
+				}
+
+				std::sort(ranking.begin(), ranking.end());
+				std::cout << "Rung " << rung << ": " << ranking.size() << " permutations, " << extractedCandidates.size() << " extracted with " << 100.0 * fraction << "% of their sample counts";
+				if (!ranking.empty())
+				{
+					std::cout << ", best score " << ranking[0].m_fMeanScore << " by permutation " << ranking[0].m_nPermutationId;
+				}
+				std::cout << ", " << timer.seconds() << " secs" << std::endl;
+
+				//Best 1 / eta of the permutations go to the next rung, extractors of the patch groups without a candidate are released
+				if (!isLastRung)
+				{
+					candidates.resize((ranking.size() + eta - 1) / eta);
+					std::vector<char> isPatchGroupUsed(permutationGroups.size(), 0);
+					for (size_t i = 0; i < candidates.size(); i++)
+					{
+						candidates[i] = ranking[i].m_nPermutationId;
+						isPatchGroupUsed[patchGroupOfPermutation[candidates[i]]] = 1;
+					}
+					for (size_t patchGroup = 0; patchGroup < extractors.size(); patchGroup++)
+					{
+						if (!isPatchGroupUsed[patchGroup])
+						{
+							extractors[patchGroup].reset();
+						}
+					}
+				}
+			}
+
+			std::cout << "Sample cost relative to extracting all permutations: " << 100.0 * searchSampleCost / exhaustiveSampleCost << "%" << std::endl;
+
+			//Permutations of the last rung are ranked in the format of MultiParameterFeatureComparisonMain
+			std::map<int, std::vector<double> > permutationIdToScoresMap;
+			std::map<int, std::vector< std::pair< std::string, double > > > permutationIdToParametersMap;
+			for (size_t i = 0; i < ranking.size(); i++)
+			{
+				const int permId = (int)ranking[i].m_nPermutationId;
+				permutationIdToScoresMap[permId] = ranking[i].m_vScores;
+				std::vector<std::pair<std::string, std::string> > parameterValues = permutations[permId].getParameterValues();
+				for (size_t p = 0; p < parameterValues.size(); p++)
+				{
+					permutationIdToParametersMap[permId].push_back(std::make_pair(parameterValues[p].first, TACore::StringUtil::strToVal<double>(parameterValues[p].second)));
+				}
+			}
+			if (MultiParameterFeatureComparisonMain::generateComparisonResult(permutationIdToScoresMap, permutationIdToParametersMap, outReportPath) != MultiParameterFeatureComparisonMain::MPFCR_OK)
+			{
+				res = PPSR_FILE_ERROR;
+			}
+		}
+	}
+	return res;
+}
@@ -57,6 +57,70 @@ std::vector<PBSDParameterSet> PBSDParameterSet::createPermutations(const PBSDPar
 	return result;
 }
 
+std::vector<PBSDParameterSet> PBSDParameterSet::createDefaultPermutations()
+{
+	PBSDParameterSet minValues(20.0f, 50.0f, 10, 8, 128, 1, 1);
+	PBSDParameterSet maxValues(21.0f, 301.0f, 50, 32, 1024, 2, 5);
+	PBSDParameterSet incrValues(10.0f, 50.0f, 20, 8, 128, 10, 1);
+	return createPermutations(minValues, maxValues, incrValues);
+}
+
+bool PBSDParameterSet::hasSamePatches(const PBSDParameterSet& other) const
+{
+	return this->m_fMinGeodesicDistance == other.m_fMinGeodesicDistance &&
+		this->m_fMaxGeodesicDistance == other.m_fMaxGeodesicDistance &&
+		this->m_nNumberOfPatches == other.m_nNumberOfPatches;
+}
+
+bool PBSDParameterSet::hasSameSamples(const PBSDParameterSet& other) const
+{
+	return hasSamePatches(other) &&
+		this->m_nSampleCount == other.m_nSampleCount &&
+		this->m_nSamplingMethod == other.m_nSamplingMethod &&
+		this->m_nShapeDistributionFunction == other.m_nShapeDistributionFunction;
+}
+
+bool PBSDParameterSet::hasSameExactSamples(const PBSDParameterSet& other) const
+{
+	return hasSamePatches(other) &&
+		this->m_nSamplingMethod == other.m_nSamplingMethod &&
+		this->m_nShapeDistributionFunction == other.m_nShapeDistributionFunction;
+}
+
+std::vector<std::vector<std::vector<size_t> > > PBSDParameterSet::groupPermutations(const std::vector<PBSDParameterSet>& permutations)
+{
+	std::vector<std::vector<std::vector<size_t> > > result;
+	for (size_t permId = 0; permId < permutations.size(); permId++)
+	{
+		const PBSDParameterSet& permutation = permutations[permId];
+
+		//Find the group of the patches, the first permutation of each group is its representative
+		size_t patchGroup = 0;
+		while (patchGroup < result.size() && !permutations[result[patchGroup][0][0]].hasSamePatches(permutation))
+		{
+			patchGroup++;
+		}
+		if (patchGroup == result.size())
+		{
+			result.push_back(std::vector<std::vector<size_t> >());
+		}
+
+		//Find the group of the samples inside the group of the patches
+		std::vector<std::vector<size_t> >& sampleGroups = result[patchGroup];
+		size_t sampleGroup = 0;
+		while (sampleGroup < sampleGroups.size() && !permutations[sampleGroups[sampleGroup][0]].hasSameSamples(permutation))
+		{
+			sampleGroup++;
+		}
+		if (sampleGroup == sampleGroups.size())
+		{
+			sampleGroups.push_back(std::vector<size_t>());
+		}
+		sampleGroups[sampleGroup].push_back(permId);
+	}
+	return result;
+}
+
 std::string PBSDParameterSet::getName(const std::string& meshName, const size_t& parameterSetId) const
 {
 	std::stringstream ss;
@@ -73,6 +137,19 @@ std::string PBSDParameterSet::getName(const std::string& meshName, const size_t&
 	return name;
 }
 
+std::vector<std::pair<std::string, std::string> > PBSDParameterSet::getParameterValues() const
+{
+	std::vector<std::pair<std::string, std::string> > values;
+	values.push_back(std::make_pair(std::string("MinGD"), TACore::StringUtil::str(this->m_fMinGeodesicDistance)));
+	values.push_back(std::make_pair(std::string("MaxGD"), TACore::StringUtil::str(this->m_fMaxGeodesicDistance)));
+	values.push_back(std::make_pair(std::string("NOP"), TACore::StringUtil::str(this->m_nNumberOfPatches)));
+	values.push_back(std::make_pair(std::string("NOB"), TACore::StringUtil::str(this->m_nNumberOfBins)));
+	values.push_back(std::make_pair(std::string("SC"), TACore::StringUtil::str(this->m_nSampleCount)));
+	values.push_back(std::make_pair(std::string("SM"), TACore::StringUtil::str(this->m_nSamplingMethod)));
+	values.push_back(std::make_pair(std::string("SDF"), TACore::StringUtil::str(this->m_nShapeDistributionFunction)));
+	return values;
+}
+
 std::ostream& operator<<(std::ostream& o, const PBSDParameterSet& paramSet)
 {
 	o << "Min Geodesic Distance: " << paramSet.m_fMinGeodesicDistance << std::endl;
@@ -3,6 +3,8 @@
 #include <string>
 #include <MultiParameterPerVertexDescriptorRun/MultiParameterFeatureExtractionMain.h>
 #include <MultiParameterPerVertexDescriptorRun/MultiParameterFeatureComparisonMain.h>
+#include <MultiParameterPerVertexDescriptorRun/BatchFeatureExtractionMain.h>
+#include <MultiParameterPerVertexDescriptorRun/PBSDParameterSearchMain.h>
 
 int mainRet(int ret, std::string message)
 {
@@ -18,6 +20,8 @@ int main(int argc, char* argv[])
 {
 	//0 --> MultiParameterFeatureExtractionMain
 	//1 --> MultiParameterFeatureComparisonMain
+	//2 --> BatchFeatureExtractionMain
+	//3 --> PBSDParameterSearchMain
 	const int mainMode = 0;
 
 	std::string runResultMessage = "Main Test Successfully Ended";
@@ -36,6 +40,16 @@ int main(int argc, char* argv[])
 			runResultMessage = "Mesh Cannot Be Loaded Correctly";
 			runResultCode = -1;
 		}
+		else if (res == MultiParameterFeatureExtractionMain::MPFER_FILE_ERROR)
+		{
+			runResultMessage = "Journal File or Queue Folder Cannot Be Used Correctly";
+			runResultCode = -1;
+		}
+		else if (res == MultiParameterFeatureExtractionMain::MPFER_EXTRACTION_ERROR)
+		{
+			runResultMessage = "Some Permutations Cannot Be Extracted Correctly";
+			runResultCode = -1;
+		}
 	}
 
 	else if (mainMode == 1)
@@ -58,5 +72,50 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	else if (mainMode == 2)
+	{
+		BatchFeatureExtractionMain::Result res = BatchFeatureExtractionMain::run(argc, argv);
+		if (res == BatchFeatureExtractionMain::BFER_COMMAND_LINE_PARSE_ERROR)
+		{
+			runResultMessage = "Command Line Cannot Be Parsed Correctly";
+			runResultCode = -1;
+		}
+		else if (res == BatchFeatureExtractionMain::BFER_INPUT_ERROR)
+		{
+			runResultMessage = "No Mesh or Unknown Descriptor Type in the Input";
+			runResultCode = -1;
+		}
+		else if (res == BatchFeatureExtractionMain::BFER_FILE_ERROR)
+		{
+			runResultMessage = "Report File or Queue Folder Cannot Be Used Correctly";
+			runResultCode = -1;
+		}
+		else if (res == BatchFeatureExtractionMain::BFER_UNFINISHED_ERROR)
+		{
+			runResultMessage = "Some Meshes Are Not Processed Yet";
+			runResultCode = -1;
+		}
+	}
+
+	else if (mainMode == 3)
+	{
+		PBSDParameterSearchMain::Result res = PBSDParameterSearchMain::run(argc, argv);
+		if (res == PBSDParameterSearchMain::PPSR_COMMAND_LINE_PARSE_ERROR)
+		{
+			runResultMessage = "Command Line Cannot Be Parsed Correctly";
+			runResultCode = -1;
+		}
+		else if (res == PBSDParameterSearchMain::PPSR_MESH_LOAD_ERROR)
+		{
+			runResultMessage = "Mesh Cannot Be Loaded Correctly";
+			runResultCode = -1;
+		}
+		else if (res == PBSDParameterSearchMain::PPSR_FILE_ERROR)
+		{
+			runResultMessage = "Output File Cannot Be Created Correctly";
+			runResultCode = -1;
+		}
+	}
+
 	return mainRet(runResultCode, runResultMessage);
 }
\ No newline at end of file
@@ -1,8 +1,35 @@
 #include "OnEdgeAvgGeoDistExtraction.h"
 #include "AvgGeodesicDistance.h"
 #include "GeodesicDistanceMatrixExtraction.h"
+#include "GeodesicDistanceMatrix.h"
+#include <core/TAMatrix.h>
 #include <core/TriangularMesh.h>
+#include <core/PhiloxRandom.h>
 #include <numeric>
+#include <cmath>
+
+namespace
+{
+	//Finds z so that a standard normal variable is in [-z, z] with the given probability
+	double calcTwoSidedNormalQuantile(const double& probability)
+	{
+		double low = 0.0;
+		double high = 40.0;
+		for (int i = 0; i < 100; i++)
+		{
+			const double mid = 0.5 * (low + high);
+			if (erf(mid / sqrt(2.0)) < probability)
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+		return 0.5 * (low + high);
+	}
+}
 
 namespace TAFeaExt
 {
@@ -13,12 +40,18 @@ namespace TAFeaExt
 
 	OnEdgeAvgGeoDistExtraction::OnEdgeAvgGeoDistExtraction()
 	{
-
+		this->m_nNumberOfSourceSamples = 0;
+		this->m_fConfidenceLevel = 0.95;
+		this->m_nRandomSeed = 5489;
+		this->m_pGeodesicDistanceMatrix = NULL;
 	}
 
 	OnEdgeAvgGeoDistExtraction::OnEdgeAvgGeoDistExtraction(const OnEdgeAvgGeoDistExtraction& other)
 	{
-
+		this->m_nNumberOfSourceSamples = other.m_nNumberOfSourceSamples;
+		this->m_fConfidenceLevel = other.m_fConfidenceLevel;
+		this->m_nRandomSeed = other.m_nRandomSeed;
+		this->m_pGeodesicDistanceMatrix = other.m_pGeodesicDistanceMatrix;
 	}
 
 	Result OnEdgeAvgGeoDistExtraction::extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures)
@@ -27,37 +60,143 @@ namespace TAFeaExt
 		{
 			return TACORE_BAD_ARGS;
 		}
-		
-		Result result = TACORE_OK;
-
-		GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
-		geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+		if (!(this->m_fConfidenceLevel > 0.0 && this->m_fConfidenceLevel < 1.0))
+		{
+			return TACORE_INVALID_OPERATION;
+		}
 
-		GlobalFeaturePtr globalFeaPtr;
-		result = geoDistMatrixExtraction.extract(mesh, globalFeaPtr);
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+		const int verSize = (int)triMesh->verts.size();
 
-		if (result == TACORE_OK)
+		//Rows of an already calculated matrix give the exact averages for free
+		if (this->m_pGeodesicDistanceMatrix != NULL)
 		{
-			GeodesicDistanceMatrix* geoMatrixDescPtr = (GeodesicDistanceMatrix*)(globalFeaPtr.get());
-			TriangularMesh *triMesh = (TriangularMesh*)mesh;
-			const size_t verSize = triMesh->verts.size();
+			const TAMatrix<float>& geoMatrix = this->m_pGeodesicDistanceMatrix->m_GeoMatrix;
+			TACORE_CHECK_ARGS(geoMatrix.rows() == verSize && geoMatrix.cols() == verSize);
 			outFeatures = std::vector<LocalFeaturePtr>(verSize);
+			for (int v = 0; v < verSize; v++)
+			{
+				const float* distanceRow = geoMatrix.getRow(v);
+				double distanceSum = 0.0;
+				for (int w = 0; w < verSize; w++)
+				{
+					distanceSum += distanceRow[w];
+				}
+				outFeatures[v] = LocalFeaturePtr(new AvgGeodesicDistance(v, (float)(distanceSum / verSize)));
+			}
+			return TACORE_OK;
+		}
+
+		const bool isSampled = (this->m_nNumberOfSourceSamples > 0 && this->m_nNumberOfSourceSamples < verSize);
+
+		//Sources are all vertices or distinct random vertices selected by a partial Fisher-Yates shuffle
+		std::vector<int> sources(verSize);
+		for (int v = 0; v < verSize; v++)
+		{
+			sources[v] = v;
+		}
+		if (isSampled)
+		{
+			TACore::PhiloxRandom rng(this->m_nRandomSeed, 0, 0);
+			for (int s = 0; s < this->m_nNumberOfSourceSamples; s++)
+			{
+				const int selected = s + (int)rng.nextInt((uint32_t)(verSize - s));
+				std::swap(sources[s], sources[selected]);
+			}
+			sources.resize(this->m_nNumberOfSourceSamples);
+		}
+		const int noSources = (int)sources.size();
+
+		//Exact averages need the distance sum of the source only, estimated ones the distance and squared distance sums of all vertices
+		std::vector<double> distanceSums(verSize, 0.0);
+		std::vector<double> sqDistanceSums(isSampled ? verSize : 0, 0.0);
+		Result result = TACORE_OK;
+		int noProcessedSources = 0;
+#pragma omp parallel
+		{
+			GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
+			geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+			std::vector<float> distances;
+			std::vector<double> threadDistanceSums(isSampled ? verSize : 0, 0.0);
+			std::vector<double> threadSqDistanceSums(isSampled ? verSize : 0, 0.0);
 
-			for (size_t v = 0; v < verSize; v++)
+#pragma omp for schedule(dynamic, 16)
+			for (int s = 0; s < noSources; s++)
 			{
-				float avgVal = 0.0f;
-				for (int w = 0; w < geoMatrixDescPtr->m_GeoMatrix.cols(); w++)
+				const Result sourceResult = geoDistMatrixExtraction.extract(triMesh, sources[s], distances);
+				if (sourceResult != TACORE_OK)
 				{
-					avgVal += geoMatrixDescPtr->m_GeoMatrix.getVal(v, w);
+#pragma omp critical
+					result = sourceResult;
+					continue;
 				}
-				avgVal /= geoMatrixDescPtr->m_GeoMatrix.cols();
 
-				LocalFeature *avgGeoDistDescPtr = new AvgGeodesicDistance(v, avgVal);
-				outFeatures[v] = LocalFeaturePtr(avgGeoDistDescPtr);
+				if (isSampled)
+				{
+					for (int w = 0; w < verSize; w++)
+					{
+						threadDistanceSums[w] += distances[w];
+						threadSqDistanceSums[w] += (double)distances[w] * distances[w];
+					}
+				}
+				else
+				{
+					double distanceSum = 0.0;
+					for (int w = 0; w < verSize; w++)
+					{
+						distanceSum += distances[w];
+					}
+					distanceSums[sources[s]] = distanceSum;
+				}
+
+#pragma omp critical
+				{
+					noProcessedSources++;
+					if (noProcessedSources < noSources)
+					{
+						std::cout << "%" << (100 * noProcessedSources) / noSources << " completed for calculating average geodesic distances" << "\r";
+					}
+					else
+					{
+						std::cout << "%" << 100 << " completed for calculating average geodesic distances" << "\n";
+					}
+				}
+			}
+
+			if (isSampled)
+			{
+#pragma omp critical
+				for (int w = 0; w < verSize; w++)
+				{
+					distanceSums[w] += threadDistanceSums[w];
+					sqDistanceSums[w] += threadSqDistanceSums[w];
+				}
 			}
 		}
+		TACORE_CHECK_RESULT(result);
 
-		return result;
+		//Half width of the interval of a mean of samples drawn without replacement from the distances to all vertices
+		double halfWidthFactor = 0.0;
+		if (isSampled)
+		{
+			const double finitePopulationCorrection = (double)(verSize - noSources) / (verSize - 1);
+			halfWidthFactor = calcTwoSidedNormalQuantile(this->m_fConfidenceLevel) * sqrt(finitePopulationCorrection / noSources);
+		}
+
+		outFeatures = std::vector<LocalFeaturePtr>(verSize);
+		for (int v = 0; v < verSize; v++)
+		{
+			AvgGeodesicDistance *avgGeoDistDescPtr = new AvgGeodesicDistance(v, (float)(distanceSums[v] / noSources));
+			if (isSampled && noSources > 1)
+			{
+				const double mean = distanceSums[v] / noSources;
+				const double variance = MAX(0.0, (sqDistanceSums[v] - noSources * mean * mean) / (noSources - 1));
+				avgGeoDistDescPtr->m_confidenceHalfWidth = (float)(halfWidthFactor * sqrt(variance));
+			}
+			outFeatures[v] = LocalFeaturePtr(avgGeoDistDescPtr);
+		}
+
+		return TACORE_OK;
 	}
 
 	Result OnEdgeAvgGeoDistExtraction::extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr)
@@ -87,4 +226,39 @@ namespace TAFeaExt
 
 		return result;
 	}
+
+	void OnEdgeAvgGeoDistExtraction::setNumberOfSourceSamples(const int& noSourceSamples)
+	{
+		this->m_nNumberOfSourceSamples = noSourceSamples;
+	}
+
+	void OnEdgeAvgGeoDistExtraction::setConfidenceLevel(const double& confidenceLevel)
+	{
+		this->m_fConfidenceLevel = confidenceLevel;
+	}
+
+	void OnEdgeAvgGeoDistExtraction::setRandomSeed(const unsigned int& randomSeed)
+	{
+		this->m_nRandomSeed = randomSeed;
+	}
+
+	void OnEdgeAvgGeoDistExtraction::setGeodesicDistanceMatrix(TAFea::GeodesicDistanceMatrix* gdMatrix)
+	{
+		this->m_pGeodesicDistanceMatrix = gdMatrix;
+	}
+
+	int OnEdgeAvgGeoDistExtraction::getNumberOfSourceSamples() const
+	{
+		return this->m_nNumberOfSourceSamples;
+	}
+
+	double OnEdgeAvgGeoDistExtraction::getConfidenceLevel() const
+	{
+		return this->m_fConfidenceLevel;
+	}
+
+	unsigned int OnEdgeAvgGeoDistExtraction::getRandomSeed() const
+	{
+		return this->m_nRandomSeed;
+	}
 }
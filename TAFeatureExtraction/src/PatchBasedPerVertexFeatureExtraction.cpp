@@ -1,7 +1,87 @@
 #include "PatchBasedPerVertexFeatureExtraction.h"
 #include <core/TriangularMesh.h>
 #include "GeodesicDistanceMatrixExtraction.h"
+#include <core/MemoryMappedFile.h>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	//Compact patch file layout:
+	//Header | Offsets of vertex records relative to the first record (numberOfVertices + 1 values) | Vertex records
+	//Vertex record: number of ids | scale end deltas | center delta | deltas between consecutive ids, all zigzag encoded varints
+	const char PATCH_FILE_MAGIC[4] = { 'T', 'A', 'P', 'F' };
+	const unsigned int PATCH_FILE_VERSION = 1;
+
+	struct PatchFileHeader
+	{
+		char m_vMagic[4];
+		unsigned int m_nVersion;
+		unsigned long long m_nNumberOfVertices;
+		unsigned int m_nNumberOfScales;
+		unsigned int m_nReserved;
+	};
+
+	unsigned int zigzagEncode(const int& val)
+	{
+		return (((unsigned int)val) << 1) ^ (unsigned int)(val >> 31);
+	}
+
+	int zigzagDecode(const unsigned int& val)
+	{
+		return (int)(val >> 1) ^ (-(int)(val & 1));
+	}
+
+	void writeVarint(unsigned int val, std::vector<unsigned char>& buffer)
+	{
+		while (val >= 0x80)
+		{
+			buffer.push_back((unsigned char)(val | 0x80));
+			val >>= 7;
+		}
+		buffer.push_back((unsigned char)val);
+	}
+
+	bool readVarint(const unsigned char*& ptr, const unsigned char* end, unsigned int& val)
+	{
+		val = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			if (ptr >= end)
+			{
+				return false;
+			}
+			const unsigned char byte = *ptr++;
+			val |= ((unsigned int)(byte & 0x7F)) << shift;
+			if (!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//Gets the header of a mapped patch file, NULL if the file is not a valid patch file
+	const PatchFileHeader* getPatchFileHeader(const TACore::MemoryMappedFile& patchFile)
+	{
+		if (patchFile.getSize() < sizeof(PatchFileHeader))
+		{
+			return NULL;
+		}
+		const PatchFileHeader* header = (const PatchFileHeader*)patchFile.getData();
+		if (memcmp(header->m_vMagic, PATCH_FILE_MAGIC, sizeof(PATCH_FILE_MAGIC)) != 0 || header->m_nVersion != PATCH_FILE_VERSION)
+		{
+			return NULL;
+		}
+		const unsigned long long indexSize = (header->m_nNumberOfVertices + 1) * sizeof(unsigned long long);
+		if (header->m_nNumberOfVertices >= patchFile.getSize() || patchFile.getSize() - sizeof(PatchFileHeader) < indexSize)
+		{
+			return NULL;
+		}
+		return header;
+	}
+}
 
 namespace TAFeaExt
 {
@@ -24,7 +104,8 @@ namespace TAFeaExt
 		m_fMaxGeodesicRadius = other.m_fMaxGeodesicRadius;
 		m_nNumberOfPatches = other.m_nNumberOfPatches;
 		m_pGeodeticDistanceMatrix = other.m_pGeodeticDistanceMatrix;
-		m_PatchesForAllVertices = other.m_PatchesForAllVertices;
+		m_pPatchesForAllVertices = other.m_pPatchesForAllVertices;
+		m_pPatchFile = other.m_pPatchFile;
 	}
 
 	Result PatchBasedPerVertexFeatureExtraction::extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures)
@@ -37,32 +118,92 @@ namespace TAFeaExt
 		//We, now, know that the mesh is a triangular mesh
 		TriangularMesh *triMesh = (TriangularMesh*)mesh;
 
+		Result result = preparePatches(triMesh);
+		if (result == TACore::TACORE_OK)
+		{
+			result = calcFeature(triMesh, *this->m_pPatchesForAllVertices, outFeatures);
+		}
+
+		return result;
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::extractToMatrix(PolygonMesh *mesh, FeatureMatrix<double>& outMatrix)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//We, now, know that the mesh is a triangular mesh
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+
+		TACORE_CHECK_RESULT(preparePatches(triMesh));
+		return calcFeatureMatrix(triMesh, *this->m_pPatchesForAllVertices, outMatrix);
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::calcFeatureMatrix(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, FeatureMatrix<double>& outMatrix)
+	{
+		std::vector<LocalFeaturePtr> features;
+		TACORE_CHECK_RESULT(calcFeature(triMesh, listOfPatches, features));
+		return createFeatureMatrix(features, outMatrix);
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::preparePatches(TriangularMesh* triMesh)
+	{
+		TACORE_CHECK_ARGS(triMesh != NULL);
+
 		Result result = TACore::TACORE_OK;
 
 		GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
 		geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
 
-		//If geodesic distance matrix is not set, calculate it
 		GlobalFeaturePtr globalFeaPtr; //Let it live if calculate the matrix
-		if (this->m_pGeodeticDistanceMatrix == NULL)
-		{	
-			result = geoDistMatrixExtraction.extract(mesh, globalFeaPtr);
-			m_pGeodeticDistanceMatrix = (GeodesicDistanceMatrix*)(globalFeaPtr.get());
-		}
-
-		if (!(this->m_PatchesForAllVertices.size() > 0))
+		if (!this->m_pPatchesForAllVertices || this->m_pPatchesForAllVertices->empty())
 		{
-			result = createPatches(triMesh, m_pGeodeticDistanceMatrix->m_GeoMatrix, this->m_fMinGeodesicRadius, this->m_fMaxGeodesicRadius, this->m_nNumberOfPatches, this->m_PatchesForAllVertices);
-		}
+			//Patches are created in a new list, the previous one may be shared with other extractors
+			std::shared_ptr<std::vector<VertexPatches> > patchesForAll(new std::vector<VertexPatches>());
+			if (this->m_pPatchFile)
+			{
+				//Patches are read from the patch file, no need for the geodesic distances
+				const int noVertices = (int)triMesh->verts.size();
+				TACORE_CHECK_RESULT(checkPatchFile(*this->m_pPatchFile, noVertices));
 
-		if (result == TACore::TACORE_OK)
-		{
-			result = calcFeature(triMesh, this->m_PatchesForAllVertices, outFeatures);
+				patchesForAll->resize(noVertices);
+				for (int v = 0; v < noVertices && result == TACore::TACORE_OK; v++)
+				{
+					result = readVertexPatchesFromPatchFile(*this->m_pPatchFile, v, (*patchesForAll)[v]);
+				}
+			}
+			else
+			{
+				//If geodesic distance matrix is not set, calculate it
+				if (this->m_pGeodeticDistanceMatrix == NULL)
+				{
+					result = geoDistMatrixExtraction.extract(triMesh, globalFeaPtr);
+					m_pGeodeticDistanceMatrix = (GeodesicDistanceMatrix*)(globalFeaPtr.get());
+				}
+
+				result = createPatches(triMesh, m_pGeodeticDistanceMatrix->m_GeoMatrix, this->m_fMinGeodesicRadius, this->m_fMaxGeodesicRadius, this->m_nNumberOfPatches, *patchesForAll);
+			}
+
+			if (result == TACore::TACORE_OK)
+			{
+				this->m_pPatchesForAllVertices = patchesForAll;
+			}
+			else
+			{
+				this->m_pPatchesForAllVertices.reset();
+			}
 		}
 
 		return result;
 	}
 
+	const std::vector<PatchBasedPerVertexFeatureExtraction::VertexPatches>& PatchBasedPerVertexFeatureExtraction::getPreparedPatches() const
+	{
+		return *this->m_pPatchesForAllVertices;
+	}
+
 	Result PatchBasedPerVertexFeatureExtraction::extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr)
 	{
 		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
@@ -75,14 +216,23 @@ namespace TAFeaExt
 
 		Result result = TACore::TACORE_OK;
 
-		GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
-		geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+		VertexPatches patches;
+		if (this->m_pPatchFile)
+		{
+			//Only the record of the vertex is read from the mapped file
+			TACORE_CHECK_RESULT(checkPatchFile(*this->m_pPatchFile, (int)triMesh->verts.size()));
+			result = readVertexPatchesFromPatchFile(*this->m_pPatchFile, id, patches);
+		}
+		else
+		{
+			GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
+			geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
 
-		std::vector<float> distances;
-		result = geoDistMatrixExtraction.extract(triMesh, id, distances);
+			std::vector<float> distances;
+			result = geoDistMatrixExtraction.extract(triMesh, id, distances);
 
-		PatchList patches;
-		result = createVertexPatches(triMesh, id, distances, this->m_fMinGeodesicRadius, this->m_fMaxGeodesicRadius, this->m_nNumberOfPatches, patches);
+			result = createVertexPatches(triMesh, id, distances, this->m_fMinGeodesicRadius, this->m_fMaxGeodesicRadius, this->m_nNumberOfPatches, patches);
+		}
 
 		if (result == TACore::TACORE_OK)
 		{
@@ -92,13 +242,13 @@ namespace TAFeaExt
 		return result;
 	}
 
-	Result PatchBasedPerVertexFeatureExtraction::createPatches(TriangularMesh* triMesh, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, std::vector<PatchList>& listOfPatchLists)
+	Result PatchBasedPerVertexFeatureExtraction::createPatches(TriangularMesh* triMesh, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, std::vector<VertexPatches>& listOfPatches)
 	{
 		TACORE_CHECK_ARGS(triMesh != NULL);
-		listOfPatchLists.clear();
+		listOfPatches.clear();
 
 		const int noVertices = (int) triMesh->verts.size();
-		listOfPatchLists = std::vector<PatchList>(noVertices);
+		listOfPatches = std::vector<VertexPatches>(noVertices);
 
 		for (int v = 0; v < noVertices; v++)
 		{
@@ -110,61 +260,89 @@ namespace TAFeaExt
 			{
 				std::cout << "%" << 100 << " completed for creating all patches for all vertices" << "\n";
 			}
-			TACORE_CHECK_RESULT( createVertexPatches(triMesh, v, distanceMatrix, minRadius, maxRadius, noOfPatches, listOfPatchLists[v]) );
+			TACORE_CHECK_RESULT( createVertexPatches(triMesh, v, distanceMatrix, minRadius, maxRadius, noOfPatches, listOfPatches[v]) );
 		}
 		return TACore::TACORE_OK;
 	}
 
-	Result PatchBasedPerVertexFeatureExtraction::createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, PatchList& patchesVertexIds)
+	Result PatchBasedPerVertexFeatureExtraction::createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const TAMatrix<float>& distanceMatrix, const float& minRadius, const float& maxRadius, const int& noOfPatches, VertexPatches& patches)
 	{
 		TACORE_CHECK_ARGS(triMesh != NULL);
-		patchesVertexIds.clear();
+		TACORE_CHECK_ARGS(vertexId >= 0 && vertexId < distanceMatrix.rows());
 
-		const float rIncrement = (maxRadius - minRadius) / (noOfPatches - 1);
-		float currentRadius = minRadius;
+		//Rows of the matrix are contiguous
+		createVertexPatchesFromDistances(vertexId, distanceMatrix.getRow(vertexId), distanceMatrix.cols(), minRadius, maxRadius, noOfPatches, patches);
+		return TACore::TACORE_OK;
+	}
 
-		patchesVertexIds = std::vector<std::vector<int> >(noOfPatches);
-		int scale = 0;
-		while (scale < noOfPatches)
-		{
-			for (int w = 0; w < distanceMatrix.cols(); w++)
-			{
-				if (distanceMatrix.getVal(vertexId, w) <= currentRadius)
-				{
-					patchesVertexIds[scale].push_back(w);
-				}
-			}
+	Result PatchBasedPerVertexFeatureExtraction::createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const std::vector<float>& distanceVector, const float& minRadius, const float& maxRadius, const int& noOfPatches, VertexPatches& patches)
+	{
+		TACORE_CHECK_ARGS(triMesh != NULL);
+		TACORE_CHECK_ARGS(vertexId >= 0 && vertexId < (int) distanceVector.size());
 
-			currentRadius += rIncrement;
-			scale++;
-		}
+		createVertexPatchesFromDistances(vertexId, &distanceVector[0], (int) distanceVector.size(), minRadius, maxRadius, noOfPatches, patches);
 		return TACore::TACORE_OK;
 	}
 
-	Result PatchBasedPerVertexFeatureExtraction::createVertexPatches(TriangularMesh* triMesh, const int& vertexId, const std::vector<float>& distanceVector, const float& minRadius, const float& maxRadius, const int& noOfPatches, PatchList& patchesVertexIds)
+	void PatchBasedPerVertexFeatureExtraction::createVertexPatchesFromDistances(const int& vertexId, const float* distanceRow, const int& noVertices, const float& minRadius, const float& maxRadius, const int& noOfPatches, VertexPatches& patches) const
 	{
-		TACORE_CHECK_ARGS(triMesh != NULL);
-		patchesVertexIds.clear();
+		patches.m_vVertexIds.clear();
+		patches.m_vScaleEnds.clear();
+		if (noOfPatches <= 0)
+		{
+			return;
+		}
 
+		//Radii are accumulated exactly as they were when each scale was a separate scan, so the patch contents do not change
 		const float rIncrement = (maxRadius - minRadius) / (noOfPatches - 1);
+		std::vector<float> radii(noOfPatches);
 		float currentRadius = minRadius;
+		float biggestRadius = minRadius;
+		for (int scale = 0; scale < noOfPatches; scale++)
+		{
+			radii[scale] = currentRadius;
+			biggestRadius = MAX(biggestRadius, currentRadius);
+			currentRadius += rIncrement;
+		}
 
-		patchesVertexIds = std::vector<std::vector<int> >(noOfPatches);
-		int scale = 0;
-		while (scale < noOfPatches)
+		//Single pass over the distance row collecting the vertices of the biggest patch
+		std::vector< std::pair<float, int> > candidates;
+		for (int w = 0; w < noVertices; w++)
 		{
-			for (int w = 0; w < (int) distanceVector.size(); w++)
+			if (distanceRow[w] <= biggestRadius)
 			{
-				if (distanceVector[w] <= currentRadius)
-				{
-					patchesVertexIds[scale].push_back(w);
-				}
+				//Center vertex comes first even if another vertex has zero distance to it
+				candidates.push_back(std::pair<float, int>(w == vertexId ? -1.0f : distanceRow[w], w));
 			}
+		}
+		std::sort(candidates.begin(), candidates.end());
 
-			currentRadius += rIncrement;
-			scale++;
+		const int noCandidates = (int) candidates.size();
+		patches.m_vVertexIds = std::vector<int>(noCandidates);
+		for (int c = 0; c < noCandidates; c++)
+		{
+			patches.m_vVertexIds[c] = candidates[c].second;
+		}
+
+		//End of each scale is the first candidate farther than its radius, scales are visited in the order of their radii
+		std::vector<int> scaleOrder(noOfPatches);
+		for (int scale = 0; scale < noOfPatches; scale++)
+		{
+			scaleOrder[scale] = scale;
+		}
+		std::stable_sort(scaleOrder.begin(), scaleOrder.end(), [&radii](const int& s0, const int& s1) { return radii[s0] < radii[s1]; });
+
+		patches.m_vScaleEnds = std::vector<int>(noOfPatches, 0);
+		int end = 0;
+		for (int i = 0; i < noOfPatches; i++)
+		{
+			const int scale = scaleOrder[i];
+			while (end < noCandidates && candidates[end].first <= radii[scale])
+			{
+				end++;
+			}
+			patches.m_vScaleEnds[scale] = end;
 		}
-		return TACore::TACORE_OK;
 	}
 
 	void PatchBasedPerVertexFeatureExtraction::setMinGeodesicDistance(const float& minGeoDistance)
@@ -202,17 +380,17 @@ namespace TAFeaExt
 		this->m_pGeodeticDistanceMatrix = gdMatrix;
 	}
 
-	void PatchBasedPerVertexFeatureExtraction::setPatchesForAllVertices(const std::vector<PatchList>& patchesForAll)
+	void PatchBasedPerVertexFeatureExtraction::setPatchesForAllVertices(const VertexPatchesListPtr& patchesForAll)
 	{
-		this->m_PatchesForAllVertices = patchesForAll;
+		this->m_pPatchesForAllVertices = patchesForAll;
 	}
 
-	std::vector<PatchBasedPerVertexFeatureExtraction::PatchList> PatchBasedPerVertexFeatureExtraction::getPatchesForAllVertices() const
+	PatchBasedPerVertexFeatureExtraction::VertexPatchesListPtr PatchBasedPerVertexFeatureExtraction::getPatchesForAllVertices() const
 	{
-		return this->m_PatchesForAllVertices;
+		return this->m_pPatchesForAllVertices;
 	}
 
-	Result PatchBasedPerVertexFeatureExtraction::savePatchesInBinary(const std::vector<PatchList>& patchesForAll, const std::string& pathToFile)
+	Result PatchBasedPerVertexFeatureExtraction::savePatchesInBinary(const std::vector<VertexPatches>& patchesForAll, const std::string& pathToFile)
 	{
 		Result res = TACORE_OK;
 		std::ofstream out(pathToFile, std::ios::out | std::ios::binary);
@@ -223,18 +401,23 @@ namespace TAFeaExt
 
 			if (numberOfVertices > 0)
 			{
-				const size_t numberOfPatchesPerVertex = patchesForAll[0].size();
+				const size_t numberOfPatchesPerVertex = patchesForAll[0].getNumberOfScales();
 				out.write((char*)&(numberOfPatchesPerVertex), sizeof(numberOfPatchesPerVertex));
 
+				//File keeps each patch as a separate list of vertex ids sorted by id
+				std::vector<int> singlePatch;
 				for (size_t v = 0; v < numberOfVertices; v++)
 				{
 					for (size_t p = 0; p < numberOfPatchesPerVertex; p++)
 					{
-						const size_t patchSize = patchesForAll[v][p].size();
+						const size_t patchSize = patchesForAll[v].getPatchSize((int) p);
+						singlePatch.assign(patchesForAll[v].m_vVertexIds.begin(), patchesForAll[v].m_vVertexIds.begin() + patchSize);
+						std::sort(singlePatch.begin(), singlePatch.end());
+
 						out.write((char*)&(patchSize), sizeof(patchSize));
 						for (size_t pv = 0; pv < patchSize; pv++)
 						{
-							int patchVertexIdx = patchesForAll[v][p][pv];
+							int patchVertexIdx = singlePatch[pv];
 							out.write((char*)&(patchVertexIdx), sizeof(patchVertexIdx));
 						}
 					}
@@ -252,7 +435,7 @@ namespace TAFeaExt
 		return res;
 	}
 
-	Result PatchBasedPerVertexFeatureExtraction::loadPatchesInBinary(const std::string& pathToFile, std::vector<PatchList>& patchesForAll)
+	Result PatchBasedPerVertexFeatureExtraction::loadPatchesInBinary(const std::string& pathToFile, std::vector<VertexPatches>& patchesForAll)
 	{
 		Result res = TACORE_OK;
 		std::ifstream inp(pathToFile, std::ios::in | std::ios::binary);
@@ -266,23 +449,41 @@ namespace TAFeaExt
 				size_t numberOfPatchesPerVertex;
 				inp.read((char*)&(numberOfPatchesPerVertex), sizeof(numberOfPatchesPerVertex));
 
-				patchesForAll = std::vector<PatchList>(numberOfVertices, PatchList(numberOfPatchesPerVertex, SinglePatch()));
+				patchesForAll = std::vector<VertexPatches>(numberOfVertices);
 
+				//Each scale adds the vertices which are not inside the previous one
+				std::vector<int> singlePatch;
+				std::vector<int> prevPatch;
 				for (size_t v = 0; v < numberOfVertices; v++)
 				{
+					VertexPatches& patches = patchesForAll[v];
+					patches.m_vScaleEnds = std::vector<int>(numberOfPatchesPerVertex, 0);
+					prevPatch.clear();
 					for (size_t p = 0; p < numberOfPatchesPerVertex; p++)
 					{
 						size_t patchSize;
 						inp.read((char*)&(patchSize), sizeof(patchSize));
 
-						patchesForAll[v][p] = SinglePatch(patchSize);
-
+						singlePatch = std::vector<int>(patchSize);
 						for (size_t pv = 0; pv < patchSize; pv++)
 						{
 							int patchVertexIdx;
 							inp.read((char*)&(patchVertexIdx), sizeof(patchVertexIdx));
-							patchesForAll[v][p][pv] = patchVertexIdx;
+							singlePatch[pv] = patchVertexIdx;
 						}
+						std::sort(singlePatch.begin(), singlePatch.end());
+
+						std::set_difference(singlePatch.begin(), singlePatch.end(), prevPatch.begin(), prevPatch.end(), std::back_inserter(patches.m_vVertexIds));
+						patches.m_vScaleEnds[p] = (int) patches.m_vVertexIds.size();
+						prevPatch.swap(singlePatch);
+					}
+
+					//Center vertex comes first, if it is inside the smallest patch
+					std::vector<int>::iterator smallestEnd = patches.m_vVertexIds.begin() + (numberOfPatchesPerVertex > 0 ? patches.m_vScaleEnds[0] : 0);
+					std::vector<int>::iterator centerIt = std::find(patches.m_vVertexIds.begin(), smallestEnd, (int) v);
+					if (centerIt != smallestEnd)
+					{
+						std::rotate(patches.m_vVertexIds.begin(), centerIt, centerIt + 1);
 					}
 				}
 
@@ -297,4 +498,196 @@ namespace TAFeaExt
 
 		return res;
 	}
-}
\ No newline at end of file
+
+	Result PatchBasedPerVertexFeatureExtraction::savePatchesInCompactBinary(const std::vector<VertexPatches>& patchesForAll, const std::string& pathToFile)
+	{
+		const size_t numberOfVertices = patchesForAll.size();
+		const int numberOfScales = numberOfVertices > 0 ? patchesForAll[0].getNumberOfScales() : 0;
+
+		//Encode all records first, the offset index is written before them
+		std::vector<unsigned char> records;
+		std::vector<unsigned long long> offsets(numberOfVertices + 1, 0);
+		for (size_t v = 0; v < numberOfVertices; v++)
+		{
+			const VertexPatches& patches = patchesForAll[v];
+			TACORE_CHECK_ARGS(patches.getNumberOfScales() == numberOfScales);
+
+			offsets[v] = records.size();
+
+			const int noIds = (int)patches.m_vVertexIds.size();
+			writeVarint((unsigned int)noIds, records);
+
+			int prev = 0;
+			for (int scale = 0; scale < numberOfScales; scale++)
+			{
+				writeVarint(zigzagEncode(patches.m_vScaleEnds[scale] - prev), records);
+				prev = patches.m_vScaleEnds[scale];
+			}
+
+			//Neighbours have close ids in most meshes, so the deltas are small
+			prev = (int)v;
+			for (int i = 0; i < noIds; i++)
+			{
+				writeVarint(zigzagEncode(patches.m_vVertexIds[i] - prev), records);
+				prev = patches.m_vVertexIds[i];
+			}
+		}
+		offsets[numberOfVertices] = records.size();
+
+		std::ofstream out(pathToFile, std::ios::out | std::ios::binary);
+		if (!out.is_open())
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		PatchFileHeader header;
+		memcpy(header.m_vMagic, PATCH_FILE_MAGIC, sizeof(PATCH_FILE_MAGIC));
+		header.m_nVersion = PATCH_FILE_VERSION;
+		header.m_nNumberOfVertices = numberOfVertices;
+		header.m_nNumberOfScales = (unsigned int)numberOfScales;
+		header.m_nReserved = 0;
+
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)&offsets[0], offsets.size() * sizeof(unsigned long long));
+		if (!records.empty())
+		{
+			out.write((const char*)&records[0], records.size());
+		}
+		const bool isWritten = out.good();
+		out.close();
+
+		return isWritten ? TACORE_OK : TACORE_FILE_ERROR;
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::loadPatchesInCompactBinary(const std::string& pathToFile, std::vector<VertexPatches>& patchesForAll)
+	{
+		TACore::MemoryMappedFile patchFile;
+		TACORE_CHECK_RESULT(patchFile.open(pathToFile));
+
+		const PatchFileHeader* header = getPatchFileHeader(patchFile);
+		if (header == NULL)
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		const int numberOfVertices = (int)header->m_nNumberOfVertices;
+		std::vector<VertexPatches> patches(numberOfVertices);
+		for (int v = 0; v < numberOfVertices; v++)
+		{
+			TACORE_CHECK_RESULT(readVertexPatchesFromPatchFile(patchFile, v, patches[v]));
+		}
+		patchesForAll.swap(patches);
+
+		return TACORE_OK;
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::openPatchFile(const std::string& pathToFile)
+	{
+		std::shared_ptr<TACore::MemoryMappedFile> patchFile(new TACore::MemoryMappedFile());
+		TACORE_CHECK_RESULT(patchFile->open(pathToFile));
+		if (getPatchFileHeader(*patchFile) == NULL)
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		//Patches calculated before are not valid anymore
+		this->m_pPatchFile = patchFile;
+		this->m_pPatchesForAllVertices.reset();
+
+		return TACORE_OK;
+	}
+
+	void PatchBasedPerVertexFeatureExtraction::closePatchFile()
+	{
+		this->m_pPatchFile.reset();
+		this->m_pPatchesForAllVertices.reset();
+	}
+
+	bool PatchBasedPerVertexFeatureExtraction::isPatchFileOpen() const
+	{
+		return (bool)this->m_pPatchFile;
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::checkPatchFile(const TACore::MemoryMappedFile& patchFile, const int& noVertices) const
+	{
+		const PatchFileHeader* header = getPatchFileHeader(patchFile);
+		if (header == NULL)
+		{
+			return TACORE_FILE_ERROR;
+		}
+		if (header->m_nNumberOfVertices != (unsigned long long)noVertices || header->m_nNumberOfScales != (unsigned int)this->m_nNumberOfPatches)
+		{
+			std::cerr << "Patch file does not match the mesh or the number of patches!" << std::endl;
+			return TACORE_INVALID_OPERATION;
+		}
+		return TACORE_OK;
+	}
+
+	Result PatchBasedPerVertexFeatureExtraction::readVertexPatchesFromPatchFile(const TACore::MemoryMappedFile& patchFile, const int& vertexId, VertexPatches& patches) const
+	{
+		const PatchFileHeader* header = getPatchFileHeader(patchFile);
+		if (header == NULL)
+		{
+			return TACORE_FILE_ERROR;
+		}
+		TACORE_CHECK_ARGS(vertexId >= 0 && (unsigned long long)vertexId < header->m_nNumberOfVertices);
+
+		//Offsets may not be aligned inside the file, copy them
+		const unsigned char* index = patchFile.getData() + sizeof(PatchFileHeader);
+		unsigned long long recordOffsets[2];
+		memcpy(recordOffsets, index + vertexId * sizeof(unsigned long long), sizeof(recordOffsets));
+
+		const unsigned char* records = index + (header->m_nNumberOfVertices + 1) * sizeof(unsigned long long);
+		const unsigned long long recordsSize = patchFile.getSize() - (records - patchFile.getData());
+		if (recordOffsets[0] > recordOffsets[1] || recordOffsets[1] > recordsSize)
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		const unsigned char* ptr = records + recordOffsets[0];
+		const unsigned char* end = records + recordOffsets[1];
+
+		unsigned int noIds;
+		if (!readVarint(ptr, end, noIds) || noIds > (unsigned int)(end - ptr))
+		{
+			return TACORE_FILE_ERROR;
+		}
+
+		const int numberOfScales = (int)header->m_nNumberOfScales;
+		patches.m_vScaleEnds = std::vector<int>(numberOfScales);
+		patches.m_vVertexIds = std::vector<int>(noIds);
+
+		unsigned int val;
+		int prev = 0;
+		for (int scale = 0; scale < numberOfScales; scale++)
+		{
+			if (!readVarint(ptr, end, val))
+			{
+				return TACORE_FILE_ERROR;
+			}
+			prev += zigzagDecode(val);
+			if (prev < 0 || prev > (int)noIds)
+			{
+				return TACORE_FILE_ERROR;
+			}
+			patches.m_vScaleEnds[scale] = prev;
+		}
+
+		prev = vertexId;
+		for (unsigned int i = 0; i < noIds; i++)
+		{
+			if (!readVarint(ptr, end, val))
+			{
+				return TACORE_FILE_ERROR;
+			}
+			prev += zigzagDecode(val);
+			if (prev < 0 || (unsigned long long)prev >= header->m_nNumberOfVertices)
+			{
+				return TACORE_FILE_ERROR;
+			}
+			patches.m_vVertexIds[i] = prev;
+		}
+
+		return TACORE_OK;
+	}
+}
@@ -3,9 +3,443 @@
 #include <core/TriangularMesh.h>
 #include <core/NDimVector.h>
 #include <core/StdVectorUtil.h>
-#include <unordered_set>
+#include <core/PhiloxRandom.h>
 #include <fstream>
-#include <time.h>
+#include <climits>
+#include <cfloat>
+#include <unordered_map>
+#ifdef TACORE_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	typedef TAFeaExt::PatchBasedShapeDistributionDescExtraction::ShapeDistributionFunction ShapeDistributionFunction;
+
+	const int SAMPLE_BATCH_SIZE = 64;
+	const int MAX_NUMBER_OF_SAMPLE_POINTS = 4;
+
+	//Points of a batch of samples in structure of arrays layout
+	//Coordinates of the j-th point of the i-th sample are at [j][i], so the kernels run over contiguous arrays
+	struct SampleBatch
+	{
+		double m_vX[MAX_NUMBER_OF_SAMPLE_POINTS][SAMPLE_BATCH_SIZE];
+		double m_vY[MAX_NUMBER_OF_SAMPLE_POINTS][SAMPLE_BATCH_SIZE];
+		double m_vZ[MAX_NUMBER_OF_SAMPLE_POINTS][SAMPLE_BATCH_SIZE];
+	};
+
+#ifdef TACORE_HAS_SSE2
+	//Two samples at a time versions of atan2 and cbrt, compilers do not vectorize the loops calling the ones of the standard library
+	//Both follow the Cephes and fdlibm ones and are accurate to a few ulps in the ranges of the kernels
+
+	const double SAMPLE_KERNEL_PI = 3.14159265358979323846;
+
+	//atan2(y, x) for y >= 0, the ratio of the smaller to the larger magnitude is reduced to [-0.21, 0.66] and given to a rational approximation
+	__m128d atan2OfNonNegative(const __m128d& y, const __m128d& x)
+	{
+		const __m128d zero = _mm_setzero_pd();
+		const __m128d absX = _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+		const __m128d larger = _mm_max_pd(y, absX);
+		const __m128d smaller = _mm_min_pd(y, absX);
+		const __m128d isSteep = _mm_cmpgt_pd(y, absX);
+
+		//atan(s / l) = pi / 4 + atan((s - l) / (s + l)) for ratios above 0.66, a single division gives either of them
+		const __m128d isLarge = _mm_cmpgt_pd(smaller, _mm_mul_pd(_mm_set1_pd(0.66), larger));
+		const __m128d numerator = _mm_or_pd(_mm_and_pd(isLarge, _mm_sub_pd(smaller, larger)), _mm_andnot_pd(isLarge, smaller));
+		const __m128d denominator = _mm_or_pd(_mm_and_pd(isLarge, _mm_add_pd(smaller, larger)), _mm_andnot_pd(isLarge, larger));
+		const __m128d t = _mm_and_pd(_mm_div_pd(numerator, denominator), _mm_cmpgt_pd(larger, zero));
+		const __m128d z = _mm_mul_pd(t, t);
+		__m128d p = _mm_set1_pd(-8.750608600031904122785E-1);
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.615753718733365076637E1));
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-7.500855792314704667340E1));
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-1.228866684490136173410E2));
+		p = _mm_add_pd(_mm_mul_pd(p, z), _mm_set1_pd(-6.485021904942025371773E1));
+		__m128d q = _mm_add_pd(z, _mm_set1_pd(2.485846490142306297962E1));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.650270098316988542046E2));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.328810604912902668951E2));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(4.853903996359136964868E2));
+		q = _mm_add_pd(_mm_mul_pd(q, z), _mm_set1_pd(1.945506571482613964425E2));
+		__m128d angle = _mm_add_pd(t, _mm_mul_pd(_mm_mul_pd(t, z), _mm_div_pd(p, q)));
+		angle = _mm_add_pd(angle, _mm_and_pd(isLarge, _mm_set1_pd(SAMPLE_KERNEL_PI / 4.0)));
+
+		//Back to the octant of (x, y)
+		angle = _mm_or_pd(_mm_and_pd(isSteep, _mm_sub_pd(_mm_set1_pd(SAMPLE_KERNEL_PI / 2.0), angle)), _mm_andnot_pd(isSteep, angle));
+		const __m128d isNegativeX = _mm_cmplt_pd(x, zero);
+		return _mm_or_pd(_mm_and_pd(isNegativeX, _mm_sub_pd(_mm_set1_pd(SAMPLE_KERNEL_PI), angle)), _mm_andnot_pd(isNegativeX, angle));
+	}
+
+	//cbrt(x) for x >= 0, the exponent of the guess is the third of the one of x and three Halley iterations refine it
+	//Zeros and subnormals, for which the guess is off, are calculated by the standard library
+	__m128d cbrtOfNonNegative(const __m128d& x)
+	{
+		const __m128i highWords = _mm_shuffle_epi32(_mm_castpd_si128(x), _MM_SHUFFLE(3, 1, 3, 1));
+		const __m128i guessHighWords = _mm_add_epi32(_mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(highWords), _mm_set1_pd(1.0 / 3.0))), _mm_set1_epi32(715094163));
+		__m128d y = _mm_castsi128_pd(_mm_unpacklo_epi32(_mm_setzero_si128(), guessHighWords));
+		for (int iteration = 0; iteration < 3; iteration++)
+		{
+			const __m128d y3 = _mm_mul_pd(_mm_mul_pd(y, y), y);
+			y = _mm_mul_pd(y, _mm_div_pd(_mm_add_pd(y3, _mm_add_pd(x, x)), _mm_add_pd(_mm_add_pd(y3, y3), x)));
+		}
+
+		if (_mm_movemask_pd(_mm_cmplt_pd(x, _mm_set1_pd(DBL_MIN))) != 0)
+		{
+			double values[2];
+			double roots[2];
+			_mm_storeu_pd(values, x);
+			_mm_storeu_pd(roots, y);
+			for (int i = 0; i < 2; i++)
+			{
+				if (values[i] < DBL_MIN)
+				{
+					roots[i] = cbrt(values[i]);
+				}
+			}
+			y = _mm_loadu_pd(roots);
+		}
+		return y;
+	}
+#endif
+
+	//Sample kernels of the distribution functions
+	//NUMBER_OF_POINTS is the number of random points of a sample, evaluate calculates the samples of a batch
+	//Loops have no branches and no calls other than sqrt so that the compiler vectorizes them,
+	//A3 and D4 call atan2 and cbrt, so they run on two samples at a time with SSE2 where it is there and finish the batch with the scalar loop
+	template<ShapeDistributionFunction F>
+	struct SampleKernel;
+
+	template<>
+	struct SampleKernel<TAFeaExt::PatchBasedShapeDistributionDescExtraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS>
+	{
+		enum { NUMBER_OF_POINTS = 3 };
+
+		//Angle between pt1 ----> pt2 and pt1 ----> pt3 from the norm of the cross product and the dot product
+		static void evaluate(const SampleBatch& batch, const int& count, const double* fixedPoint, double* out)
+		{
+			int i = 0;
+#ifdef TACORE_HAS_SSE2
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128d x0 = _mm_loadu_pd(&batch.m_vX[0][i]), y0 = _mm_loadu_pd(&batch.m_vY[0][i]), z0 = _mm_loadu_pd(&batch.m_vZ[0][i]);
+				const __m128d ux = _mm_sub_pd(_mm_loadu_pd(&batch.m_vX[1][i]), x0), uy = _mm_sub_pd(_mm_loadu_pd(&batch.m_vY[1][i]), y0), uz = _mm_sub_pd(_mm_loadu_pd(&batch.m_vZ[1][i]), z0);
+				const __m128d vx = _mm_sub_pd(_mm_loadu_pd(&batch.m_vX[2][i]), x0), vy = _mm_sub_pd(_mm_loadu_pd(&batch.m_vY[2][i]), y0), vz = _mm_sub_pd(_mm_loadu_pd(&batch.m_vZ[2][i]), z0);
+				const __m128d cx = _mm_sub_pd(_mm_mul_pd(uy, vz), _mm_mul_pd(uz, vy));
+				const __m128d cy = _mm_sub_pd(_mm_mul_pd(uz, vx), _mm_mul_pd(ux, vz));
+				const __m128d cz = _mm_sub_pd(_mm_mul_pd(ux, vy), _mm_mul_pd(uy, vx));
+				const __m128d crossNorm = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, cx), _mm_mul_pd(cy, cy)), _mm_mul_pd(cz, cz)));
+				const __m128d dot = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ux, vx), _mm_mul_pd(uy, vy)), _mm_mul_pd(uz, vz));
+				_mm_storeu_pd(out + i, atan2OfNonNegative(crossNorm, dot));
+			}
+#endif
+			for (; i < count; i++)
+			{
+				const double ux = batch.m_vX[1][i] - batch.m_vX[0][i], uy = batch.m_vY[1][i] - batch.m_vY[0][i], uz = batch.m_vZ[1][i] - batch.m_vZ[0][i];
+				const double vx = batch.m_vX[2][i] - batch.m_vX[0][i], vy = batch.m_vY[2][i] - batch.m_vY[0][i], vz = batch.m_vZ[2][i] - batch.m_vZ[0][i];
+				const double cx = uy * vz - uz * vy, cy = uz * vx - ux * vz, cz = ux * vy - uy * vx;
+				out[i] = atan2(sqrt(cx * cx + cy * cy + cz * cz), ux * vx + uy * vy + uz * vz);
+			}
+		}
+	};
+
+	template<>
+	struct SampleKernel<TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT>
+	{
+		enum { NUMBER_OF_POINTS = 1 };
+
+		static void evaluate(const SampleBatch& batch, const int& count, const double* fixedPoint, double* out)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				const double dx = batch.m_vX[0][i] - fixedPoint[0], dy = batch.m_vY[0][i] - fixedPoint[1], dz = batch.m_vZ[0][i] - fixedPoint[2];
+				out[i] = sqrt(dx * dx + dy * dy + dz * dz);
+			}
+		}
+	};
+
+	template<>
+	struct SampleKernel<TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS>
+	{
+		enum { NUMBER_OF_POINTS = 2 };
+
+		static void evaluate(const SampleBatch& batch, const int& count, const double* fixedPoint, double* out)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				const double dx = batch.m_vX[1][i] - batch.m_vX[0][i], dy = batch.m_vY[1][i] - batch.m_vY[0][i], dz = batch.m_vZ[1][i] - batch.m_vZ[0][i];
+				out[i] = sqrt(dx * dx + dy * dy + dz * dz);
+			}
+		}
+	};
+
+	template<>
+	struct SampleKernel<TAFeaExt::PatchBasedShapeDistributionDescExtraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS>
+	{
+		enum { NUMBER_OF_POINTS = 3 };
+
+		//Area is the half of the norm of the cross product
+		static void evaluate(const SampleBatch& batch, const int& count, const double* fixedPoint, double* out)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				const double ux = batch.m_vX[1][i] - batch.m_vX[0][i], uy = batch.m_vY[1][i] - batch.m_vY[0][i], uz = batch.m_vZ[1][i] - batch.m_vZ[0][i];
+				const double vx = batch.m_vX[2][i] - batch.m_vX[0][i], vy = batch.m_vY[2][i] - batch.m_vY[0][i], vz = batch.m_vZ[2][i] - batch.m_vZ[0][i];
+				const double cx = uy * vz - uz * vy, cy = uz * vx - ux * vz, cz = ux * vy - uy * vx;
+				out[i] = sqrt(0.5 * sqrt(cx * cx + cy * cy + cz * cz));
+			}
+		}
+	};
+
+	template<>
+	struct SampleKernel<TAFeaExt::PatchBasedShapeDistributionDescExtraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS>
+	{
+		enum { NUMBER_OF_POINTS = 4 };
+
+		//Volume is the sixth of the triple product of the edges to the fourth point
+		static void evaluate(const SampleBatch& batch, const int& count, const double* fixedPoint, double* out)
+		{
+			int i = 0;
+#ifdef TACORE_HAS_SSE2
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128d x3 = _mm_loadu_pd(&batch.m_vX[3][i]), y3 = _mm_loadu_pd(&batch.m_vY[3][i]), z3 = _mm_loadu_pd(&batch.m_vZ[3][i]);
+				const __m128d ux = _mm_sub_pd(_mm_loadu_pd(&batch.m_vX[0][i]), x3), uy = _mm_sub_pd(_mm_loadu_pd(&batch.m_vY[0][i]), y3), uz = _mm_sub_pd(_mm_loadu_pd(&batch.m_vZ[0][i]), z3);
+				const __m128d vx = _mm_sub_pd(_mm_loadu_pd(&batch.m_vX[1][i]), x3), vy = _mm_sub_pd(_mm_loadu_pd(&batch.m_vY[1][i]), y3), vz = _mm_sub_pd(_mm_loadu_pd(&batch.m_vZ[1][i]), z3);
+				const __m128d wx = _mm_sub_pd(_mm_loadu_pd(&batch.m_vX[2][i]), x3), wy = _mm_sub_pd(_mm_loadu_pd(&batch.m_vY[2][i]), y3), wz = _mm_sub_pd(_mm_loadu_pd(&batch.m_vZ[2][i]), z3);
+				const __m128d tripleProduct = _mm_add_pd(_mm_add_pd(
+					_mm_mul_pd(ux, _mm_sub_pd(_mm_mul_pd(vy, wz), _mm_mul_pd(vz, wy))),
+					_mm_mul_pd(uy, _mm_sub_pd(_mm_mul_pd(vz, wx), _mm_mul_pd(vx, wz)))),
+					_mm_mul_pd(uz, _mm_sub_pd(_mm_mul_pd(vx, wy), _mm_mul_pd(vy, wx))));
+				const __m128d volume = _mm_div_pd(_mm_andnot_pd(_mm_set1_pd(-0.0), tripleProduct), _mm_set1_pd(6.0));
+				_mm_storeu_pd(out + i, cbrtOfNonNegative(volume));
+			}
+#endif
+			for (; i < count; i++)
+			{
+				const double ux = batch.m_vX[0][i] - batch.m_vX[3][i], uy = batch.m_vY[0][i] - batch.m_vY[3][i], uz = batch.m_vZ[0][i] - batch.m_vZ[3][i];
+				const double vx = batch.m_vX[1][i] - batch.m_vX[3][i], vy = batch.m_vY[1][i] - batch.m_vY[3][i], vz = batch.m_vZ[1][i] - batch.m_vZ[3][i];
+				const double wx = batch.m_vX[2][i] - batch.m_vX[3][i], wy = batch.m_vY[2][i] - batch.m_vY[3][i], wz = batch.m_vZ[2][i] - batch.m_vZ[3][i];
+				const double tripleProduct = ux * (vy * wz - vz * wy) + uy * (vz * wx - vx * wz) + uz * (vx * wy - vy * wx);
+				out[i] = cbrt(fabs(tripleProduct) / 6.0);
+			}
+		}
+	};
+
+	//Maps noPoints random numbers to different indices in [0, range) in the order they are drawn without rejection
+	//The k-th index is mapped into the range - k remaining ones and shifted over the smaller indices drawn before
+	//Shifting and keeping the drawn indices sorted use comparisons instead of branches, which the random indices mispredict
+	//If the range is smaller than the number of points, indices are mapped with repetition
+	void drawDistinctIndices(const uint32_t* randoms, const int& range, const int& noPoints, int* indices)
+	{
+		if (range < noPoints)
+		{
+			for (int k = 0; k < noPoints; k++)
+			{
+				indices[k] = (int)TACore::PhiloxRandom::toRange(randoms[k], (uint32_t)range);
+			}
+			return;
+		}
+
+		int sortedIndices[MAX_NUMBER_OF_SAMPLE_POINTS];
+		for (int k = 0; k < noPoints; k++)
+		{
+			//Sorted indices are visited in ascending order, so the shifted index passes exactly the ones not greater than itself
+			int index = (int)TACore::PhiloxRandom::toRange(randoms[k], (uint32_t)(range - k));
+			for (int j = 0; j < k; j++)
+			{
+				index += (sortedIndices[j] <= index) ? 1 : 0;
+			}
+			indices[k] = index;
+			if (k + 1 == noPoints)
+			{
+				break;
+			}
+
+			//Bubbled down to its place from the end
+			sortedIndices[k] = index;
+			for (int j = k; j > 0; j--)
+			{
+				const int smaller = MIN(sortedIndices[j - 1], sortedIndices[j]);
+				const int larger = MAX(sortedIndices[j - 1], sortedIndices[j]);
+				sortedIndices[j - 1] = smaller;
+				sortedIndices[j] = larger;
+			}
+		}
+	}
+
+	//Random points of the biased vertex sampling, the vertices of the patch are drawn uniformly
+	struct VertexPointSampler
+	{
+		enum { RANDOMS_PER_POINT = 1 };
+
+		const double* m_pCoords;			//< Coordinates of the mesh vertices
+		const int* m_pVertexIds;			//< Vertex ids of the patch
+		int m_nPatchSize;					//< Number of vertices in the patch
+
+		void fillSample(const uint32_t* randoms, const int& noPoints, const int& sampleIdx, SampleBatch& batch) const
+		{
+			int indices[MAX_NUMBER_OF_SAMPLE_POINTS];
+			drawDistinctIndices(randoms, m_nPatchSize, noPoints, indices);
+			for (int j = 0; j < noPoints; j++)
+			{
+				const double* vertexCoords = m_pCoords + 3 * m_pVertexIds[indices[j]];
+				batch.m_vX[j][sampleIdx] = vertexCoords[0];
+				batch.m_vY[j][sampleIdx] = vertexCoords[1];
+				batch.m_vZ[j][sampleIdx] = vertexCoords[2];
+			}
+		}
+	};
+
+	//Random points of the unbiased surface sampling, points are uniform on the surface of the triangles of the patch
+	//A layer is drawn in proportion to its area, then a triangle of the layer in proportion to its area, then a point inside the triangle
+	struct SurfacePointSampler
+	{
+		enum { RANDOMS_PER_POINT = 6 };
+
+		const double* m_pCoords;						//< Coordinates of the mesh vertices
+		const int* m_pTriangleVertexIds;				//< Vertex ids of the triangles of the patch, 3 per triangle
+		const int* m_pLayerStarts;						//< Start of each layer inside the triangles
+		const TACore::AliasTable* m_pLayerTables;		//< Alias table over the triangle areas of each layer
+		const TACore::AliasTable* m_pScaleTable;		//< Alias table over the areas of the layers inside the patch
+
+		void fillSample(const uint32_t* randoms, const int& noPoints, const int& sampleIdx, SampleBatch& batch) const
+		{
+			for (int j = 0; j < noPoints; j++, randoms += RANDOMS_PER_POINT)
+			{
+				const int layer = m_pScaleTable->sample(randoms[0], randoms[1]);
+				const int triangle = m_pLayerStarts[layer] + m_pLayerTables[layer].sample(randoms[2], randoms[3]);
+				const double* a = m_pCoords + 3 * m_pTriangleVertexIds[3 * triangle];
+				const double* b = m_pCoords + 3 * m_pTriangleVertexIds[3 * triangle + 1];
+				const double* c = m_pCoords + 3 * m_pTriangleVertexIds[3 * triangle + 2];
+
+				//Uniform barycentric coordinates, see http://graphics.stanford.edu/courses/cs468-08-fall/pdf/osada.pdf 4.2
+				const double sqrtR1 = sqrt((randoms[4] + 0.5) * (1.0 / 4294967296.0));
+				const double r2 = (randoms[5] + 0.5) * (1.0 / 4294967296.0);
+				const double wa = 1.0 - sqrtR1;
+				const double wb = sqrtR1 * (1.0 - r2);
+				const double wc = sqrtR1 * r2;
+				batch.m_vX[j][sampleIdx] = wa * a[0] + wb * b[0] + wc * c[0];
+				batch.m_vY[j][sampleIdx] = wa * a[1] + wb * b[1] + wc * c[1];
+				batch.m_vZ[j][sampleIdx] = wa * a[2] + wb * b[2] + wc * c[2];
+			}
+		}
+	};
+
+	//Creates the samples of a patch in batches from the random points of the sampler
+	template<ShapeDistributionFunction F, class PointSampler>
+	void createSamples(const PointSampler& sampler, const double* fixedPoint, const int& sampleCount, TACore::PhiloxRandom& rng, double* samples)
+	{
+		typedef SampleKernel<F> Kernel;
+		const int randomsPerSample = PointSampler::RANDOMS_PER_POINT * Kernel::NUMBER_OF_POINTS;
+
+		SampleBatch batch;
+		std::vector<uint32_t> randoms(randomsPerSample * SAMPLE_BATCH_SIZE);
+		for (int batchStart = 0; batchStart < sampleCount; batchStart += SAMPLE_BATCH_SIZE)
+		{
+			const int count = MIN(SAMPLE_BATCH_SIZE, sampleCount - batchStart);
+			rng.fill(&randoms[0], count * randomsPerSample);
+			for (int i = 0; i < count; i++)
+			{
+				sampler.fillSample(&randoms[i * randomsPerSample], Kernel::NUMBER_OF_POINTS, i, batch);
+			}
+			Kernel::evaluate(batch, count, fixedPoint, samples + batchStart);
+		}
+	}
+
+	//Resolves the distribution function once for all samples of the patch
+	template<class PointSampler>
+	void createSamples(const ShapeDistributionFunction& function, const PointSampler& sampler, const double* fixedPoint, const int& sampleCount, TACore::PhiloxRandom& rng, double* samples)
+	{
+		typedef TAFeaExt::PatchBasedShapeDistributionDescExtraction Extraction;
+		switch (function)
+		{
+			case Extraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS: createSamples<Extraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS>(sampler, fixedPoint, sampleCount, rng, samples); break;
+			case Extraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT: createSamples<Extraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT>(sampler, fixedPoint, sampleCount, rng, samples); break;
+			case Extraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS: createSamples<Extraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS>(sampler, fixedPoint, sampleCount, rng, samples); break;
+			case Extraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS: createSamples<Extraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS>(sampler, fixedPoint, sampleCount, rng, samples); break;
+			case Extraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS: createSamples<Extraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS>(sampler, fixedPoint, sampleCount, rng, samples); break;
+		}
+	}
+
+	//Number of samples of a combination of points in the exact histograms
+	//Angle depends on which point is the apex, so each combination gives a sample for each of its three points
+	int getNumberOfOrderingsOfACombination(const ShapeDistributionFunction& function)
+	{
+		return (function == TAFeaExt::PatchBasedShapeDistributionDescExtraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS) ? 3 : 1;
+	}
+
+	//Enumerates all combinations of different vertices of the patch in batches and evaluates the kernel on them
+	//Combinations are visited in lexicographic order, the j-th point of the r-th ordering of a combination is its ((j + r) mod k)-th vertex
+	template<ShapeDistributionFunction F>
+	void createExactSamples(const double* coords, const int* vertexIds, const int& patchSize, const double* fixedPoint, double* samples)
+	{
+		typedef SampleKernel<F> Kernel;
+		const int noPoints = Kernel::NUMBER_OF_POINTS;
+		const int noOrderings = getNumberOfOrderingsOfACombination(F);
+
+		int combination[MAX_NUMBER_OF_SAMPLE_POINTS];
+		for (int j = 0; j < noPoints; j++)
+		{
+			combination[j] = j;
+		}
+
+		SampleBatch batch;
+		int count = 0;
+		bool hasNext = (patchSize >= noPoints);
+		while (hasNext)
+		{
+			for (int r = 0; r < noOrderings; r++)
+			{
+				for (int j = 0; j < noPoints; j++)
+				{
+					const double* vertexCoords = coords + 3 * vertexIds[combination[(j + r) % noPoints]];
+					batch.m_vX[j][count] = vertexCoords[0];
+					batch.m_vY[j][count] = vertexCoords[1];
+					batch.m_vZ[j][count] = vertexCoords[2];
+				}
+				if (++count == SAMPLE_BATCH_SIZE)
+				{
+					Kernel::evaluate(batch, count, fixedPoint, samples);
+					samples += count;
+					count = 0;
+				}
+			}
+
+			//Next combination, the rightmost index which can move is incremented and the ones after it follow it
+			int pos = noPoints - 1;
+			while (pos >= 0 && combination[pos] == patchSize - noPoints + pos)
+			{
+				pos--;
+			}
+			hasNext = (pos >= 0);
+			if (hasNext)
+			{
+				combination[pos]++;
+				for (int j = pos + 1; j < noPoints; j++)
+				{
+					combination[j] = combination[j - 1] + 1;
+				}
+			}
+		}
+		if (count > 0)
+		{
+			Kernel::evaluate(batch, count, fixedPoint, samples);
+		}
+	}
+
+	//Copies the coordinates of all vertices into a contiguous array in double precision
+	//Coordinates of a vertex are kept together since the samples gather random vertices
+	void gatherMeshCoordinates(const TAShape::TriangularMesh* triMesh, std::vector<double>& meshCoords)
+	{
+		const int noVertices = (int)triMesh->verts.size();
+		meshCoords = std::vector<double>(3 * noVertices);
+		for (int v = 0; v < noVertices; v++)
+		{
+			const float* coords = triMesh->verts[v]->coords;
+			meshCoords[3 * v] = coords[0];
+			meshCoords[3 * v + 1] = coords[1];
+			meshCoords[3 * v + 2] = coords[2];
+		}
+	}
+}
 
 namespace TAFeaExt
 {
@@ -27,6 +461,8 @@ namespace TAFeaExt
 
 		this->m_nNumberOfBins = 8;
 		this->m_nSampleCount = 256;
+		this->m_nRandomSeed = 5489;
+		this->m_nExactSampleThreshold = 0;
 	}
 
 	PatchBasedShapeDistributionDescExtraction::PatchBasedShapeDistributionDescExtraction(const PatchBasedShapeDistributionDescExtraction& other)
@@ -37,6 +473,8 @@ namespace TAFeaExt
 		this->m_lfMinPossibleSample = other.m_lfMaxPossibleSample;
 		this->m_nNumberOfBins = other.m_nNumberOfBins;
 		this->m_nSampleCount = other.m_nSampleCount;
+		this->m_nRandomSeed = other.m_nRandomSeed;
+		this->m_nExactSampleThreshold = other.m_nExactSampleThreshold;
 	}
 
 	void PatchBasedShapeDistributionDescExtraction::setShapeDistributionFunction(const ShapeDistributionFunction& shapeDistributionFunction)
@@ -91,20 +529,159 @@ namespace TAFeaExt
 		return this->m_lfMaxPossibleSample;
 	}
 
+	void PatchBasedShapeDistributionDescExtraction::setRandomSeed(const unsigned int& randomSeed)
+	{
+		this->m_nRandomSeed = randomSeed;
+	}
+
+	unsigned int PatchBasedShapeDistributionDescExtraction::getRandomSeed() const
+	{
+		return this->m_nRandomSeed;
+	}
+
+	void PatchBasedShapeDistributionDescExtraction::setExactSampleThreshold(const int& exactSampleThreshold)
+	{
+		this->m_nExactSampleThreshold = exactSampleThreshold;
+	}
+
+	int PatchBasedShapeDistributionDescExtraction::getExactSampleThreshold() const
+	{
+		return this->m_nExactSampleThreshold;
+	}
+
 	PatchBasedPerVertexFeatureExtraction::TypeOfGlobalDescriptor PatchBasedShapeDistributionDescExtraction::getGlobalDescriptorType() const
 	{
 		return PatchBasedPerVertexFeatureExtraction::SHAPE_DISTRIBUTION_HISTOGRAM;
 	}
 
-	Result PatchBasedShapeDistributionDescExtraction::calcFeature(TriangularMesh* triMesh, const std::vector<PatchList>& listOfPatchLists, std::vector<LocalFeaturePtr>& outFeatures)
+	Result PatchBasedShapeDistributionDescExtraction::extractForNumbersOfBins(PolygonMesh *mesh, const std::vector<int>& numbersOfBins, std::vector<std::vector<LocalFeaturePtr> >& outFeatures)
 	{
-		TACORE_CHECK_ARGS(triMesh != NULL);
-		TACORE_CHECK_ARGS(listOfPatchLists.size() > 0);
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+		TACORE_CHECK_ARGS(numbersOfBins.size() > 0);
+		TACORE_CHECK_ARGS(*std::min_element(numbersOfBins.begin(), numbersOfBins.end()) > 0);
 
-		const double M_PI = 3.14159265;
+		//We, now, know that the mesh is a triangular mesh
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+
+		TACORE_CHECK_RESULT(preparePatches(triMesh));
+		return calcFeaturesForNumbersOfBins(triMesh, getPreparedPatches(), numbersOfBins, outFeatures);
+	}
+
+	Result PatchBasedShapeDistributionDescExtraction::isSampleCountIndependent(PolygonMesh *mesh, bool& outIsIndependent)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		outIsIndependent = false;
+		if (this->m_SamplingMethod != BIASED_VERTEX_SAMPLING || this->m_nExactSampleThreshold <= 0)
+		{
+			return TACORE_OK;
+		}
+
+		//We, now, know that the mesh is a triangular mesh
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+
+		TACORE_CHECK_RESULT(preparePatches(triMesh));
+
+		//Patches are nested, so the smallest one has the fewest samples and the biggest one has the most
+		const std::vector<VertexPatches>& listOfPatches = getPreparedPatches();
+		for (size_t v = 0; v < listOfPatches.size(); v++)
+		{
+			const VertexPatches& patches = listOfPatches[v];
+			if (patches.getNumberOfScales() == 0)
+			{
+				continue;
+			}
+			if (getNumberOfExactSamples(patches.getPatchSize(0)) <= 0
+				|| getNumberOfExactSamples(patches.getPatchSize(patches.getNumberOfScales() - 1)) > this->m_nExactSampleThreshold)
+			{
+				return TACORE_OK;
+			}
+		}
+		outIsIndependent = true;
+
+		return TACORE_OK;
+	}
+
+	Result PatchBasedShapeDistributionDescExtraction::calcFeature(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, std::vector<LocalFeaturePtr>& outFeatures)
+	{
+		std::vector<std::vector<LocalFeaturePtr> > featuresOfBins;
+		TACORE_CHECK_RESULT(calcFeaturesForNumbersOfBins(triMesh, listOfPatches, std::vector<int>(1, this->m_nNumberOfBins), featuresOfBins));
+		outFeatures.swap(featuresOfBins[0]);
+
+		return TACore::TACORE_OK;
+	}
+
+	Result PatchBasedShapeDistributionDescExtraction::calcFeaturesForNumbersOfBins(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, const std::vector<int>& numbersOfBins, std::vector<std::vector<LocalFeaturePtr> >& outFeatures)
+	{
+		TACORE_CHECK_ARGS(triMesh != NULL);
+		TACORE_CHECK_ARGS(listOfPatches.size() > 0);
 
 		const size_t verSize = triMesh->verts.size();
-		outFeatures = std::vector<LocalFeaturePtr>(verSize);
+		const int noNumbersOfBins = (int)numbersOfBins.size();
+		outFeatures = std::vector<std::vector<LocalFeaturePtr> >(noNumbersOfBins, std::vector<LocalFeaturePtr>(verSize));
+
+		prepareMaxPossibleSample(triMesh);
+
+		std::vector<double> meshCoords;
+		gatherMeshCoordinates(triMesh, meshCoords);
+
+		//Each vertex draws from its own random streams, so the descriptors do not depend on the number of threads
+		const int noVertices = (int)verSize;
+#pragma omp parallel for schedule(dynamic, 64)
+		for (int v = 0; v < noVertices; v++)
+		{
+			std::vector<LocalFeaturePtr> vertexFeatures(noNumbersOfBins);
+			calcPatchHistograms(triMesh, v, listOfPatches[v], meshCoords, numbersOfBins, vertexFeatures);
+			for (int b = 0; b < noNumbersOfBins; b++)
+			{
+				outFeatures[b][v] = vertexFeatures[b];
+			}
+		}
+
+		return TACore::TACORE_OK;
+	}
+
+	Result PatchBasedShapeDistributionDescExtraction::calcFeatureMatrix(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, FeatureMatrix<double>& outMatrix)
+	{
+		TACORE_CHECK_ARGS(triMesh != NULL);
+		TACORE_CHECK_ARGS(listOfPatches.size() > 0);
+		TACORE_CHECK_ARGS(this->m_nNumberOfBins > 0);
+
+		//Rows of the matrix have the same layout, so all vertices must have the same number of patches
+		const int noVertices = (int)triMesh->verts.size();
+		const int numberOfPatches = listOfPatches[0].getNumberOfScales();
+		for (size_t v = 1; v < listOfPatches.size(); v++)
+		{
+			TACORE_CHECK_ARGS(listOfPatches[v].getNumberOfScales() == numberOfPatches);
+		}
+
+		prepareMaxPossibleSample(triMesh);
+
+		std::vector<double> meshCoords;
+		gatherMeshCoordinates(triMesh, meshCoords);
+
+		//Histograms of a vertex are written directly into its row, a block for each patch
+		outMatrix.init(noVertices, numberOfPatches, this->m_nNumberOfBins, FeatureMatrix<double>::PATCH_BASED_SHAPE_DISTRIBUTION_HISTOGRAM);
+		const std::vector<int> numbersOfBins(1, this->m_nNumberOfBins);
+#pragma omp parallel for schedule(dynamic, 64)
+		for (int v = 0; v < noVertices; v++)
+		{
+			double* row = outMatrix.getRow(v);
+			fillPatchHistograms(triMesh, v, listOfPatches[v], meshCoords, numbersOfBins, &row);
+		}
+
+		return TACore::TACORE_OK;
+	}
+
+	void PatchBasedShapeDistributionDescExtraction::prepareMaxPossibleSample(TriangularMesh* triMesh)
+	{
+		const double M_PI = 3.14159265;
 
 		//if angle is the case, setting or not setting does not affect the value of max val
 		if (this->m_DistributionFunction == ANGLE_BETWEEN_THREE_RANDOM_POINTS)
@@ -129,146 +706,280 @@ namespace TAFeaExt
 				this->m_lfMaxPossibleSample = cbrt(triMesh->calcMaxVolumeOfTetrahedronBetweenFourVertices());
 			}
 		}
+	}
 
-		for (size_t v = 0; v < verSize; v++)
-		{
-			if (v < verSize - 1)
-			{
-				std::cout << "%" << (100 * v) / verSize << " completed for creating descriptors from patches for all vertices" << "\r";
-			}
-			else
-			{
-				std::cout << "%" << 100 << " completed for creating descriptors from patches for all vertices" << "\n";
-			}
+	Result PatchBasedShapeDistributionDescExtraction::calcFeature(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, LocalFeaturePtr& outFeaturePtr)
+	{
+		TACORE_CHECK_ARGS(triMesh != NULL);
 
-			calcFeature(triMesh, v, listOfPatchLists[v], outFeatures[v]);
-		}
+		//Bin ranges of a single vertex are the ones of the whole mesh, so its histograms match the ones of all vertices
+		prepareMaxPossibleSample(triMesh);
+
+		std::vector<double> meshCoords;
+		gatherMeshCoordinates(triMesh, meshCoords);
+
+		std::vector<LocalFeaturePtr> vertexFeatures(1);
+		calcPatchHistograms(triMesh, id, patches, meshCoords, std::vector<int>(1, this->m_nNumberOfBins), vertexFeatures);
+		outFeaturePtr = vertexFeatures[0];
 
 		return TACore::TACORE_OK;
 	}
 
-	Result PatchBasedShapeDistributionDescExtraction::calcFeature(TriangularMesh* triMesh, const int& id, const PatchList& patchesVertexIds, LocalFeaturePtr& outFeaturePtr)
+	void PatchBasedShapeDistributionDescExtraction::calcPatchHistograms(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, const std::vector<double>& meshCoords, const std::vector<int>& numbersOfBins, std::vector<LocalFeaturePtr>& outFeaturePtrs) const
 	{
-		const size_t numberOfPatchesV = patchesVertexIds.size();
-		PatchBasedShapeDistributionHistogram *pDesc = new PatchBasedShapeDistributionHistogram(id);
+		const int numberOfPatchesV = patches.getNumberOfScales();
+		const int noNumbersOfBins = (int)numbersOfBins.size();
+
+		//Histograms of all patches are calculated into a contiguous block for each number of bins
+		std::vector<std::vector<double> > histograms(noNumbersOfBins);
+		std::vector<double*> histogramPtrs(noNumbersOfBins);
+		for (int b = 0; b < noNumbersOfBins; b++)
+		{
+			histograms[b] = std::vector<double>(numberOfPatchesV * numbersOfBins[b], 0.0);
+			histogramPtrs[b] = histograms[b].data();
+		}
+		fillPatchHistograms(triMesh, id, patches, meshCoords, numbersOfBins, histogramPtrs.data());
 
 		//A vertex will contain a vector for each patch defining the probability distribution function of the samples
-		//Each sample will be counted inside the corresponding bins
 		//Therefore descriptor has the size of numberOfPatches * numberOfBins
-		pDesc->m_vDescriptor = std::vector<std::vector<double> >(numberOfPatchesV, std::vector<double>(this->m_nNumberOfBins, 0.0));
-
-		for (size_t patchIdx = 0; patchIdx < numberOfPatchesV; patchIdx++)
+		for (int b = 0; b < noNumbersOfBins; b++)
 		{
-			const SinglePatch& aPatch = patchesVertexIds[patchIdx];
+			PatchBasedShapeDistributionHistogram *pDesc = new PatchBasedShapeDistributionHistogram(id);
+			pDesc->m_vDescriptor = std::vector<std::vector<double> >(numberOfPatchesV);
+			for (int patchIdx = 0; patchIdx < numberOfPatchesV; patchIdx++)
+			{
+				const double* patchHistogram = histogramPtrs[b] + patchIdx * numbersOfBins[b];
+				pDesc->m_vDescriptor[patchIdx] = std::vector<double>(patchHistogram, patchHistogram + numbersOfBins[b]);
+			}
+			outFeaturePtrs[b] = LocalFeaturePtr(pDesc);
+		}
+	}
 
-			//create all samples
-			srand(time(NULL));
-			std::vector<double> samples;
-			createSamplesFromPatch(triMesh, aPatch, this->m_nSampleCount, samples);
+	void PatchBasedShapeDistributionDescExtraction::fillPatchHistograms(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, const std::vector<double>& meshCoords, const std::vector<int>& numbersOfBins, double* const* outHistograms) const
+	{
+		const int numberOfPatchesV = patches.getNumberOfScales();
+		const int noNumbersOfBins = (int)numbersOfBins.size();
 
-			//Fill the histogram corresponding to the patch
-			std::vector<double>& patchHistogram = pDesc->m_vDescriptor[patchIdx];
+		//Triangles of all scales are found once since the patches are nested
+		PatchTriangles patchTriangles;
+		if (this->m_SamplingMethod == UNBIASED_SURFACE_SAMPLING)
+		{
+			createPatchTriangles(triMesh, patches, meshCoords, patchTriangles);
+		}
 
-			//Calculate the bin size
-			const double binSize = (this->m_lfMaxPossibleSample - this->m_lfMinPossibleSample) / this->m_nNumberOfBins;
+		std::vector<double> samples;
+		for (int patchIdx = 0; patchIdx < numberOfPatchesV; patchIdx++)
+		{
+			//create all samples from the stream of the (vertex, patch) pair
+			TACore::PhiloxRandom rng(this->m_nRandomSeed, (uint32_t)patchIdx, (uint32_t)id);
+			createSamplesFromPatch(patches, patchTriangles, patchIdx, meshCoords, this->m_nSampleCount, rng, samples);
 
-			//for each sample find the corresponding bin and update the histogram
-			for (size_t sampleIdx = 0; sampleIdx < samples.size(); sampleIdx++)
+			//Same samples fill the histogram of the patch for each number of bins
+			for (int b = 0; b < noNumbersOfBins; b++)
 			{
-				int binIndex = int((samples[sampleIdx] - this->m_lfMinPossibleSample) / binSize);
-				if (binIndex >= this->m_nNumberOfBins) binIndex = this->m_nNumberOfBins - 1;
-				else if (binIndex < 0) binIndex = 0;
+				const int numberOfBins = numbersOfBins[b];
+				const double binSize = (this->m_lfMaxPossibleSample - this->m_lfMinPossibleSample) / numberOfBins;
+				double* patchHistogram = outHistograms[b] + patchIdx * numberOfBins;
 
-				patchHistogram[binIndex] += 1.0;
+				//for each sample find the corresponding bin and update the histogram
+				for (size_t sampleIdx = 0; sampleIdx < samples.size(); sampleIdx++)
+				{
+					int binIndex = int((samples[sampleIdx] - this->m_lfMinPossibleSample) / binSize);
+					if (binIndex >= numberOfBins) binIndex = numberOfBins - 1;
+					else if (binIndex < 0) binIndex = 0;
+
+					patchHistogram[binIndex] += 1.0;
+				}
+				const double normalization = 1.0 / (double(samples.size()));
+				for (int bin = 0; bin < numberOfBins; bin++)
+				{
+					patchHistogram[bin] *= normalization;
+				}
 			}
-			patchHistogram = patchHistogram / (double(samples.size()));
 		}
-
-		outFeaturePtr = LocalFeaturePtr(pDesc);
-
-		return TACore::TACORE_OK;
 	}
 
-	void PatchBasedShapeDistributionDescExtraction::createSamplesFromPatch(TriangularMesh* triMesh, const SinglePatch& patch, const int& sampleCount, std::vector<double>& samples) const
+	void PatchBasedShapeDistributionDescExtraction::createPatchTriangles(TriangularMesh* triMesh, const VertexPatches& patches, const std::vector<double>& meshCoords, PatchTriangles& patchTriangles) const
 	{
-		samples = std::vector<double>(sampleCount);
-		for (int i = 0; i < sampleCount; i++)
+		const int noPatchVertices = (int)patches.m_vVertexIds.size();
+		const int numberOfScales = patches.getNumberOfScales();
+
+		std::unordered_map<int, int> positions(2 * noPatchVertices);
+		for (int pos = 0; pos < noPatchVertices; pos++)
 		{
-			samples[i] = createSample(triMesh, patch);
+			positions[patches.m_vVertexIds[pos]] = pos;
 		}
-	}
 
-	double PatchBasedShapeDistributionDescExtraction::createSample(TriangularMesh* triMesh, const SinglePatch& patch) const
-	{
-		if (this->m_SamplingMethod == BIASED_VERTEX_SAMPLING)
+		//A triangle is inside a patch when its three vertices are inside the patch
+		//It is added when its last vertex in the distance order is visited, so the triangles are sorted by the scale they enter the patches
+		std::vector<int> triangleVertexIds;
+		std::vector<int> lastPositions;
+		for (int pos = 0; pos < noPatchVertices; pos++)
 		{
-			return createBiasedVertexSample(triMesh, patch);
+			const Vertex* patchVertex = triMesh->verts[patches.m_vVertexIds[pos]];
+			for (size_t t = 0; t < patchVertex->triList.size(); t++)
+			{
+				const Triangle* tri = triMesh->tris[patchVertex->triList[t]];
+				const int triVertexIds[3] = { tri->v1i, tri->v2i, tri->v3i };
+				bool isAdded = true;
+				for (int k = 0; k < 3 && isAdded; k++)
+				{
+					std::unordered_map<int, int>::const_iterator posItr = positions.find(triVertexIds[k]);
+					isAdded = (posItr != positions.end() && posItr->second <= pos);
+				}
+				if (isAdded)
+				{
+					triangleVertexIds.insert(triangleVertexIds.end(), triVertexIds, triVertexIds + 3);
+					lastPositions.push_back(pos);
+				}
+			}
 		}
-		return createUnbiasedSurfaceSample(triMesh, patch);
-	}
 
-	double PatchBasedShapeDistributionDescExtraction::createBiasedVertexSample(TriangularMesh* triMesh, const SinglePatch& patch) const
-	{
-		size_t numberOfRandomPoints = getNumberOfRandomPointsForASample();
-		std::unordered_set<Vertex*> randomVertices; //Use pointer equality to select different random vertices
-													//Use unordered_set instead of set in order not to integrate much bias because of the pointer locations
-		while (randomVertices.size() < numberOfRandomPoints)
+		//Number of triangles inside the patch of each scale, the distinct ones are the ends of the layers
+		std::vector<int> scaleTriangleEnds(numberOfScales);
+		for (int scale = 0; scale < numberOfScales; scale++)
 		{
-			int randomVertexId = rand() % patch.size();
-			randomVertices.insert(triMesh->verts[patch[randomVertexId]]);
+			scaleTriangleEnds[scale] = (int)(std::lower_bound(lastPositions.begin(), lastPositions.end(), patches.getPatchSize(scale)) - lastPositions.begin());
 		}
-
-		std::unordered_set<Vertex*>::iterator ptItr = randomVertices.begin();
-
-		double ret = 0.0;
-		if (this->m_DistributionFunction == ANGLE_BETWEEN_THREE_RANDOM_POINTS)
+		std::vector<int> layerEnds(scaleTriangleEnds);
+		std::sort(layerEnds.begin(), layerEnds.end());
+		layerEnds.erase(std::unique(layerEnds.begin(), layerEnds.end()), layerEnds.end());
+		if (!layerEnds.empty() && layerEnds[0] == 0)
 		{
-			Vector3D pt1((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt2((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt3((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]);
+			layerEnds.erase(layerEnds.begin());
+		}
 
-			ret = calcAngleBetweenThreePoints(pt1, pt2, pt3);
+		const int numberOfLayers = (int)layerEnds.size();
+		patchTriangles.m_vTriangleVertexIds.swap(triangleVertexIds);
+		patchTriangles.m_vLayerStarts = std::vector<int>(numberOfLayers + 1, 0);
+		patchTriangles.m_vLayerTables = std::vector<TACore::AliasTable>(numberOfLayers);
+		patchTriangles.m_vLayerAreas = std::vector<double>(numberOfLayers, 0.0);
+		patchTriangles.m_vScaleLayerEnds = std::vector<int>(numberOfScales);
+		for (int scale = 0; scale < numberOfScales; scale++)
+		{
+			patchTriangles.m_vScaleLayerEnds[scale] = (int)(std::upper_bound(layerEnds.begin(), layerEnds.end(), scaleTriangleEnds[scale]) - layerEnds.begin());
 		}
-		else if (this->m_DistributionFunction == DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT)
+
+		//Each layer has its own alias table over the triangle areas, it is shared by all scales containing the layer
+		const double* coords = &meshCoords[0];
+		std::vector<double> areas;
+		for (int layer = 0; layer < numberOfLayers; layer++)
 		{
-			//The index of a fixed point is always 0
-			Vector3D pt1(triMesh->verts[patch[0]]->coords[0], triMesh->verts[patch[0]]->coords[1], triMesh->verts[patch[0]]->coords[2]);
-			Vector3D pt2((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]);
+			const int layerStart = patchTriangles.m_vLayerStarts[layer];
+			const int layerEnd = layerEnds[layer];
+			patchTriangles.m_vLayerStarts[layer + 1] = layerEnd;
 
-			ret = calcDistanceBetweenTwoPoints(pt1, pt2);
+			areas = std::vector<double>(layerEnd - layerStart);
+			for (int t = layerStart; t < layerEnd; t++)
+			{
+				const double* a = coords + 3 * patchTriangles.m_vTriangleVertexIds[3 * t];
+				const double* b = coords + 3 * patchTriangles.m_vTriangleVertexIds[3 * t + 1];
+				const double* c = coords + 3 * patchTriangles.m_vTriangleVertexIds[3 * t + 2];
+				const double ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+				const double vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+				const double cx = uy * vz - uz * vy, cy = uz * vx - ux * vz, cz = ux * vy - uy * vx;
+				areas[t - layerStart] = 0.5 * sqrt(cx * cx + cy * cy + cz * cz);
+			}
+			patchTriangles.m_vLayerTables[layer].build(&areas[0], (int)areas.size());
+			patchTriangles.m_vLayerAreas[layer] = patchTriangles.m_vLayerTables[layer].getTotalWeight();
 		}
-		else if (this->m_DistributionFunction == DISTANCE_BETWEEN_TWO_RANDOM_POINTS)
-		{
-			Vector3D pt1((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt2((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]);
+	}
 
-			ret = calcDistanceBetweenTwoPoints(pt1, pt2);
+	void PatchBasedShapeDistributionDescExtraction::createSamplesFromPatch(const VertexPatches& patches, const PatchTriangles& patchTriangles, const int& scale, const std::vector<double>& meshCoords, const int& sampleCount, TACore::PhiloxRandom& rng, std::vector<double>& samples) const
+	{
+		//Small patches of the vertex sampling are enumerated instead of being sampled
+		if (this->m_SamplingMethod == BIASED_VERTEX_SAMPLING && patches.getPatchSize(scale) > 0)
+		{
+			const long long exactSampleCount = getNumberOfExactSamples(patches.getPatchSize(scale));
+			if (exactSampleCount > 0 && exactSampleCount <= this->m_nExactSampleThreshold)
+			{
+				samples = std::vector<double>((size_t)exactSampleCount, 0.0);
+				createExactVertexSamples(patches, scale, meshCoords, &samples[0]);
+				return;
+			}
 		}
-		else if (this->m_DistributionFunction == SQRT_OF_AREA_OF_THREE_RANDOM_POINTS)
+
+		samples = std::vector<double>(sampleCount, 0.0);
+		if (sampleCount <= 0 || patches.getPatchSize(scale) <= 0)
 		{
-			Vector3D pt1((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt2((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt3((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]);
+			return;
+		}
 
-			ret = sqrt(calcAreaInsideThreePoints(pt1, pt2, pt3));
+		//A patch without any area, e.g. a single vertex, has no surface to sample, so its vertices are sampled
+		if (this->m_SamplingMethod == UNBIASED_SURFACE_SAMPLING && patchTriangles.getArea(scale) > 0.0)
+		{
+			createUnbiasedSurfaceSamples(patches, patchTriangles, scale, meshCoords, sampleCount, rng, &samples[0]);
 		}
-		else if (this->m_DistributionFunction == CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS)
+		else
 		{
-			Vector3D pt1((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt2((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt3((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]); ptItr++;
-			Vector3D pt4((*ptItr)->coords[0], (*ptItr)->coords[1], (*ptItr)->coords[2]);
-
-			ret = cbrt(calcVolumeInsideFourPoints(pt1, pt2, pt3, pt4));
+			createBiasedVertexSamples(patches, scale, meshCoords, sampleCount, rng, &samples[0]);
 		}
+	}
 
-		return ret;
+	void PatchBasedShapeDistributionDescExtraction::createBiasedVertexSamples(const VertexPatches& patches, const int& scale, const std::vector<double>& meshCoords, const int& sampleCount, TACore::PhiloxRandom& rng, double* samples) const
+	{
+		VertexPointSampler sampler;
+		sampler.m_pCoords = &meshCoords[0];
+		sampler.m_pVertexIds = &patches.m_vVertexIds[0];
+		sampler.m_nPatchSize = patches.getPatchSize(scale);
+
+		//Fixed point is the center vertex of the patch, which is always the first one
+		createSamples(this->m_DistributionFunction, sampler, sampler.m_pCoords + 3 * patches.m_vVertexIds[0], sampleCount, rng, samples);
 	}
 
-	double PatchBasedShapeDistributionDescExtraction::createUnbiasedSurfaceSample(TriangularMesh* triMesh, const SinglePatch& patch) const
+	void PatchBasedShapeDistributionDescExtraction::createUnbiasedSurfaceSamples(const VertexPatches& patches, const PatchTriangles& patchTriangles, const int& scale, const std::vector<double>& meshCoords, const int& sampleCount, TACore::PhiloxRandom& rng, double* samples) const
 	{
-		double ret = 0.0;
-		return ret;
+		//Only the table over the layers is built for the scale
+		TACore::AliasTable scaleTable;
+		scaleTable.build(&patchTriangles.m_vLayerAreas[0], patchTriangles.m_vScaleLayerEnds[scale]);
+
+		SurfacePointSampler sampler;
+		sampler.m_pCoords = &meshCoords[0];
+		sampler.m_pTriangleVertexIds = &patchTriangles.m_vTriangleVertexIds[0];
+		sampler.m_pLayerStarts = &patchTriangles.m_vLayerStarts[0];
+		sampler.m_pLayerTables = &patchTriangles.m_vLayerTables[0];
+		sampler.m_pScaleTable = &scaleTable;
+
+		//Fixed point is the center vertex of the patch, which is always the first one
+		createSamples(this->m_DistributionFunction, sampler, sampler.m_pCoords + 3 * patches.m_vVertexIds[0], sampleCount, rng, samples);
+	}
+
+	long long PatchBasedShapeDistributionDescExtraction::getNumberOfExactSamples(const int& patchSize) const
+	{
+		//Binomial coefficient computed incrementally, each partial product is itself a binomial coefficient so the divisions are exact
+		const int noPoints = getNumberOfRandomPointsForASample();
+		long long noCombinations = 1;
+		for (int j = 0; j < noPoints; j++)
+		{
+			if (patchSize - j <= 0)
+			{
+				return 0;
+			}
+			if (noCombinations > LLONG_MAX / (3 * (long long)patchSize))
+			{
+				return LLONG_MAX;
+			}
+			noCombinations = noCombinations * (patchSize - j) / (j + 1);
+		}
+		return noCombinations * getNumberOfOrderingsOfACombination(this->m_DistributionFunction);
+	}
+
+	void PatchBasedShapeDistributionDescExtraction::createExactVertexSamples(const VertexPatches& patches, const int& scale, const std::vector<double>& meshCoords, double* samples) const
+	{
+		const double* coords = &meshCoords[0];
+		const int* vertexIds = &patches.m_vVertexIds[0];
+		const int patchSize = patches.getPatchSize(scale);
+
+		//Fixed point is the center vertex of the patch, which is always the first one
+		const double* fixedPoint = coords + 3 * vertexIds[0];
+		switch (this->m_DistributionFunction)
+		{
+			case ANGLE_BETWEEN_THREE_RANDOM_POINTS: createExactSamples<ANGLE_BETWEEN_THREE_RANDOM_POINTS>(coords, vertexIds, patchSize, fixedPoint, samples); break;
+			case DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT: createExactSamples<DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT>(coords, vertexIds, patchSize, fixedPoint, samples); break;
+			case DISTANCE_BETWEEN_TWO_RANDOM_POINTS: createExactSamples<DISTANCE_BETWEEN_TWO_RANDOM_POINTS>(coords, vertexIds, patchSize, fixedPoint, samples); break;
+			case SQRT_OF_AREA_OF_THREE_RANDOM_POINTS: createExactSamples<SQRT_OF_AREA_OF_THREE_RANDOM_POINTS>(coords, vertexIds, patchSize, fixedPoint, samples); break;
+			case CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS: createExactSamples<CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS>(coords, vertexIds, patchSize, fixedPoint, samples); break;
+		}
 	}
 
 	int PatchBasedShapeDistributionDescExtraction::getNumberOfRandomPointsForASample() const
@@ -318,7 +1029,7 @@ namespace TAFeaExt
 		Vector3D pt2ToPt4(pt2, pt4);
 		Vector3D pt3ToPt4(pt3, pt4);
 
-		return abs(pt1ToPt4  % (pt2ToPt4 * pt3ToPt4)) / 6.0;
+		return fabs(pt1ToPt4  % (pt2ToPt4 * pt3ToPt4)) / 6.0;
 	}
 
 	void PatchBasedShapeDistributionDescExtraction::writeHistogram(const std::vector<double>& histogram, const std::string& filePath)
@@ -13,12 +13,22 @@ namespace TAFeaExt
 
 	PatchBasedSumOfCenterDistancesExtraction::PatchBasedSumOfCenterDistancesExtraction()
 	{
-
+		this->m_SpreadMeasure = MEAN_DISTANCE_TO_CENTER;
 	}
 
 	PatchBasedSumOfCenterDistancesExtraction::PatchBasedSumOfCenterDistancesExtraction(const PatchBasedSumOfCenterDistancesExtraction& other)
 	{
+		this->m_SpreadMeasure = other.m_SpreadMeasure;
+	}
+
+	void PatchBasedSumOfCenterDistancesExtraction::setSpreadMeasure(const SpreadMeasure& spreadMeasure)
+	{
+		this->m_SpreadMeasure = spreadMeasure;
+	}
 
+	PatchBasedSumOfCenterDistancesExtraction::SpreadMeasure PatchBasedSumOfCenterDistancesExtraction::getSpreadMeasure() const
+	{
+		return this->m_SpreadMeasure;
 	}
 
 	PatchBasedPerVertexFeatureExtraction::TypeOfGlobalDescriptor PatchBasedSumOfCenterDistancesExtraction::getGlobalDescriptorType() const
@@ -26,33 +36,29 @@ namespace TAFeaExt
 		return PatchBasedPerVertexFeatureExtraction::SUM_EUC_DISTANCES_TO_CENTER;
 	}
 
-	Result PatchBasedSumOfCenterDistancesExtraction::calcFeature(TriangularMesh* triMesh, const std::vector<PatchList>& listOfPatchLists, std::vector<LocalFeaturePtr>& outFeatures)
+	Result PatchBasedSumOfCenterDistancesExtraction::calcFeature(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, std::vector<LocalFeaturePtr>& outFeatures)
 	{
 		TACORE_CHECK_ARGS(triMesh != NULL);
-		TACORE_CHECK_ARGS(listOfPatchLists.size() > 0);
+		TACORE_CHECK_ARGS(listOfPatches.size() > 0);
 
 		const size_t verSize = triMesh->verts.size();
 		outFeatures = std::vector<LocalFeaturePtr>(verSize);
 
-		const size_t numberOfPatches = listOfPatchLists[0].size();
+		//Descriptors of the vertices do not depend on each other
+		const int noVertices = (int)verSize;
+#pragma omp parallel for schedule(dynamic, 64)
+		for (int v = 0; v < noVertices; v++)
+		{
+			calcFeature(triMesh, v, listOfPatches[v], outFeatures[v]);
+		}
+		std::cout << "%" << 100 << " completed for creating descriptors from patches for all vertices" << "\n";
+
+		//Update the maximum values for all patches
+		const size_t numberOfPatches = listOfPatches[0].getNumberOfScales();
 		std::vector<double> descNormalizationVec(numberOfPatches, 0.0); //Holds maximum values inside the features for all patch
-		
 		for (size_t v = 0; v < verSize; v++)
 		{
-			if (v < verSize - 1)
-			{
-				std::cout << "%" << (100 * v) / verSize << " completed for creating descriptors from patches for all vertices" << "\r";
-			}
-			else
-			{
-				std::cout << "%" << 100 << " completed for creating descriptors from patches for all vertices" << "\n";
-			}
-
-			calcFeature(triMesh, v, listOfPatchLists[v], outFeatures[v]);
-
 			const std::vector<double>& descriptor = ((PatchBasedSumOfCenterDistances*)outFeatures[v].get())->m_vDescriptor;
-
-			//Update the maximum values for all patches
 			for (size_t i = 0; i < descNormalizationVec.size(); i++)
 			{
 				if (descriptor[i] > descNormalizationVec[i])
@@ -72,36 +78,119 @@ namespace TAFeaExt
 		return TACore::TACORE_OK;
 	}
 
-	Result PatchBasedSumOfCenterDistancesExtraction::calcFeature(TriangularMesh* triMesh, const int& id, const PatchList& patchesVertexIds, LocalFeaturePtr& outFeaturePtr)
+	Result PatchBasedSumOfCenterDistancesExtraction::calcFeatureMatrix(TriangularMesh* triMesh, const std::vector<VertexPatches>& listOfPatches, FeatureMatrix<double>& outMatrix)
 	{
-		const size_t numberOfPatchesV = patchesVertexIds.size();
-		PatchBasedSumOfCenterDistances* pDesc = new PatchBasedSumOfCenterDistances(id);
-		pDesc->m_vDescriptor = std::vector<double>(numberOfPatchesV);
+		TACORE_CHECK_ARGS(triMesh != NULL);
+		TACORE_CHECK_ARGS(listOfPatches.size() > 0);
+
+		//Rows of the matrix have the same layout, so all vertices must have the same number of patches
+		const int noVertices = (int)triMesh->verts.size();
+		const int numberOfPatches = listOfPatches[0].getNumberOfScales();
+		for (size_t v = 1; v < listOfPatches.size(); v++)
+		{
+			TACORE_CHECK_ARGS(listOfPatches[v].getNumberOfScales() == numberOfPatches);
+		}
 
-		for (size_t patchIdx = 0; patchIdx < numberOfPatchesV; patchIdx++)
+		outMatrix.init(noVertices, numberOfPatches, 1, FeatureMatrix<double>::PATCH_BASED_SUM_OF_CENTER_DISTANCES);
+#pragma omp parallel for schedule(dynamic, 64)
+		for (int v = 0; v < noVertices; v++)
 		{
-			const SinglePatch& aPatch = patchesVertexIds[patchIdx];
-			Vector3D patchCenter(0.0, 0.0, 0.0);
+			calcCenterDistances(triMesh, listOfPatches[v], outMatrix.getRow(v));
+		}
 
-			for (size_t w = 0; w < aPatch.size(); w++)
+		//Normalize each patch by its maximum value among all vertices
+		std::vector<double> descNormalizationVec(numberOfPatches, 0.0);
+		for (int v = 0; v < noVertices; v++)
+		{
+			const double* descriptor = outMatrix.getRow(v);
+			for (int i = 0; i < numberOfPatches; i++)
 			{
-				Vertex* patchVertex = triMesh->verts[aPatch[w]];
-				patchCenter = patchCenter + Vector3D(patchVertex->coords[0], patchVertex->coords[1], patchVertex->coords[2]);
+				descNormalizationVec[i] = MAX(descNormalizationVec[i], descriptor[i]);
 			}
-			patchCenter = patchCenter * (1.0 / ((double)aPatch.size()));
-
-			double sumOfCenterDistances = 0.0;
-			for (size_t w = 0; w < aPatch.size(); w++)
+		}
+		for (int v = 0; v < noVertices; v++)
+		{
+			double* descriptor = outMatrix.getRow(v);
+			for (int i = 0; i < numberOfPatches; i++)
 			{
-				Vertex* patchVertex = triMesh->verts[aPatch[w]];
-				sumOfCenterDistances += Vector3D::L2Distance(patchCenter, Vector3D(patchVertex->coords[0], patchVertex->coords[1], patchVertex->coords[2]));
+				descriptor[i] /= descNormalizationVec[i];
 			}
-			sumOfCenterDistances /= aPatch.size();
-			pDesc->m_vDescriptor[patchIdx] = sumOfCenterDistances;
 		}
 
+		return TACore::TACORE_OK;
+	}
+
+	Result PatchBasedSumOfCenterDistancesExtraction::calcFeature(TriangularMesh* triMesh, const int& id, const VertexPatches& patches, LocalFeaturePtr& outFeaturePtr)
+	{
+		const int numberOfPatchesV = patches.getNumberOfScales();
+		PatchBasedSumOfCenterDistances* pDesc = new PatchBasedSumOfCenterDistances(id);
+		pDesc->m_vDescriptor = std::vector<double>(numberOfPatchesV, 0.0);
 		outFeaturePtr = LocalFeaturePtr(pDesc);
 
+		if (numberOfPatchesV > 0)
+		{
+			calcCenterDistances(triMesh, patches, &pDesc->m_vDescriptor[0]);
+		}
+
 		return TACore::TACORE_OK;
 	}
-}
\ No newline at end of file
+
+	void PatchBasedSumOfCenterDistancesExtraction::calcCenterDistances(TriangularMesh* triMesh, const VertexPatches& patches, double* outDescriptor) const
+	{
+		//Patches without vertices keep their zero values
+		const int numberOfPatchesV = patches.getNumberOfScales();
+		if (patches.m_vVertexIds.empty())
+		{
+			return;
+		}
+
+		//Coordinates are taken relative to the center vertex, which is inside all patches, so the running sums stay small
+		const float* origin = triMesh->verts[patches.m_vVertexIds[0]]->coords;
+
+		//Running sums of the coordinates and their squares over the distance sorted vertices
+		//Patch of a scale is the prefix of the vertex list, so the sums of a scale continue from the sums of the previous one
+		double sum[3] = { 0.0, 0.0, 0.0 };
+		double sumOfSquares = 0.0;
+		int w = 0;
+		for (int patchIdx = 0; patchIdx < numberOfPatchesV; patchIdx++)
+		{
+			const int patchSize = patches.getPatchSize(patchIdx);
+			for (; w < patchSize; w++)
+			{
+				const float* coords = triMesh->verts[patches.m_vVertexIds[w]]->coords;
+				for (int d = 0; d < 3; d++)
+				{
+					const double c = (double)coords[d] - origin[d];
+					sum[d] += c;
+					sumOfSquares += c * c;
+				}
+			}
+			if (patchSize <= 0)
+			{
+				continue;
+			}
+
+			const double patchCenter[3] = { sum[0] / patchSize, sum[1] / patchSize, sum[2] / patchSize };
+			if (this->m_SpreadMeasure == RMS_DISTANCE_TO_CENTER)
+			{
+				//Mean of the squared distances to the center is the mean of the squares minus the square of the center
+				const double meanSqDistance = sumOfSquares / patchSize - (patchCenter[0] * patchCenter[0] + patchCenter[1] * patchCenter[1] + patchCenter[2] * patchCenter[2]);
+				outDescriptor[patchIdx] = sqrt(MAX(meanSqDistance, 0.0));
+			}
+			else
+			{
+				//Distance is not linear in the center, so the vertices of the patch are visited again for the new center
+				double sumOfCenterDistances = 0.0;
+				for (int k = 0; k < patchSize; k++)
+				{
+					const float* coords = triMesh->verts[patches.m_vVertexIds[k]]->coords;
+					const double dx = (double)coords[0] - origin[0] - patchCenter[0];
+					const double dy = (double)coords[1] - origin[1] - patchCenter[1];
+					const double dz = (double)coords[2] - origin[2] - patchCenter[2];
+					sumOfCenterDistances += sqrt(dx * dx + dy * dy + dz * dz);
+				}
+				outDescriptor[patchIdx] = sumOfCenterDistances / patchSize;
+			}
+		}
+	}
+}
@@ -0,0 +1,972 @@
+#include "SpectralDescExtraction.h"
+#include <core/TriangularMesh.h>
+#include <core/VertexGrid.h>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#ifdef ENABLE_TIMING_REPORTS
+#include <core/Timer.h>
+#endif
+
+namespace TAFeaExt
+{
+	SpectralDescExtraction::~SpectralDescExtraction()
+	{
+		SpectralDescExtraction::clear();
+	}
+
+	SpectralDescExtraction::SpectralDescExtraction()
+	{
+		this->m_LaplacianUsed = STAR_LAPLACIAN;
+		this->m_nNoEigenVal = 125;
+		this->m_pCoarseMesh = NULL;
+		this->m_nNoRefinementIterations = 4;
+		this->m_nRefinementFilterDegree = 8;
+		this->m_bValidateCoarseToFine = false;
+		this->m_bAdaptiveEigenCount = false;
+		this->m_nEigenValBlockSize = 25;
+		this->m_fAdaptiveEigenTolerance = 1e-6;
+	}
+
+	SpectralDescExtraction::SpectralDescExtraction(const SpectralDescExtraction& other)
+	{
+		this->m_LaplacianUsed = other.m_LaplacianUsed;
+		this->m_nNoEigenVal = other.m_nNoEigenVal;
+		this->m_mLaplacian = other.m_mLaplacian; //Shallow copy
+		this->m_pLaplacian = other.m_pLaplacian;
+		this->m_pEigenBasis = other.m_pEigenBasis;
+		this->m_pCoarseMesh = other.m_pCoarseMesh;
+		this->m_nNoRefinementIterations = other.m_nNoRefinementIterations;
+		this->m_nRefinementFilterDegree = other.m_nRefinementFilterDegree;
+		this->m_bValidateCoarseToFine = other.m_bValidateCoarseToFine;
+		this->m_bAdaptiveEigenCount = other.m_bAdaptiveEigenCount;
+		this->m_nEigenValBlockSize = other.m_nEigenValBlockSize;
+		this->m_fAdaptiveEigenTolerance = other.m_fAdaptiveEigenTolerance;
+	}
+
+	void SpectralDescExtraction::clear()
+	{
+		this->m_LaplacianUsed = STAR_LAPLACIAN;
+		this->m_nNoEigenVal = 125;
+		this->m_mLaplacian.reset();
+		this->m_pLaplacian.reset();
+		this->m_pEigenBasis.reset();
+		this->m_pCoarseMesh = NULL;
+		this->m_nNoRefinementIterations = 4;
+		this->m_nRefinementFilterDegree = 8;
+		this->m_bValidateCoarseToFine = false;
+		this->m_bAdaptiveEigenCount = false;
+		this->m_nEigenValBlockSize = 25;
+		this->m_fAdaptiveEigenTolerance = 1e-6;
+	}
+
+	Result SpectralDescExtraction::prepareEigenBasis(PolygonMesh *mesh)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//Reuse the basis if it is the basis of the same laplacian of the same mesh, the address alone may belong to another mesh or an edited one
+		//An adaptive basis is complete with any size, it stopped where the remaining eigen pairs became insignificant
+		const unsigned long long meshHash = ((TriangularMesh*)mesh)->calcContentHash();
+		if (this->m_pEigenBasis && this->m_pEigenBasis->m_pMesh == mesh && this->m_pEigenBasis->m_nMeshHash == meshHash
+			&& this->m_pEigenBasis->m_nLaplacianType == (int)this->m_LaplacianUsed
+			&& (this->m_pEigenBasis->m_vEigenValues.n_elem >= this->m_nNoEigenVal || (this->m_bAdaptiveEigenCount && supportsAdaptiveEigenCount() && this->m_pCoarseMesh == NULL)))
+		{
+			return TACORE_OK;
+		}
+
+		TACORE_CHECK_RESULT(prepareLaplacian(mesh));
+		const std::vector<double>& ringAreas = this->m_pLaplacian->m_vRingAreas;
+
+		SpectralEigenBasisPtr eigenBasis(new SpectralEigenBasis());
+		if (this->m_pCoarseMesh != NULL)
+		{
+			TACORE_CHECK_RESULT(calcEigenDecompositionFromCoarseMesh(mesh, eigenBasis->m_vEigenValues, eigenBasis->m_mEigenVectors));
+		}
+		else if (this->m_bAdaptiveEigenCount && supportsAdaptiveEigenCount())
+		{
+			const double sumRingAreas = std::accumulate(ringAreas.begin(), ringAreas.end(), 0.0);
+			const arma::SpMat<double>& laplacian = *(this->m_mLaplacian);
+			const arma::SpMat<double> laplacianRows = laplacian.t();
+			const double spectrumBound = calcSpectrumUpperBound(laplacianRows);
+			const double spectrumSign = getSpectrumSign();
+			const int numberOfVertices = (int)laplacian.n_rows;
+			const unsigned int blockSize = MAX(this->m_nEigenValBlockSize, 1u);
+
+			//First block is a cold decomposition, its eigen pairs are kept in ascending order of the magnitudes of the eigen values
+			//ritzVals are the magnitudes, i.e. the eigen values of sign * laplacian, like the Ritz values of the refinement
+			unsigned int noEigenVals = MIN(MAX(blockSize, 2u), this->m_nNoEigenVal);
+			arma::vec ritzVals;
+			arma::mat ritzVecs;
+			{
+				arma::cx_vec eigval;
+				arma::cx_mat eigvec;
+				TACORE_CHECK_RESULT(calcEigenDecomposition(noEigenVals, &eigval, &eigvec));
+				const arma::vec absEigVals = arma::abs(arma::real(eigval));
+				const arma::uvec ascending = arma::sort_index(absEigVals);
+				const arma::mat eigVecs = arma::real(eigvec);
+				ritzVals = arma::vec(noEigenVals);
+				ritzVecs = arma::mat(eigVecs.n_rows, noEigenVals);
+				for (unsigned int k = 0; k < noEigenVals; k++)
+				{
+					ritzVals(k) = absEigVals(ascending(k));
+					for (arma::uword v = 0; v < eigVecs.n_rows; v++)
+					{
+						ritzVecs(v, k) = eigVecs(v, ascending(k));
+					}
+				}
+			}
+
+			//Grow the number of eigen pairs block by block until the largest ones do not change the descriptor
+			//Each block extends the subspace of the previous eigen vectors by random vectors and refines it, instead of a cold decomposition of all of them
+			std::mt19937 blockGenerator(5489u);
+			std::uniform_real_distribution<double> blockDistribution(-1.0, 1.0);
+			double errorBound = 0.0;
+			while (true)
+			{
+				const unsigned int noSignificant = countSignificantEigenVals(ritzVals.subvec(0, noEigenVals - 1) * spectrumSign, sumRingAreas);
+				const unsigned int nextNoEigenVals = MIN(noEigenVals + blockSize, this->m_nNoEigenVal);
+				const unsigned int noGuardVectors = MAX(nextNoEigenVals / 4, 8u);
+				const unsigned int subspaceSize = MIN(nextNoEigenVals + noGuardVectors, (unsigned int)MAX(numberOfVertices - 2, 0));
+				if (noSignificant < noEigenVals || noEigenVals >= this->m_nNoEigenVal || subspaceSize < nextNoEigenVals)
+				{
+					//Keep the significant ones, at least two of them are needed for the time boundaries
+					const unsigned int noUsed = MIN(MAX(noSignificant, 2u), noEigenVals);
+					eigenBasis->m_vEigenValues = ritzVals.subvec(0, noUsed - 1) * spectrumSign;
+					eigenBasis->m_mEigenVectors = ritzVecs.cols(0, noUsed - 1);
+					std::cout << "Number of eigen values used: " << noUsed << " (" << noEigenVals << " calculated, max relative eigen value error bound " << errorBound << ")" << std::endl;
+					break;
+				}
+
+				arma::mat subspace(numberOfVertices, subspaceSize);
+				for (unsigned int k = 0; k < subspaceSize; k++)
+				{
+					for (int v = 0; v < numberOfVertices; v++)
+					{
+						subspace(v, k) = (k < noEigenVals) ? ritzVecs(v, k) : blockDistribution(blockGenerator);
+					}
+				}
+				TACORE_CHECK_RESULT(refineEigenSubspace(laplacianRows, spectrumBound, nextNoEigenVals, subspace, ritzVals, errorBound));
+				ritzVecs = subspace;
+				noEigenVals = nextNoEigenVals;
+			}
+		}
+		else
+		{
+			if (this->m_bAdaptiveEigenCount && this->m_pCoarseMesh == NULL)
+			{
+				std::cout << "Descriptor has no eigen value beyond which the eigen pairs are insignificant, " << this->m_nNoEigenVal << " eigen values are calculated" << std::endl;
+			}
+
+			arma::cx_vec eigval;
+			arma::cx_mat eigvec;
+			TACORE_CHECK_RESULT(calcEigenDecomposition(this->m_nNoEigenVal, &eigval, &eigvec));
+			eigenBasis->m_vEigenValues = arma::real(eigval);
+			eigenBasis->m_mEigenVectors = arma::real(eigvec);
+		}
+		eigenBasis->m_pMesh = mesh;
+		eigenBasis->m_nMeshHash = meshHash;
+		eigenBasis->m_nLaplacianType = (int)this->m_LaplacianUsed;
+		eigenBasis->m_fSumRingAreas = std::accumulate(ringAreas.begin(), ringAreas.end(), 0.0);
+		this->m_pEigenBasis = eigenBasis;
+
+		return TACORE_OK;
+	}
+
+	Result SpectralDescExtraction::prepareLaplacian(PolygonMesh *mesh)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//Reuse the laplacian if it is the same laplacian of the same mesh, the matrix may have been replaced by the laplacian of the coarse mesh
+		//We, now, know that the mesh is a triangular mesh
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+		const unsigned long long meshHash = triMesh->calcContentHash();
+		if (this->m_pLaplacian && this->m_pLaplacian->m_pMesh == mesh && this->m_pLaplacian->m_nMeshHash == meshHash
+			&& this->m_pLaplacian->m_nLaplacianType == (int)this->m_LaplacianUsed)
+		{
+			this->m_mLaplacian = this->m_pLaplacian->m_pMatrix;
+			return TACORE_OK;
+		}
+
+		SpectralLaplacianPtr laplacian(new SpectralLaplacian());
+		laplacian->m_pMesh = mesh;
+		laplacian->m_nMeshHash = meshHash;
+		laplacian->m_nLaplacianType = (int)this->m_LaplacianUsed;
+		triMesh->calcRingAreasOfVertices(laplacian->m_vRingAreas);
+		TACORE_CHECK_RESULT(createLaplacianMatrix(mesh, this->m_LaplacianUsed, laplacian->m_vRingAreas));
+		laplacian->m_pMatrix = this->m_mLaplacian;
+		this->m_pLaplacian = laplacian;
+
+		return TACORE_OK;
+	}
+
+	Result SpectralDescExtraction::calcEigenDecompositionFromCoarseMesh(PolygonMesh *mesh, arma::vec& outEigVals, arma::mat& outEigVecs)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+		if (this->m_pCoarseMesh == NULL || this->m_pCoarseMesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+
+		//We, now, know that the meshes are triangular meshes
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+		TriangularMesh *coarseTriMesh = (TriangularMesh*)this->m_pCoarseMesh;
+
+		const unsigned int noEigenVal = this->m_nNoEigenVal;
+		const int numberOfVertices = (int)triMesh->verts.size();
+		const int numberOfCoarseVertices = (int)coarseTriMesh->verts.size();
+
+		//Guard vectors speed up the convergence of the last wanted eigen vectors in the subspace iteration
+		const unsigned int noGuardVectors = MAX(noEigenVal / 4, 8u);
+		const unsigned int subspaceSize = MIN(noEigenVal + noGuardVectors, (unsigned int)MAX(numberOfCoarseVertices - 2, 0));
+		if (subspaceSize < noEigenVal || subspaceSize < 2)
+		{
+			std::cerr << "Coarse mesh has too few vertices for " << noEigenVal << " eigen values!" << std::endl;
+			return TACORE_INVALID_OPERATION;
+		}
+
+#ifdef ENABLE_TIMING_REPORTS
+		TACore::Timer timer;
+#endif
+
+		//Cold decomposition of the coarse laplacian
+		std::vector<double> coarseRingAreas;
+		coarseTriMesh->calcRingAreasOfVertices(coarseRingAreas);
+		TACORE_CHECK_RESULT(createLaplacianMatrix(this->m_pCoarseMesh, this->m_LaplacianUsed, coarseRingAreas));
+
+		arma::cx_vec coarseEigval;
+		arma::cx_mat coarseEigvec;
+		TACORE_CHECK_RESULT(calcEigenDecomposition(subspaceSize, &coarseEigval, &coarseEigvec));
+		const arma::mat coarseEigVecs = arma::real(coarseEigvec);
+
+		TACORE_CHECK_RESULT(prepareLaplacian(mesh));
+		const arma::SpMat<double>& laplacian = *(this->m_mLaplacian);
+		const arma::SpMat<double> laplacianRows = laplacian.t();
+		const double spectrumBound = calcSpectrumUpperBound(laplacianRows);
+
+		//Iterations work on sign * laplacian whose spectrum is in [0, spectrumBound], the discrete laplacian is negative semidefinite
+		//Ritz values are the absolute eigen values in ascending order, the sign is put back at the end
+		const double spectrumSign = getSpectrumSign();
+
+		//Prolong the coarse eigen vectors by copying the value of the nearest coarse vertex
+		double coarseEdgeLengthSum = 0.0;
+		for (size_t e = 0; e < coarseTriMesh->edges.size(); e++)
+		{
+			coarseEdgeLengthSum += coarseTriMesh->edges[e]->length;
+		}
+		const float coarseCellSize = coarseTriMesh->edges.empty() ? 1.0f : (float)(coarseEdgeLengthSum / coarseTriMesh->edges.size());
+		TAShape::VertexGrid coarseGrid;
+		TACORE_CHECK_RESULT(coarseGrid.build(coarseTriMesh, coarseCellSize));
+
+		arma::mat subspace(numberOfVertices, subspaceSize);
+#pragma omp parallel for
+		for (int v = 0; v < numberOfVertices; v++)
+		{
+			const int nearestCoarseVertex = coarseGrid.queryNearest(triMesh->verts[v]->coords);
+			for (unsigned int k = 0; k < subspaceSize; k++)
+			{
+				subspace(v, k) = coarseEigVecs(nearestCoarseVertex, k);
+			}
+		}
+
+		arma::vec ritzVals;
+		double maxEigenValErrorBound = 0.0;
+		TACORE_CHECK_RESULT(refineEigenSubspace(laplacianRows, spectrumBound, noEigenVal, subspace, ritzVals, maxEigenValErrorBound));
+
+		outEigVals = ritzVals.subvec(0, noEigenVal - 1) * spectrumSign;
+		outEigVecs = subspace.cols(0, noEigenVal - 1);
+		std::cout << "Coarse to fine eigen decomposition of " << numberOfVertices << " vertices from " << numberOfCoarseVertices
+			<< " vertices: max relative eigen value error bound " << maxEigenValErrorBound << std::endl;
+#ifdef ENABLE_TIMING_REPORTS
+		const double coarseToFineSeconds = timer.seconds();
+		std::cout << "Time Passed to Calculate the Eigenvalues from the Coarse Mesh: " << coarseToFineSeconds << " secs." << std::endl;
+#endif
+
+		if (this->m_bValidateCoarseToFine)
+		{
+#ifdef ENABLE_TIMING_REPORTS
+			timer.reset();
+#endif
+			arma::cx_vec eigval;
+			arma::cx_mat eigvec;
+			TACORE_CHECK_RESULT(calcEigenDecomposition(noEigenVal, &eigval, &eigvec));
+
+			//Cold eigen values are compared in the order of their magnitudes, as the Ritz values are sorted
+			arma::vec coldEigVals = arma::abs(arma::real(eigval));
+			std::sort(coldEigVals.memptr(), coldEigVals.memptr() + coldEigVals.n_elem);
+			double maxRelError = 0.0;
+			for (unsigned int k = 0; k < noEigenVal; k++)
+			{
+				//Zero eigen value of the constant eigen vector has no relative error
+				if (coldEigVals(k) > 1e-12 * spectrumBound)
+				{
+					maxRelError = MAX(maxRelError, std::fabs(ritzVals(k) - coldEigVals(k)) / coldEigVals(k));
+				}
+			}
+			std::cout << "Cold eigen decomposition: max relative eigen value error of coarse to fine: " << maxRelError << std::endl;
+#ifdef ENABLE_TIMING_REPORTS
+			const double coldSeconds = timer.seconds();
+			std::cout << "Time Passed to Calculate the Eigenvalues by Cold Decomposition: " << coldSeconds << " secs., speedup of coarse to fine: " << coldSeconds / coarseToFineSeconds << std::endl;
+#endif
+		}
+
+		return TACORE_OK;
+	}
+
+	Result SpectralDescExtraction::refineEigenSubspace(const arma::SpMat<double>& laplacianRows, const double& spectrumBound, const unsigned int& noWanted,
+		arma::mat& subspace, arma::vec& outRitzVals, double& outErrorBound) const
+	{
+		if (!this->m_mLaplacian)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+		const arma::SpMat<double>& laplacian = *(this->m_mLaplacian);
+		const double spectrumSign = getSpectrumSign();
+		const int numberOfVertices = (int)subspace.n_rows;
+		const unsigned int subspaceSize = (unsigned int)subspace.n_cols;
+		if (noWanted == 0 || noWanted > subspaceSize)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		outErrorBound = 0.0;
+		for (unsigned int iter = 0; iter <= this->m_nNoRefinementIterations; iter++)
+		{
+			if (iter > 0 && outRitzVals(subspaceSize - 1) < spectrumBound)
+			{
+				//Chebyshev filter amplifies the part of the spectrum below the largest Ritz value and damps [largest Ritz value, spectrumBound]
+				const double halfWidth = (spectrumBound - outRitzVals(subspaceSize - 1)) / 2.0;
+				const double center = (spectrumBound + outRitzVals(subspaceSize - 1)) / 2.0;
+				arma::mat curr = subspace.t();
+				arma::mat prevToNext(subspaceSize, numberOfVertices);
+				for (unsigned int d = 1; d <= this->m_nRefinementFilterDegree; d++)
+				{
+					chebyshevStep(laplacianRows, spectrumSign / halfWidth, (-1.0) * center / halfWidth, curr, prevToNext, d == 1);
+					curr.swap(prevToNext);
+				}
+				subspace = curr.t();
+			}
+
+			//Rayleigh-Ritz on the orthonormalized subspace
+			arma::mat orthoBasis, upperTri;
+			if (!arma::qr_econ(orthoBasis, upperTri, subspace))
+			{
+				return TACORE_ERROR;
+			}
+			const arma::mat projected = orthoBasis.t() * (laplacian * orthoBasis) * spectrumSign;
+			arma::cx_vec projectedEigval;
+			arma::cx_mat projectedEigvec;
+			if (!arma::eig_gen(projectedEigval, projectedEigvec, projected))
+			{
+				return TACORE_ERROR;
+			}
+			const arma::vec projectedEigVals = arma::real(projectedEigval);
+			const arma::uvec ascending = arma::sort_index(projectedEigVals);
+			const arma::mat projectedEigVecs = arma::real(projectedEigvec);
+			arma::mat sortedEigVecs(subspaceSize, subspaceSize);
+			outRitzVals = arma::vec(subspaceSize);
+			for (unsigned int k = 0; k < subspaceSize; k++)
+			{
+				outRitzVals(k) = projectedEigVals(ascending(k));
+				for (unsigned int r = 0; r < subspaceSize; r++)
+				{
+					sortedEigVecs(r, k) = projectedEigVecs(r, ascending(k));
+				}
+			}
+			subspace = orthoBasis * sortedEigVecs;
+
+			//Residual norms of the wanted Ritz pairs relative to the spectrum bound
+			//Residual norm of a Ritz pair also bounds the error of its Ritz value, so it is reported relative to the Ritz value as well
+			const arma::mat laplacianSubspace = laplacian * subspace * spectrumSign;
+			double maxResidual = 0.0;
+			outErrorBound = 0.0;
+			for (unsigned int k = 0; k < noWanted; k++)
+			{
+				double sqResidual = 0.0;
+				double sqNorm = 0.0;
+				for (int v = 0; v < numberOfVertices; v++)
+				{
+					const double r = laplacianSubspace(v, k) - outRitzVals(k) * subspace(v, k);
+					sqResidual += r * r;
+					sqNorm += subspace(v, k) * subspace(v, k);
+				}
+				const double residual = sqrt(sqResidual / sqNorm);
+				maxResidual = MAX(maxResidual, residual / spectrumBound);
+				//Zero eigen value of the constant eigen vector has no relative error
+				if (outRitzVals(k) > 1e-12 * spectrumBound)
+				{
+					outErrorBound = MAX(outErrorBound, residual / outRitzVals(k));
+				}
+			}
+			std::cout << "Eigen subspace refinement, iteration " << iter << ": max relative residual " << maxResidual << std::endl;
+		}
+
+
+		return TACORE_OK;
+	}
+
+	bool SpectralDescExtraction::supportsAdaptiveEigenCount() const
+	{
+		return false;
+	}
+
+	unsigned int SpectralDescExtraction::countSignificantEigenVals(const arma::vec& eigVals, const double& sumRingAreas) const
+	{
+		return (unsigned int)eigVals.n_elem;
+	}
+
+	unsigned int SpectralDescExtraction::getNumberOfEigenValsUsed() const
+	{
+		if (!this->m_pEigenBasis)
+		{
+			return 0;
+		}
+		return MIN(this->m_nNoEigenVal, (unsigned int)this->m_pEigenBasis->m_vEigenValues.n_elem);
+	}
+
+	void SpectralDescExtraction::setAdaptiveEigenCount(const bool& adaptive)
+	{
+		this->m_bAdaptiveEigenCount = adaptive;
+	}
+
+	bool SpectralDescExtraction::getAdaptiveEigenCount() const
+	{
+		return this->m_bAdaptiveEigenCount;
+	}
+
+	void SpectralDescExtraction::setEigenValBlockSize(const unsigned int& blockSize)
+	{
+		this->m_nEigenValBlockSize = blockSize;
+	}
+
+	unsigned int SpectralDescExtraction::getEigenValBlockSize() const
+	{
+		return this->m_nEigenValBlockSize;
+	}
+
+	void SpectralDescExtraction::setAdaptiveEigenTolerance(const double& tolerance)
+	{
+		this->m_fAdaptiveEigenTolerance = tolerance;
+	}
+
+	double SpectralDescExtraction::getAdaptiveEigenTolerance() const
+	{
+		return this->m_fAdaptiveEigenTolerance;
+	}
+
+	void SpectralDescExtraction::setCoarseMesh(PolygonMesh *coarseMesh)
+	{
+		this->m_pCoarseMesh = coarseMesh;
+	}
+
+	PolygonMesh* SpectralDescExtraction::getCoarseMesh() const
+	{
+		return this->m_pCoarseMesh;
+	}
+
+	void SpectralDescExtraction::setNumberOfRefinementIterations(const unsigned int& noRefinementIterations)
+	{
+		this->m_nNoRefinementIterations = noRefinementIterations;
+	}
+
+	unsigned int SpectralDescExtraction::getNumberOfRefinementIterations() const
+	{
+		return this->m_nNoRefinementIterations;
+	}
+
+	void SpectralDescExtraction::setRefinementFilterDegree(const unsigned int& filterDegree)
+	{
+		this->m_nRefinementFilterDegree = filterDegree;
+	}
+
+	unsigned int SpectralDescExtraction::getRefinementFilterDegree() const
+	{
+		return this->m_nRefinementFilterDegree;
+	}
+
+	void SpectralDescExtraction::setValidateCoarseToFine(const bool& validate)
+	{
+		this->m_bValidateCoarseToFine = validate;
+	}
+
+	bool SpectralDescExtraction::getValidateCoarseToFine() const
+	{
+		return this->m_bValidateCoarseToFine;
+	}
+
+	Result SpectralDescExtraction::evaluateSpectralFilters(const arma::mat& filters, arma::mat& outDescriptors) const
+	{
+		if (!this->m_pEigenBasis)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+		const arma::mat& eigVecs = this->m_pEigenBasis->m_mEigenVectors;
+		if (filters.n_rows == 0 || filters.n_rows > eigVecs.n_cols)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//Only the first filters.n_rows eigen pairs take part, a shared basis may have more of them
+		const arma::mat sqEigVecs = arma::square(eigVecs.cols(0, filters.n_rows - 1)) * this->m_pEigenBasis->m_fSumRingAreas;
+
+		//Transposed product so that the descriptor of each vertex is a contiguous column
+		outDescriptors = filters.t() * sqEigVecs.t();
+
+		return TACORE_OK;
+	}
+
+	void SpectralDescExtraction::setTypeOfLaplacian(const SpectralDescExtraction::TypeOfLaplacian& typeLap)
+	{
+		this->m_LaplacianUsed = typeLap;
+	}
+
+	SpectralDescExtraction::TypeOfLaplacian SpectralDescExtraction::getTypeOfLaplacian() const
+	{
+		return this->m_LaplacianUsed;
+	}
+
+	void SpectralDescExtraction::setNumberOfEigenVals(const unsigned int& noEigenVals)
+	{
+		this->m_nNoEigenVal = noEigenVals;
+	}
+
+	unsigned int SpectralDescExtraction::getNumberOfEigenVals() const
+	{
+		return this->m_nNoEigenVal;
+	}
+
+	void SpectralDescExtraction::setEigenBasis(const SpectralEigenBasisPtr& eigenBasis)
+	{
+		this->m_pEigenBasis = eigenBasis;
+	}
+
+	SpectralEigenBasisPtr SpectralDescExtraction::getEigenBasis() const
+	{
+		return this->m_pEigenBasis;
+	}
+
+	void SpectralDescExtraction::setLaplacian(const SpectralLaplacianPtr& laplacian)
+	{
+		this->m_pLaplacian = laplacian;
+		this->m_mLaplacian = laplacian ? laplacian->m_pMatrix : std::shared_ptr<arma::SpMat<double> >();
+	}
+
+	SpectralLaplacianPtr SpectralDescExtraction::getLaplacian() const
+	{
+		return this->m_pLaplacian;
+	}
+
+	double SpectralDescExtraction::getSpectrumSign() const
+	{
+		return (this->m_LaplacianUsed == DISCRETE_LAPLACIAN) ? -1.0 : 1.0;
+	}
+
+	double SpectralDescExtraction::calcSpectrumUpperBound(const arma::SpMat<double>& laplacianRows)
+	{
+		const int numberOfRows = (int)laplacianRows.n_cols;
+		double upperBound = 0.0;
+		for (int i = 0; i < numberOfRows; i++)
+		{
+			double absRowSum = 0.0;
+			for (arma::uword k = laplacianRows.col_ptrs[i]; k < laplacianRows.col_ptrs[i + 1]; k++)
+			{
+				absRowSum += std::fabs(laplacianRows.values[k]);
+			}
+			upperBound = MAX(upperBound, absRowSum);
+		}
+		return upperBound;
+	}
+
+	void SpectralDescExtraction::chebyshevStep(const arma::SpMat<double>& laplacianRows, const double& alpha, const double& beta,
+		const arma::mat& curr, arma::mat& prevToNext, const bool& isFirstStep)
+	{
+		const int numberOfRows = (int)laplacianRows.n_cols;
+		const int blockSize = (int)curr.n_rows;
+#pragma omp parallel
+		{
+			std::vector<double> acc(blockSize);
+#pragma omp for schedule(dynamic, 1024)
+			for (int i = 0; i < numberOfRows; i++)
+			{
+				std::fill(acc.begin(), acc.end(), 0.0);
+				for (arma::uword k = laplacianRows.col_ptrs[i]; k < laplacianRows.col_ptrs[i + 1]; k++)
+				{
+					const double w = laplacianRows.values[k];
+					const double* currJ = curr.colptr(laplacianRows.row_indices[k]);
+					for (int b = 0; b < blockSize; b++)
+					{
+						acc[b] += w * currJ[b];
+					}
+				}
+				const double* currI = curr.colptr(i);
+				double* outI = prevToNext.colptr(i);
+				//T_1 = Y * T_0 and T_(k+1) = 2 * Y * T_k - T_(k-1), the previous block is not read on the first step
+				if (isFirstStep)
+				{
+					for (int b = 0; b < blockSize; b++)
+					{
+						outI[b] = alpha * acc[b] + beta * currI[b];
+					}
+				}
+				else
+				{
+					for (int b = 0; b < blockSize; b++)
+					{
+						outI[b] = 2.0 * (alpha * acc[b] + beta * currI[b]) - outI[b];
+					}
+				}
+			}
+		}
+	}
+
+	Result SpectralDescExtraction::createLaplacianMatrix(PolygonMesh *mesh, const TypeOfLaplacian& typeLap, const std::vector<double>& vertexRingAreas)
+	{
+#ifdef ENABLE_TIMING_REPORTS
+		TACore::Timer timer;
+#endif
+		Result res = TACore::TACORE_OK;
+		if (typeLap == SpectralDescExtraction::STAR_LAPLACIAN)
+		{
+			res = createStarLaplacianMatrix(mesh, vertexRingAreas);
+		}
+		if (typeLap == SpectralDescExtraction::DISCRETE_LAPLACIAN)
+		{
+			res = createDiscreteLaplacianMatrix(mesh, vertexRingAreas);
+		}
+#ifdef ENABLE_TIMING_REPORTS
+		std::cout << "Time Passed to Create Laplacian: " << timer.seconds() << " secs." << std::endl;
+#endif
+		return res;
+	}
+
+	Result SpectralDescExtraction::calcEigenDecomposition(const unsigned int& noEigenVals, arma::cx_vec *pEigVals, arma::cx_mat *pEigVecs)
+	{
+#ifdef ENABLE_TIMING_REPORTS
+		TACore::Timer timer;
+#endif
+		if (noEigenVals < 2)
+		{
+			std::cerr << "Number of eigen values and vectors must be greater than or equal to 2!" << std::endl;
+			return TACore::TACORE_BAD_ARGS;
+		}
+		if (!this->m_mLaplacian)
+		{
+			return TACore::TACORE_INVALID_OPERATION;
+		}
+
+		const bool ret = arma::eigs_gen(*pEigVals, *pEigVecs, *(this->m_mLaplacian), noEigenVals, "sm");
+		if (ret == false)
+		{
+			std::cout << "eigs_gen is failed to converge to find the eigen values of the Laplacian matrix" << std::endl;
+			return TACore::TACORE_ERROR;
+		}
+#ifdef ENABLE_TIMING_REPORTS
+		std::cout << "Time Passed to Calculate the Eigenvalues of the Laplacian: " << timer.seconds() << " secs." << std::endl;
+#endif
+		return TACore::TACORE_OK;
+	}
+
+	Result SpectralDescExtraction::createStarLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//We, now, know that the mesh is a triangular mesh
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+
+		this->m_mLaplacian.reset();
+
+		const int numberOfVertices = (int)triMesh->verts.size();
+		const int numberOfTriangles = (int)triMesh->tris.size();
+		const int numberOfEdges = (int)triMesh->edges.size();
+
+		//Visit each triangle once and calculate the cotangents of its three angles
+		//triangleCots[3 * t + k] is the cotangent of the angle facing the k^th edge (e1, e2, e3) of the triangle t
+		std::vector<double> triangleCots(3 * numberOfTriangles);
+#pragma omp parallel for
+		for (int t = 0; t < numberOfTriangles; t++)
+		{
+			const Triangle* tri = triMesh->tris[t];
+			const float* p1 = triMesh->verts[tri->v1i]->coords;
+			const float* p2 = triMesh->verts[tri->v2i]->coords;
+			const float* p3 = triMesh->verts[tri->v3i]->coords;
+
+			triangleCots[3 * t] = cotangentOfAngle(p3, p1, p2);		//e1 = (v1, v2) faces v3
+			triangleCots[3 * t + 1] = cotangentOfAngle(p2, p1, p3);	//e2 = (v1, v3) faces v2
+			triangleCots[3 * t + 2] = cotangentOfAngle(p1, p2, p3);	//e3 = (v2, v3) faces v1
+		}
+
+		//Cotangent weight of an edge is the average of the cotangents of the angles facing it
+		//Scattering to the edges is a single O(T) pass, so it is not worth to synchronize it
+		std::vector<double> edgeWeights(numberOfEdges, 0.0);
+		std::vector<int> edgeTriangleCounts(numberOfEdges, 0);
+		for (int t = 0; t < numberOfTriangles; t++)
+		{
+			const Triangle* tri = triMesh->tris[t];
+			edgeWeights[tri->e1] += triangleCots[3 * t];
+			edgeWeights[tri->e2] += triangleCots[3 * t + 1];
+			edgeWeights[tri->e3] += triangleCots[3 * t + 2];
+			edgeTriangleCounts[tri->e1]++;
+			edgeTriangleCounts[tri->e2]++;
+			edgeTriangleCounts[tri->e3]++;
+		}
+		for (int e = 0; e < numberOfEdges; e++)
+		{
+			if (edgeTriangleCounts[e] > 0)
+			{
+				edgeWeights[e] /= edgeTriangleCounts[e];
+			}
+		}
+
+		//Sum of the weights of each row. Every off diagonal entry of a row is normalized with it
+		std::vector<double> rowWeightSums(numberOfVertices, 0.0);
+#pragma omp parallel for
+		for (int i = 0; i < numberOfVertices; i++)
+		{
+			const std::vector<int>& edgeList = triMesh->verts[i]->edgeList;
+			double sum_w = 0.0;
+			for (size_t e = 0; e < edgeList.size(); e++)
+			{
+				sum_w += edgeWeights[edgeList[e]];
+			}
+			rowWeightSums[i] = sum_w;
+		}
+
+		//Sparsity pattern is symmetric: column j holds the diagonal and one entry for each neighbor of j
+		//Armadillo keeps sparse matrices column compressed, so the offsets of the columns are known before filling
+		arma::uvec colPtrs(numberOfVertices + 1);
+		colPtrs(0) = 0;
+		for (int j = 0; j < numberOfVertices; j++)
+		{
+			colPtrs(j + 1) = colPtrs(j) + triMesh->verts[j]->edgeList.size() + 1;
+		}
+
+		const size_t numberOfNonZeros = (size_t)colPtrs(numberOfVertices);
+		arma::uvec rowIndices(numberOfNonZeros);
+		arma::vec values(numberOfNonZeros);
+
+		//Normalize the laplacian while filling
+		const double sumRingAreas = std::accumulate(vertexRingAreas.begin(), vertexRingAreas.end(), 0.0);
+
+		//Each column is written to its own slot of the compressed arrays, no synchronization is needed
+#pragma omp parallel for
+		for (int j = 0; j < numberOfVertices; j++)
+		{
+			const std::vector<int>& edgeList = triMesh->verts[j]->edgeList;
+			const int noEntries = (int)edgeList.size() + 1;
+			arma::uword* colRows = rowIndices.memptr() + colPtrs(j);
+			double* colValues = values.memptr() + colPtrs(j);
+
+			colRows[0] = j;
+			colValues[0] = 1.0 / sumRingAreas;
+			for (int e = 1; e < noEntries; e++)
+			{
+				const Edge* edge = triMesh->edges[edgeList[e - 1]];
+				const int i = (edge->v1i == j) ? edge->v2i : edge->v1i;
+				colRows[e] = i;
+				colValues[e] = ((-1.0) * edgeWeights[edge->idx] / rowWeightSums[i]) / sumRingAreas;
+			}
+
+			//Row indices of a column must be ascending. Columns are as short as the vertex degree, insertion sort is enough
+			for (int e = 1; e < noEntries; e++)
+			{
+				const arma::uword row = colRows[e];
+				const double value = colValues[e];
+				int k = e - 1;
+				while (k >= 0 && colRows[k] > row)
+				{
+					colRows[k + 1] = colRows[k];
+					colValues[k + 1] = colValues[k];
+					k--;
+				}
+				colRows[k + 1] = row;
+				colValues[k + 1] = value;
+			}
+		}
+
+		this->m_mLaplacian.reset(new arma::SpMat<double>(rowIndices, colPtrs, values, numberOfVertices, numberOfVertices));
+
+		return TACore::TACORE_OK;
+	}
+
+	Result SpectralDescExtraction::createDiscreteLaplacianMatrix(PolygonMesh *mesh, const std::vector<double>& vertexRingAreas)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//We, now, know that the mesh is a triangular mesh
+		TriangularMesh *triMesh = (TriangularMesh*)mesh;
+
+		this->m_mLaplacian.reset();
+
+		const int numberOfVertices = (int)triMesh->verts.size();
+		const double pi = 3.1415926535897;
+		const double epsilon = 1e-10;
+
+		//Adaptive h according to the edge lengths around the vertex
+		std::vector<double> vertexHs(numberOfVertices, 0.0);
+#pragma omp parallel for
+		for (int i = 0; i < numberOfVertices; i++)
+		{
+			const std::vector<int>& vertexTriList = triMesh->verts[i]->triList;
+			std::set<int> neighborEdgeIndicesList;
+			for (size_t t = 0; t < vertexTriList.size(); t++)
+			{
+				neighborEdgeIndicesList.insert(triMesh->tris[vertexTriList[t]]->e1);
+			}
+			double neighborEdgeLengthSum = 0.0;
+			for (std::set<int>::iterator it = neighborEdgeIndicesList.begin(); it != neighborEdgeIndicesList.end(); ++it) {
+				neighborEdgeLengthSum += triMesh->edges[*it]->length;
+			}
+			vertexHs[i] = neighborEdgeIndicesList.empty() ? 0.0 : neighborEdgeLengthSum / neighborEdgeIndicesList.size();
+		}
+
+		//An entry of the row i is (A_j / 3) * exp(-d^2 / hh) * 4 / (pi * hh * hh) and it is kept only if it is greater than epsilon
+		//Bounding A_j by the maximum ring area gives the radius beyond which no entry of the row can pass the threshold:
+		//d^2 < hh * ln((A_max / 3) * 4 / (pi * hh * hh) / epsilon)
+		//Thus only the vertices inside that radius are visited, the kept entries are the same as visiting all of the vertices
+		const double maxRingArea = vertexRingAreas.empty() ? 0.0 : *std::max_element(vertexRingAreas.begin(), vertexRingAreas.end());
+		std::vector<float> supportRadii(numberOfVertices, -1.0f);
+		double radiusSum = 0.0;
+		int numberOfRadii = 0;
+		for (int i = 0; i < numberOfVertices; i++)
+		{
+			const double hh = vertexHs[i] * vertexHs[i];
+			if (hh <= 0.0)
+			{
+				continue;
+			}
+			const double ratio = (maxRingArea / 3.0) * (4.0 / (pi * hh * hh)) / epsilon;
+			if (ratio > 1.0)
+			{
+				//Small slack against the float round-off of the distances compared in the grid
+				supportRadii[i] = (float)(sqrt(hh * log(ratio)) * 1.01);
+				radiusSum += supportRadii[i];
+				numberOfRadii++;
+			}
+		}
+
+		TAShape::VertexGrid grid;
+		if (numberOfRadii > 0)
+		{
+			TACORE_CHECK_RESULT(grid.build(triMesh, (float)(radiusSum / numberOfRadii)));
+		}
+
+		//Rows are independent, each thread fills its own rows, sorted by column
+		std::vector< std::vector<int> > rowCols(numberOfVertices);
+		std::vector< std::vector<double> > rowValues(numberOfVertices);
+#pragma omp parallel for schedule(dynamic, 256)
+		for (int i = 0; i < numberOfVertices; i++)
+		{
+			Vertex *vi = triMesh->verts[i];
+			std::vector<int> candidates;
+			if (supportRadii[i] > 0.0f)
+			{
+				grid.queryRadius(vi->coords, supportRadii[i], candidates);
+				std::sort(candidates.begin(), candidates.end());
+			}
+
+			const double hh = vertexHs[i] * vertexHs[i];
+			const double fourOverPIhhhh = 4.0 / (pi * hh * hh);
+
+			std::vector<int>& cols = rowCols[i];
+			std::vector<double>& values = rowValues[i];
+			cols.reserve(candidates.size() + 1);
+			values.reserve(candidates.size() + 1);
+
+			double diagonalEntry = 0.0;
+			int diagonalPos = -1;
+			for (size_t c = 0; c < candidates.size(); c++)
+			{
+				const int j = candidates[c];
+				if (j == i)
+				{
+					continue;
+				}
+				if (diagonalPos < 0 && j > i)
+				{
+					diagonalPos = (int)cols.size();
+				}
+				const float eucDistanceBetweenTwo = triMesh->eucDistanceBetween(vi, triMesh->verts[j]);
+				const double entry = (vertexRingAreas[j] / 3.0) * exp((-1.0 * eucDistanceBetweenTwo * eucDistanceBetweenTwo) / hh) * fourOverPIhhhh;
+
+				if (entry > epsilon)
+				{
+					cols.push_back(j);
+					values.push_back(entry);
+					diagonalEntry += (-1.0) * entry;
+				}
+			}
+			if (diagonalPos < 0)
+			{
+				diagonalPos = (int)cols.size();
+			}
+			cols.insert(cols.begin() + diagonalPos, i);
+			values.insert(values.begin() + diagonalPos, diagonalEntry);
+		}
+
+		//Rows of the Laplacian in compressed form are the columns of its transpose in compressed column form
+		arma::uvec rowPtrs(numberOfVertices + 1);
+		rowPtrs(0) = 0;
+		for (int i = 0; i < numberOfVertices; i++)
+		{
+			rowPtrs(i + 1) = rowPtrs(i) + rowCols[i].size();
+		}
+
+		const size_t numberOfNonZeros = (size_t)rowPtrs(numberOfVertices);
+		arma::uvec colIndices(numberOfNonZeros);
+		arma::vec values(numberOfNonZeros);
+#pragma omp parallel for
+		for (int i = 0; i < numberOfVertices; i++)
+		{
+			arma::uword* outCols = colIndices.memptr() + rowPtrs(i);
+			double* outValues = values.memptr() + rowPtrs(i);
+			for (size_t k = 0; k < rowCols[i].size(); k++)
+			{
+				outCols[k] = rowCols[i][k];
+				outValues[k] = rowValues[i][k];
+			}
+		}
+
+		arma::SpMat<double> laplacianTransposed(colIndices, rowPtrs, values, numberOfVertices, numberOfVertices);
+		this->m_mLaplacian.reset(new arma::SpMat<double>(laplacianTransposed.t()));
+
+		return TACore::TACORE_OK;
+	}
+
+
+	double SpectralDescExtraction::cotangentOfAngle(const float* apex, const float* p, const float* q)
+	{
+		const double u[3] = { p[0] - apex[0], p[1] - apex[1], p[2] - apex[2] };
+		const double v[3] = { q[0] - apex[0], q[1] - apex[1], q[2] - apex[2] };
+
+		//cot = cos / sin = (u . v) / |u x v|
+		const double dot = u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+		const double cx = u[1] * v[2] - u[2] * v[1];
+		const double cy = u[2] * v[0] - u[0] * v[2];
+		const double cz = u[0] * v[1] - u[1] * v[0];
+		const double crossNorm = sqrt(cx * cx + cy * cy + cz * cz);
+
+		//Degenerate triangle, it does not contribute to the weight
+		if (crossNorm <= 0.0)
+		{
+			return 0.0;
+		}
+		return dot / crossNorm;
+	}
+}
\ No newline at end of file
@@ -2,5 +2,18 @@
 
 namespace TAFeaExt
 {
+	Result PerVertexFeatureExtraction::extractToMatrix(PolygonMesh *mesh, FeatureMatrix<double>& outMatrix)
+	{
+		std::vector<LocalFeaturePtr> features;
+		TACORE_CHECK_RESULT(extract(mesh, features));
+		return createFeatureMatrix(features, outMatrix);
+	}
 
-}
\ No newline at end of file
+	Result PerVertexFeatureExtraction::extractToMatrix(PolygonMesh *mesh, FeatureMatrix<float>& outMatrix)
+	{
+		FeatureMatrix<double> matrix;
+		TACORE_CHECK_RESULT(extractToMatrix(mesh, matrix));
+		outMatrix.assign(matrix);
+		return TACORE_OK;
+	}
+}
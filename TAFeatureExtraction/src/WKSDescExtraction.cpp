@@ -0,0 +1,159 @@
+#include "WKSDescExtraction.h"
+#include "WaveKernelSignatureDesc.h"
+#include <core/TriangularMesh.h>
+#include <cmath>
+
+#ifdef ENABLE_TIMING_REPORTS
+#include <core/Timer.h>
+#endif
+
+namespace TAFeaExt
+{
+	WKSDescExtraction::~WKSDescExtraction()
+	{
+		clear();
+	}
+
+	WKSDescExtraction::WKSDescExtraction()
+	{
+		this->m_nNumberOfEnergySamples = 100;
+		this->m_fVarianceFactor = 6.0;
+	}
+
+	WKSDescExtraction::WKSDescExtraction(const WKSDescExtraction& other) : SpectralDescExtraction(other)
+	{
+		this->m_nNumberOfEnergySamples = other.m_nNumberOfEnergySamples;
+		this->m_fVarianceFactor = other.m_fVarianceFactor;
+	}
+
+	void WKSDescExtraction::clear()
+	{
+		SpectralDescExtraction::clear();
+		this->m_nNumberOfEnergySamples = 100;
+		this->m_fVarianceFactor = 6.0;
+	}
+
+	Result WKSDescExtraction::extract(PolygonMesh *mesh, std::vector<LocalFeaturePtr>& outFeatures)
+	{
+		if (this->m_nNumberOfEnergySamples < 2)
+		{
+			return TACORE_INVALID_OPERATION;
+		}
+		TACORE_CHECK_RESULT(prepareEigenBasis(mesh));
+
+#ifdef ENABLE_TIMING_REPORTS
+		TACore::Timer timer;
+#endif
+		const arma::vec& eigval = this->m_pEigenBasis->m_vEigenValues;
+		const double sumRingAreas = this->m_pEigenBasis->m_fSumRingAreas;
+		const unsigned int noEigenVal = getNumberOfEigenValsUsed();
+
+		//Log of the scaled eigen values, the zero eigen value of the constant eigen vector has no energy
+		const double zeroEigenValTolerance = 1e-8;
+		std::vector<double> logEigVals(noEigenVal, 0.0);
+		std::vector<bool> hasEnergy(noEigenVal, false);
+		double minEnergy = INFINITY;
+		double maxEnergy = -INFINITY;
+		for (unsigned int eig = 0; eig < noEigenVal; eig++)
+		{
+			const double scaledEigVal = sumRingAreas * std::fabs(eigval(eig));
+			if (scaledEigVal > zeroEigenValTolerance)
+			{
+				hasEnergy[eig] = true;
+				logEigVals[eig] = log(scaledEigVal);
+				minEnergy = MIN(minEnergy, logEigVals[eig]);
+				maxEnergy = MAX(maxEnergy, logEigVals[eig]);
+			}
+		}
+		if (!(maxEnergy > minEnergy))
+		{
+			std::cerr << "At least two distinct non zero eigen values are needed for the wave kernel signature!" << std::endl;
+			return TACORE_ERROR;
+		}
+
+		const double eIncrement = (maxEnergy - minEnergy) / (this->m_nNumberOfEnergySamples - 1);
+		const double sigma = this->m_fVarianceFactor * eIncrement;
+		const double twoSigmaSq = 2.0 * sigma * sigma;
+
+		//Energy normalization does not depend on the vertex, so each energy is a filter normalized by its sum
+		arma::mat filters(noEigenVal, this->m_nNumberOfEnergySamples);
+		for (unsigned int e = 0; e < this->m_nNumberOfEnergySamples; e++)
+		{
+			const double energy = minEnergy + e * eIncrement;
+			double energySum = 0.0;
+			for (unsigned int eig = 0; eig < noEigenVal; eig++)
+			{
+				double filterVal = 0.0;
+				if (hasEnergy[eig])
+				{
+					const double diff = energy - logEigVals[eig];
+					filterVal = exp((-1.0) * diff * diff / twoSigmaSq);
+				}
+				filters(eig, e) = filterVal;
+				energySum += filterVal;
+			}
+			if (energySum > 0.0)
+			{
+				filters.col(e) /= energySum;
+			}
+		}
+
+		arma::mat descriptors;
+		TACORE_CHECK_RESULT(evaluateSpectralFilters(filters, descriptors));
+
+		const int verSize = (int)descriptors.n_cols;
+		outFeatures = std::vector<LocalFeaturePtr>(verSize);
+#pragma omp parallel for
+		for (int v = 0; v < verSize; v++)
+		{
+			WaveKernelSignatureDesc *pDesc = new WaveKernelSignatureDesc(v);
+			const double* vertexDesc = descriptors.colptr(v);
+			pDesc->m_vDescriptor = std::vector<double>(vertexDesc, vertexDesc + descriptors.n_rows);
+			outFeatures[v] = LocalFeaturePtr(pDesc);
+		}
+#ifdef ENABLE_TIMING_REPORTS
+		std::cout << "Time Passed to Calculate WKS from Eigenvalues and Eigenvectors: " << timer.seconds() << " secs." << std::endl;
+#endif
+
+		return TACORE_OK;
+	}
+
+	Result WKSDescExtraction::extract(PolygonMesh *mesh, const int& id, LocalFeaturePtr& outFeaturePtr)
+	{
+		if (!mesh || mesh->getPolygonType() != TA_TRIANGULAR)
+		{
+			return TACORE_BAD_ARGS;
+		}
+
+		//Descriptor of a single vertex needs the whole eigen basis, so it is not cheaper than extracting all of them
+		std::vector<LocalFeaturePtr> features;
+		TACORE_CHECK_RESULT(extract(mesh, features));
+		if (id < 0 || id >= (int)features.size())
+		{
+			return TACORE_BAD_ARGS;
+		}
+		outFeaturePtr = features[id];
+
+		return TACORE_OK;
+	}
+
+	void WKSDescExtraction::setNumberOfEnergySamples(const unsigned int& noEnergySamples)
+	{
+		this->m_nNumberOfEnergySamples = noEnergySamples;
+	}
+
+	unsigned int WKSDescExtraction::getNumberOfEnergySamples() const
+	{
+		return this->m_nNumberOfEnergySamples;
+	}
+
+	void WKSDescExtraction::setVarianceFactor(const double& varianceFactor)
+	{
+		this->m_fVarianceFactor = varianceFactor;
+	}
+
+	double WKSDescExtraction::getVarianceFactor() const
+	{
+		return this->m_fVarianceFactor;
+	}
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <random>
 #include <core/TAMatrix.h>
 #include <core/TriangularMesh.h>
 #include <core/CommandLineParser.h>
@@ -6,6 +7,8 @@
 #include <core/StdVectorUtil.h>
 #include <core/StringUtil.h>
 #include <core/PathUtil.h>
+#include <core/NDimVector.h>
+#include <core/PhiloxRandom.h>
 
 #include <oi/ThreeDimOIShape.h>
 
@@ -15,6 +18,8 @@
 #include "HeatKernelSignatureDesc.h"
 #include "PatchBasedSumOfCenterDistances.h"
 #include "PatchBasedShapeDistributionHistogram.h"
+#include "FeatureMatrix.h"
+#include "TAFeatureFileIO.h"
 
 //Extractors
 #include "OnEdgeAvgGeoDistExtraction.h"
@@ -292,8 +297,433 @@ int IntrinsicWaveExtractionTestAPP(int argc, char* argv[])
 	return mainRet(1, "Main Test Successfully Ended");
 }
 
+//Prints the outcome of a check and counts the failed ones
+void check(const bool& isPassed, const std::string& description, int& numberOfFailed)
+{
+	std::cout << (isPassed ? "PASSED: " : "FAILED: ") << description << std::endl;
+	if (!isPassed)
+	{
+		numberOfFailed++;
+	}
+}
+
+//Whether two feature matrices have the same layout and the same values up to a tolerance
+bool areFeatureMatricesEqual(const TAFea::FeatureMatrix<double>& first, const TAFea::FeatureMatrix<double>& second, const double& tolerance)
+{
+	if (first.rows() != second.rows() || first.getNumberOfBlocks() != second.getNumberOfBlocks() || first.getBlockSize() != second.getBlockSize()
+		|| first.getDescriptorType() != second.getDescriptorType())
+	{
+		return false;
+	}
+	const size_t noValues = (size_t)first.rows() * first.cols();
+	for (size_t i = 0; i < noValues; i++)
+	{
+		if (fabs(first.getData()[i] - second.getData()[i]) > tolerance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//Adds the arguments shared by the file format tests
+void addFileFormatTestArgs(TACore::ArgParser& parser)
+{
+	parser.addArg("input", "", true, 1, "", "Input mesh file");
+	parser.addArg("output-folder", "", true, 1, "", "Folder in which the test files are written");
+	parser.addArg("min-gd", "", false, 1, "20", "Minimum geodesic distance of the patches");
+	parser.addArg("max-gd", "", false, 1, "100", "Maximum geodesic distance of the patches");
+}
+
+//Sets the extraction parameters of the file format tests, they are small so the tests run quickly on any mesh
+void setFileFormatTestParameters(TACore::ArgParser& parser, TAFeaExt::PatchBasedShapeDistributionDescExtraction& extractor)
+{
+	extractor.setMinGeodesicDistance((float)parser.getDouble("min-gd"));
+	extractor.setMaxGeodesicDistance((float)parser.getDouble("max-gd"));
+	extractor.setNumberOfPatches(5);
+	extractor.setNumberOfBins(8);
+	extractor.setSampleCount(256);
+	extractor.setSamplingMethod(TAFeaExt::PatchBasedShapeDistributionDescExtraction::BIASED_VERTEX_SAMPLING);
+	extractor.setShapeDistributionFunction(TAFeaExt::PatchBasedShapeDistributionDescExtraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS);
+	extractor.setRandomSeed(5489);
+}
+
+//Extracts the features of all vertices from the geodesic distances of the mesh
+//Distance matrix is returned, since the extractor refers to it as long as it is used
+bool extractFileFormatTestFeatures(TACore::ArgParser& parser, TriangularMesh& triMesh, TAFeaExt::PatchBasedShapeDistributionDescExtraction& extractor,
+	GlobalFeaturePtr& outGdMatrix, std::vector<LocalFeaturePtr>& outFeas, TAFea::FeatureMatrix<double>& outFeaMatrix)
+{
+	TAFeaExt::GeodesicDistanceMatrixExtraction geoDistMatrixExtraction;
+	geoDistMatrixExtraction.setGeodesicDistanceType(GeodesicDistanceMatrix::ON_EDGE_GEODESIC);
+	if (geoDistMatrixExtraction.extract(&triMesh, outGdMatrix) != TACORE_OK)
+	{
+		return false;
+	}
+	setFileFormatTestParameters(parser, extractor);
+	extractor.setGeodesicDistanceMatrix((GeodesicDistanceMatrix*)outGdMatrix.get());
+	return extractor.extract(&triMesh, outFeas) == TACORE_OK && TAFea::createFeatureMatrix(outFeas, outFeaMatrix) == TACORE_OK;
+}
+
+//Checks that patches survive the compact patch file
+//Features extracted from the mapped patch file must be the same as the ones extracted from the geodesic distances, for all vertices and for a single one
+int PatchFileFormatTestAPP(int argc, char* argv[])
+{
+	// Parse args
+	TACore::ArgParser parser("PatchFileFormatTest", "Writes and reads back the patch file of a mesh");
+	addFileFormatTestArgs(parser);
+
+	if (!parser.parseCommandLine(argc, argv))
+	{
+		return mainRet(-1, "Command line parameters cannot be parsed correctly");
+	}
+
+	TriangularMesh triMesh;
+	if (triMesh.load(parser.get("input").c_str()) != TACORE_OK || triMesh.verts.empty())
+	{
+		return mainRet(1, "Mesh cannot be loaded correctly");
+	}
+	const std::string patchFilePath = TACore::PathUtil::joinPath(parser.get("output-folder"), "patches.pat");
+	int numberOfFailed = 0;
+
+	//Extractors differ only in where their patches come from
+	TAFeaExt::PatchBasedShapeDistributionDescExtraction extractors[3];
+	GlobalFeaturePtr gdMatrix;
+	std::vector<LocalFeaturePtr> feas;
+	TAFea::FeatureMatrix<double> feaMatrix;
+	check(extractFileFormatTestFeatures(parser, triMesh, extractors[0], gdMatrix, feas, feaMatrix), "Features are extracted from the geodesic distances", numberOfFailed);
+	setFileFormatTestParameters(parser, extractors[1]);
+	setFileFormatTestParameters(parser, extractors[2]);
+
+	const TAFeaExt::PatchBasedPerVertexFeatureExtraction::VertexPatchesListPtr patches = extractors[0].getPatchesForAllVertices();
+	std::vector<TAFeaExt::PatchBasedPerVertexFeatureExtraction::VertexPatches> loadedPatches;
+	check(patches && extractors[0].savePatchesInCompactBinary(*patches, patchFilePath) == TACORE_OK, "Patch file is saved", numberOfFailed);
+	check(extractors[0].loadPatchesInCompactBinary(patchFilePath, loadedPatches) == TACORE_OK, "Patch file is loaded", numberOfFailed);
+	bool arePatchesEqual = patches && loadedPatches.size() == patches->size();
+	for (size_t v = 0; arePatchesEqual && v < loadedPatches.size(); v++)
+	{
+		arePatchesEqual = loadedPatches[v].m_vVertexIds == (*patches)[v].m_vVertexIds && loadedPatches[v].m_vScaleEnds == (*patches)[v].m_vScaleEnds;
+	}
+	check(arePatchesEqual, "Loaded patches are the saved ones", numberOfFailed);
+
+	std::vector<LocalFeaturePtr> mappedFeas;
+	TAFea::FeatureMatrix<double> mappedFeaMatrix;
+	check(extractors[1].openPatchFile(patchFilePath) == TACORE_OK && extractors[1].extract(&triMesh, mappedFeas) == TACORE_OK
+		&& TAFea::createFeatureMatrix(mappedFeas, mappedFeaMatrix) == TACORE_OK, "Features are extracted from the mapped patch file", numberOfFailed);
+	check(areFeatureMatricesEqual(feaMatrix, mappedFeaMatrix, 0.0), "Features of the mapped patch file are the same", numberOfFailed);
+
+	//Extractor of the single vertex extracts nothing before, so it must set up the bin ranges of the mesh by itself
+	const int lastVertex = (int)triMesh.verts.size() - 1;
+	LocalFeaturePtr vertexFea;
+	TAFea::FeatureMatrix<double> vertexFeaMatrix;
+	check(extractors[2].openPatchFile(patchFilePath) == TACORE_OK && extractors[2].extract(&triMesh, lastVertex, vertexFea) == TACORE_OK
+		&& TAFea::createFeatureMatrix(std::vector<LocalFeaturePtr>(1, vertexFea), vertexFeaMatrix) == TACORE_OK
+		&& vertexFeaMatrix.cols() == feaMatrix.cols() && std::equal(vertexFeaMatrix.getRow(0), vertexFeaMatrix.getRow(0) + vertexFeaMatrix.cols(), feaMatrix.getRow(lastVertex)),
+		"Feature of a single vertex read from the mapped patch file is the same", numberOfFailed);
+	extractors[1].closePatchFile();
+	extractors[2].closePatchFile();
+
+	std::cout << numberOfFailed << " checks failed" << std::endl;
+	return mainRet(numberOfFailed == 0 ? 0 : 1, "Patch File Format Test Ended");
+}
+
+//Checks that features survive their file formats: the feature container with its header and the legacy PBSD file
+int FeatureFileFormatTestAPP(int argc, char* argv[])
+{
+	// Parse args
+	TACore::ArgParser parser("FeatureFileFormatTest", "Writes and reads back the feature files of a mesh");
+	addFileFormatTestArgs(parser);
+
+	if (!parser.parseCommandLine(argc, argv))
+	{
+		return mainRet(-1, "Command line parameters cannot be parsed correctly");
+	}
+
+	TriangularMesh triMesh;
+	if (triMesh.load(parser.get("input").c_str()) != TACORE_OK || triMesh.verts.empty())
+	{
+		return mainRet(1, "Mesh cannot be loaded correctly");
+	}
+	const std::string outputFolder = parser.get("output-folder");
+	const std::string featureFilePath = TACore::PathUtil::joinPath(outputFolder, "features.fea");
+	const std::string legacyFeatureFilePath = TACore::PathUtil::joinPath(outputFolder, "features.bin");
+	int numberOfFailed = 0;
+
+	TAFeaExt::PatchBasedShapeDistributionDescExtraction extractor;
+	GlobalFeaturePtr gdMatrix;
+	std::vector<LocalFeaturePtr> feas;
+	TAFea::FeatureMatrix<double> feaMatrix;
+	check(extractFileFormatTestFeatures(parser, triMesh, extractor, gdMatrix, feas, feaMatrix), "Features are extracted from the geodesic distances", numberOfFailed);
+
+	//Feature container
+	TAFea::FeatureFileInfo info;
+	info.m_nMeshHash = triMesh.calcContentHash();
+	info.m_vParameters.push_back(std::make_pair(std::string("DescriptorType"), std::string("pbsd")));
+	info.m_vParameters.push_back(std::make_pair(std::string("NumberOfBins"), std::string("8")));
+	TAFea::FeatureMatrix<double> readFeaMatrix;
+	TAFea::FeatureFileInfo readInfo;
+	check(TAFea::TAFeatureFileIO::writeFeatures(feas, info, featureFilePath) == TACORE_OK, "Feature file is written", numberOfFailed);
+	check(TAFea::TAFeatureFileIO::isFeatureContainer(featureFilePath), "Feature file is a container", numberOfFailed);
+	check(TAFea::TAFeatureFileIO::readFeatureMatrix(featureFilePath, readFeaMatrix, &readInfo) == TACORE_OK && areFeatureMatricesEqual(feaMatrix, readFeaMatrix, 0.0),
+		"Features read from the feature file are the written ones", numberOfFailed);
+	check(readInfo.m_nMeshHash == info.m_nMeshHash && readInfo.m_vParameters == info.m_vParameters, "Header of the feature file is the written one", numberOfFailed);
+
+	//Legacy PBSD file is not a container, but it is still read
+	std::vector<LocalFeaturePtr> legacyFeas;
+	TAFea::FeatureMatrix<double> legacyFeaMatrix;
+	check(TAFea::TAFeatureFileIO::writePBSDInBinary(feas, legacyFeatureFilePath) == TACORE_OK, "Legacy feature file is written", numberOfFailed);
+	check(!TAFea::TAFeatureFileIO::isFeatureContainer(legacyFeatureFilePath), "Legacy feature file is not a container", numberOfFailed);
+	check(TAFea::TAFeatureFileIO::readPBSDInBinary(legacyFeatureFilePath, legacyFeas) == TACORE_OK && TAFea::createFeatureMatrix(legacyFeas, legacyFeaMatrix) == TACORE_OK
+		&& areFeatureMatricesEqual(feaMatrix, legacyFeaMatrix, 0.0), "Features read from the legacy feature file are the written ones", numberOfFailed);
+
+	std::cout << numberOfFailed << " checks failed" << std::endl;
+	return mainRet(numberOfFailed == 0 ? 0 : 1, "Feature File Format Test Ended");
+}
+
+//Checks the mapped reading of a feature container: its layout, its rows and the distances of all rows to reference descriptors
+int MappedFeatureFileTestAPP(int argc, char* argv[])
+{
+	// Parse args
+	TACore::ArgParser parser("MappedFeatureFileTest", "Writes the feature file of a mesh and reads it back mapped");
+	addFileFormatTestArgs(parser);
+
+	if (!parser.parseCommandLine(argc, argv))
+	{
+		return mainRet(-1, "Command line parameters cannot be parsed correctly");
+	}
+
+	TriangularMesh triMesh;
+	if (triMesh.load(parser.get("input").c_str()) != TACORE_OK || triMesh.verts.empty())
+	{
+		return mainRet(1, "Mesh cannot be loaded correctly");
+	}
+	const std::string featureFilePath = TACore::PathUtil::joinPath(parser.get("output-folder"), "mapped_features.fea");
+	int numberOfFailed = 0;
+
+	TAFeaExt::PatchBasedShapeDistributionDescExtraction extractor;
+	GlobalFeaturePtr gdMatrix;
+	std::vector<LocalFeaturePtr> feas;
+	TAFea::FeatureMatrix<double> feaMatrix;
+	check(extractFileFormatTestFeatures(parser, triMesh, extractor, gdMatrix, feas, feaMatrix), "Features are extracted from the geodesic distances", numberOfFailed);
+
+	TAFea::FeatureFileInfo info;
+	info.m_nMeshHash = triMesh.calcContentHash();
+	check(TAFea::TAFeatureFileIO::writeFeatures(feas, info, featureFilePath) == TACORE_OK, "Feature file is written", numberOfFailed);
+
+	TAFea::MappedFeatureFile mappedFile;
+	const int noCols = feaMatrix.cols();
+	std::vector<double> row(noCols);
+	check(mappedFile.open(featureFilePath) == TACORE_OK && mappedFile.rows() == feaMatrix.rows() && mappedFile.cols() == noCols
+		&& mappedFile.getInfo().m_nMeshHash == info.m_nMeshHash, "Mapped feature file has the written layout", numberOfFailed);
+	bool areRowsEqual = mappedFile.isOpen();
+	for (int v = 0; areRowsEqual && v < mappedFile.rows(); v++)
+	{
+		mappedFile.readRow(v, &row[0]);
+		areRowsEqual = std::equal(row.begin(), row.end(), feaMatrix.getRow(v));
+	}
+	check(areRowsEqual, "Rows of the mapped feature file are the written ones", numberOfFailed);
+
+	//References are the first and the last rows, distances of the file are compared with the ones summed up row by row
+	const int noRefs = 2;
+	std::vector<double> refDescriptors(feaMatrix.getRow(0), feaMatrix.getRow(0) + noCols);
+	refDescriptors.insert(refDescriptors.end(), feaMatrix.getRow(feaMatrix.rows() - 1), feaMatrix.getRow(feaMatrix.rows() - 1) + noCols);
+	std::vector<double> distances;
+	bool areDistancesEqual = mappedFile.isOpen();
+	if (areDistancesEqual)
+	{
+		mappedFile.calcL2Distances(&refDescriptors[0], noRefs, distances);
+		areDistancesEqual = distances.size() == (size_t)noRefs * feaMatrix.rows();
+	}
+	for (int ref = 0; areDistancesEqual && ref < noRefs; ref++)
+	{
+		for (int v = 0; areDistancesEqual && v < feaMatrix.rows(); v++)
+		{
+			double sqDistance = 0.0;
+			for (int i = 0; i < noCols; i++)
+			{
+				const double diff = feaMatrix.getRow(v)[i] - refDescriptors[ref * noCols + i];
+				sqDistance += diff * diff;
+			}
+			areDistancesEqual = fabs(distances[(size_t)ref * feaMatrix.rows() + v] - sqrt(sqDistance)) <= 1e-9 * (1.0 + sqrt(sqDistance));
+		}
+	}
+	check(areDistancesEqual, "Distances of the mapped rows to the references are the ones of the written rows", numberOfFailed);
+	check(areDistancesEqual && distances[0] == 0.0 && distances[(size_t)2 * feaMatrix.rows() - 1] == 0.0, "Distances of the references to themselves are zero", numberOfFailed);
+	mappedFile.close();
+
+	std::cout << numberOfFailed << " checks failed" << std::endl;
+	return mainRet(numberOfFailed == 0 ? 0 : 1, "Mapped Feature File Test Ended");
+}
+
+//Exposes the sample kernels and the scalar sample functions of the shape distribution extraction to ShapeDistributionKernelTestAPP
+class ShapeDistributionKernelCheck : public TAFeaExt::PatchBasedShapeDistributionDescExtraction
+{
+public:
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::getNumberOfExactSamples;
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::createExactVertexSamples;
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::createBiasedVertexSamples;
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::calcAngleBetweenThreePoints;
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::calcDistanceBetweenTwoPoints;
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::calcAreaInsideThreePoints;
+	using TAFeaExt::PatchBasedShapeDistributionDescExtraction::calcVolumeInsideFourPoints;
+};
+
+//Checks the batched sample kernels against the scalar functions of the shape distributions on random points
+//Exact samples enumerate the combinations in lexicographic order, so each of them is compared with the scalar function of the same points,
+//random samples of the vertex sampling are compared with the exact distribution through their mean
+int ShapeDistributionKernelTestAPP(int argc, char* argv[])
+{
+	typedef TAFeaExt::PatchBasedShapeDistributionDescExtraction Extraction;
+	const int noPoints = 10;
+	const int sampleCount = 200000;
+	int numberOfFailed = 0;
+
+	//Batched kernels draw their random numbers in blocks, which must be the numbers drawn one by one
+	TACore::PhiloxRandom blockRng(5489, 1, 2);
+	TACore::PhiloxRandom singleRng(5489, 1, 2);
+	std::vector<uint32_t> randoms(1000);
+	bool areRandomsEqual = true;
+	for (int count = 1; count <= 300; count += 37)
+	{
+		blockRng.fill(&randoms[0], count);
+		for (int i = 0; i < count; i++)
+		{
+			areRandomsEqual = areRandomsEqual && (randoms[i] == singleRng.next());
+		}
+	}
+	check(areRandomsEqual, "Random numbers drawn in blocks are the ones drawn one by one", numberOfFailed);
+
+	std::mt19937 generator(5489);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	std::vector<double> coords(3 * noPoints);
+	std::vector<Vector3D> points(noPoints);
+	for (int i = 0; i < noPoints; i++)
+	{
+		coords[3 * i] = uniform(generator);
+		coords[3 * i + 1] = uniform(generator);
+		coords[3 * i + 2] = uniform(generator);
+		points[i] = Vector3D(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]);
+	}
+
+	//Patch of the smaller scale is the first half of the points
+	TAFeaExt::PatchBasedPerVertexFeatureExtraction::VertexPatches patches;
+	for (int i = 0; i < noPoints; i++)
+	{
+		patches.m_vVertexIds.push_back(i);
+	}
+	patches.m_vScaleEnds.push_back(noPoints / 2);
+	patches.m_vScaleEnds.push_back(noPoints);
+
+	const Extraction::ShapeDistributionFunction functions[] = { Extraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS, Extraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT,
+		Extraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS, Extraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS, Extraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS };
+	const int noPointsOfFunctions[] = { 3, 1, 2, 3, 4 };
+	const char* functionNames[] = { "A3", "D1", "D2", "D3", "D4" };
+
+	ShapeDistributionKernelCheck kernelCheck;
+
+	//Volumes below 1 are the usual case in a patch, they must not be truncated
+	const double smallVolume = kernelCheck.calcVolumeInsideFourPoints(Vector3D(0.0, 0.0, 0.0), Vector3D(0.5, 0.0, 0.0), Vector3D(0.0, 0.5, 0.0), Vector3D(0.0, 0.0, 0.5));
+	check(fabs(smallVolume - 0.125 / 6.0) <= 1e-12, "Volume of a tetrahedron smaller than 1 is not truncated", numberOfFailed);
+
+	for (int f = 0; f < 5; f++)
+	{
+		kernelCheck.setShapeDistributionFunction(functions[f]);
+		const int noSamplePoints = noPointsOfFunctions[f];
+		const int noOrderings = (functions[f] == Extraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS) ? 3 : 1;
+		for (int scale = 0; scale < patches.getNumberOfScales(); scale++)
+		{
+			const int patchSize = patches.getPatchSize(scale);
+			const long long noExactSamples = kernelCheck.getNumberOfExactSamples(patchSize);
+			std::vector<double> exactSamples((size_t)MAX(noExactSamples, 1LL), 0.0);
+			kernelCheck.createExactVertexSamples(patches, scale, coords, &exactSamples[0]);
+
+			//Scalar samples of the combinations in the same order
+			std::vector<double> scalarSamples;
+			int combination[4] = { 0, 1, 2, 3 };
+			bool hasNext = (patchSize >= noSamplePoints);
+			while (hasNext)
+			{
+				for (int r = 0; r < noOrderings; r++)
+				{
+					Vector3D pts[4];
+					for (int j = 0; j < noSamplePoints; j++)
+					{
+						pts[j] = points[combination[(j + r) % noSamplePoints]];
+					}
+					switch (functions[f])
+					{
+						case Extraction::ANGLE_BETWEEN_THREE_RANDOM_POINTS: scalarSamples.push_back(kernelCheck.calcAngleBetweenThreePoints(pts[0], pts[1], pts[2])); break;
+						case Extraction::DISTANCE_BETWEEN_FIXED_AND_RANDOM_POINT: scalarSamples.push_back(kernelCheck.calcDistanceBetweenTwoPoints(points[0], pts[0])); break;
+						case Extraction::DISTANCE_BETWEEN_TWO_RANDOM_POINTS: scalarSamples.push_back(kernelCheck.calcDistanceBetweenTwoPoints(pts[0], pts[1])); break;
+						case Extraction::SQRT_OF_AREA_OF_THREE_RANDOM_POINTS: scalarSamples.push_back(sqrt(kernelCheck.calcAreaInsideThreePoints(pts[0], pts[1], pts[2]))); break;
+						case Extraction::CBRT_OF_VOLUME_OF_FOUR_RANDOM_POINTS: scalarSamples.push_back(cbrt(kernelCheck.calcVolumeInsideFourPoints(pts[0], pts[1], pts[2], pts[3]))); break;
+					}
+				}
+				int pos = noSamplePoints - 1;
+				while (pos >= 0 && combination[pos] == patchSize - noSamplePoints + pos)
+				{
+					pos--;
+				}
+				hasNext = (pos >= 0);
+				if (hasNext)
+				{
+					combination[pos]++;
+					for (int j = pos + 1; j < noSamplePoints; j++)
+					{
+						combination[j] = combination[j - 1] + 1;
+					}
+				}
+			}
+
+			const std::string description = std::string(functionNames[f]) + " of a patch of " + StringUtil::str(patchSize) + " points";
+			bool areSamplesEqual = (noExactSamples == (long long)scalarSamples.size());
+			double exactMean = 0.0;
+			for (size_t i = 0; areSamplesEqual && i < scalarSamples.size(); i++)
+			{
+				areSamplesEqual = fabs(exactSamples[i] - scalarSamples[i]) <= 1e-6 * MAX(1.0, fabs(scalarSamples[i]));
+			}
+			for (size_t i = 0; i < scalarSamples.size(); i++)
+			{
+				exactMean += scalarSamples[i] / scalarSamples.size();
+			}
+			check(areSamplesEqual, "Exact samples of the kernel are the scalar ones, " + description, numberOfFailed);
+
+			//Vertex sampling draws ordered distinct points uniformly, so its mean converges to the mean of the exact samples
+			std::vector<double> randomSamples(sampleCount, 0.0);
+			TACore::PhiloxRandom rng(5489, (uint32_t)f, (uint32_t)scale);
+			kernelCheck.createBiasedVertexSamples(patches, scale, coords, sampleCount, rng, &randomSamples[0]);
+			double randomMean = 0.0;
+			for (int i = 0; i < sampleCount; i++)
+			{
+				randomMean += randomSamples[i] / sampleCount;
+			}
+			check(fabs(randomMean - exactMean) <= 0.02 * fabs(exactMean), "Mean of the random samples is the exact mean, " + description, numberOfFailed);
+		}
+	}
+
+	std::cout << numberOfFailed << " checks failed" << std::endl;
+	return mainRet(numberOfFailed == 0 ? 0 : 1, "Shape Distribution Kernel Test Ended");
+}
+
 int main(int argc, char* argv[])
 {
+	//Checks are selected by their name as the first argument, the other apps by uncommenting them
+	if (argc > 1 && std::string(argv[1]) == "patch-files")
+	{
+		return PatchFileFormatTestAPP(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::string(argv[1]) == "feature-files")
+	{
+		return FeatureFileFormatTestAPP(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::string(argv[1]) == "mapped-feature-files")
+	{
+		return MappedFeatureFileTestAPP(argc - 1, argv + 1);
+	}
+	if (argc > 1 && std::string(argv[1]) == "shape-distribution-kernels")
+	{
+		return ShapeDistributionKernelTestAPP(argc - 1, argv + 1);
+	}
+
 	/*return IntrinsicWaveExtractionTestAPP(argc, argv);*/
 	/*return HKSExtractionTestAPP(argc, argv);*/
 	/*return OnEdgeAvgDistExtractionTestApp(argc, argv);*/
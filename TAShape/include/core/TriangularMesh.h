@@ -232,6 +232,13 @@ namespace TAShape
 		*/
 		TriMeshAuxInfo calcAuxInfo() const;
 
+		/**
+		* @brief			Calculates a 64 bit FNV-1a hash of the vertex coordinates and the vertex indices of the triangles
+		*					Meshes with the same content give the same hash, so it identifies the mesh that features are extracted from
+		* @return			Content hash of the mesh
+		*/
+		unsigned long long calcContentHash() const;
+
 	};
 
 }
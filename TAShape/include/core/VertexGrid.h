@@ -0,0 +1,80 @@
+#ifndef TA_VERTEX_GRID_H
+#define TA_VERTEX_GRID_H
+
+#include <vector>
+#include <core/Defs.h>
+
+namespace TAShape
+{
+	class TriangularMesh;
+}
+
+namespace TAShape
+{
+	//Uniform grid spatial index over the vertices of a triangular mesh
+	//Vertices are bucketed into cubic cells so that a query only visits the cells around the query point
+	//Cell contents are kept in two flat arrays (cell offsets and vertex ids) filled by a counting sort
+	//The grid is not modified by queries, so the same grid can be queried from multiple threads
+	//The mesh must outlive the grid and its vertices must not move after build
+	class VertexGrid
+	{
+	public:
+		VertexGrid();
+		virtual ~VertexGrid();
+
+		/**
+		* @brief			Builds the grid over the vertices of the mesh
+		*					If the requested cell size creates too many cells for the number of vertices, it is enlarged
+		* @param			[in] mesh Mesh whose vertices are indexed
+		* @param			[in] cellSize Requested side length of a cell
+		* @return			TACORE_OK if successfully built.
+		* @return			TACORE_BAD_ARGS if mesh is NULL, has no vertices or cellSize is not positive
+		*/
+		TACore::Result build(const TriangularMesh* mesh, const float& cellSize);
+
+		/**
+		* @brief			Finds the vertices whose euc distance to the point is smaller than or equal to radius
+		*					Found vertex ids are appended to the output in cell order, not sorted
+		* @param			[in] point Coordinates of the query point
+		* @param			[in] radius Radius of the query sphere
+		* @param			[out] outVertexIds Ids of the vertices inside the query sphere
+		* @return			void
+		*/
+		void queryRadius(const float* point, const float& radius, std::vector<int>& outVertexIds) const;
+
+		/**
+		* @brief			Finds the vertex closest to the point
+		*					Cells are visited in growing shells around the cell of the point until no closer vertex can exist
+		* @param			[in] point Coordinates of the query point
+		* @return			Id of the closest vertex, -1 if the grid is empty
+		*/
+		int queryNearest(const float* point) const;
+
+		/**
+		* @brief			Clears the grid
+		* @return			void
+		*/
+		void clear();
+
+		/**
+		* @brief			Gets the side length of a cell, which may be larger than the requested one
+		* @return			Side length of a cell
+		*/
+		float getCellSize() const;
+
+	private:
+		const TriangularMesh* m_pMesh;			//< Mesh whose vertices are indexed
+		float m_fCellSize;						//< Side length of a cubic cell
+		float m_vMinCorner[3];					//< Minimum corner of the bounding box of the vertices
+		int m_vDims[3];							//< Number of cells in each dimension
+		std::vector<int> m_vCellStarts;			//< Offset of each cell inside m_vCellVertexIds, size is number of cells + 1
+		std::vector<int> m_vCellVertexIds;		//< Vertex ids grouped by their cells
+
+		/**
+		* @brief			Gets the cell coordinate of a value in a dimension clamped into the grid
+		*/
+		int cellCoord(const float& val, const int& dim) const;
+	};
+}
+
+#endif
@@ -4,6 +4,19 @@
 #include <core/ColorPalette.h>
 #include <core/TriMeshAuxInfo.h>
 
+namespace
+{
+	//Mixes the bytes of a value into a 64 bit FNV-1a hash
+	void fnv1aHashBytes(unsigned long long& hash, const void* val, const size_t& size)
+	{
+		const unsigned char* bytes = (const unsigned char*)val;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+	}
+}
+
 namespace TAShape
 {
 	TriangularMesh::TriangularMesh()
@@ -514,4 +527,25 @@ namespace TAShape
 		res.m_lfMaxVolumeOfTetrahedronConstructedByForVertices = calcMaxVolumeOfTetrahedronBetweenFourVertices();
 		return res;
 	}
+
+	unsigned long long TriangularMesh::calcContentHash() const
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+
+		const unsigned int noVerts = (unsigned int)verts.size();
+		fnv1aHashBytes(hash, &noVerts, sizeof(noVerts));
+		for (unsigned int v = 0; v < noVerts; v++)
+		{
+			fnv1aHashBytes(hash, verts[v]->coords, 3 * sizeof(float));
+		}
+
+		const unsigned int noTris = (unsigned int)tris.size();
+		fnv1aHashBytes(hash, &noTris, sizeof(noTris));
+		for (unsigned int t = 0; t < noTris; t++)
+		{
+			const int triVerts[3] = { tris[t]->v1i, tris[t]->v2i, tris[t]->v3i };
+			fnv1aHashBytes(hash, triVerts, sizeof(triVerts));
+		}
+		return hash;
+	}
 }
\ No newline at end of file
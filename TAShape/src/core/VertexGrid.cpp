@@ -0,0 +1,225 @@
+#include <core/VertexGrid.h>
+#include <core/TriangularMesh.h>
+#include <cmath>
+#include <cstdlib>
+
+namespace TAShape
+{
+	VertexGrid::VertexGrid()
+	{
+		m_pMesh = NULL;
+		m_fCellSize = 0.0f;
+		for (int d = 0; d < 3; d++)
+		{
+			m_vMinCorner[d] = 0.0f;
+			m_vDims[d] = 0;
+		}
+	}
+
+	VertexGrid::~VertexGrid()
+	{
+		clear();
+	}
+
+	void VertexGrid::clear()
+	{
+		m_pMesh = NULL;
+		m_fCellSize = 0.0f;
+		for (int d = 0; d < 3; d++)
+		{
+			m_vMinCorner[d] = 0.0f;
+			m_vDims[d] = 0;
+		}
+		m_vCellStarts.clear();
+		m_vCellVertexIds.clear();
+	}
+
+	float VertexGrid::getCellSize() const
+	{
+		return m_fCellSize;
+	}
+
+	TACore::Result VertexGrid::build(const TriangularMesh* mesh, const float& cellSize)
+	{
+		TACORE_CHECK_ARGS(mesh != NULL);
+		TACORE_CHECK_ARGS(mesh->verts.size() > 0);
+		TACORE_CHECK_ARGS(cellSize > 0.0f);
+
+		clear();
+		m_pMesh = mesh;
+
+		const int noVertices = (int)mesh->verts.size();
+
+		float maxCorner[3];
+		for (int d = 0; d < 3; d++)
+		{
+			m_vMinCorner[d] = mesh->verts[0]->coords[d];
+			maxCorner[d] = mesh->verts[0]->coords[d];
+		}
+		for (int v = 1; v < noVertices; v++)
+		{
+			const float* c = mesh->verts[v]->coords;
+			for (int d = 0; d < 3; d++)
+			{
+				m_vMinCorner[d] = MIN(m_vMinCorner[d], c[d]);
+				maxCorner[d] = MAX(maxCorner[d], c[d]);
+			}
+		}
+
+		//Do not let the grid have much more cells than vertices, empty cells cost memory and query time
+		const double maxNumberOfCells = 8.0 * noVertices + 64.0;
+		m_fCellSize = cellSize;
+		while (true)
+		{
+			double numberOfCells = 1.0;
+			for (int d = 0; d < 3; d++)
+			{
+				numberOfCells *= floor((maxCorner[d] - m_vMinCorner[d]) / m_fCellSize) + 1.0;
+			}
+			if (numberOfCells <= maxNumberOfCells)
+			{
+				break;
+			}
+			m_fCellSize *= 2.0f;
+		}
+
+		for (int d = 0; d < 3; d++)
+		{
+			m_vDims[d] = (int)floor((maxCorner[d] - m_vMinCorner[d]) / m_fCellSize) + 1;
+		}
+
+		//Counting sort of the vertices into their cells
+		const int numberOfCells = m_vDims[0] * m_vDims[1] * m_vDims[2];
+		std::vector<int> vertexCells(noVertices);
+		m_vCellStarts = std::vector<int>(numberOfCells + 1, 0);
+		for (int v = 0; v < noVertices; v++)
+		{
+			const float* c = mesh->verts[v]->coords;
+			const int cell = (cellCoord(c[2], 2) * m_vDims[1] + cellCoord(c[1], 1)) * m_vDims[0] + cellCoord(c[0], 0);
+			vertexCells[v] = cell;
+			m_vCellStarts[cell + 1]++;
+		}
+		for (int cell = 0; cell < numberOfCells; cell++)
+		{
+			m_vCellStarts[cell + 1] += m_vCellStarts[cell];
+		}
+
+		m_vCellVertexIds = std::vector<int>(noVertices);
+		std::vector<int> cellFill(m_vCellStarts.begin(), m_vCellStarts.end() - 1);
+		for (int v = 0; v < noVertices; v++)
+		{
+			m_vCellVertexIds[cellFill[vertexCells[v]]++] = v;
+		}
+
+		return TACore::TACORE_OK;
+	}
+
+	void VertexGrid::queryRadius(const float* point, const float& radius, std::vector<int>& outVertexIds) const
+	{
+		if (m_pMesh == NULL || radius < 0.0f)
+		{
+			return;
+		}
+
+		int minCell[3], maxCell[3];
+		for (int d = 0; d < 3; d++)
+		{
+			minCell[d] = cellCoord(point[d] - radius, d);
+			maxCell[d] = cellCoord(point[d] + radius, d);
+		}
+
+		const float sqRadius = radius * radius;
+		for (int z = minCell[2]; z <= maxCell[2]; z++)
+		{
+			for (int y = minCell[1]; y <= maxCell[1]; y++)
+			{
+				const int rowStart = (z * m_vDims[1] + y) * m_vDims[0];
+				for (int x = minCell[0]; x <= maxCell[0]; x++)
+				{
+					const int cell = rowStart + x;
+					for (int i = m_vCellStarts[cell]; i < m_vCellStarts[cell + 1]; i++)
+					{
+						const int w = m_vCellVertexIds[i];
+						const float* c = m_pMesh->verts[w]->coords;
+						const float d0 = c[0] - point[0];
+						const float d1 = c[1] - point[1];
+						const float d2 = c[2] - point[2];
+						if (d0 * d0 + d1 * d1 + d2 * d2 <= sqRadius)
+						{
+							outVertexIds.push_back(w);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	int VertexGrid::queryNearest(const float* point) const
+	{
+		if (m_pMesh == NULL || m_vCellVertexIds.empty())
+		{
+			return -1;
+		}
+
+		int centerCell[3];
+		for (int d = 0; d < 3; d++)
+		{
+			centerCell[d] = cellCoord(point[d], d);
+		}
+		const int maxShell = MAX(m_vDims[0], MAX(m_vDims[1], m_vDims[2]));
+
+		int nearestVertex = -1;
+		float nearestSqDist = INFINITY;
+		for (int shell = 0; shell <= maxShell; shell++)
+		{
+			//Only the cells on the surface of the shell are new
+			for (int z = MAX(centerCell[2] - shell, 0); z <= MIN(centerCell[2] + shell, m_vDims[2] - 1); z++)
+			{
+				for (int y = MAX(centerCell[1] - shell, 0); y <= MIN(centerCell[1] + shell, m_vDims[1] - 1); y++)
+				{
+					const bool isSurfaceZY = (abs(z - centerCell[2]) == shell || abs(y - centerCell[1]) == shell);
+					const int rowStart = (z * m_vDims[1] + y) * m_vDims[0];
+					for (int x = MAX(centerCell[0] - shell, 0); x <= MIN(centerCell[0] + shell, m_vDims[0] - 1); x++)
+					{
+						if (!isSurfaceZY && abs(x - centerCell[0]) != shell)
+						{
+							continue;
+						}
+						const int cell = rowStart + x;
+						for (int i = m_vCellStarts[cell]; i < m_vCellStarts[cell + 1]; i++)
+						{
+							const int w = m_vCellVertexIds[i];
+							const float* c = m_pMesh->verts[w]->coords;
+							const float d0 = c[0] - point[0];
+							const float d1 = c[1] - point[1];
+							const float d2 = c[2] - point[2];
+							const float sqDist = d0 * d0 + d1 * d1 + d2 * d2;
+							if (sqDist < nearestSqDist)
+							{
+								nearestSqDist = sqDist;
+								nearestVertex = w;
+							}
+						}
+					}
+				}
+			}
+
+			//Vertices in the next shells are at least shell * cellSize away from the point
+			const float shellDist = shell * m_fCellSize;
+			if (nearestVertex >= 0 && nearestSqDist <= shellDist * shellDist)
+			{
+				break;
+			}
+		}
+
+		return nearestVertex;
+	}
+
+	int VertexGrid::cellCoord(const float& val, const int& dim) const
+	{
+		int coord = (int)floor((val - m_vMinCorner[dim]) / m_fCellSize);
+		if (coord < 0) coord = 0;
+		else if (coord >= m_vDims[dim]) coord = m_vDims[dim] - 1;
+		return coord;
+	}
+}
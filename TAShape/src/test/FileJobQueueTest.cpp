@@ -0,0 +1,126 @@
+//Smoke test of TACore::FileJobQueue, depends on TACore only so it also builds where the shape providers do not, e.g. on Linux:
+//	g++ -std=c++11 -pthread -DFILE_JOB_QUEUE_TEST_MAIN -ITACore/include TAShape/src/test/FileJobQueueTest.cpp
+//		TACore/src/core/FileJobQueue.cpp TACore/src/core/PathUtil.cpp TACore/src/core/StringUtil.cpp -o FileJobQueueTest
+//Runs for a few seconds since the ages of the jobs are measured in seconds
+#include <core/FileJobQueue.h>
+#include <core/CommandLineParser.h>
+#include <core/PathUtil.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+	//Prints the outcome of a check and counts the failed ones
+	void check(const bool& isPassed, const std::string& description, int& numberOfFailed)
+	{
+		std::cout << (isPassed ? "PASSED: " : "FAILED: ") << description << std::endl;
+		if (!isPassed)
+		{
+			numberOfFailed++;
+		}
+	}
+
+	//Removes the job files of a queue folder left by a previous run
+	void clearQueueFolder(const std::string& queueFolder)
+	{
+		const char* stateFolders[] = { "pending", "running", "done", "failed" };
+		for (int i = 0; i < 4; i++)
+		{
+			std::vector<std::string> paths;
+			TACore::PathUtil::getDirectoryEntries(TACore::PathUtil::joinPath(queueFolder, stateFolders[i]), paths);
+			for (size_t p = 0; p < paths.size(); p++)
+			{
+				remove(paths[p].c_str());
+			}
+		}
+	}
+}
+
+int FileJobQueueTestApp(int argc, char* argv[])
+{
+	TACore::ArgParser parser("FileJobQueueTest", "Checks claiming, renewing and requeueing the jobs of a file job queue");
+	parser.addArg("queue-dir", "", false, 1, "FileJobQueueTestFolder", "Folder of the queue, job files in it are removed");
+	if (!parser.parseCommandLine(argc, argv))
+	{
+		return -1;
+	}
+
+	const std::string queueFolder = parser.get("queue-dir");
+	int numberOfFailed = 0;
+	TACore::FileJobQueue queue;
+	check(queue.open(queueFolder) == TACore::TACORE_OK, "Queue folder is opened", numberOfFailed);
+	if (!queue.isOpen())
+	{
+		return 1;
+	}
+	clearQueueFolder(queueFolder);
+
+	//Adding
+	check(queue.addJob("test_a", "content a") == TACore::TACORE_OK, "Job a is added", numberOfFailed);
+	check(queue.addJob("test_b", "content b") == TACore::TACORE_OK, "Job b is added", numberOfFailed);
+	check(queue.addJob("other_c", "content c") == TACore::TACORE_OK, "Job c is added", numberOfFailed);
+	check(queue.addJob("test_a", "content a") == TACore::TACORE_INVALID_OPERATION, "Pending job a is not added again", numberOfFailed);
+
+	//Claiming in the order of the names, only the jobs with the prefix
+	std::string name;
+	std::string content;
+	check(queue.claimJob("test_", name, content) && name == "test_a" && content == "content a", "Job a is claimed first", numberOfFailed);
+	check(queue.claimJob("test_", name, content) && name == "test_b" && content == "content b", "Job b is claimed second", numberOfFailed);
+	check(!queue.claimJob("test_", name, content), "No job with the prefix is left", numberOfFailed);
+	check(queue.addJob("test_a", "content a") == TACore::TACORE_INVALID_OPERATION, "Running job a is not added again", numberOfFailed);
+
+	//Fresh jobs are not requeued, a renewed job is kept while the other one is requeued after the age limit
+	check(queue.requeueStaleJobs("test_", 1) == 0, "Fresh jobs are not requeued", numberOfFailed);
+	std::this_thread::sleep_for(std::chrono::seconds(3));
+	queue.renewJob("test_a");
+	check(queue.requeueStaleJobs("test_", 1) == 1, "Only the job which is not renewed is requeued", numberOfFailed);
+	std::vector<std::string> names;
+	queue.getJobNames(TACore::FileJobQueue::JOB_PENDING, "test_", names);
+	check(names.size() == 1 && names[0] == "test_b", "Requeued job b is pending", numberOfFailed);
+	check(queue.finishJob("test_b", true) == TACore::TACORE_FILE_ERROR, "Requeued job b cannot be finished", numberOfFailed);
+	std::vector<std::string> temporaryPaths;
+	TACore::PathUtil::getDirectoryEntries(queueFolder, temporaryPaths, "tmp");
+	check(temporaryPaths.size() == 1, "Only the clock probe is left in the queue folder after requeueing", numberOfFailed);
+
+	//Heartbeat renews the claimed jobs until they are finished
+	check(queue.claimJob("test_", name, content) && name == "test_b", "Requeued job b is claimed again", numberOfFailed);
+	check(queue.startHeartbeat(1) == TACore::TACORE_OK, "Heartbeat is started", numberOfFailed);
+	check(queue.startHeartbeat(1) == TACore::TACORE_INVALID_OPERATION, "Heartbeat is not started twice", numberOfFailed);
+	std::this_thread::sleep_for(std::chrono::seconds(4));
+	check(queue.requeueStaleJobs("test_", 2) == 0, "Jobs renewed by the heartbeat are not requeued", numberOfFailed);
+	queue.stopHeartbeat();
+
+	//Finishing
+	check(queue.finishJob("test_a", true) == TACore::TACORE_OK, "Job a is done", numberOfFailed);
+	check(queue.finishJob("test_b", false) == TACore::TACORE_OK, "Job b is failed", numberOfFailed);
+	queue.getJobNames(TACore::FileJobQueue::JOB_DONE, "test_", names);
+	check(names.size() == 1 && names[0] == "test_a", "Job a is in done", numberOfFailed);
+	queue.getJobNames(TACore::FileJobQueue::JOB_FAILED, "test_", names);
+	check(names.size() == 1 && names[0] == "test_b", "Job b is in failed", numberOfFailed);
+	check(!queue.waitForJob("test_", 1, 1, name, content), "Waiting returns when no job with the prefix is pending or running", numberOfFailed);
+	check(queue.waitForJob("", 1, 1, name, content) && name == "other_c", "Waiting claims the job without the prefix", numberOfFailed);
+	check(queue.finishJob("other_c", true) == TACore::TACORE_OK, "Job c is done", numberOfFailed);
+
+	//A finished job can be added again
+	check(queue.addJob("test_b", "content b") == TACore::TACORE_OK, "Failed job b is added again", numberOfFailed);
+	queue.getJobNames(TACore::FileJobQueue::JOB_FAILED, "test_", names);
+	check(names.empty(), "Job b is not in failed anymore", numberOfFailed);
+
+	queue.close();
+	temporaryPaths.clear();
+	TACore::PathUtil::getDirectoryEntries(queueFolder, temporaryPaths, "tmp");
+	check(temporaryPaths.empty(), "Clock probe is removed when the queue is closed", numberOfFailed);
+	clearQueueFolder(queueFolder);
+
+	std::cout << numberOfFailed << " checks failed" << std::endl;
+	return (numberOfFailed == 0) ? 0 : 1;
+}
+
+#ifdef FILE_JOB_QUEUE_TEST_MAIN
+int main(int argc, char* argv[])
+{
+	return FileJobQueueTestApp(argc, argv);
+}
+#endif
@@ -7,6 +7,8 @@
 using namespace TACore;
 using namespace TAShape;
 
+int FileJobQueueTestApp(int argc, char* argv[]);
+
 int mainRet(int ret, std::string message)
 {
 	std::cout << "Message: " << message << std::endl;
@@ -19,6 +21,12 @@ int mainRet(int ret, std::string message)
 
 int main(int argc, char* argv[])
 {
+	//Checks of the core classes are selected by their name as the first argument
+	if (argc > 1 && std::string(argv[1]) == "file-job-queue")
+	{
+		return FileJobQueueTestApp(argc - 1, argv + 1);
+	}
+
 	// Parse args
 	TACore::ArgParser parser("TAShapeTest", "Loads, Saves, Shows different types of shapes");
 	parser.addArg("input", "", true, 1, "", "Input shape file to be loaded");